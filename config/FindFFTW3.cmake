@@ -4,6 +4,9 @@
 #  FFTW3_INCLUDE_DIR, where to find FFTW3lib.h, etc.
 #  FFTW3_LIBRARIES, the libraries needed to use FFTW3.
 #  JFFTW3_FOUND, If false, do not try to use FFTW3.
+#  FFTW3_THREADS_FOUND, if the multi-threaded FFTW3 library was also found.
+#  FFTW3_THREADS_LIBRARIES, the libraries needed to use multi-threaded FFTW3
+#     (VIGRA_FFTW_THREADS must then be defined to use them in FFTWPlan).
 # also defined, but not for general use are
 #  FFTW3_LIBRARY, where to find the FFTW3 library.
 
@@ -21,6 +24,12 @@ IF(FFTW3_FOUND)
   SET(FFTW3_LIBRARIES ${FFTW3_LIBRARY})
 ENDIF(FFTW3_FOUND)
 
+FIND_LIBRARY(FFTW3_THREADS_LIBRARY NAMES fftw3_threads )
+IF(FFTW3_FOUND AND FFTW3_THREADS_LIBRARY)
+  SET(FFTW3_THREADS_FOUND TRUE)
+  SET(FFTW3_THREADS_LIBRARIES ${FFTW3_THREADS_LIBRARY} ${FFTW3_LIBRARY})
+ENDIF(FFTW3_FOUND AND FFTW3_THREADS_LIBRARY)
+
 # Deprecated declarations.
 SET (NATIVE_FFTW3_INCLUDE_PATH ${FFTW3_INCLUDE_DIR} )
 IF(FFTW3_LIBRARY)
@@ -58,6 +58,9 @@ FUNCTION(VIGRA_ADD_TEST target)
     if(DEFINED LIBRARIES)
         TARGET_LINK_LIBRARIES(${target} ${LIBRARIES})
     endif()
+    if(CMAKE_THREAD_LIBS_INIT)
+        TARGET_LINK_LIBRARIES(${target} ${CMAKE_THREAD_LIBS_INIT})
+    endif()
     
     # find the test executable
     GET_TARGET_PROPERTY(${target}_executable ${target} LOCATION)
@@ -41,6 +41,7 @@
 #include "numerictraits.hxx"
 #include <memory>
 #include <algorithm>
+#include <utility>
 #include <iosfwd>
 
 #ifdef VIGRA_CHECK_BOUNDS
@@ -539,6 +540,17 @@ public:
         initImpl(rhs.begin(), rhs.end(), VigraFalseType());
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        // take over the memory of 'rhs', which is left empty
+    ArrayVector( this_type && rhs )
+    : view_type(),
+      capacity_(0),
+      alloc_(rhs.alloc_)
+    {
+        this->swap(rhs);
+    }
+#endif
+
     template <class U>
     explicit ArrayVector( ArrayVectorView<U> const & rhs, Alloc const & alloc = Alloc() )
     : view_type(),
@@ -574,6 +586,20 @@ public:
         return *this;
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        // The memory of 'rhs' is always taken over, and 'rhs' is left empty. 
+        // Unlike the copy assignment, this invalidates views to this array 
+        // even when the sizes match.
+    this_type & operator=( this_type && rhs )
+    {
+        if(this == &rhs)
+            return *this;
+        ArrayVector t(std::move(rhs));
+        this->swap(t);
+        return *this;
+    }
+#endif
+
     template <class U>
     this_type & operator=( ArrayVectorView<U> const & rhs);
 
@@ -872,6 +898,13 @@ ArrayVector<T, Alloc>::swap(this_type & rhs)
     std::swap(this->data_, rhs.data_);
 }
 
+template <class T, class Alloc>
+inline void
+swap(ArrayVector<T, Alloc> & a, ArrayVector<T, Alloc> & b)
+{
+    a.swap(b);
+}
+
 template <class T, class Alloc>
 inline void
 ArrayVector<T, Alloc>::deallocate(pointer data, size_type size)
@@ -38,6 +38,7 @@
 
 #include <memory>
 #include <algorithm>
+#include <utility>
 #include "utilities.hxx"
 #include "iteratortraits.hxx"
 #include "accessor.hxx"
@@ -751,6 +752,22 @@ class BasicImage
         resizeCopy(rhs);
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move constructor: take over the data of rhs, which becomes 
+            an image of size 0x0
+        */
+    BasicImage(BasicImage && rhs)
+    : data_(0),
+      lines_(0),
+      width_(0),
+      height_(0),
+      allocator_(rhs.allocator_),
+      pallocator_(rhs.pallocator_)
+    {
+        swap(rhs);
+    }
+#endif
+
         /** destructor
         */
     ~BasicImage()
@@ -762,6 +779,14 @@ class BasicImage
         */
     BasicImage & operator=(const BasicImage & rhs);
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move rhs image. The data of rhs are taken over without copying 
+            (invalidating all iterators into this image, even if the sizes match), 
+            and rhs becomes an image of size 0x0.
+        */
+    BasicImage & operator=(BasicImage && rhs);
+#endif
+
         /** \deprecated set Image with const value
         */
     BasicImage & operator=(value_type pixel);
@@ -1111,6 +1136,17 @@ BasicImage<PIXELTYPE, Alloc>::operator=(const BasicImage & rhs)
     return *this;
 }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+template <class PIXELTYPE, class Alloc>
+BasicImage<PIXELTYPE, Alloc> &
+BasicImage<PIXELTYPE, Alloc>::operator=(BasicImage && rhs)
+{
+    if(this != &rhs)
+        BasicImage(std::move(rhs)).swap(*this);
+    return *this;
+}
+#endif
+
 template <class PIXELTYPE, class Alloc>
 BasicImage<PIXELTYPE, Alloc> &
 BasicImage<PIXELTYPE, Alloc>::operator=(value_type pixel)
@@ -1241,6 +1277,13 @@ BasicImage<PIXELTYPE, Alloc>::swap( BasicImage & rhs )
   }
 }
 
+template <class PIXELTYPE, class Alloc>
+inline void
+swap(BasicImage<PIXELTYPE, Alloc> & a, BasicImage<PIXELTYPE, Alloc> & b)
+{
+    a.swap(b);
+}
+
 template <class PIXELTYPE, class Alloc>
 void
 BasicImage<PIXELTYPE, Alloc>::deallocate()
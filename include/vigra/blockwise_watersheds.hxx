@@ -0,0 +1,412 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_BLOCKWISE_WATERSHEDS_HXX
+#define VIGRA_BLOCKWISE_WATERSHEDS_HXX
+
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include "config.hxx"
+#include "error.hxx"
+#include "array_vector.hxx"
+#include "union_find.hxx"
+#include "multi_blockwise.hxx"
+#include "watersheds3d.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // The union-find watershed algorithm connects each voxel with its lowest 
+    // neighbor (or, on plateaus without lower neighbors, with all neighbors of
+    // the same value) and labels the connected components of the resulting graph.
+    // Since the edges of this graph depend only on 3x3x3 neighborhoods, the
+    // algorithm can be decomposed into blocks: 
+    //
+    //   LabelBlocks:   compute the direction bits of each block with a halo of one voxel
+    //                  and label the block, recording the scan order index of the first 
+    //                  voxel of each label,
+    //   MergeBlocks:   recompute the direction bits at the block's surface (with a halo 
+    //                  of two voxels) and merge labels connected by edges to preceding
+    //                  voxels in other blocks,
+    //   RelabelBlocks: replace the provisional labels with the final ones.
+    //
+    // Blocks are independent within each pass and are processed in parallel.
+template <class SrcArray, class DestArray, class Neighborhood3D>
+class BlockwiseWatershedsTask
+{
+  public:
+    typedef MultiArrayShape<3>::type          Shape;
+    typedef typename SrcArray::value_type     SrcType;
+    typedef typename DestArray::value_type    LabelType;
+    typedef typename Neighborhood3D::Direction Direction;
+
+    enum Pass { LabelBlocks, MergeBlocks, RelabelBlocks };
+
+    BlockwiseWatershedsTask(SrcArray const & src, DestArray & dest, Shape const & block_shape,
+                            ArrayVector<std::ptrdiff_t> & offsets,
+                            ArrayVector<ArrayVector<std::ptrdiff_t> > & first_voxels,
+                            ArrayVector<std::ptrdiff_t> & final_labels)
+    : src_(src), dest_(dest),
+      shape_(src.shape()), block_shape_(block_shape),
+      offsets_(offsets), first_voxels_(first_voxels), final_labels_(final_labels),
+      regions_(0), pass_(LabelBlocks)
+    {
+        for(unsigned int k=0; k<3; ++k)
+            blocks_[k] = (shape_[k] + block_shape_[k] - 1) / block_shape_[k];
+
+        // neighbors preceding the center in scan order
+        for(int k=0; k<Neighborhood3D::DirectionCount; ++k)
+        {
+            Shape d(Neighborhood3D::diff(k));
+            if(d[2] > 0 || (d[2] == 0 && (d[1] > 0 || (d[1] == 0 && d[0] >= 0))))
+                continue;
+            causal_.push_back(d);
+            bits_.push_back(Neighborhood3D::directionBit((Direction)k));
+            for(int j=0; j<Neighborhood3D::DirectionCount; ++j)
+                if(Shape(Neighborhood3D::diff(j)) == -d)
+                    opposite_bits_.push_back(Neighborhood3D::directionBit((Direction)j));
+        }
+    }
+
+    std::ptrdiff_t numberOfBlocks() const
+    {
+        return prod(blocks_);
+    }
+
+    void operator()(int, std::ptrdiff_t i) const
+    {
+        Shape start = blockCoordinate(i)*block_shape_,
+              stop  = min(start + block_shape_, shape_);
+        if(pass_ == LabelBlocks)
+            labelBlock(i, start, stop);
+        else if(pass_ == MergeBlocks)
+            mergeBlock(i, start, stop);
+        else
+            relabelBlock(i, start, stop);
+    }
+
+    Shape blockCoordinate(std::ptrdiff_t i) const
+    {
+        Shape block;
+        for(unsigned int k=0; k<3; ++k)
+        {
+            block[k] = i % blocks_[k];
+            i /= blocks_[k];
+        }
+        return block;
+    }
+
+    std::ptrdiff_t blockIndex(Shape const & p) const
+    {
+        return (p[0] / block_shape_[0]) + 
+               blocks_[0]*((p[1] / block_shape_[1]) + blocks_[1]*(p[2] / block_shape_[2]));
+    }
+
+    static bool isInside(Shape const & p, Shape const & start, Shape const & stop)
+    {
+        for(unsigned int k=0; k<3; ++k)
+            if(p[k] < start[k] || p[k] >= stop[k])
+                return false;
+        return true;
+    }
+
+        // direction bits as computed by preparewatersheds3D() for [start, stop)
+        // and a margin of one voxel (clipped at the border), returns the 
+        // start of the enlarged box
+    Shape orientations(Shape const & start, Shape const & stop, MultiArray<3, int> & bits) const
+    {
+        Shape outerStart = max(start - Shape(1), Shape()),
+              outerStop  = min(stop + Shape(1), shape_);
+        MultiArray<3, SrcType> buffer;
+        MultiArrayView<3, SrcType, StridedArrayTag> src =
+            blockwiseCheckout(src_, outerStart, outerStop, buffer);
+        bits.reshape(outerStop - outerStart);
+        preparewatersheds3D(src.traverser_begin(), src.shape(), StandardConstValueAccessor<SrcType>(),
+                            bits.traverser_begin(), StandardValueAccessor<int>(), Neighborhood3D());
+        return outerStart;
+    }
+
+    void labelBlock(std::ptrdiff_t i, Shape const & start, Shape const & stop) const
+    {
+        MultiArray<3, int> bits;
+        Shape bitsStart = orientations(start, stop, bits);
+        MultiArray<3, LabelType> buffer;
+        MultiArrayView<3, LabelType, StridedArrayTag> labels =
+            blockwiseDestination(dest_, start, stop, buffer);
+
+        // same as watershedLabeling3D(), but the latter doesn't support blocks of width 1
+        UnionFindArray<LabelType> regions;
+        Shape p(start);
+        do
+        {
+            LabelType currentLabel = regions.nextFreeLabel();
+            for(unsigned int j=0; j<causal_.size(); ++j)
+            {
+                Shape q = p + causal_[j];
+                if(!isInside(q, start, stop))
+                    continue;
+                if((bits[p - bitsStart] & bits_[j]) || (bits[q - bitsStart] & opposite_bits_[j]))
+                    currentLabel = regions.makeUnion(labels[q - start], currentLabel);
+            }
+            labels[p - start] = regions.finalizeLabel(currentLabel);
+        }
+        while(incrementCoordinate(p, start, stop));
+        offsets_[i+1] = regions.makeContiguous();
+
+        // labels are numbered in scan order of their first voxel, record these voxels
+        ArrayVector<std::ptrdiff_t> & first = first_voxels_[i];
+        Shape stride = detail::defaultStride<3>(shape_);
+        LabelType next = 1;
+        p = start;
+        do
+        {
+            LabelType label = regions[labels[p - start]];
+            labels[p - start] = label;
+            if(label == next)
+            {
+                first.push_back(dot(p, stride));
+                ++next;
+            }
+        }
+        while(incrementCoordinate(p, start, stop));
+
+        blockwiseCommit(dest_, start, labels);
+    }
+
+    void mergeBlock(std::ptrdiff_t i, Shape const & start, Shape const & stop) const
+    {
+        // direction bits and labels of the block and its neighbors
+        Shape labelStart = max(start - Shape(1), Shape()),
+              labelStop  = min(stop + Shape(1), shape_);
+        MultiArray<3, int> bits;
+        Shape bitsStart = orientations(labelStart, labelStop, bits);
+        MultiArray<3, LabelType> buffer;
+        MultiArrayView<3, LabelType, StridedArrayTag> labels =
+            blockwiseCheckout(dest_, labelStart, labelStop, buffer);
+
+        // only voxels at the block's surface have neighbors in other blocks
+        Shape p(start);
+        do
+        {
+            bool atSurface = false;
+            for(unsigned int k=0; k<3; ++k)
+                if(p[k] == start[k] || p[k] == stop[k]-1)
+                    atSurface = true;
+            if(!atSurface)
+                continue;
+            for(unsigned int j=0; j<causal_.size(); ++j)
+            {
+                Shape q = p + causal_[j];
+                if(!isInside(q, labelStart, labelStop) || isInside(q, start, stop))
+                    continue; // outside the volume or within the block
+                if((bits[p - bitsStart] & bits_[j]) || (bits[q - bitsStart] & opposite_bits_[j]))
+                    regions_->makeUnion(offsets_[i] + (std::ptrdiff_t)labels[p - labelStart],
+                                        offsets_[blockIndex(q)] + (std::ptrdiff_t)labels[q - labelStart]);
+            }
+        }
+        while(incrementCoordinate(p, start, stop));
+    }
+
+    void relabelBlock(std::ptrdiff_t i, Shape const & start, Shape const & stop) const
+    {
+        MultiArray<3, LabelType> buffer;
+        MultiArrayView<3, LabelType, StridedArrayTag> labels =
+            blockwiseCheckout(dest_, start, stop, buffer);
+        typename MultiArrayView<3, LabelType, StridedArrayTag>::iterator l = labels.begin(), 
+                                                                         end = labels.end();
+        for(; l != end; ++l)
+            *l = (LabelType)final_labels_[offsets_[i] + (std::ptrdiff_t)*l];
+        blockwiseCommit(dest_, start, labels);
+    }
+
+    SrcArray const & src_;
+    DestArray & dest_;
+    Shape shape_, block_shape_, blocks_;
+    ArrayVector<std::ptrdiff_t> & offsets_;
+    ArrayVector<ArrayVector<std::ptrdiff_t> > & first_voxels_;
+    ArrayVector<std::ptrdiff_t> & final_labels_;
+    ArrayVector<Shape> causal_;
+    ArrayVector<unsigned int> bits_, opposite_bits_;
+    ConcurrentUnionFindArray<std::ptrdiff_t> * regions_;
+    Pass pass_;
+};
+
+} // namespace detail
+
+/** \addtogroup BlockwiseProcessing
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                blockwise watersheds3D                */
+/*                                                      */
+/********************************************************/
+
+/** \brief Blockwise and parallel version of the union-find watershed algorithm.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <class SrcArray, class DestArray, class Neighborhood3D>
+        unsigned int
+        watersheds3D(SrcArray const & src, DestArray & dest,
+                     Neighborhood3D neighborhood3D, BlockwiseOptions<3> const & opt);
+    }
+    \endcode
+
+    Computes the same labeling as \ref watersheds3D() for the whole volume, 
+    but only ever holds a few blocks of the data in memory, so that \a src and \a dest
+    can be \ref vigra::ChunkedArray objects backed by files (e.g. \ref vigra::ChunkedArrayHDF5)
+    that don't fit into RAM. \a src and \a dest may also be in-memory arrays
+    (\ref vigra::MultiArrayView) in any combination. The volume is divided into blocks 
+    of shape <tt>opt.block_shape</tt> (default: the chunk shape of \a dest, if chunked),
+    which are processed in parallel by <tt>opt.n_threads</tt> threads:
+
+    <ol>
+    <li> Each block is segmented independently. Since a voxel's lowest neighbor
+         (and whether it belongs to a plateau) only depends on its direct neighborhood,
+         the block is read with a margin of one voxel, so that seeds (local minima and 
+         minimal plateaus) and the descent directions are determined exactly as 
+         for the whole volume.
+    <li> Regions touching across the seams between blocks are merged in a 
+         concurrent union-find structure, using the same descent and plateau 
+         criteria for the voxel pairs on either side of the seam.
+    <li> The merged regions are numbered in scan order of their first voxel and 
+         the labels are written back block by block.
+    </ol>
+
+    The result is therefore identical to \ref watersheds3D() on the complete volume, 
+    independent of the block shape and the number of threads. Besides the blocks, 
+    memory is only needed for a few integers per provisional label.
+    The function returns the number of regions, i.e. the largest label.
+    \a src and \a dest must have the same shape and must not overlap. The value type
+    of \a dest must be an integer type large enough to hold all labels.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/blockwise_watersheds.hxx\><br>
+    Namespace: vigra
+
+    \code
+    HDF5File file("volume.h5", HDF5File::Open);
+    ChunkedArrayHDF5<3, float> boundaries(file, "boundaries");
+    ChunkedArrayHDF5<3, UInt32> labels(file, "labels", boundaries.shape());
+
+    unsigned int count = watersheds3D(boundaries, labels, NeighborCode3DSix(),
+                                      BlockwiseOptions<3>().numThreads(8));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> unsigned int watersheds3D)
+
+template <class SrcArray, class DestArray, class Neighborhood3D>
+unsigned int
+watersheds3D(SrcArray const & src, DestArray & dest,
+             Neighborhood3D, BlockwiseOptions<3> const & opt)
+{
+    typedef MultiArrayShape<3>::type Shape;
+    typedef typename DestArray::value_type LabelType;
+    typedef detail::BlockwiseWatershedsTask<SrcArray, DestArray, Neighborhood3D> Task;
+
+    vigra_precondition(Shape(src.shape()) == Shape(dest.shape()),
+        "watersheds3D(): shape mismatch between input and output.");
+    vigra_precondition(!detail::blockwiseArraysOverlap(src, dest),
+        "watersheds3D(): source and destination must not overlap.");
+    if(min(Shape(src.shape())) <= 0)
+        return 0;
+
+    Shape block_shape = opt.block_shape;
+    if(min(block_shape) <= 0)
+        block_shape = detail::blockwiseDefaultBlockShape(dest);
+
+    ArrayVector<std::ptrdiff_t> offsets, final_labels;
+    ArrayVector<ArrayVector<std::ptrdiff_t> > first_voxels;
+    Task task(src, dest, block_shape, offsets, first_voxels, final_labels);
+    std::ptrdiff_t blockCount = task.numberOfBlocks();
+    offsets.resize(blockCount + 1, 0);
+    first_voxels.resize(blockCount);
+
+    // label each block separately
+    parallel_foreach(opt.n_threads, blockCount, task);
+    for(std::ptrdiff_t i = 0; i < blockCount; ++i)
+        offsets[i+1] += offsets[i];
+    std::ptrdiff_t labelCount = offsets[blockCount];
+
+    // merge regions across the seams
+    detail::ConcurrentUnionFindArray<std::ptrdiff_t> regions(labelCount + 1);
+    task.regions_ = &regions;
+    task.pass_ = Task::MergeBlocks;
+    parallel_foreach(opt.n_threads, blockCount, task);
+
+    // number the regions in scan order of their first voxel, like watersheds3D()
+    ArrayVector<std::ptrdiff_t> first(labelCount + 1, NumericTraits<std::ptrdiff_t>::max());
+    for(std::ptrdiff_t i = 0; i < blockCount; ++i)
+    {
+        for(std::ptrdiff_t l = 0; l < (std::ptrdiff_t)first_voxels[i].size(); ++l)
+        {
+            std::ptrdiff_t root = regions.find(offsets[i] + l + 1);
+            first[root] = std::min(first[root], first_voxels[i][l]);
+        }
+        ArrayVector<std::ptrdiff_t>().swap(first_voxels[i]);
+    }
+    ArrayVector<std::pair<std::ptrdiff_t, std::ptrdiff_t> > roots;
+    for(std::ptrdiff_t l = 1; l <= labelCount; ++l)
+        if(regions.find(l) == l)
+            roots.push_back(std::make_pair(first[l], l));
+    std::sort(roots.begin(), roots.end());
+    vigra_invariant(roots.size() <= (std::size_t)NumericTraits<LabelType>::max(),
+        "watersheds3D(): Need more labels than can be represented in the destination type.");
+
+    final_labels.resize(labelCount + 1, 0);
+    for(std::ptrdiff_t k = 0; k < (std::ptrdiff_t)roots.size(); ++k)
+        final_labels[roots[k].second] = k + 1;
+    for(std::ptrdiff_t l = 1; l <= labelCount; ++l)
+        final_labels[l] = final_labels[regions.find(l)];
+
+    // write the final labels
+    task.pass_ = Task::RelabelBlocks;
+    parallel_foreach(opt.n_threads, blockCount, task);
+    return (unsigned int)roots.size();
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_BLOCKWISE_WATERSHEDS_HXX
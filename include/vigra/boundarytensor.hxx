@@ -45,6 +45,7 @@
 #include "combineimages.hxx"
 #include "numerictraits.hxx"
 #include "convolution.hxx"
+#include "scratch_arena.hxx"
 
 namespace vigra {
 
@@ -224,7 +225,7 @@ template <class SrcIterator, class SrcAccessor,
 void
 evenPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
                  DestIterator dupperleft, DestAccessor dest,
-                 double scale, bool noLaplacian)
+                 double scale, bool noLaplacian, ScratchArena * arena = 0)
 {
     vigra_precondition(dest.size(dupperleft) == 3,
                        "evenPolarFilters(): image for even output must have 3 bands.");
@@ -234,9 +235,9 @@ evenPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor sr
 
     typedef typename
        NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
-    typedef BasicImage<TinyVector<TmpType, 3> > TmpImage;
+    typedef ScratchImage<TinyVector<TmpType, 3> > TmpImage;
     typedef typename TmpImage::traverser TmpTraverser;
-    TmpImage t(w, h);
+    TmpImage t(Size2D(w, h), arena);
 
     KernelArray k2;
     initGaussianPolarFilters2(scale, k2);
@@ -287,7 +288,7 @@ template <class SrcIterator, class SrcAccessor,
 void
 oddPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
                 DestIterator dupperleft, DestAccessor dest,
-                double scale, bool addResult)
+                double scale, bool addResult, ScratchArena * arena = 0)
 {
     vigra_precondition(dest.size(dupperleft) == 3,
                        "oddPolarFilters(): image for odd output must have 3 bands.");
@@ -297,9 +298,9 @@ oddPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src
 
     typedef typename
        NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
-    typedef BasicImage<TinyVector<TmpType, 4> > TmpImage;
+    typedef ScratchImage<TinyVector<TmpType, 4> > TmpImage;
     typedef typename TmpImage::traverser TmpTraverser;
-    TmpImage t(w, h);
+    TmpImage t(Size2D(w, h), arena);
 
     detail::KernelArray k1;
     detail::initGaussianPolarFilters1(scale, k1);
@@ -557,6 +558,11 @@ void rieszTransformOfLOG(triple<SrcIterator, SrcIterator, SrcAccessor> src,
     \ref boundaryTensor1() with the same interface implements a variant of the
     boundary tensor where the 0th-order Riesz transform has been dropped, so that the
     tensor is no longer sensitive to blobs.
+    
+    The filter responses are collected in two temporary images. When a 
+    \ref vigra::ScratchArena is passed, these images are allocated from the arena,
+    so that repeated calls on images of the same size don't allocate any memory
+    (see \ref ScratchMemory).
 
     <b> Declarations:</b>
 
@@ -568,6 +574,13 @@ void rieszTransformOfLOG(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         void boundaryTensor(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
                             DestIterator dupperleft, DestAccessor dest,
                             double scale);
+
+        // take the temporary images from 'arena'
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void boundaryTensor(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                            DestIterator dupperleft, DestAccessor dest,
+                            double scale, ScratchArena & arena);
     }
     \endcode
 
@@ -579,6 +592,12 @@ void rieszTransformOfLOG(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                             pair<DestIterator, DestAccessor> dest,
                             double scale);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                            pair<DestIterator, DestAccessor> dest,
+                            double scale, ScratchArena & arena);
     }
     \endcode
 
@@ -591,6 +610,11 @@ void rieszTransformOfLOG(triple<SrcIterator, SrcIterator, SrcAccessor> src,
     FVector3Image bt(w,h);
     ...
     boundaryTensor(srcImageRange(img), destImage(bt), 2.0);
+    
+    // process a sequence of images, reusing the temporary memory
+    ScratchArena arena;
+    for(int k=0; k<images.size(); ++k)
+        boundaryTensor(srcImageRange(images[k]), destImage(bt), 2.0, arena);
     \endcode
 
 */
@@ -613,6 +637,23 @@ void boundaryTensor(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor
                              dupperleft, dest, scale, true);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+void boundaryTensor(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                    DestIterator dupperleft, DestAccessor dest,
+                    double scale, ScratchArena & arena)
+{
+    vigra_precondition(dest.size(dupperleft) == 3,
+                       "boundaryTensor(): image for even output must have 3 bands.");
+    vigra_precondition(scale > 0.0,
+                       "boundaryTensor(): scale must be positive.");
+
+    detail::evenPolarFilters(supperleft, slowerright, src,
+                             dupperleft, dest, scale, false, &arena);
+    detail::oddPolarFilters(supperleft, slowerright, src,
+                             dupperleft, dest, scale, true, &arena);
+}
+
 template <class SrcIterator, class SrcAccessor,
           class DestIterator, class DestAccessor>
 inline
@@ -624,6 +665,17 @@ void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                    dest.first, dest.second, scale);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline
+void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                    pair<DestIterator, DestAccessor> dest,
+                    double scale, ScratchArena & arena)
+{
+    boundaryTensor(src.first, src.second, src.third,
+                   dest.first, dest.second, scale, arena);
+}
+
 /** \brief Boundary tensor variant.
 
     This function implements a variant of the boundary tensor where the 
@@ -643,6 +695,13 @@ void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         void boundaryTensor1(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
                              DestIterator dupperleft, DestAccessor dest,
                              double scale);
+
+        // take the temporary images from 'arena'
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void boundaryTensor1(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                             DestIterator dupperleft, DestAccessor dest,
+                             double scale, ScratchArena & arena);
     }
     \endcode
 
@@ -654,6 +713,12 @@ void boundaryTensor(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         void boundaryTensor1(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                              pair<DestIterator, DestAccessor> dest,
                              double scale);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void boundaryTensor1(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                             pair<DestIterator, DestAccessor> dest,
+                             double scale, ScratchArena & arena);
     }
     \endcode
 */
@@ -676,6 +741,23 @@ void boundaryTensor1(SrcIterator supperleft, SrcIterator slowerright, SrcAccesso
                              dupperleft, dest, scale, true);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+void boundaryTensor1(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                    DestIterator dupperleft, DestAccessor dest,
+                    double scale, ScratchArena & arena)
+{
+    vigra_precondition(dest.size(dupperleft) == 3,
+                       "boundaryTensor1(): image for even output must have 3 bands.");
+    vigra_precondition(scale > 0.0,
+                       "boundaryTensor1(): scale must be positive.");
+
+    detail::evenPolarFilters(supperleft, slowerright, src,
+                             dupperleft, dest, scale, true, &arena);
+    detail::oddPolarFilters(supperleft, slowerright, src,
+                             dupperleft, dest, scale, true, &arena);
+}
+
 template <class SrcIterator, class SrcAccessor,
           class DestIterator, class DestAccessor>
 inline
@@ -687,6 +769,17 @@ void boundaryTensor1(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                     dest.first, dest.second, scale);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline
+void boundaryTensor1(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                     pair<DestIterator, DestAccessor> dest,
+                     double scale, ScratchArena & arena)
+{
+    boundaryTensor1(src.first, src.second, src.third,
+                    dest.first, dest.second, scale, arena);
+}
+
 /********************************************************/
 /*                                                      */
 /*                    boundaryTensor3                   */
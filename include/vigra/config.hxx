@@ -106,6 +106,15 @@
     
     #if _MSC_VER >= 1600
         #define VIGRA_HAS_UNIQUE_PTR
+        #define VIGRA_HAS_RVALUE_REFERENCES
+    #endif
+    
+    #if _MSC_VER >= 1700
+        #define VIGRA_HAS_STD_THREAD
+    #endif
+    
+    #if _MSC_VER >= 1900
+        #define VIGRA_HAS_THREAD_LOCAL
     #endif
     
     #define VIGRA_NEED_BIN_STREAMS
@@ -144,6 +153,13 @@
     
     #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
         #define VIGRA_HAS_UNIQUE_PTR
+        #define VIGRA_HAS_RVALUE_REFERENCES
+    #endif
+    
+    #if __cplusplus >= 201103L
+        #define VIGRA_HAS_NOEXCEPT
+        #define VIGRA_HAS_STD_THREAD
+        #define VIGRA_HAS_THREAD_LOCAL
     #endif
 
 #endif  // __GNUC__
@@ -222,6 +238,10 @@
     #define VIGRA_EXPORT
 #endif
 
+#ifdef VIGRA_NO_THREADS
+#  undef VIGRA_HAS_STD_THREAD
+#endif
+
 #ifdef VIGRA_HAS_UNIQUE_PTR
 #  define VIGRA_UNIQUE_PTR  std::unique_ptr
 #else
@@ -43,6 +43,7 @@
 #include "recursiveconvolution.hxx"
 #include "nonlineardiffusion.hxx"
 #include "combineimages.hxx"
+#include "copyimage.hxx"
 
 /** \page Convolution Functions to Convolve Images and Signals
 
@@ -282,6 +283,133 @@ convolveImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                   dest.first, dest.second, kx, ky);
 }
 
+/** \brief Convolve an image with a 2D kernel, using a separable approximation if possible.
+
+    The kernel is approximated by a sum of at most <tt>maxRank</tt> separable 
+    kernels by means of \ref Kernel2D::separableApproximation(). If the relative 
+    approximation error is at most <tt>tolerance</tt> and the separable filters need fewer 
+    operations than the 2D kernel (i.e. <tt>rank*(width+height) < width*height</tt>),
+    the image is convolved with each pair of 1D kernels (see \ref separableConvolveX() and 
+    \ref separableConvolveY()), and the results are added. Otherwise, or when the kernel's 
+    border treatment is <tt>BORDER_TREATMENT_CLIP</tt> (which renormalizes with the 
+    2D kernel's weights), the image is convolved directly with the 2D kernel, as in 
+    the \ref convolveImage() variant taking <tt>kernel2d()</tt>.
+    
+    The tolerance refers to the kernel coefficients (in the sense of the Frobenius norm), 
+    so that the absolute error of the result is bounded by 
+    <tt>tolerance * sqrt(width*height) * ||kernel|| * max|src|</tt>. For 
+    <tt>BORDER_TREATMENT_AVOID</tt>, the destination's border pixels are left unchanged.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class T>
+        void convolveImage(SrcIterator supperleft,
+                           SrcIterator slowerright, SrcAccessor sa,
+                           DestIterator dupperleft, DestAccessor da,
+                           Kernel2D<T> const & kernel, 
+                           double tolerance, unsigned int maxRank = 3);
+    }
+    \endcode
+
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class T>
+        inline void
+        convolveImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                      pair<DestIterator, DestAccessor> dest,
+                      Kernel2D<T> const & kernel, 
+                      double tolerance, unsigned int maxRank = 3);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/convolution.hxx\>
+
+
+    \code
+    vigra::FImage src(w,h), dest(w,h);
+    ...
+
+    // an anisotropic Gaussian rotated by 30 degrees is not separable, 
+    // but well approximated by 2 or 3 separable terms
+    Kernel2D<double> kernel;
+    ...
+    vigra::convolveImage(srcImageRange(src), destImage(dest), kernel, 1e-4);
+
+    \endcode
+*/
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class T>
+void convolveImage(SrcIterator supperleft,
+                   SrcIterator slowerright, SrcAccessor sa,
+                   DestIterator dupperleft, DestAccessor da,
+                   Kernel2D<T> const & kernel, 
+                   double tolerance, unsigned int maxRank = 3)
+{
+    typedef typename
+        NumericTraits<typename SrcAccessor::value_type>::RealPromote
+        TmpType;
+    typedef typename BasicImage<TmpType>::iterator TmpIterator;
+        
+    ArrayVector<Kernel1D<T> > kx, ky;
+    int kw = kernel.width(),
+        kh = kernel.height();
+    bool separable = kernel.borderTreatment() != BORDER_TREATMENT_CLIP &&
+                     kernel.separableApproximation(maxRank, tolerance, kx, ky) <= tolerance &&
+                     (int)kx.size()*(kw + kh) < kw*kh;
+    if(!separable)
+    {
+        convolveImage(supperleft, slowerright, sa, dupperleft, da, 
+                      kernel.center(), kernel.accessor(), 
+                      kernel.upperLeft(), kernel.lowerRight(), kernel.borderTreatment());
+        return;
+    }
+    
+    Diff2D shape = slowerright - supperleft;
+    BasicImage<TmpType> sum(shape), term(shape);
+    for(unsigned int k=0; k<kx.size(); ++k)
+    {
+        convolveImage(supperleft, slowerright, sa, 
+                      term.upperLeft(), term.accessor(), kx[k], ky[k]);
+        TmpIterator s = sum.begin(), t = term.begin(), end = sum.end();
+        for(; s != end; ++s, ++t)
+            *s += *t;
+    }
+    
+    Diff2D ul(0, 0), lr(shape);
+    if(kernel.borderTreatment() == BORDER_TREATMENT_AVOID)
+    {
+        ul = kernel.lowerRight();
+        lr += kernel.upperLeft();
+    }
+    copyImage(srcIterRange(sum.upperLeft() + ul, sum.upperLeft() + lr, sum.accessor()),
+              destIter(dupperleft + ul, da));
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class T>
+inline void
+convolveImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+              pair<DestIterator, DestAccessor> dest,
+              Kernel2D<T> const & kernel, 
+              double tolerance, unsigned int maxRank = 3)
+{
+    convolveImage(src.first, src.second, src.third,
+                  dest.first, dest.second, kernel, tolerance, maxRank);
+}
+
 /********************************************************/
 /*                                                      */
 /*                    simpleSharpening                  */
@@ -38,7 +38,11 @@
 #define VIGRA_DISTANCETRANSFORM_HXX
 
 #include <cmath>
+#include <limits>
 #include "stdimage.hxx"
+#include "array_vector.hxx"
+#include "tinyvector.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
@@ -66,15 +70,6 @@ struct InternalDistanceTransformL1NormFunctor
     }
 };
 
-// Euclidean metric
-struct InternalDistanceTransformL2NormFunctor
-{
-    float operator()(float dx, float dy) const
-    {
-        return VIGRA_CSTD::sqrt(dx*dx + dy*dy);
-    }
-};
-
 
 template <class SrcImageIterator, class SrcAccessor,
                    class DestImageIterator, class DestAccessor,
@@ -266,6 +261,257 @@ internalDistanceTransform(SrcImageIterator src_upperleft,
     }
 }
 
+namespace detail {
+
+    // First pass of the exact Euclidean distance transform: for a band of 
+    // columns, compute the distance (in pixels) to the nearest object pixel 
+    // in the same column by a downward and an upward scan, and store it 
+    // via 'ga'. Columns without object pixels get the image height, which
+    // is larger than any actual column distance. The scans run along the 
+    // rows of the band, so that memory is accessed consecutively.
+template <class SrcImageIterator, class SrcAccessor, class ValueType,
+          class DistImageIterator, class DistAccessor>
+class EuclideanDistanceColumnFunctor
+{
+  public:
+    enum { BandWidth = 64 };
+
+    EuclideanDistanceColumnFunctor(SrcImageIterator sul, SrcAccessor sa, ValueType background,
+                                   DistImageIterator gul, DistAccessor ga, int w, int h)
+    : sul_(sul), sa_(sa), background_(background), gul_(gul), ga_(ga), w_(w), h_(h)
+    {}
+
+    void operator()(int /* threadId */, std::ptrdiff_t band) const
+    {
+        int x0 = (int)band*BandWidth,
+            x1 = std::min<int>(x0 + BandWidth, w_);
+
+        for(int y=0; y<h_; ++y)
+        {
+            typename SrcImageIterator::row_iterator s = (sul_ + Diff2D(x0, y)).rowIterator();
+            typename DistImageIterator::row_iterator g = (gul_ + Diff2D(x0, y)).rowIterator(),
+                                                     p = (gul_ + Diff2D(x0, y == 0 ? 0 : y-1)).rowIterator();
+            for(int x=x0; x<x1; ++x, ++s, ++g, ++p)
+            {
+                if(sa_(s) != background_)
+                    ga_.set(0, g);
+                else if(y == 0 || (int)ga_(p) >= h_)
+                    ga_.set(h_, g);
+                else
+                    ga_.set((int)ga_(p) + 1, g);
+            }
+        }
+        for(int y=h_-2; y>=0; --y)
+        {
+            typename DistImageIterator::row_iterator g = (gul_ + Diff2D(x0, y)).rowIterator(),
+                                                     n = (gul_ + Diff2D(x0, y+1)).rowIterator();
+            for(int x=x0; x<x1; ++x, ++g, ++n)
+            {
+                int d = (int)ga_(n) + 1;
+                if(d < (int)ga_(g))
+                    ga_.set(d, g);
+            }
+        }
+    }
+
+    SrcImageIterator sul_;
+    SrcAccessor sa_;
+    ValueType background_;
+    DistImageIterator gul_;
+    DistAccessor ga_;
+    int w_, h_;
+};
+
+    // Second pass of the exact Euclidean distance transform: for each row,
+    // compute the lower envelope of the parabolas rooted at the column 
+    // distances (Felzenszwalb and Huttenlocher) and sample it at every pixel. 
+    // The column distances of the row are copied into a buffer first, so
+    // that they may be stored in the destination image. Each thread uses its 
+    // own buffers.
+template <class DistImageIterator, class DistAccessor,
+          class DestImageIterator, class DestAccessor>
+class EuclideanDistanceRowFunctor
+{
+  public:
+    EuclideanDistanceRowFunctor(DistImageIterator gul, DistAccessor ga, int w, int h,
+                                DestImageIterator dul, DestAccessor da,
+                                TinyVector<double, 2> const & pixelPitch,
+                                ArrayVector<ArrayVector<double> > & buffers)
+    : gul_(gul), ga_(ga), w_(w), h_(h), dul_(dul), da_(da),
+      px2_(sq(pixelPitch[0])), py2_(sq(pixelPitch[1])),
+      buffers_(buffers)
+    {}
+
+    void operator()(int threadId, std::ptrdiff_t y) const
+    {
+        int w = w_;
+        
+        // parabola k is rooted at column v[k] with height f[k] and is part
+        // of the lower envelope in the interval [z[k], z[k+1])
+        ArrayVector<double> & buffer = buffers_[threadId];
+        buffer.resize(4*w + 1);
+        double * g = buffer.begin(),
+               * v = g + w, 
+               * f = v + w, 
+               * z = f + w;
+        
+        typename DistImageIterator::row_iterator gi = (gul_ + Diff2D(0, (int)y)).rowIterator();
+        for(int q=0; q<w; ++q, ++gi)
+            g[q] = (int)ga_(gi);
+        
+        int k = -1;
+        for(int q=0; q<w; ++q)
+        {
+            if(g[q] >= h_)
+                continue;
+            double fq = py2_*sq(g[q]);
+            if(k < 0)
+            {
+                k = 0;
+                z[0] = -NumericTraits<double>::max();
+            }
+            else
+            {
+                double s;
+                while((s = ((fq + px2_*sq((double)q)) - (f[k] + px2_*sq(v[k]))) / (2.0*px2_*(q - v[k]))) <= z[k])
+                    --k;
+                ++k;
+                z[k] = s;
+            }
+            v[k] = q;
+            f[k] = fq;
+        }
+        
+        typename DestImageIterator::row_iterator d = (dul_ + Diff2D(0, (int)y)).rowIterator();
+        if(k < 0)
+        {
+            // no object pixels at all: set all distances to the image diagonal
+            double diagonal = std::sqrt(px2_*sq((double)w) + py2_*sq((double)h_));
+            for(int x=0; x<w; ++x, ++d)
+                da_.set(diagonal, d);
+            return;
+        }
+        z[k+1] = NumericTraits<double>::max();
+        
+        k = 0;
+        for(int x=0; x<w; ++x, ++d)
+        {
+            while(z[k+1] < x)
+                ++k;
+            da_.set(std::sqrt(px2_*sq(x - v[k]) + f[k]), d);
+        }
+    }
+
+    DistImageIterator gul_;
+    DistAccessor ga_;
+    int w_, h_;
+    DestImageIterator dul_;
+    DestAccessor da_;
+    double px2_, py2_;
+    ArrayVector<ArrayVector<double> > & buffers_;
+};
+
+    // The column distances can be stored in the destination image if it 
+    // holds plain scalars of at least 32 bits, which represent all column 
+    // distances exactly.
+template <class DestAccessor>
+struct EuclideanDistanceInDestination
+{
+    typedef VigraFalseType type;
+};
+
+template <class T>
+struct EuclideanDistanceInDestination<StandardValueAccessor<T> >
+{
+    typedef typename IfBool<sizeof(T) >= 4 && NumericTraits<T>::isScalar::asBool,
+                            VigraTrueType, VigraFalseType>::type type;
+};
+
+template <class T>
+struct EuclideanDistanceInDestination<StandardAccessor<T> >
+: public EuclideanDistanceInDestination<StandardValueAccessor<T> >
+{};
+
+template <class SrcImageIterator, class SrcAccessor, class ValueType,
+          class DistImageIterator, class DistAccessor,
+          class DestImageIterator, class DestAccessor>
+void
+euclideanDistanceTransformPasses(SrcImageIterator src_upperleft, SrcAccessor sa, ValueType background,
+                                 DistImageIterator dist_upperleft, DistAccessor ga, 
+                                 DestImageIterator dest_upperleft, DestAccessor da,
+                                 int w, int h, TinyVector<double, 2> const & pixelPitch,
+                                 int nThreads)
+{
+    typedef EuclideanDistanceColumnFunctor<SrcImageIterator, SrcAccessor, ValueType,
+                                           DistImageIterator, DistAccessor> ColumnFunctor;
+    typedef EuclideanDistanceRowFunctor<DistImageIterator, DistAccessor,
+                                        DestImageIterator, DestAccessor> RowFunctor;
+    
+    ColumnFunctor columns(src_upperleft, sa, background, dist_upperleft, ga, w, h);
+    parallel_foreach(nThreads, (w + ColumnFunctor::BandWidth - 1) / ColumnFunctor::BandWidth, columns);
+    
+    ArrayVector<ArrayVector<double> > buffers(nThreads);
+    RowFunctor rows(dist_upperleft, ga, w, h, dest_upperleft, da, pixelPitch, buffers);
+    parallel_foreach(nThreads, h, rows);
+}
+
+template <class SrcImageIterator, class SrcAccessor,
+          class DestImageIterator, class DestAccessor,
+          class ValueType>
+void
+euclideanDistanceTransformPasses(SrcImageIterator src_upperleft, SrcAccessor sa, ValueType background,
+                                 DestImageIterator dest_upperleft, DestAccessor da,
+                                 int w, int h, TinyVector<double, 2> const & pixelPitch,
+                                 int nThreads, VigraTrueType /* column distances in dest */)
+{
+    euclideanDistanceTransformPasses(src_upperleft, sa, background, 
+                                     dest_upperleft, da, dest_upperleft, da,
+                                     w, h, pixelPitch, nThreads);
+}
+
+template <class SrcImageIterator, class SrcAccessor,
+          class DestImageIterator, class DestAccessor,
+          class ValueType>
+void
+euclideanDistanceTransformPasses(SrcImageIterator src_upperleft, SrcAccessor sa, ValueType background,
+                                 DestImageIterator dest_upperleft, DestAccessor da,
+                                 int w, int h, TinyVector<double, 2> const & pixelPitch,
+                                 int nThreads, VigraFalseType /* column distances in dest */)
+{
+    IImage dist(w, h);
+    euclideanDistanceTransformPasses(src_upperleft, sa, background, 
+                                     dist.upperLeft(), dist.accessor(), dest_upperleft, da,
+                                     w, h, pixelPitch, nThreads);
+}
+
+template <class SrcImageIterator, class SrcAccessor,
+          class DestImageIterator, class DestAccessor,
+          class ValueType>
+void
+internalEuclideanDistanceTransform(SrcImageIterator src_upperleft, 
+                SrcImageIterator src_lowerright, SrcAccessor sa,
+                DestImageIterator dest_upperleft, DestAccessor da,
+                ValueType background, TinyVector<double, 2> const & pixelPitch,
+                int nThreads)
+{
+    int w = src_lowerright.x - src_upperleft.x;  
+    int h = src_lowerright.y - src_upperleft.y;  
+    if(w <= 0 || h <= 0)
+        return;
+    
+    vigra_precondition(pixelPitch[0] > 0.0 && pixelPitch[1] > 0.0,
+        "euclideanDistanceTransform(): pixel pitch must be positive.");
+    
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+    
+    euclideanDistanceTransformPasses(src_upperleft, sa, background, dest_upperleft, da,
+                                     w, h, pixelPitch, nThreads,
+                                     typename EuclideanDistanceInDestination<DestAccessor>::type());
+}
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*                 distanceTransform                    */
@@ -276,6 +522,10 @@ internalDistanceTransform(SrcImageIterator src_upperleft,
     Perform a distance transform using either the Euclidean, Manhattan, 
     or chessboard metrics.
     
+    The Euclidean distance transform is exact, and its cost is linear in the
+    number of pixels regardless of the image content. \ref euclideanDistanceTransform()
+    additionally supports anisotropic pixel pitch and multi-threading.
+    
     See also: \ref MultiArrayDistanceTransform "multi-dimensional distance transforms"
 */
 //@{
@@ -298,8 +548,12 @@ internalDistanceTransform(SrcImageIterator src_upperleft,
     
     </ul>
     
-    If you use the L2 norm, the destination pixels must be real valued to give
-    correct results.
+    If you use the L2 norm, the destination pixels should be real valued to give
+    correct results (distances are rounded for integral destination types). 
+    The L2 distances are computed exactly by \ref euclideanDistanceTransform()
+    with unit pixel pitch, whereas the L1 and L-infinity distances are computed
+    by a propagation scheme. If the image contains no object pixels, the 
+    L2 distance of all pixels is the length of the image diagonal.
     
     <b> Declarations:</b>
     
@@ -393,9 +647,9 @@ distanceTransform(SrcImageIterator src_upperleft,
     }
     else if(norm == 2)
     {
-        internalDistanceTransform(src_upperleft, src_lowerright, sa,
-                                  dest_upperleft, da, background,
-                                  InternalDistanceTransformL2NormFunctor());
+        detail::internalEuclideanDistanceTransform(src_upperleft, src_lowerright, sa,
+                                                   dest_upperleft, da, background,
+                                                   TinyVector<double, 2>(1.0), 1);
     }
     else
     {
@@ -418,6 +672,139 @@ distanceTransform(
                       dest.first, dest.second, background, norm);
 }
 
+/********************************************************/
+/*                                                      */
+/*              euclideanDistanceTransform              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Exact Euclidean distance transform with pixel pitch.
+
+    For all background pixels, calculate the Euclidean distance to the nearest 
+    object pixel, as in \ref distanceTransform() with <tt>norm == 2</tt>.
+    Pixels whose source value equals <tt>background</tt> are background, all 
+    other pixels are objects and are assigned the distance 0. If the image
+    contains no object pixels, all pixels are assigned the length of the 
+    image diagonal.
+    
+    The distance between pixels <tt>(x1, y1)</tt> and <tt>(x2, y2)</tt> is 
+    <tt>sqrt(sq(pixelPitch[0]*(x1-x2)) + sq(pixelPitch[1]*(y1-y2)))</tt>,
+    which is useful for data with anisotropic resolution.
+    
+    The algorithm is the separable lower envelope method of
+    
+    P. Felzenszwalb, D. Huttenlocher: <em>"Distance Transforms of Sampled Functions"</em>,
+    Cornell Computing and Information Science Technical Report TR2004-1963, 2004
+    
+    It first determines the distance to the nearest object pixel in the same 
+    column and then, for every row, the lower envelope of the parabolas 
+    rooted at these column distances. The result is exact, and the running time 
+    is linear in the number of pixels, independent of the image content. 
+    Columns (in bands of neighboring columns) and rows are processed in 
+    parallel by <tt>nThreads</tt> threads (if <tt>nThreads <= 0</tt>, 
+    \ref defaultConcurrency() threads are used, see \ref ParallelProcessing). 
+    The result doesn't depend on the number of threads. The column distances 
+    are stored in the destination image if its pixel type is a scalar of at least 
+    32 bits (e.g. <tt>float</tt>) accessed by a standard accessor. Otherwise, the 
+    function allocates an <tt>int</tt> image of the source size for them.
+
+    <b> Declarations:</b>
+    
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcImageIterator, class SrcAccessor,
+                  class DestImageIterator, class DestAccessor,
+                  class ValueType>
+        void euclideanDistanceTransform(SrcImageIterator src_upperleft, 
+                        SrcImageIterator src_lowerright, SrcAccessor sa,
+                        DestImageIterator dest_upperleft, DestAccessor da,
+                        ValueType background, 
+                        TinyVector<double, 2> const & pixelPitch = TinyVector<double, 2>(1.0),
+                        int nThreads = 1);
+    }
+    \endcode
+    
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcImageIterator, class SrcAccessor,
+                  class DestImageIterator, class DestAccessor,
+                  class ValueType>
+        void euclideanDistanceTransform(
+            triple<SrcImageIterator, SrcImageIterator, SrcAccessor> src,
+            pair<DestImageIterator, DestAccessor> dest,
+            ValueType background, 
+            TinyVector<double, 2> const & pixelPitch = TinyVector<double, 2>(1.0),
+            int nThreads = 1);
+    }
+    \endcode
+    
+    <b> Usage:</b>
+    
+    <b>\#include</b> \<vigra/distancetransform.hxx\><br>
+    Namespace: vigra
+    
+    \code
+    vigra::BImage mask(w,h);
+    vigra::FImage distance(w, h);
+    ...
+    
+    // pixels are 0.5 units wide and 2 units high, use 8 threads
+    vigra::euclideanDistanceTransform(srcImageRange(mask), destImage(distance), 0,
+                                      TinyVector<double, 2>(0.5, 2.0), 8);
+    \endcode
+
+    <b> Required Interface:</b>
+    
+    \code
+    SrcImageIterator src_upperleft, src_lowerright;
+    DestImageIterator dest_upperleft;
+    
+    SrcAccessor sa;
+    DestAccessor da;
+    
+    ValueType background;
+    double distance;
+    
+    sa(src_upperleft) != background;
+    da.set(distance, dest_upperleft);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void euclideanDistanceTransform)
+
+template <class SrcImageIterator, class SrcAccessor,
+          class DestImageIterator, class DestAccessor,
+          class ValueType>
+inline void
+euclideanDistanceTransform(SrcImageIterator src_upperleft, 
+                SrcImageIterator src_lowerright, SrcAccessor sa,
+                DestImageIterator dest_upperleft, DestAccessor da,
+                ValueType background, 
+                TinyVector<double, 2> const & pixelPitch = TinyVector<double, 2>(1.0),
+                int nThreads = 1)
+{
+    detail::internalEuclideanDistanceTransform(src_upperleft, src_lowerright, sa,
+                                               dest_upperleft, da, background,
+                                               pixelPitch, nThreads);
+}
+
+template <class SrcImageIterator, class SrcAccessor,
+          class DestImageIterator, class DestAccessor,
+          class ValueType>
+inline void
+euclideanDistanceTransform(
+    triple<SrcImageIterator, SrcImageIterator, SrcAccessor> src,
+    pair<DestImageIterator, DestAccessor> dest,
+    ValueType background, 
+    TinyVector<double, 2> const & pixelPitch = TinyVector<double, 2>(1.0),
+    int nThreads = 1)
+{
+    euclideanDistanceTransform(src.first, src.second, src.third,
+                               dest.first, dest.second, background, 
+                               pixelPitch, nThreads);
+}
+
 //@}
 
 } // namespace vigra
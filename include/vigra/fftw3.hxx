@@ -37,6 +37,7 @@
 #define VIGRA_FFTW3_HXX
 
 #include <cmath>
+#include <cstddef>
 #include <functional>
 #include <complex>
 #include "stdimage.hxx"
@@ -655,11 +656,29 @@ struct MultiMathOperand<FFTWComplex<Real> >
     void reset(unsigned int /*LEVEL*/) const
     {}
     
+    void move(unsigned int /*LEVEL*/, std::ptrdiff_t /*d*/) const
+    {}
+    
+    bool isUnstrided(unsigned int /*LEVEL*/) const
+    {
+        return true;
+    }
+    
+    bool isMergeable(unsigned int /*inner*/, unsigned int /*outer*/) const
+    {
+        return true;
+    }
+    
     FFTWComplex<Real> const & operator*() const
     {
         return v_;
     }
     
+    FFTWComplex<Real> const & get(std::ptrdiff_t /*i*/) const
+    {
+        return v_;
+    }
+    
     FFTWComplex<Real> v_;
 };
 
@@ -785,6 +785,26 @@ class HDF5File
         return fileName_();
     }
 
+        /** \brief Check if the file was opened in read-only mode.
+        */
+    inline bool isReadOnly() const
+    {
+        unsigned int intent = 0;
+        H5Fget_intent(fileHandle_, &intent);
+        return intent == H5F_ACC_RDONLY;
+    }
+
+        /** \brief Check if a dataset of the given name exists.
+             If the first character is a "/", the path will be interpreted as absolute path,
+             otherwise it will be interpreted as path relative to the current group.
+        */
+    inline bool existsDataset(std::string datasetName)
+    {
+        // make datasetName clean
+        datasetName = get_absolute_path(datasetName);
+        return H5Lexists(fileHandle_, datasetName.c_str(), H5P_DEFAULT) > 0;
+    }
+
         /** \brief Get the number of dimensions of a certain dataset
              If the first character is a "/", the path will be interpreted as absolute path,
              otherwise it will be interpreted as path relative to the current group.
@@ -355,6 +355,41 @@ class Histogram
         this->setData(&data_[0]);
     }
     
+        // the view must refer to our own copy of the data
+    Histogram(Histogram const & rhs)
+    : BaseType(rhs),
+      data_(rhs.data_)
+    {
+        this->setData(&data_[0]);
+    }
+    
+    Histogram & operator=(Histogram const & rhs)
+    {
+        BaseType::operator=(rhs);
+        data_ = rhs.data_;
+        this->setData(&data_[0]);
+        return *this;
+    }
+    
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+    Histogram(Histogram && rhs)
+    : BaseType(rhs),
+      data_(std::move(rhs.data_))
+    {
+        this->setData(&data_[0]);
+        rhs.setData(0);
+    }
+    
+    Histogram & operator=(Histogram && rhs)
+    {
+        BaseType::operator=(rhs);
+        data_ = std::move(rhs.data_);
+        this->setData(&data_[0]);
+        rhs.setData(rhs.data_.size() > 0 ? rhs.data_.begin() : 0);
+        return *this;
+    }
+#endif
+    
     Histogram const & reset()
     {
         this->setData(&data_[0]);
@@ -39,10 +39,12 @@
 
 #include <vector>
 #include <functional>
+#include <cstddef>
 #include "utilities.hxx"
 #include "stdimage.hxx"
 #include "union_find.hxx"
 #include "sized_int.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
@@ -79,6 +81,23 @@ namespace vigra {
                                 SrcIterator lowerrights, SrcAccessor sa,
                                 DestIterator upperleftd, DestAccessor da,
                                 bool eight_neighbors, EqualityFunctor equal);
+
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        unsigned int labelImage(SrcIterator upperlefts,
+                                SrcIterator lowerrights, SrcAccessor sa,
+                                DestIterator upperleftd, DestAccessor da,
+                                bool eight_neighbors, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class EqualityFunctor>
+        unsigned int labelImage(SrcIterator upperlefts,
+                                SrcIterator lowerrights, SrcAccessor sa,
+                                DestIterator upperleftd, DestAccessor da,
+                                bool eight_neighbors, EqualityFunctor equal,
+                                ParallelOptions const & opt);
     }
     \endcode
 
@@ -97,6 +116,21 @@ namespace vigra {
         unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
                                 pair<DestIterator, DestAccessor> dest,
                                 bool eight_neighbors, EqualityFunctor equal)
+
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                pair<DestIterator, DestAccessor> dest,
+                                bool eight_neighbors, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class EqualityFunctor>
+        unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                pair<DestIterator, DestAccessor> dest,
+                                bool eight_neighbors, EqualityFunctor equal,
+                                ParallelOptions const & opt);
     }
     \endcode
 
@@ -110,6 +144,13 @@ namespace vigra {
     the function (inclusive). The parameter '<TT>eight_neighbors</TT>'
     determines whether the regions should be 4-connected or
     8-connected. The function uses accessors.
+    
+    When \ref vigra::ParallelOptions are passed, the image is split into 
+    horizontal stripes, one per thread. The stripes are labeled 
+    independently, the regions touching across stripe boundaries are merged
+    by means of a concurrent union-find array, and the final labels are written 
+    in parallel. The result is identical to the sequential algorithm.
+    The EqualityFunctor must be thread-safe in this case.
 
     Return:  the number of regions found (= largest region label)
 
@@ -129,6 +170,10 @@ namespace vigra {
 
     // find 4-connected regions
     vigra::labelImage(srcImageRange(src), destImage(labels), false);
+    
+    // find 8-connected regions using 4 threads
+    vigra::labelImage(srcImageRange(src), destImage(labels), true, 
+                      vigra::ParallelOptions().numThreads(4));
     \endcode
 
     <b> Required Interface:</b>
@@ -306,7 +351,7 @@ unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         template <class SrcIterator, class SrcAccessor,
                   class DestIterator, class DestAccessor,
                   class ValueType>
-        int labelImageWithBackground(SrcIterator upperlefts,
+        unsigned int labelImageWithBackground(SrcIterator upperlefts,
                        SrcIterator lowerrights, SrcAccessor sa,
                        DestIterator upperleftd, DestAccessor da,
                        bool eight_neighbors,
@@ -315,11 +360,31 @@ unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         template <class SrcIterator, class SrcAccessor,
                   class DestIterator, class DestAccessor,
                   class ValueType, class EqualityFunctor>
-        int labelImageWithBackground(SrcIterator upperlefts,
+        unsigned int labelImageWithBackground(SrcIterator upperlefts,
                        SrcIterator lowerrights, SrcAccessor sa,
                        DestIterator upperleftd, DestAccessor da,
                        bool eight_neighbors,
                        ValueType background_value, EqualityFunctor equal);
+
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class ValueType>
+        unsigned int labelImageWithBackground(SrcIterator upperlefts,
+                       SrcIterator lowerrights, SrcAccessor sa,
+                       DestIterator upperleftd, DestAccessor da,
+                       bool eight_neighbors,
+                       ValueType background_value, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class ValueType, class EqualityFunctor>
+        unsigned int labelImageWithBackground(SrcIterator upperlefts,
+                       SrcIterator lowerrights, SrcAccessor sa,
+                       DestIterator upperleftd, DestAccessor da,
+                       bool eight_neighbors,
+                       ValueType background_value, EqualityFunctor equal,
+                       ParallelOptions const & opt);
     }
     \endcode
 
@@ -329,18 +394,36 @@ unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
         template <class SrcIterator, class SrcAccessor,
                   class DestIterator, class DestAccessor,
                   class ValueType>
-        int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
-                                     pair<DestIterator, DestAccessor> dest,
-                                     bool eight_neighbors,
-                                     ValueType background_value);
+        unsigned int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                              pair<DestIterator, DestAccessor> dest,
+                                              bool eight_neighbors,
+                                              ValueType background_value);
 
         template <class SrcIterator, class SrcAccessor,
                   class DestIterator, class DestAccessor,
                   class ValueType, class EqualityFunctor>
-        int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
-                                     pair<DestIterator, DestAccessor> dest,
-                                     bool eight_neighbors,
-                                     ValueType background_value, EqualityFunctor equal);
+        unsigned int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                              pair<DestIterator, DestAccessor> dest,
+                                              bool eight_neighbors,
+                                              ValueType background_value, EqualityFunctor equal);
+
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class ValueType>
+        unsigned int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                              pair<DestIterator, DestAccessor> dest,
+                                              bool eight_neighbors,
+                                              ValueType background_value, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class ValueType, class EqualityFunctor>
+        unsigned int labelImageWithBackground(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                                              pair<DestIterator, DestAccessor> dest,
+                                              bool eight_neighbors,
+                                              ValueType background_value, EqualityFunctor equal,
+                                              ParallelOptions const & opt);
     }
     \endcode
 
@@ -358,6 +441,14 @@ unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
     returned by the function (inclusive). The parameter
     '<TT>eight_neighbors</TT>' determines whether the regions should
     be 4-connected or 8-connected. The function uses accessors.
+    When \ref vigra::ParallelOptions are passed, the image is labeled 
+    in parallel as described in \ref labelImage(), with identical results.
+    
+    For 8-bit images (more precisely: when the equality predicate is 
+    <tt>std::equal_to<UInt8></tt>, as is the default for \ref vigra::BImage),
+    the function uses a faster run-based algorithm: every row is split into 
+    runs of equal foreground values, and only touching runs in successive 
+    rows are merged. The result is the same.
 
     Return:  the number of regions found (= largest region label)
 
@@ -543,6 +634,124 @@ unsigned int labelImageWithBackground(
     return count;
 }
 
+namespace detail {
+
+template <class T>
+struct LabelImageRun
+{
+    int begin, end;    // [begin, end) along the row
+    IntBiggest label;  // provisional label
+    T value;
+};
+
+    // Run-based labeling: each row is decomposed into maximal runs of equal,
+    // non-background pixels, and a run is merged with all runs of the previous 
+    // row that touch it and have the same value. This needs only one
+    // comparison per pixel and one union per touching pair of runs instead 
+    // of one per neighboring pair of pixels. Requires 'equal' to be transitive.
+    // Provisional labels are created in scan order of the runs' first pixels,
+    // so the contiguous labels are identical to those of the pixel-based
+    // algorithm. Background pixels remain untouched.
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType, class EqualityFunctor>
+unsigned int labelImageWithBackgroundRuns(
+    SrcIterator upperlefts,
+    SrcIterator lowerrights, SrcAccessor sa,
+    DestIterator upperleftd, DestAccessor da,
+    bool eight_neighbors,
+    ValueType background_value, EqualityFunctor equal)
+{
+    typedef typename SrcAccessor::value_type SrcType;
+    typedef LabelImageRun<SrcType> Run;
+
+    int w = lowerrights.x - upperlefts.x;
+    int h = lowerrights.y - upperlefts.y;
+    int d = eight_neighbors ? 1 : 0;
+
+    ArrayVector<Run> runs;
+    ArrayVector<std::ptrdiff_t> rowBegin(h+1);
+    UnionFindArray<IntBiggest> regions;
+
+    // pass 1: decompose rows into runs and merge touching runs
+    SrcIterator ys(upperlefts);
+    for(int y = 0; y != h; ++y, ++ys.y)
+    {
+        rowBegin[y] = runs.size();
+        typename SrcIterator::row_iterator xs = ys.rowIterator();
+        std::ptrdiff_t p = (y == 0) ? 0 : rowBegin[y-1], 
+                       pend = rowBegin[y];
+        int x = 0;
+        while(x < w)
+        {
+            SrcType v = sa(xs, x);
+            if(equal(v, background_value))
+            {
+                ++x;
+                continue;
+            }
+            Run run;
+            run.begin = x;
+            while(++x < w && equal(sa(xs, x), v))
+                ;
+            run.end = x;
+            run.value = v;
+            run.label = 0;
+
+            // runs of the previous row that end before the current one 
+            // cannot touch any later run of this row either
+            while(p < pend && runs[p].end + d <= run.begin)
+                ++p;
+            for(std::ptrdiff_t q = p; q < pend && runs[q].begin < run.end + d; ++q)
+            {
+                if(!equal(runs[q].value, v))
+                    continue;
+                run.label = (run.label == 0)
+                                ? runs[q].label
+                                : regions.makeUnion(run.label, runs[q].label);
+            }
+            if(run.label == 0)
+                run.label = regions.makeNewLabel();
+            runs.push_back(run);
+        }
+    }
+    rowBegin[h] = runs.size();
+
+    // pass 2: assign contiguous labels to the runs
+    unsigned int count = regions.makeContiguous();
+    DestIterator yd(upperleftd);
+    for(int y = 0; y != h; ++y, ++yd.y)
+    {
+        typename DestIterator::row_iterator xd = yd.rowIterator();
+        for(std::ptrdiff_t r = rowBegin[y]; r != rowBegin[y+1]; ++r)
+        {
+            IntBiggest label = regions[runs[r].label];
+            for(int x = runs[r].begin; x != runs[r].end; ++x)
+                da.set(label, xd, x);
+        }
+    }
+    return count;
+}
+
+} // namespace detail
+
+    // fast path for 8-bit images compared with std::equal_to
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType>
+inline
+unsigned int labelImageWithBackground(
+    SrcIterator upperlefts,
+    SrcIterator lowerrights, SrcAccessor sa,
+    DestIterator upperleftd, DestAccessor da,
+    bool eight_neighbors,
+    ValueType background_value, std::equal_to<UInt8> equal)
+{
+    return detail::labelImageWithBackgroundRuns(upperlefts, lowerrights, sa,
+                                                upperleftd, da,
+                                                eight_neighbors, background_value, equal);
+}
+
 template <class SrcIterator, class SrcAccessor,
           class DestIterator, class DestAccessor,
           class ValueType, class EqualityFunctor>
@@ -591,6 +800,273 @@ unsigned int labelImageWithBackground(
                             std::equal_to<typename SrcAccessor::value_type>());
 }
 
+/********************************************************/
+/*                                                      */
+/*           parallel connected components              */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Parallel variant of labelImage() and labelImageWithBackground(), 
+    // see ParallelLabelVolumeFunctor in labelvolume.hxx. The image is split 
+    // into horizontal stripes which are labeled independently, the regions 
+    // touching across the upper border of every stripe are merged in a concurrent
+    // union-find array, and the provisional labels are replaced with the final ones.
+    // The result is identical to the sequential algorithm.
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType, class EqualityFunctor>
+class ParallelLabelImageFunctor
+{
+  public:
+    typedef typename DestAccessor::value_type LabelType;
+    
+    enum Pass { LabelStripes, MergeStripes, RelabelStripes };
+    
+    ParallelLabelImageFunctor(SrcIterator upperlefts, SrcIterator lowerrights, SrcAccessor sa,
+                              DestIterator upperleftd, DestAccessor da, bool eight_neighbors,
+                              bool withBackground, ValueType const & backgroundValue, 
+                              EqualityFunctor equal, int stripeHeight, 
+                              ArrayVector<std::ptrdiff_t> & offsets)
+    : upperlefts_(upperlefts), lowerrights_(lowerrights), sa_(sa), 
+      upperleftd_(upperleftd), da_(da), eight_neighbors_(eight_neighbors),
+      withBackground_(withBackground), backgroundValue_(backgroundValue), equal_(equal),
+      stripeHeight_(stripeHeight), offsets_(offsets), regions_(0), pass_(LabelStripes)
+    {}
+    
+    void operator()(int, std::ptrdiff_t k) const
+    {
+        if(pass_ == MergeStripes)
+            ++k; // the first stripe has no predecessor
+            
+        int w = lowerrights_.x - upperlefts_.x,
+            y0 = k*stripeHeight_, 
+            y1 = std::min<int>(lowerrights_.y - upperlefts_.y, y0 + stripeHeight_);
+        SrcIterator s = upperlefts_ + Diff2D(0, y0);
+        DestIterator d = upperleftd_ + Diff2D(0, y0);
+        
+        if(pass_ == LabelStripes)
+        {
+            offsets_[k+1] = withBackground_
+                                ? labelImageWithBackground(s, s + Diff2D(w, y1 - y0), sa_, d, da_,
+                                                           eight_neighbors_, backgroundValue_, equal_)
+                                : labelImage(s, s + Diff2D(w, y1 - y0), sa_, d, da_, 
+                                             eight_neighbors_, equal_);
+        }
+        else if(pass_ == MergeStripes)
+        {
+            int dx = eight_neighbors_ ? 1 : 0;
+            for(int x = 0; x < w; ++x)
+            {
+                if(isBackground(s, Diff2D(x, 0)))
+                    continue;
+                for(int nx = std::max(0, x - dx); nx <= std::min(w - 1, x + dx); ++nx)
+                {
+                    if(!isBackground(s, Diff2D(nx, -1)) && 
+                       equal_(sa_(s, Diff2D(x, 0)), sa_(s, Diff2D(nx, -1))))
+                        regions_->makeUnion(offsets_[k] + (std::ptrdiff_t)da_(d, Diff2D(x, 0)), 
+                                            offsets_[k-1] + (std::ptrdiff_t)da_(d, Diff2D(nx, -1)));
+                }
+            }
+        }
+        else // pass_ == RelabelStripes
+        {
+            for(int y = y0; y < y1; ++y, ++s.y, ++d.y)
+            {
+                typename SrcIterator::row_iterator xs = s.rowIterator();
+                typename DestIterator::row_iterator xd = d.rowIterator();
+                for(int x = 0; x < w; ++x, ++xs, ++xd)
+                {
+                    if(withBackground_ && equal_(sa_(xs), backgroundValue_))
+                        continue; // background pixels remain untouched
+                    da_.set((LabelType)(*regions_)[offsets_[k] + (std::ptrdiff_t)da_(xd)], xd);
+                }
+            }
+        }
+    }
+    
+    bool isBackground(SrcIterator const & s, Diff2D const & p) const
+    {
+        return withBackground_ && equal_(sa_(s, p), backgroundValue_);
+    }
+    
+    SrcIterator upperlefts_, lowerrights_;
+    SrcAccessor sa_;
+    DestIterator upperleftd_;
+    DestAccessor da_;
+    bool eight_neighbors_, withBackground_;
+    ValueType backgroundValue_;
+    EqualityFunctor equal_;
+    int stripeHeight_;
+    ArrayVector<std::ptrdiff_t> & offsets_;
+    ConcurrentUnionFindArray<std::ptrdiff_t> * regions_;
+    Pass pass_;
+};
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType, class EqualityFunctor>
+unsigned int 
+parallelLabelImage(SrcIterator upperlefts, SrcIterator lowerrights, SrcAccessor sa,
+                   DestIterator upperleftd, DestAccessor da, bool eight_neighbors,
+                   bool withBackground, ValueType const & backgroundValue, 
+                   EqualityFunctor equal, ParallelOptions const & opt)
+{
+    typedef ParallelLabelImageFunctor<SrcIterator, SrcAccessor, DestIterator, DestAccessor, 
+                                      ValueType, EqualityFunctor> Functor;
+    typedef typename DestAccessor::value_type LabelType;
+    
+    int nThreads = opt.actualNumThreads(), 
+        h = lowerrights.y - upperlefts.y;
+    if(h == 0)
+        return 0;
+    int stripeHeight = (h + nThreads - 1) / nThreads,
+        stripes = (h + stripeHeight - 1) / stripeHeight;
+    
+    ArrayVector<std::ptrdiff_t> offsets(stripes + 1, 0);
+    Functor f(upperlefts, lowerrights, sa, upperleftd, da, eight_neighbors, 
+              withBackground, backgroundValue, equal, stripeHeight, offsets);
+    parallel_foreach(nThreads, stripes, f);
+    
+    for(int k = 0; k < stripes; ++k)
+        offsets[k+1] += offsets[k];
+    ConcurrentUnionFindArray<std::ptrdiff_t> regions(offsets[stripes] + 1);
+    f.regions_ = &regions;
+    
+    f.pass_ = Functor::MergeStripes;
+    parallel_foreach(nThreads, stripes - 1, f);
+    
+    std::ptrdiff_t count = regions.makeContiguous();
+    vigra_invariant(count <= (std::ptrdiff_t)NumericTraits<LabelType>::max(),
+        "connected components: Need more labels than can be represented in the destination type.");
+    
+    f.pass_ = Functor::RelabelStripes;
+    parallel_foreach(nThreads, stripes, f);
+    return (unsigned int)count;
+}
+
+} // namespace detail
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class EqualityFunctor>
+unsigned int labelImage(SrcIterator upperlefts,
+                        SrcIterator lowerrights, SrcAccessor sa,
+                        DestIterator upperleftd, DestAccessor da,
+                        bool eight_neighbors, EqualityFunctor equal,
+                        ParallelOptions const & opt)
+{
+    if(opt.actualNumThreads() == 1)
+        return labelImage(upperlefts, lowerrights, sa, upperleftd, da, eight_neighbors, equal);
+    return detail::parallelLabelImage(upperlefts, lowerrights, sa, upperleftd, da, eight_neighbors,
+                                      false, typename SrcAccessor::value_type(), equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline
+unsigned int labelImage(SrcIterator upperlefts,
+                        SrcIterator lowerrights, SrcAccessor sa,
+                        DestIterator upperleftd, DestAccessor da,
+                        bool eight_neighbors, ParallelOptions const & opt)
+{
+    return labelImage(upperlefts, lowerrights, sa, upperleftd, da, eight_neighbors,
+                      std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class EqualityFunctor>
+inline
+unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                        pair<DestIterator, DestAccessor> dest,
+                        bool eight_neighbors, EqualityFunctor equal,
+                        ParallelOptions const & opt)
+{
+    return labelImage(src.first, src.second, src.third,
+                      dest.first, dest.second, eight_neighbors, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline
+unsigned int labelImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                        pair<DestIterator, DestAccessor> dest,
+                        bool eight_neighbors, ParallelOptions const & opt)
+{
+    return labelImage(src.first, src.second, src.third,
+                      dest.first, dest.second, eight_neighbors,
+                      std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType, class EqualityFunctor>
+unsigned int labelImageWithBackground(
+    SrcIterator upperlefts,
+    SrcIterator lowerrights, SrcAccessor sa,
+    DestIterator upperleftd, DestAccessor da,
+    bool eight_neighbors,
+    ValueType background_value, EqualityFunctor equal,
+    ParallelOptions const & opt)
+{
+    if(opt.actualNumThreads() == 1)
+        return labelImageWithBackground(upperlefts, lowerrights, sa, upperleftd, da, 
+                                        eight_neighbors, background_value, equal);
+    return detail::parallelLabelImage(upperlefts, lowerrights, sa, upperleftd, da, eight_neighbors,
+                                      true, background_value, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType>
+inline
+unsigned int labelImageWithBackground(
+    SrcIterator upperlefts,
+    SrcIterator lowerrights, SrcAccessor sa,
+    DestIterator upperleftd, DestAccessor da,
+    bool eight_neighbors,
+    ValueType background_value, ParallelOptions const & opt)
+{
+    return labelImageWithBackground(upperlefts, lowerrights, sa,
+                            upperleftd, da,
+                            eight_neighbors, background_value,
+                            std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType, class EqualityFunctor>
+inline
+unsigned int labelImageWithBackground(
+    triple<SrcIterator, SrcIterator, SrcAccessor> src,
+    pair<DestIterator, DestAccessor> dest,
+    bool eight_neighbors,
+    ValueType background_value, EqualityFunctor equal,
+    ParallelOptions const & opt)
+{
+    return labelImageWithBackground(src.first, src.second, src.third,
+                                    dest.first, dest.second,
+                                    eight_neighbors, background_value, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class ValueType>
+inline
+unsigned int labelImageWithBackground(
+    triple<SrcIterator, SrcIterator, SrcAccessor> src,
+    pair<DestIterator, DestAccessor> dest,
+    bool eight_neighbors,
+    ValueType background_value, ParallelOptions const & opt)
+{
+    return labelImageWithBackground(src.first, src.second, src.third,
+                            dest.first, dest.second,
+                            eight_neighbors, background_value,
+                            std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
 /********************************************************/
 /*                                                      */
 /*            regionImageToCrackEdgeImage               */
@@ -40,6 +40,7 @@
 #include "voxelneighborhood.hxx"
 #include "multi_array.hxx"
 #include "union_find.hxx"
+#include "threadpool.hxx"
 
 namespace vigra{
 
@@ -77,6 +78,21 @@ namespace vigra{
                                  DestIterator d_Iter, DestAccessor da,
                                  Neighborhood3D neighborhood3D, EqualityFunctor equal);
 
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D>
+        unsigned int labelVolume(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                 DestIterator d_Iter, DestAccessor da,
+                                 Neighborhood3D neighborhood3D, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D, class EqualityFunctor>
+        unsigned int labelVolume(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                 DestIterator d_Iter, DestAccessor da,
+                                 Neighborhood3D neighborhood3D, EqualityFunctor equal,
+                                 ParallelOptions const & opt);
     }
     \endcode
 
@@ -98,6 +114,21 @@ namespace vigra{
                                  pair<DestIterator, DestAccessor> dest,
                                  Neighborhood3D neighborhood3D, EqualityFunctor equal);
 
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D>
+        unsigned int labelVolume(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                 pair<DestIterator, DestAccessor> dest,
+                                 Neighborhood3D neighborhood3D, ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                 class DestIterator, class DestAccessor,
+                 class Neighborhood3D, class EqualityFunctor>
+        unsigned int labelVolume(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                 pair<DestIterator, DestAccessor> dest,
+                                 Neighborhood3D neighborhood3D, EqualityFunctor equal,
+                                 ParallelOptions const & opt);
     }
     \endcode
     
@@ -110,6 +141,12 @@ namespace vigra{
         unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
                                     pair<DestIterator, DestAccessor> dest);
                                     
+        // parallel version
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor>
+        unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                    pair<DestIterator, DestAccessor> dest,
+                                    ParallelOptions const & opt);
     }
     \endcode
 
@@ -121,6 +158,13 @@ namespace vigra{
     without overflow. Region numbers will be a consecutive sequence
     starting with one and ending with the region number returned by
     the function (inclusive).
+    
+    When \ref vigra::ParallelOptions are passed, the volume is split into 
+    slabs along the z-axis, one per thread. The slabs are labeled 
+    independently, the regions touching across slab boundaries are merged
+    by means of a concurrent union-find array, and the final labels are written 
+    in parallel. The result is identical to the sequential algorithm.
+    The EqualityFunctor must be thread-safe in this case.
 
     Return:  the number of regions found (= largest region label)
 
@@ -139,6 +183,10 @@ namespace vigra{
 
     // find 26-connected regions
     int max_region_label = vigra::labelVolume(srcMultiArrayRange(src), destMultiArray(dest), NeighborCode3DTwentySix());
+    
+    // the same, using 8 threads
+    int max_region_label = vigra::labelVolume(srcMultiArrayRange(src), destMultiArray(dest), NeighborCode3DTwentySix(),
+                                              ParallelOptions().numThreads(8));
     \endcode
 
     <b> Required Interface:</b>
@@ -369,6 +417,22 @@ unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
                                                           Neighborhood3D neighborhood3D, ValueType background_value,
                                                             EqualityFunctor equal);
 
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D, class ValueType>
+        unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                               DestIterator d_Iter, DestAccessor da,
+                                               Neighborhood3D neighborhood3D, ValueType background_value,
+                                               ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D, class ValueType, class EqualityFunctor>
+        unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                               DestIterator d_Iter, DestAccessor da,
+                                               Neighborhood3D neighborhood3D, ValueType background_value,
+                                               EqualityFunctor equal, ParallelOptions const & opt);
     }
     \endcode
 
@@ -391,6 +455,22 @@ unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
                                                         Neighborhood3D neighborhood3D, ValueType background_value,
                                                         EqualityFunctor equal);
 
+        // parallel versions
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D, class ValueType>
+        unsigned int labelVolumeWithBackground(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                               pair<DestIterator, DestAccessor> dest,
+                                               Neighborhood3D neighborhood3D, ValueType background_value,
+                                               ParallelOptions const & opt);
+
+        template <class SrcIterator, class SrcAccessor,class SrcShape,
+                  class DestIterator, class DestAccessor,
+                  class Neighborhood3D, class ValueType, class EqualityFunctor>
+        unsigned int labelVolumeWithBackground(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                               pair<DestIterator, DestAccessor> dest,
+                                               Neighborhood3D neighborhood3D, ValueType background_value,
+                                               EqualityFunctor equal, ParallelOptions const & opt);
     }
     \endcode
 
@@ -405,7 +485,9 @@ unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
     The destination's value type should be large enough to hold the
     labels without overflow. Region numbers will be a consecutive
     sequence starting with one and ending with the region number
-    returned by the function (inclusive).
+    returned by the function (inclusive). When \ref vigra::ParallelOptions
+    are passed, the volume is labeled in parallel as described in 
+    \ref labelVolume(), with identical results.
 
     Return:  the number of regions found (= largest region label)
 
@@ -549,8 +631,8 @@ unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, Sr
                 
                     do
                     {            
-                        // if colors are equal
-                        if(equal(sa(xs), sa(xs, *nc)))
+                        // if colors are equal (background neighbors have label 0)
+                        if(da(xd,*nc) != 0 && equal(sa(xs), sa(xs, *nc)))
                         {
                             currentLabel = label.makeUnion(label[da(xd,*nc)], currentLabel);
                         }
@@ -564,8 +646,8 @@ unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, Sr
                     int j=0;
                     while(nc.direction() != Neighborhood3D::Error)
                     {
-                        //   colors equal???
-                        if(equal(sa(xs), sa(xs, *nc)))
+                        //   colors equal??? (background neighbors have label 0)
+                        if(da(xd,*nc) != 0 && equal(sa(xs), sa(xs, *nc)))
                         {
                             currentLabel = label.makeUnion(label[da(xd,*nc)], currentLabel);
                         }
@@ -599,6 +681,298 @@ unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, Sr
     return count;
 }
 
+/********************************************************/
+/*                                                      */
+/*           parallel connected components              */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Parallel variant of labelVolume() and labelVolumeWithBackground(). The 
+    // volume is split into slabs along the z-axis, which are processed in three
+    // passes: 
+    //
+    // LabelSlabs: every slab is labeled independently by the sequential algorithm. 
+    //     Local label 'l' of slab 'k' becomes the provisional global label 
+    //     'offsets[k] + l', where offsets[k] is the number of regions in all
+    //     preceding slabs (the background keeps label 0).
+    // MergeSlabs: the regions that touch across the front face of every slab are
+    //     merged in a concurrent union-find array over the provisional labels.
+    // RelabelSlabs: all local labels are replaced with the final labels.
+    //
+    // Since the provisional labels increase in scan order of each region's first 
+    // voxel and the union-find array keeps the smallest label as root, the final
+    // labels are identical to the result of the sequential algorithm.
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class ValueType, class EqualityFunctor>
+class ParallelLabelVolumeFunctor
+{
+  public:
+    typedef typename DestAccessor::value_type LabelType;
+    typedef typename SrcIterator::multi_difference_type Diff;
+    
+    enum Pass { LabelSlabs, MergeSlabs, RelabelSlabs };
+    
+    ParallelLabelVolumeFunctor(SrcIterator s, SrcShape const & shape, SrcAccessor sa,
+                               DestIterator d, DestAccessor da,
+                               bool withBackground, ValueType const & backgroundValue, 
+                               EqualityFunctor equal, int slabDepth, 
+                               ArrayVector<MultiArrayIndex> & offsets)
+    : s_(s), shape_(shape), sa_(sa), d_(d), da_(da),
+      withBackground_(withBackground), backgroundValue_(backgroundValue), equal_(equal),
+      slabDepth_(slabDepth), offsets_(offsets), regions_(0), pass_(LabelSlabs)
+    {
+        // neighbors in the preceding z-slice
+        for(int k=0; k<Neighborhood3D::DirectionCount; ++k)
+            if(Neighborhood3D::diff(k)[2] == -1)
+                faceNeighbors_.push_back(Neighborhood3D::diff(k));
+    }
+    
+    void operator()(int, MultiArrayIndex k) const
+    {
+        if(pass_ == MergeSlabs)
+            ++k; // the first slab has no predecessor
+            
+        int w = shape_[0], h = shape_[1], 
+            z0 = k*slabDepth_, z1 = std::min<int>(shape_[2], z0 + slabDepth_);
+        SrcIterator s = s_ + Diff(0, 0, z0);
+        DestIterator d = d_ + Diff(0, 0, z0);
+        
+        if(pass_ == LabelSlabs)
+        {
+            SrcShape shape(shape_);
+            shape[2] = z1 - z0;
+            offsets_[k+1] = withBackground_
+                                ? labelVolumeWithBackground(s, shape, sa_, d, da_, Neighborhood3D(), 
+                                                            backgroundValue_, equal_)
+                                : labelVolume(s, shape, sa_, d, da_, Neighborhood3D(), equal_);
+        }
+        else if(pass_ == MergeSlabs)
+        {
+            for(int y = 0; y < h; ++y)
+            {
+                for(int x = 0; x < w; ++x)
+                {
+                    Diff p(x, y, 0);
+                    LabelType label = da_(d, p);
+                    if(label == 0)
+                        continue; // background
+                    for(unsigned int j = 0; j < faceNeighbors_.size(); ++j)
+                    {
+                        Diff q = p + faceNeighbors_[j];
+                        if(q[0] < 0 || q[0] >= w || q[1] < 0 || q[1] >= h)
+                            continue;
+                        LabelType neighborLabel = da_(d, q);
+                        if(neighborLabel == 0)
+                            continue; // background
+                        if(equal_(sa_(s, p), sa_(s, q)))
+                            regions_->makeUnion(provisionalLabel(k, label), 
+                                                provisionalLabel(k-1, neighborLabel));
+                    }
+                }
+            }
+        }
+        else // pass_ == RelabelSlabs
+        {
+            DestIterator zd = d;
+            for(int z = z0; z < z1; ++z, ++zd.dim2())
+            {
+                DestIterator yd(zd);
+                for(int y = 0; y < h; ++y, ++yd.dim1())
+                {
+                    DestIterator xd(yd);
+                    for(int x = 0; x < w; ++x, ++xd.dim0())
+                        da_.set((LabelType)(*regions_)[provisionalLabel(k, da_(xd))], xd);
+                }
+            }
+        }
+    }
+    
+    MultiArrayIndex provisionalLabel(MultiArrayIndex k, LabelType label) const
+    {
+        return label == 0
+                   ? 0
+                   : offsets_[k] + (MultiArrayIndex)label;
+    }
+    
+    SrcIterator s_;
+    SrcShape shape_;
+    SrcAccessor sa_;
+    DestIterator d_;
+    DestAccessor da_;
+    bool withBackground_;
+    ValueType backgroundValue_;
+    EqualityFunctor equal_;
+    int slabDepth_;
+    ArrayVector<MultiArrayIndex> & offsets_;
+    ArrayVector<Diff> faceNeighbors_;
+    ConcurrentUnionFindArray<MultiArrayIndex> * regions_;
+    Pass pass_;
+};
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class ValueType, class EqualityFunctor>
+unsigned int 
+parallelLabelVolume(SrcIterator s, SrcShape const & shape, SrcAccessor sa,
+                    DestIterator d, DestAccessor da, Neighborhood3D, 
+                    bool withBackground, ValueType const & backgroundValue, 
+                    EqualityFunctor equal, ParallelOptions const & opt)
+{
+    typedef ParallelLabelVolumeFunctor<SrcIterator, SrcShape, SrcAccessor, 
+                                       DestIterator, DestAccessor, 
+                                       Neighborhood3D, ValueType, EqualityFunctor> Functor;
+    typedef typename DestAccessor::value_type LabelType;
+    
+    int nThreads = opt.actualNumThreads(), 
+        depth = shape[2];
+    if(depth == 0)
+        return 0;
+    int slabDepth = (depth + nThreads - 1) / nThreads,
+        slabs = (depth + slabDepth - 1) / slabDepth;
+    
+    ArrayVector<MultiArrayIndex> offsets(slabs + 1, 0);
+    Functor f(s, shape, sa, d, da, withBackground, backgroundValue, equal, slabDepth, offsets);
+    parallel_foreach(nThreads, slabs, f);
+    
+    for(int k = 0; k < slabs; ++k)
+        offsets[k+1] += offsets[k];
+    ConcurrentUnionFindArray<MultiArrayIndex> regions(offsets[slabs] + 1);
+    f.regions_ = &regions;
+    
+    f.pass_ = Functor::MergeSlabs;
+    parallel_foreach(nThreads, slabs - 1, f);
+    
+    MultiArrayIndex count = regions.makeContiguous();
+    vigra_invariant(count <= (MultiArrayIndex)NumericTraits<LabelType>::max(),
+        "connected components: Need more labels than can be represented in the destination type.");
+    
+    f.pass_ = Functor::RelabelSlabs;
+    parallel_foreach(nThreads, slabs, f);
+    return (unsigned int)count;
+}
+
+} // namespace detail
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class EqualityFunctor>
+unsigned int labelVolume(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                         DestIterator d_Iter, DestAccessor da,
+                         Neighborhood3D neighborhood3D, EqualityFunctor equal,
+                         ParallelOptions const & opt)
+{
+    if(opt.actualNumThreads() == 1)
+        return labelVolume(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, equal);
+    return detail::parallelLabelVolume(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, 
+                                       false, typename SrcAccessor::value_type(), equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D>
+inline 
+unsigned int labelVolume(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                         DestIterator d_Iter, DestAccessor da,
+                         Neighborhood3D neighborhood3D, ParallelOptions const & opt)
+{
+    return labelVolume(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, 
+                       std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class EqualityFunctor>
+inline 
+unsigned int labelVolume(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                         pair<DestIterator, DestAccessor> dest,
+                         Neighborhood3D neighborhood3D, EqualityFunctor equal,
+                         ParallelOptions const & opt)
+{
+    return labelVolume(src.first, src.second, src.third, dest.first, dest.second, neighborhood3D, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D>
+inline 
+unsigned int labelVolume(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                         pair<DestIterator, DestAccessor> dest,
+                         Neighborhood3D neighborhood3D, ParallelOptions const & opt)
+{
+    return labelVolume(src.first, src.second, src.third, dest.first, dest.second, neighborhood3D, 
+                       std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor>
+inline 
+unsigned int labelVolumeSix(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                            pair<DestIterator, DestAccessor> dest, 
+                            ParallelOptions const & opt)
+{
+    return labelVolume(src.first, src.second, src.third, dest.first, dest.second, NeighborCode3DSix(), 
+                       std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D,
+          class ValueType, class EqualityFunctor>
+unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                       DestIterator d_Iter, DestAccessor da,
+                                       Neighborhood3D neighborhood3D,
+                                       ValueType backgroundValue, EqualityFunctor equal,
+                                       ParallelOptions const & opt)
+{
+    if(opt.actualNumThreads() == 1)
+        return labelVolumeWithBackground(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, backgroundValue, equal);
+    return detail::parallelLabelVolume(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, 
+                                       true, backgroundValue, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class ValueType>
+inline 
+unsigned int labelVolumeWithBackground(SrcIterator s_Iter, SrcShape srcShape, SrcAccessor sa,
+                                       DestIterator d_Iter, DestAccessor da,
+                                       Neighborhood3D neighborhood3D, ValueType backgroundValue,
+                                       ParallelOptions const & opt)
+{
+    return labelVolumeWithBackground(s_Iter, srcShape, sa, d_Iter, da, neighborhood3D, backgroundValue, 
+                                     std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class ValueType, class EqualityFunctor>
+inline 
+unsigned int labelVolumeWithBackground(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                       pair<DestIterator, DestAccessor> dest,
+                                       Neighborhood3D neighborhood3D, ValueType backgroundValue, 
+                                       EqualityFunctor equal, ParallelOptions const & opt)
+{
+    return labelVolumeWithBackground(src.first, src.second, src.third, dest.first, dest.second, 
+                                     neighborhood3D, backgroundValue, equal, opt);
+}
+
+template <class SrcIterator, class SrcAccessor,class SrcShape,
+          class DestIterator, class DestAccessor,
+          class Neighborhood3D, class ValueType>
+inline 
+unsigned int labelVolumeWithBackground(triple<SrcIterator, SrcShape, SrcAccessor> src,
+                                       pair<DestIterator, DestAccessor> dest,
+                                       Neighborhood3D neighborhood3D, ValueType backgroundValue,
+                                       ParallelOptions const & opt)
+{
+    return labelVolumeWithBackground(src.first, src.second, src.third, dest.first, dest.second, 
+                                     neighborhood3D, backgroundValue, 
+                                     std::equal_to<typename SrcAccessor::value_type>(), opt);
+}
+
 //@}
 
 } //end of namespace vigra
@@ -238,6 +238,15 @@ class Matrix
     : BaseType(rhs)
     {}
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move constructor. Takes over the memory of \a rhs,
+            which is left as an empty matrix.
+         */
+    Matrix(Matrix &&rhs)
+    : BaseType(std::move(rhs))
+    {}
+#endif
+
         /** construct from temporary matrix, which looses its data.
 
             This operation is equivalent to
@@ -273,6 +282,17 @@ class Matrix
         return *this;
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move assignment. The memory of \a rhs is taken over, so that all 
+            objects (array views, iterators) depending on this matrix are invalidated.
+         */
+    Matrix & operator=(Matrix &&rhs)
+    {
+        BaseType::operator=(std::move(rhs)); // has the correct semantics already
+        return *this;
+    }
+#endif
+
         /** assign a temporary matrix. If the shapes of the two matrices match,
             only the data are copied (in order to not invalidate views and iterators
             depending on this matrix). Otherwise, the memory is swapped
@@ -995,6 +1015,34 @@ transpose(MultiArrayView<2, T, C> const & v)
     return v.transpose();
 }
 
+    /** create the transpose of a temporary matrix.
+        Since a view to a temporary would become invalid, the result is 
+        returned as a temporary matrix. Square matrices are transposed 
+        in-place, so that no new memory needs to be allocated.
+
+    <b>\#include</b> \<vigra/matrix.hxx\> or<br>
+    <b>\#include</b> \<vigra/linear_algebra.hxx\><br>
+        Namespaces: vigra and vigra::linalg
+     */
+template <class T>
+inline TemporaryMatrix<T>
+transpose(TemporaryMatrix<T> const & v)
+{
+    const MultiArrayIndex rows = rowCount(v);
+    const MultiArrayIndex cols = columnCount(v);
+    if(rows != cols)
+    {
+        TemporaryMatrix<T> ret(cols, rows);
+        transpose(v, ret);
+        return ret;
+    }
+    TemporaryMatrix<T> & t = const_cast<TemporaryMatrix<T> &>(v);
+    for(MultiArrayIndex i = 1; i < cols; ++i)
+        for(MultiArrayIndex j = 0; j < i; ++j)
+            std::swap(t(j, i), t(i, j));
+    return t;
+}
+
     /** Create new matrix by concatenating two matrices \a a and \a b vertically, i.e. on top of each other.
         The two matrices must have the same number of columns.
         The result is returned as a temporary matrix.
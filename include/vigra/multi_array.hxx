@@ -39,6 +39,7 @@
 
 #include <memory>
 #include <algorithm>
+#include <utility>
 #include "accessor.hxx"
 #include "tinyvector.hxx"
 #include "rgbvalue.hxx"
@@ -48,6 +49,7 @@
 #include "multi_iterator.hxx"
 #include "metaprogramming.hxx"
 #include "mathutil.hxx"
+#include "memory.hxx"
 
 // Bounds checking Macro used if VIGRA_CHECK_BOUNDS is defined.
 #ifdef VIGRA_CHECK_BOUNDS
@@ -1270,6 +1272,32 @@ public:
         return (&operator[](p) - m_ptr) == coordinateToScanOrderIndex(p);
     }
 
+        /** Largest power of 2 that divides the byte addresses of all lines along the
+            first axis, i.e. the alignment of the data pointer and all line starts.
+            Vectorized kernels can use aligned loads and stores for entire lines when
+            this is a multiple of the vector width (see \ref vigra::PaddedMultiArray).
+            Returns 0 when the array is empty.
+        */
+    std::size_t alignment() const
+    {
+        std::size_t a = reinterpret_cast<std::size_t>(m_ptr);
+        if(a == 0)
+            return 0;
+        for(int k = 1; k < actual_dimension; ++k)
+            a |= (std::size_t)m_stride[k] * sizeof(T);
+        return a & (~a + 1);
+    }
+
+        /** Check whether all lines along the first axis start at addresses that
+            are multiples of \a bytes (which must be a power of 2), and the
+            elements of each line are consecutive in memory.
+        */
+    bool isAligned(std::size_t bytes) const
+    {
+        std::size_t a = alignment();
+        return a != 0 && a % bytes == 0 && m_stride[0] == 1;
+    }
+
         /** bind the M outmost dimensions to certain indices.
             this reduces the dimensionality of the image to
             max { 1, N-M }.
@@ -2537,6 +2565,19 @@ public:
         allocate (this->m_ptr, this->elementCount (), rhs.data ());
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move constructor. Takes over the memory of \a rhs, which 
+            is left as an empty array.
+         */
+    MultiArray (MultiArray && rhs)
+    : MultiArrayView <N, T> (difference_type (diff_zero_t(0)),
+                             difference_type (diff_zero_t(0)), 0),
+      m_alloc (rhs.m_alloc)
+    {
+        this->swap(rhs);
+    }
+#endif
+
         /** constructor from an array expression
          */
     template<class Expression>
@@ -2567,6 +2608,21 @@ public:
         return *this;
     }
 
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        /** move assignment.<br>
+            The memory of \a rhs is taken over without copying, and \a rhs is 
+            left as an empty array. Unlike the copy assignment, this invalidates all
+            objects (array views, iterators) depending on the lhs array, even when 
+            the shapes match.
+         */
+    MultiArray & operator= (MultiArray && rhs)
+    {
+        if (this != &rhs)
+            MultiArray(std::move(rhs)).swap(*this);
+        return *this;
+    }
+#endif
+
         /** assignment from arbitrary MultiArrayView.<br>
             If the size of \a rhs is the same as the left-hand side arrays's old size, only
             the data are copied. Otherwise, new storage is allocated, which invalidates all
@@ -2930,6 +2986,13 @@ MultiArray <N, T, A>::swap (MultiArray & other)
     std::swap(this->m_alloc,  other.m_alloc);
 }
 
+template <unsigned int N, class T, class A>
+inline void
+swap(MultiArray <N, T, A> & a, MultiArray <N, T, A> & b)
+{
+    a.swap(b);
+}
+
 template <unsigned int N, class T, class A>
 void MultiArray <N, T, A>::allocate (pointer & ptr, difference_type_1 s,
                                      const_reference init)
@@ -2997,6 +3060,160 @@ inline void MultiArray <N, T, A>::deallocate (pointer & ptr, difference_type_1 s
     ptr = 0;
 }
 
+/********************************************************/
+/*                                                      */
+/*                   PaddedMultiArray                   */
+/*                                                      */
+/********************************************************/
+
+/** \brief Array whose lines are aligned for vectorized processing.
+
+    Like \ref vigra::MultiArray, this class owns its data. However, each line along
+    the first axis is padded such that all lines start at addresses that are multiples
+    of <tt>ALIGNMENT</tt> bytes (default: 64, suitable for AVX, AVX-512, and cache lines).
+    Vectorized kernels can thus process every line with aligned loads and stores and
+    don't need to peel off unaligned elements at the beginning of each line.
+    The padding is not part of the array's shape.
+
+    PaddedMultiArray is derived from <tt>MultiArrayView<N, T, StridedArrayTag></tt>, so it can 
+    be passed to all functions accepting strided views. The elements of each line are 
+    consecutive, but lines are not, so <tt>isUnstrided()</tt> returns <tt>false</tt> when 
+    the shape is not a multiple of the alignment. Consequently, the array does not bind
+    to functions requiring contiguous memory (<tt>MultiArrayView<N, T, UnstridedArrayTag></tt>,
+    e.g. \ref vigra::HDF5File::write()), which would otherwise read the padding.
+    Copy construction and assignment copy the data.
+
+    \code
+    PaddedMultiArray<3, float> volume(Shape3(301, 200, 100));
+    // each line starts at a 64-byte boundary, the lines have a stride of 304 elements
+    vigra_assert(volume.isAligned(64) && volume.stride(1) == 304, "");
+
+    gaussianSmoothMultiArray(srcMultiArrayRange(volume), destMultiArray(volume), 2.0);
+    \endcode
+
+    <b>\#include</b> \<vigra/multi_array.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T, int ALIGNMENT = 64>
+class PaddedMultiArray
+: public MultiArrayView<N, T, StridedArrayTag>
+{
+  public:
+    typedef MultiArrayView<N, T, StridedArrayTag>   view_type;
+    typedef typename view_type::value_type          value_type;
+    typedef typename view_type::const_reference     const_reference;
+    typedef typename view_type::difference_type     difference_type;
+    typedef AlignedAllocator<T, ALIGNMENT>          allocator_type;
+
+        /** Construct an empty array.
+        */
+    PaddedMultiArray()
+    {}
+
+        /** Construct an array of the given shape, with all elements set to \a init.
+        */
+    explicit PaddedMultiArray(difference_type const & shape,
+                              const_reference init = value_type())
+    {
+        reshape(shape, init);
+    }
+
+        /** Copy constructor.
+        */
+    PaddedMultiArray(PaddedMultiArray const & rhs)
+    : view_type()
+    {
+        copyOrReshape(rhs);
+    }
+
+        /** Construct from the data of an arbitrary view.
+        */
+    template <class U, class StrideTag>
+    explicit PaddedMultiArray(MultiArrayView<N, U, StrideTag> const & rhs)
+    {
+        copyOrReshape(rhs);
+    }
+
+        /** Copy assignment. When the shapes differ, the array is reshaped first.
+        */
+    PaddedMultiArray & operator=(PaddedMultiArray const & rhs)
+    {
+        if(this != &rhs)
+            copyOrReshape(rhs);
+        return *this;
+    }
+
+        /** Assignment from an arbitrary view. When the shapes differ, the array is reshaped first.
+        */
+    template <class U, class StrideTag>
+    PaddedMultiArray & operator=(MultiArrayView<N, U, StrideTag> const & rhs)
+    {
+        copyOrReshape(rhs);
+        return *this;
+    }
+
+        /** Set all elements to \a v.
+        */
+    PaddedMultiArray & operator=(value_type const & v)
+    {
+        this->init(v);
+        return *this;
+    }
+
+        /** Change the shape and set all elements to \a init.
+        */
+    void reshape(difference_type const & shape, const_reference init = value_type())
+    {
+        difference_type strides = paddedStrides(shape);
+        MultiArrayIndex size = (min(shape) > 0)
+                                   ? shape[N-1]*strides[N-1]
+                                   : 0;
+        buffer_.reshape(typename MultiArrayShape<1>::type(size), init);
+        this->m_shape = shape;
+        this->m_stride = strides;
+        this->m_ptr = buffer_.data();
+    }
+
+        /** Swap the data of two arrays in constant time.
+        */
+    void swap(PaddedMultiArray & rhs)
+    {
+        buffer_.swap(rhs.buffer_);
+        std::swap(this->m_shape, rhs.m_shape);
+        std::swap(this->m_stride, rhs.m_stride);
+        std::swap(this->m_ptr, rhs.m_ptr);
+    }
+
+        /** Strides of the padded memory layout for the given shape.
+        */
+    static difference_type paddedStrides(difference_type const & shape)
+    {
+        // smallest number of elements occupying a multiple of ALIGNMENT bytes
+        MultiArrayIndex step = 1;
+        while((step*sizeof(T)) % ALIGNMENT != 0)
+            ++step;
+        difference_type res;
+        res[0] = 1;
+        if(N > 1)
+            res[1] = ((shape[0] + step - 1) / step) * step;
+        for(int k = 2; k < (int)N; ++k)
+            res[k] = res[k-1]*shape[k-1];
+        return res;
+    }
+
+  private:
+    template <class U, class StrideTag>
+    void copyOrReshape(MultiArrayView<N, U, StrideTag> const & rhs)
+    {
+        if(this->shape() != rhs.shape())
+            reshape(rhs.shape());
+        if(this->hasData())
+            this->copy(rhs);
+    }
+
+    MultiArray<1, T, allocator_type> buffer_;
+};
+
 /********************************************************/
 /*                                                      */
 /*              argument object factories               */
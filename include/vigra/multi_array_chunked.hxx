@@ -0,0 +1,1369 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2012-2014 by Ullrich Koethe                  */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_ARRAY_CHUNKED_HXX
+#define VIGRA_MULTI_ARRAY_CHUNKED_HXX
+
+#include <list>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <new>
+#include "config.hxx"
+#include "error.hxx"
+#include "multi_array.hxx"
+#include "multi_pointoperators.hxx"
+
+#ifdef VIGRA_HAS_STD_THREAD
+#include <mutex>
+#endif
+
+namespace vigra {
+
+/** \addtogroup ChunkedArrayClasses Chunked arrays
+
+    Store big data (potentially larger than RAM) as a collection of rectangular blocks.
+
+    Chunks are only allocated when they are first accessed, and a bounded LRU cache
+    decides which chunks are kept in memory. Backends differ in where evicted chunks go:
+    \ref vigra::ChunkedArrayLazy keeps everything in RAM, \ref vigra::ChunkedArrayDirectory
+    spills chunks to files in a directory, and \ref vigra::ChunkedArrayHDF5 (in
+    <tt>\<vigra/multi_array_chunked_hdf5.hxx\></tt>) uses a chunked HDF5 dataset.
+*/
+//@{
+
+namespace detail {
+
+    // Protects the chunk handles and the cache of a ChunkedArray.
+#ifdef VIGRA_HAS_STD_THREAD
+typedef std::mutex ChunkedArrayMutex;
+typedef std::lock_guard<std::mutex> ChunkedArrayLock;
+#else
+struct ChunkedArrayMutex {};
+
+struct ChunkedArrayLock
+{
+    explicit ChunkedArrayLock(ChunkedArrayMutex &)
+    {}
+};
+#endif
+
+    // Default chunk shape: about 2^18 elements, i.e. 512x512 in 2D and 64^3 in 3D.
+template <int N>
+inline TinyVector<MultiArrayIndex, N>
+defaultChunkShape()
+{
+    return TinyVector<MultiArrayIndex, N>(MultiArrayIndex(1) << std::max(18 / N, 2));
+}
+
+template <int N>
+inline TinyVector<MultiArrayIndex, N>
+chunkArrayShape(TinyVector<MultiArrayIndex, N> const & shape,
+                TinyVector<MultiArrayIndex, N> const & chunk_shape)
+{
+    TinyVector<MultiArrayIndex, N> res;
+    for(int k=0; k<N; ++k)
+        res[k] = (shape[k] + chunk_shape[k] - 1) / chunk_shape[k];
+    return res;
+}
+
+    // Advance 'p' in scan order within the box [start, stop).
+    // Returns false when 'p' wraps around (i.e. the iteration is finished).
+template <int N>
+inline bool
+incrementCoordinate(TinyVector<MultiArrayIndex, N> & p,
+                    TinyVector<MultiArrayIndex, N> const & start,
+                    TinyVector<MultiArrayIndex, N> const & stop)
+{
+    for(int k=0; k<N; ++k)
+    {
+        if(++p[k] < stop[k])
+            return true;
+        p[k] = start[k];
+    }
+    return false;
+}
+
+    // Default cache size: enough chunks to hold a complete slab through the
+    // two largest axes of the chunk grid, so that line-wise and slice-wise
+    // traversals do not reload chunks.
+template <int N>
+inline int
+defaultCacheSize(TinyVector<MultiArrayIndex, N> const & chunk_array_shape)
+{
+    TinyVector<MultiArrayIndex, N> s(chunk_array_shape);
+    std::sort(s.begin(), s.end());
+    MultiArrayIndex res = s[N-1];
+    if(N > 1)
+        res *= s[N-2];
+    return (int)res + 1;
+}
+
+template <class REFERENCE>
+struct ChunkedIteratorIsConst
+{
+    static const bool value = false;
+};
+
+template <class T>
+struct ChunkedIteratorIsConst<T const &>
+{
+    static const bool value = true;
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                  ChunkedArrayOptions                 */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Option object for \ref vigra::ChunkedArray and its subclasses.
+
+        <b>\#include</b> \<vigra/multi_array_chunked.hxx\><br>
+        Namespace: vigra
+    */
+class ChunkedArrayOptions
+{
+  public:
+        /** Initialize options with default values: fill value 0,
+            automatic cache size, no compression.
+        */
+    ChunkedArrayOptions()
+    : fill_value(0.0),
+      cache_max(-1),
+      compression_level(0)
+    {}
+
+        /** Value of array elements that have never been written.
+
+            Default: 0
+        */
+    ChunkedArrayOptions & fillValue(double v)
+    {
+        fill_value = v;
+        return *this;
+    }
+
+        /** Maximum number of chunks kept in memory.
+
+            Chunks that are currently in use (e.g. by an iterator) are never evicted,
+            so the cache may temporarily exceed this size. A negative value selects
+            the default, which is big enough to hold all chunks intersecting a
+            hyperplane through the two longest axes of the array.
+
+            Default: -1
+        */
+    ChunkedArrayOptions & cacheMax(int v)
+    {
+        cache_max = v;
+        return *this;
+    }
+
+        /** Compression level of the backing store (if supported by the backend).
+
+            Default: 0 (no compression)
+        */
+    ChunkedArrayOptions & compression(int v)
+    {
+        compression_level = v;
+        return *this;
+    }
+
+    double fill_value;
+    int cache_max;
+    int compression_level;
+};
+
+/********************************************************/
+/*                                                      */
+/*                       ChunkBase                      */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Book-keeping information of a single chunk.
+
+        Backends derive from this class to store additional data
+        (e.g. allocators or file names).
+    */
+template <unsigned int N, class T>
+class ChunkBase
+{
+  public:
+    typedef typename MultiArrayShape<N>::type shape_type;
+    typedef T * pointer;
+
+    ChunkBase()
+    : pointer_(0),
+      refcount_(0),
+      dirty_(false),
+      in_cache_(false)
+    {}
+
+    virtual ~ChunkBase()
+    {}
+
+        // address of the chunk's data (0 when not resident)
+    pointer pointer_;
+        // index of the chunk in the chunk grid
+    shape_type index_;
+        // shape of this chunk (smaller than the nominal chunk shape at the array border)
+    shape_type shape_;
+    shape_type strides_;
+        // number of active users, chunks with refcount_ > 0 are never evicted
+    int refcount_;
+        // true when the data have been modified since the last write to the backing store
+    bool dirty_;
+    bool in_cache_;
+    typename std::list<ChunkBase *>::iterator cache_position_;
+};
+
+template <unsigned int N, class T>
+class ChunkedArray;
+
+/********************************************************/
+/*                                                      */
+/*                 ChunkedArrayIterator                 */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Scan-order iterator over a \ref vigra::ChunkedArray.
+
+        The iterator holds a reference to the current chunk, so that the chunk
+        stays in memory while the iterator points into it. It is a forward
+        iterator and can be used with STL algorithms.
+    */
+template <unsigned int N, class T, class REFERENCE, class POINTER>
+class ChunkedArrayIterator
+{
+  public:
+    typedef ChunkedArray<N, T>                    array_type;
+    typedef ChunkBase<N, T>                       Chunk;
+    typedef typename MultiArrayShape<N>::type     shape_type;
+    typedef T                                     value_type;
+    typedef REFERENCE                             reference;
+    typedef POINTER                               pointer;
+    typedef MultiArrayIndex                       difference_type;
+    typedef std::forward_iterator_tag             iterator_category;
+
+    static const bool is_const = detail::ChunkedIteratorIsConst<REFERENCE>::value;
+
+    ChunkedArrayIterator()
+    : array_(0), point_(), chunk_(0), ptr_(0)
+    {}
+
+    ChunkedArrayIterator(array_type * array, shape_type const & point)
+    : array_(array), point_(point), chunk_(0), ptr_(0)
+    {
+        locate();
+    }
+
+    ChunkedArrayIterator(ChunkedArrayIterator const & rhs)
+    : array_(rhs.array_), point_(rhs.point_),
+      chunk_index_(rhs.chunk_index_), chunk_stop_(rhs.chunk_stop_),
+      chunk_(rhs.chunk_), ptr_(rhs.ptr_)
+    {
+        if(chunk_)
+            array_->retainChunk(chunk_);
+    }
+
+    ~ChunkedArrayIterator()
+    {
+        release();
+    }
+
+    ChunkedArrayIterator & operator=(ChunkedArrayIterator const & rhs)
+    {
+        if(this != &rhs)
+        {
+            release();
+            array_ = rhs.array_;
+            point_ = rhs.point_;
+            chunk_index_ = rhs.chunk_index_;
+            chunk_stop_ = rhs.chunk_stop_;
+            chunk_ = rhs.chunk_;
+            ptr_ = rhs.ptr_;
+            if(chunk_)
+                array_->retainChunk(chunk_);
+        }
+        return *this;
+    }
+
+    reference operator*() const
+    {
+        return *ptr_;
+    }
+
+    pointer operator->() const
+    {
+        return ptr_;
+    }
+
+    ChunkedArrayIterator & operator++()
+    {
+        ++point_[0];
+        if(point_[0] < chunk_stop_[0])
+        {
+            ptr_ += chunk_->strides_[0];
+            return *this;
+        }
+        // end of the current line segment: carry over to the next line
+        shape_type const & shape = array_->shape();
+        if(point_[0] < shape[0])
+        {
+            locate();
+            return *this;
+        }
+        point_[0] = 0;
+        for(unsigned int k=1; k<N; ++k)
+        {
+            if(++point_[k] < shape[k] || k == N-1)
+                break;
+            point_[k] = 0;
+        }
+        locate();
+        return *this;
+    }
+
+    ChunkedArrayIterator operator++(int)
+    {
+        ChunkedArrayIterator res(*this);
+        ++*this;
+        return res;
+    }
+
+    bool operator==(ChunkedArrayIterator const & rhs) const
+    {
+        return point_ == rhs.point_;
+    }
+
+    bool operator!=(ChunkedArrayIterator const & rhs) const
+    {
+        return point_ != rhs.point_;
+    }
+
+        /** Coordinate of the current element.
+        */
+    shape_type const & point() const
+    {
+        return point_;
+    }
+
+  private:
+    void release()
+    {
+        if(chunk_)
+            array_->releaseChunk(chunk_);
+        chunk_ = 0;
+        ptr_ = 0;
+    }
+
+    void locate()
+    {
+        if(point_[N-1] >= array_->shape(N-1))
+        {
+            release();
+            return;
+        }
+        shape_type chunkIndex = array_->chunkIndexOf(point_);
+        if(chunk_ == 0 || chunk_index_ != chunkIndex)
+        {
+            release();
+            chunk_ = array_->acquireChunk(chunkIndex, is_const);
+            chunk_index_ = chunkIndex;
+        }
+        shape_type chunkStart = array_->chunkStart(chunkIndex);
+        chunk_stop_ = chunkStart + array_->chunkShape(chunkIndex);
+        ptr_ = chunk_->pointer_ + dot(point_ - chunkStart, chunk_->strides_);
+    }
+
+    array_type * array_;
+    shape_type point_, chunk_index_, chunk_stop_;
+    Chunk * chunk_;
+    T * ptr_;
+};
+
+/********************************************************/
+/*                                                      */
+/*                     ChunkIterator                    */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Iterate over the chunks of a \ref vigra::ChunkedArray that
+        intersect a region of interest.
+
+        Dereferencing the iterator gives a MultiArrayView to the part of the current chunk
+        that lies inside the ROI. The view stays valid until the iterator is advanced or
+        destroyed. This is the most efficient way to run point-wise operations
+        over a chunked array:
+
+        \code
+        ChunkedArrayLazy<3, float> array(Shape3(2000, 2000, 2000));
+
+        ChunkIterator<3, float> i   = array.chunk_begin(Shape3(0), array.shape()),
+                                end = array.chunk_end(Shape3(0), array.shape());
+        for(; i != end; ++i)
+            *i = 1.0f;
+        \endcode
+    */
+template <unsigned int N, class T>
+class ChunkIterator
+{
+  public:
+    typedef ChunkedArray<N, T>                    array_type;
+    typedef ChunkBase<N, T>                       Chunk;
+    typedef typename MultiArrayShape<N>::type     shape_type;
+    typedef MultiArrayView<N, T, StridedArrayTag> value_type;
+    typedef value_type &                          reference;
+    typedef value_type *                          pointer;
+    typedef MultiArrayIndex                       difference_type;
+    typedef std::forward_iterator_tag             iterator_category;
+
+    ChunkIterator()
+    : array_(0), chunk_(0), scan_index_(0), scan_end_(0)
+    {}
+
+    ChunkIterator(array_type * array, shape_type const & start, shape_type const & stop,
+                  bool at_end = false)
+    : array_(array),
+      start_(start), stop_(stop),
+      chunk_begin_(array->chunkIndexOf(start)),
+      chunk_end_(array->chunkIndexOf(stop - shape_type(1)) + shape_type(1)),
+      chunk_index_(chunk_begin_),
+      chunk_(0),
+      scan_index_(0),
+      scan_end_(prod(chunk_end_ - chunk_begin_))
+    {
+        if(at_end)
+            scan_index_ = scan_end_;
+        else
+            locate();
+    }
+
+    ChunkIterator(ChunkIterator const & rhs)
+    : array_(rhs.array_),
+      start_(rhs.start_), stop_(rhs.stop_),
+      chunk_begin_(rhs.chunk_begin_), chunk_end_(rhs.chunk_end_),
+      chunk_index_(rhs.chunk_index_),
+      roi_start_(rhs.roi_start_), roi_stop_(rhs.roi_stop_),
+      chunk_(rhs.chunk_),
+      view_(rhs.view_),
+      scan_index_(rhs.scan_index_), scan_end_(rhs.scan_end_)
+    {
+        if(chunk_)
+            array_->retainChunk(chunk_);
+    }
+
+    ~ChunkIterator()
+    {
+        release();
+    }
+
+    ChunkIterator & operator=(ChunkIterator const & rhs)
+    {
+        if(this != &rhs)
+        {
+            release();
+            array_ = rhs.array_;
+            start_ = rhs.start_;
+            stop_ = rhs.stop_;
+            chunk_begin_ = rhs.chunk_begin_;
+            chunk_end_ = rhs.chunk_end_;
+            chunk_index_ = rhs.chunk_index_;
+            roi_start_ = rhs.roi_start_;
+            roi_stop_ = rhs.roi_stop_;
+            chunk_ = rhs.chunk_;
+            bindView(rhs.view_);
+            scan_index_ = rhs.scan_index_;
+            scan_end_ = rhs.scan_end_;
+            if(chunk_)
+                array_->retainChunk(chunk_);
+        }
+        return *this;
+    }
+
+    reference operator*()
+    {
+        return view_;
+    }
+
+    pointer operator->()
+    {
+        return &view_;
+    }
+
+    ChunkIterator & operator++()
+    {
+        release();
+        ++scan_index_;
+        detail::incrementCoordinate(chunk_index_, chunk_begin_, chunk_end_);
+        locate();
+        return *this;
+    }
+
+    bool operator==(ChunkIterator const & rhs) const
+    {
+        return scan_index_ == rhs.scan_index_;
+    }
+
+    bool operator!=(ChunkIterator const & rhs) const
+    {
+        return scan_index_ != rhs.scan_index_;
+    }
+
+        /** Global coordinate of the first element in the current view.
+        */
+    shape_type const & chunkStart() const
+    {
+        return roi_start_;
+    }
+
+        /** Global coordinate beyond the last element in the current view.
+        */
+    shape_type const & chunkStop() const
+    {
+        return roi_stop_;
+    }
+
+  private:
+    void release()
+    {
+        if(chunk_)
+            array_->releaseChunk(chunk_);
+        chunk_ = 0;
+    }
+
+    void locate()
+    {
+        if(scan_index_ >= scan_end_)
+            return;
+        chunk_ = array_->acquireChunk(chunk_index_, false);
+        shape_type chunkStart = array_->chunkStart(chunk_index_);
+        roi_start_ = max(start_, chunkStart);
+        roi_stop_  = min(stop_, chunkStart + chunk_->shape_);
+        bindView(value_type(chunk_->shape_, chunk_->strides_, chunk_->pointer_)
+                    .subarray(roi_start_ - chunkStart, roi_stop_ - chunkStart));
+    }
+
+        // MultiArrayView::operator= copies data, but we want to re-point the view
+    void bindView(value_type const & v)
+    {
+        view_.~value_type();
+        new (&view_) value_type(v);
+    }
+
+    array_type * array_;
+    shape_type start_, stop_, chunk_begin_, chunk_end_, chunk_index_;
+    shape_type roi_start_, roi_stop_;
+    Chunk * chunk_;
+    value_type view_;
+    MultiArrayIndex scan_index_, scan_end_;
+};
+
+/********************************************************/
+/*                                                      */
+/*                      ChunkedArray                    */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Abstract base class of chunked arrays.
+
+        A chunked array partitions an N-dimensional array into rectangular chunks of
+        equal shape (except at the array border), which are only allocated when first
+        accessed. The number of chunks resident in memory is limited by an LRU cache,
+        whose size can be controlled by \ref ChunkedArrayOptions::cacheMax(). When a chunk is
+        evicted, its data are written to the backing store of the concrete subclass (see
+        \ref vigra::ChunkedArrayDirectory and \ref vigra::ChunkedArrayHDF5).
+        \ref vigra::ChunkedArrayLazy has no backing store and never evicts chunks.
+
+        Elements are accessed by <tt>getItem()/setItem()</tt>, scan-order iterators,
+        iteration over chunks (<tt>chunk_begin()/chunk_end()</tt>), or by checking out
+        a rectangular subarray into an ordinary MultiArrayView. The latter is the
+        way to apply existing VIGRA algorithms to chunked data:
+
+        \code
+        ChunkedArrayLazy<3, float> array(Shape3(2000, 2000, 2000));
+        ...
+        Shape3 start(100, 100, 100), stop(300, 300, 300), margin(20);
+
+        // checkout the block plus a margin, smooth it, and write back the block's interior
+        MultiArray<3, float> block = array.subarray(start - margin, stop + margin);
+        gaussianSmoothMultiArray(srcMultiArrayRange(block), destMultiArray(block), 4.0);
+        array.commitSubarray(start, block.subarray(margin, margin + stop - start));
+        \endcode
+
+        Loading, caching and evicting chunks is protected by a mutex, so that
+        \ref checkoutSubarray(), \ref commitSubarray(), \ref getItem() and 
+        \ref setItem() can be called concurrently from several threads (e.g. by 
+        \ref blockwiseCaller()), provided that different threads don't write 
+        the same elements. Changing the array's shape or cache size is not thread-safe.
+
+        <b>\#include</b> \<vigra/multi_array_chunked.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T>
+class ChunkedArray
+{
+  public:
+    typedef ChunkBase<N, T>                                 Chunk;
+    typedef typename MultiArrayShape<N>::type               shape_type;
+    typedef T                                               value_type;
+    typedef T &                                             reference;
+    typedef T const &                                       const_reference;
+    typedef T *                                             pointer;
+    typedef T const *                                       const_pointer;
+    typedef ChunkedArrayIterator<N, T, T &, T *>             iterator;
+    typedef ChunkedArrayIterator<N, T, T const &, T const *> const_iterator;
+    typedef ChunkIterator<N, T>                             chunk_iterator;
+
+        /** Create a chunked array of the given shape. If \a chunk_shape is zero,
+            a default chunk shape with about 2^18 elements is chosen.
+        */
+    ChunkedArray(shape_type const & shape,
+                 shape_type const & chunk_shape = shape_type(),
+                 ChunkedArrayOptions const & options = ChunkedArrayOptions())
+    : shape_(shape),
+      chunk_shape_(prod(chunk_shape) > 0
+                       ? chunk_shape
+                       : detail::defaultChunkShape<N>()),
+      handle_array_(detail::chunkArrayShape(shape_, chunk_shape_), (Chunk *)0),
+      cache_max_size_(options.cache_max),
+      fill_value_(T(options.fill_value))
+    {
+        vigra_precondition(prod(shape) > 0 && min(shape) > 0,
+            "ChunkedArray(): array shape must be positive.");
+        if(cache_max_size_ < 0)
+            cache_max_size_ = detail::defaultCacheSize(handle_array_.shape());
+        fill_chunk_.pointer_ = &fill_value_;
+        fill_chunk_.shape_ = chunk_shape_;
+        fill_chunk_.strides_ = shape_type();
+    }
+
+    virtual ~ChunkedArray()
+    {
+        typename MultiArray<N, Chunk *>::iterator i   = handle_array_.begin(),
+                                                  end = handle_array_.end();
+        for(; i != end; ++i)
+            delete *i;
+    }
+
+        /** Name of the storage backend.
+        */
+    virtual std::string backend() const = 0;
+
+        /** The array's shape.
+        */
+    shape_type const & shape() const
+    {
+        return shape_;
+    }
+
+        /** The array's extent along dimension \a d.
+        */
+    MultiArrayIndex shape(int d) const
+    {
+        return shape_[d];
+    }
+
+        /** Total number of elements.
+        */
+    MultiArrayIndex size() const
+    {
+        return prod(shape_);
+    }
+
+        /** Nominal shape of the chunks (chunks at the upper array border may be smaller).
+        */
+    shape_type const & chunkShape() const
+    {
+        return chunk_shape_;
+    }
+
+        /** Number of chunks along each axis.
+        */
+    shape_type const & chunkArrayShape() const
+    {
+        return handle_array_.shape();
+    }
+
+        /** Index of the chunk containing the element at \a p.
+        */
+    shape_type chunkIndexOf(shape_type const & p) const
+    {
+        shape_type res;
+        for(unsigned int k=0; k<N; ++k)
+            res[k] = p[k] / chunk_shape_[k];
+        return res;
+    }
+
+        /** Global coordinate of the first element of the chunk at \a chunk_index.
+        */
+    shape_type chunkStart(shape_type const & chunk_index) const
+    {
+        return chunk_index * chunk_shape_;
+    }
+
+        /** Actual shape of the chunk at \a chunk_index.
+        */
+    shape_type chunkShape(shape_type const & chunk_index) const
+    {
+        return min(chunk_shape_, shape_ - chunkStart(chunk_index));
+    }
+
+        /** Check if the given coordinate is inside the array.
+        */
+    bool isInside(shape_type const & p) const
+    {
+        for(unsigned int k=0; k<N; ++k)
+            if(p[k] < 0 || p[k] >= shape_[k])
+                return false;
+        return true;
+    }
+
+        /** Number of chunks currently resident in memory.
+        */
+    std::size_t cacheSize() const
+    {
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        return cache_.size();
+    }
+
+        /** Maximum number of chunks resident in memory.
+        */
+    int cacheMaxSize() const
+    {
+        return cache_max_size_;
+    }
+
+        /** Change the maximum number of resident chunks. A negative value
+            restores the default. Excess chunks are evicted immediately.
+        */
+    void setCacheMaxSize(int c)
+    {
+        cache_max_size_ = c < 0
+                              ? detail::defaultCacheSize(handle_array_.shape())
+                              : c;
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        cleanCache();
+    }
+
+        /** Read the element at \a p.
+        */
+    value_type getItem(shape_type const & p) const
+    {
+        vigra_precondition(isInside(p),
+            "ChunkedArray::getItem(): index out of bounds.");
+        ChunkedArray * self = const_cast<ChunkedArray *>(this);
+        shape_type chunkIndex = chunkIndexOf(p);
+        Chunk * chunk = self->acquireChunk(chunkIndex, true);
+        value_type res = chunk->pointer_[dot(p - chunkStart(chunkIndex), chunk->strides_)];
+        self->releaseChunk(chunk);
+        return res;
+    }
+
+        /** Write \a v to the element at \a p.
+        */
+    void setItem(shape_type const & p, value_type const & v)
+    {
+        vigra_precondition(isInside(p),
+            "ChunkedArray::setItem(): index out of bounds.");
+        shape_type chunkIndex = chunkIndexOf(p);
+        Chunk * chunk = acquireChunk(chunkIndex, false);
+        chunk->pointer_[dot(p - chunkStart(chunkIndex), chunk->strides_)] = v;
+        releaseChunk(chunk);
+    }
+
+        /** Copy the block starting at \a start into \a subarray. The block's shape
+            is given by the shape of \a subarray.
+        */
+    template <class U, class Stride>
+    void checkoutSubarray(shape_type const & start, MultiArrayView<N, U, Stride> subarray) const
+    {
+        shape_type stop = start + subarray.shape();
+        vigra_precondition(isInside(start) && isInside(stop - shape_type(1)),
+            "ChunkedArray::checkoutSubarray(): subarray out of bounds.");
+        ChunkedArray * self = const_cast<ChunkedArray *>(this);
+        shape_type chunkBegin = chunkIndexOf(start),
+                   chunkEnd   = chunkIndexOf(stop - shape_type(1)) + shape_type(1),
+                   chunkIndex = chunkBegin;
+        do
+        {
+            Chunk * chunk = self->acquireChunk(chunkIndex, true);
+            shape_type chunkStart = this->chunkStart(chunkIndex),
+                       roiStart   = max(start, chunkStart),
+                       roiStop    = min(stop, chunkStart + chunkShape(chunkIndex));
+            if(chunk == &fill_chunk_)
+            {
+                // MultiArrayView's copy loops cannot handle the fill chunk's zero strides
+                subarray.subarray(roiStart - start, roiStop - start).init(fill_value_);
+            }
+            else
+            {
+                MultiArrayView<N, T, StridedArrayTag> data(chunkShape(chunkIndex), chunk->strides_, chunk->pointer_);
+                subarray.subarray(roiStart - start, roiStop - start)
+                        .copy(data.subarray(roiStart - chunkStart, roiStop - chunkStart));
+            }
+            self->releaseChunk(chunk);
+        }
+        while(detail::incrementCoordinate(chunkIndex, chunkBegin, chunkEnd));
+    }
+
+        /** Write the data of \a subarray into the block starting at \a start.
+        */
+    template <class U, class Stride>
+    void commitSubarray(shape_type const & start, MultiArrayView<N, U, Stride> const & subarray)
+    {
+        shape_type stop = start + subarray.shape();
+        vigra_precondition(isInside(start) && isInside(stop - shape_type(1)),
+            "ChunkedArray::commitSubarray(): subarray out of bounds.");
+        shape_type chunkBegin = chunkIndexOf(start),
+                   chunkEnd   = chunkIndexOf(stop - shape_type(1)) + shape_type(1),
+                   chunkIndex = chunkBegin;
+        do
+        {
+            Chunk * chunk = acquireChunk(chunkIndex, false);
+            shape_type chunkStart = this->chunkStart(chunkIndex),
+                       roiStart   = max(start, chunkStart),
+                       roiStop    = min(stop, chunkStart + chunk->shape_);
+            MultiArrayView<N, T, StridedArrayTag> data(chunk->shape_, chunk->strides_, chunk->pointer_);
+            data.subarray(roiStart - chunkStart, roiStop - chunkStart)
+                .copy(subarray.subarray(roiStart - start, roiStop - start));
+            releaseChunk(chunk);
+        }
+        while(detail::incrementCoordinate(chunkIndex, chunkBegin, chunkEnd));
+    }
+
+        /** Check out the block <tt>[start, stop)</tt> into a newly allocated MultiArray.
+
+            The result is a copy, use \ref commitSubarray() to write modifications back
+            into the chunked array.
+        */
+    MultiArray<N, T> subarray(shape_type const & start, shape_type const & stop) const
+    {
+        MultiArray<N, T> res(stop - start);
+        checkoutSubarray(start, res);
+        return res;
+    }
+
+        /** Remove the chunks completely inside the block <tt>[start, stop)</tt>
+            from memory. Chunks that are currently in use are skipped.
+
+            If \a destroy is <tt>false</tt>, modified data are first written to the
+            backing store (backends without a backing store keep their chunks in this case).
+            If \a destroy is <tt>true</tt>, the data are discarded, and subsequent reads
+            return the fill value (or the previously stored contents of the backing store).
+        */
+    void releaseChunks(shape_type const & start, shape_type const & stop, bool destroy = false)
+    {
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        shape_type chunkBegin = chunkIndexOf(start),
+                   chunkEnd   = chunkIndexOf(stop - shape_type(1)) + shape_type(1),
+                   chunkIndex = chunkBegin;
+        do
+        {
+            Chunk * chunk = handle_array_[chunkIndex];
+            shape_type chunkStart = this->chunkStart(chunkIndex),
+                       chunkStop  = chunkStart + chunkShape(chunkIndex);
+            if(chunk == 0 || chunk->refcount_ > 0 || chunk->pointer_ == 0 ||
+               !allLessEqual(start, chunkStart) || !allLessEqual(chunkStop, stop))
+                continue;
+            if(unloadChunk(chunk, destroy))
+                removeFromCache(chunk);
+        }
+        while(detail::incrementCoordinate(chunkIndex, chunkBegin, chunkEnd));
+    }
+
+        /** Write all modified chunks to the backing store (if any),
+            without removing them from memory.
+        */
+    void flush()
+    {
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        typename std::list<Chunk *>::iterator i = cache_.begin();
+        for(; i != cache_.end(); ++i)
+            if((*i)->dirty_)
+                flushChunk(*i);
+    }
+
+        /** Scan-order iterator to the first element.
+        */
+    iterator begin()
+    {
+        return iterator(this, shape_type());
+    }
+
+        /** Scan-order iterator past the last element.
+        */
+    iterator end()
+    {
+        return iterator(this, endPoint());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(const_cast<ChunkedArray *>(this), shape_type());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(const_cast<ChunkedArray *>(this), endPoint());
+    }
+
+        /** Iterator to the first chunk intersecting the block <tt>[start, stop)</tt>.
+        */
+    chunk_iterator chunk_begin(shape_type const & start, shape_type const & stop)
+    {
+        return chunk_iterator(this, start, stop);
+    }
+
+        /** Iterator past the last chunk intersecting the block <tt>[start, stop)</tt>.
+        */
+    chunk_iterator chunk_end(shape_type const & start, shape_type const & stop)
+    {
+        return chunk_iterator(this, start, stop, true);
+    }
+
+  protected:
+
+        /* Make sure that the chunk at \a chunk_index is resident and return it.
+           The chunk is locked until releaseChunk() is called.
+
+           If \a chunk_index has never been written and the backend has no backing store,
+           const access returns a dummy chunk that points to the fill value.
+        */
+    Chunk * acquireChunk(shape_type const & chunk_index, bool isConst)
+    {
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        Chunk *& chunk = handle_array_[chunk_index];
+        if(isConst && (chunk == 0 || chunk->pointer_ == 0) && !hasBackingStore())
+            return &fill_chunk_;
+        if(chunk == 0 || chunk->pointer_ == 0)
+        {
+            loadChunk(&chunk, chunk_index);
+            chunk->index_ = chunk_index;
+        }
+        ++chunk->refcount_;
+        if(!isConst)
+            chunk->dirty_ = true;
+        if(chunk->in_cache_)
+        {
+            cache_.splice(cache_.begin(), cache_, chunk->cache_position_);
+        }
+        else
+        {
+            cache_.push_front(chunk);
+            chunk->cache_position_ = cache_.begin();
+            chunk->in_cache_ = true;
+            cleanCache();
+        }
+        return chunk;
+    }
+
+    void releaseChunk(Chunk * chunk)
+    {
+        if(chunk == &fill_chunk_)
+            return;
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        --chunk->refcount_;
+    }
+
+        /* Add another lock to an already acquired chunk (used when copying iterators).
+        */
+    void retainChunk(Chunk * chunk)
+    {
+        if(chunk == &fill_chunk_)
+            return;
+        detail::ChunkedArrayLock lock(cache_mutex_);
+        ++chunk->refcount_;
+    }
+
+        /* Evict least recently used chunks until the cache size is below
+           its maximum or no more chunks can be evicted.
+        */
+    void cleanCache()
+    {
+        typename std::list<Chunk *>::iterator i = cache_.end();
+        while((int)cache_.size() > cache_max_size_ && i != cache_.begin())
+        {
+            --i;
+            Chunk * chunk = *i;
+            if(chunk->refcount_ == 0 && unloadChunk(chunk, false))
+            {
+                chunk->in_cache_ = false;
+                i = cache_.erase(i);
+            }
+        }
+    }
+
+    void removeFromCache(Chunk * chunk)
+    {
+        if(chunk->in_cache_)
+        {
+            cache_.erase(chunk->cache_position_);
+            chunk->in_cache_ = false;
+        }
+    }
+
+        /* Unload all chunks. Must be called in the destructors of subclasses,
+           because the virtual functions are no longer available in the base
+           class destructor.
+        */
+    void unloadAll(bool destroy)
+    {
+        typename std::list<Chunk *>::iterator i = cache_.begin();
+        for(; i != cache_.end(); ++i)
+        {
+            unloadChunk(*i, destroy);
+            (*i)->in_cache_ = false;
+        }
+        cache_.clear();
+    }
+
+    static bool allLessEqual(shape_type const & a, shape_type const & b)
+    {
+        for(unsigned int k=0; k<N; ++k)
+            if(a[k] > b[k])
+                return false;
+        return true;
+    }
+
+    shape_type endPoint() const
+    {
+        shape_type res;
+        res[N-1] = shape_[N-1];
+        return res;
+    }
+
+        /* Make the chunk at \a chunk_index resident. If <tt>*chunk</tt> is zero,
+           a new chunk object must be allocated. The function must set the chunk's
+           pointer_, shape_ and strides_ members and return the data pointer.
+        */
+    virtual pointer loadChunk(Chunk ** chunk, shape_type const & chunk_index) = 0;
+
+        /* Free the memory of a chunk. If \a destroy is false, the data must be preserved
+           (i.e. written to the backing store); backends that cannot do this return false
+           and keep the chunk. Returns true if the memory was freed.
+        */
+    virtual bool unloadChunk(Chunk * chunk, bool destroy) = 0;
+
+        /* Write a modified chunk to the backing store and reset its dirty flag.
+        */
+    virtual void flushChunk(Chunk * chunk)
+    {}
+
+        /* Return true if chunks that are not resident may contain data,
+           i.e. must be loaded before reading.
+        */
+    virtual bool hasBackingStore() const = 0;
+
+    template <unsigned int, class, class, class>
+    friend class ChunkedArrayIterator;
+
+    template <unsigned int, class>
+    friend class ChunkIterator;
+
+    shape_type shape_, chunk_shape_;
+    MultiArray<N, Chunk *> handle_array_;
+    std::list<Chunk *> cache_;
+    int cache_max_size_;
+    T fill_value_;
+    Chunk fill_chunk_;
+    mutable detail::ChunkedArrayMutex cache_mutex_;
+
+  private:
+    ChunkedArray(ChunkedArray const &);
+    ChunkedArray & operator=(ChunkedArray const &);
+};
+
+/********************************************************/
+/*                                                      */
+/*                   ChunkedArrayLazy                   */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Chunked array that allocates chunks in memory on first write access.
+
+        This is useful for huge, but sparsely populated arrays: untouched chunks
+        consume no memory and read as the fill value. Since there is no backing store,
+        chunks are never evicted from the cache. Use \ref releaseChunks() with
+        <tt>destroy = true</tt> to explicitly free chunks that are no longer needed.
+
+        <b>\#include</b> \<vigra/multi_array_chunked.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T, class Alloc = std::allocator<T> >
+class ChunkedArrayLazy
+: public ChunkedArray<N, T>
+{
+  public:
+    typedef ChunkedArray<N, T>                base_type;
+    typedef typename base_type::shape_type    shape_type;
+    typedef typename base_type::pointer       pointer;
+    typedef typename base_type::Chunk         Chunk;
+
+    ChunkedArrayLazy(shape_type const & shape,
+                     shape_type const & chunk_shape = shape_type(),
+                     ChunkedArrayOptions const & options = ChunkedArrayOptions(),
+                     Alloc const & alloc = Alloc())
+    : base_type(shape, chunk_shape, options),
+      alloc_(alloc)
+    {
+        // chunks cannot be evicted without a backing store
+        this->cache_max_size_ = NumericTraits<int>::max();
+    }
+
+    ~ChunkedArrayLazy()
+    {
+        this->unloadAll(true);
+    }
+
+    virtual std::string backend() const
+    {
+        return "ChunkedArrayLazy";
+    }
+
+  protected:
+    virtual pointer loadChunk(Chunk ** chunk, shape_type const & chunk_index)
+    {
+        if(*chunk == 0)
+        {
+            *chunk = new Chunk;
+            (*chunk)->shape_ = this->chunkShape(chunk_index);
+            (*chunk)->strides_ = detail::defaultStride<N>((*chunk)->shape_);
+        }
+        std::size_t size = prod((*chunk)->shape_);
+        pointer p = alloc_.allocate(size);
+        std::uninitialized_fill(p, p + size, this->fill_value_);
+        (*chunk)->pointer_ = p;
+        return p;
+    }
+
+    virtual bool unloadChunk(Chunk * chunk, bool destroy)
+    {
+        if(!destroy || chunk->pointer_ == 0)
+            return false;
+        std::size_t size = prod(chunk->shape_);
+        for(std::size_t k=0; k<size; ++k)
+            chunk->pointer_[k].~T();
+        alloc_.deallocate(chunk->pointer_, size);
+        chunk->pointer_ = 0;
+        chunk->dirty_ = false;
+        return true;
+    }
+
+    virtual bool hasBackingStore() const
+    {
+        return false;
+    }
+
+    Alloc alloc_;
+};
+
+/********************************************************/
+/*                                                      */
+/*                 ChunkedArrayDirectory                */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Chunked array that stores each chunk in a separate file of a directory.
+
+        Chunks are read from <tt>path/chunk_i_j_k.raw</tt> (with the chunk indices
+        <tt>i, j, k</tt> along each axis) when they are first accessed, and written back
+        when they are evicted from the cache, when \ref flush() is called, and upon
+        destruction. Chunks whose file does not exist yet are initialized with
+        the fill value. Thus, an array can be reopened later by creating a new
+        <tt>ChunkedArrayDirectory</tt> with the same path, shape, and chunk shape.
+        Since write errors cannot be reported from the destructor, call \ref flush()
+        explicitly before the array goes out of scope if you need to detect them.
+
+        The directory must exist. Data are stored in the raw binary format
+        of the machine, so <tt>T</tt> must be a plain data type (e.g. a scalar or
+        \ref vigra::TinyVector of scalars).
+
+        <b>\#include</b> \<vigra/multi_array_chunked.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T>
+class ChunkedArrayDirectory
+: public ChunkedArray<N, T>
+{
+  public:
+    typedef ChunkedArray<N, T>                base_type;
+    typedef typename base_type::shape_type    shape_type;
+    typedef typename base_type::pointer       pointer;
+    typedef typename base_type::Chunk         Chunk;
+
+    ChunkedArrayDirectory(std::string const & path,
+                          shape_type const & shape,
+                          shape_type const & chunk_shape = shape_type(),
+                          ChunkedArrayOptions const & options = ChunkedArrayOptions())
+    : base_type(shape, chunk_shape, options),
+      path_(path)
+    {}
+
+        /** Write back all dirty chunks and release the memory.
+
+            Write errors are silently ignored here because destructors must
+            not throw. Call \ref flush() explicitly before destruction in
+            order to detect them.
+        */
+    ~ChunkedArrayDirectory()
+    {
+        try
+        {
+            this->flush();
+        }
+        catch(...)
+        {
+            // cannot report errors from a destructor
+        }
+        this->unloadAll(true);
+    }
+
+    virtual std::string backend() const
+    {
+        return "ChunkedArrayDirectory";
+    }
+
+        /** Name of the file that stores the chunk at \a chunk_index.
+        */
+    std::string chunkFileName(shape_type const & chunk_index) const
+    {
+        std::ostringstream s;
+        s << path_ << "/chunk";
+        for(unsigned int k=0; k<N; ++k)
+            s << "_" << chunk_index[k];
+        s << ".raw";
+        return s.str();
+    }
+
+  protected:
+    virtual pointer loadChunk(Chunk ** chunk, shape_type const & chunk_index)
+    {
+        if(*chunk == 0)
+        {
+            *chunk = new Chunk;
+            (*chunk)->shape_ = this->chunkShape(chunk_index);
+            (*chunk)->strides_ = detail::defaultStride<N>((*chunk)->shape_);
+        }
+        std::size_t size = prod((*chunk)->shape_);
+        pointer p = new T[size];
+        std::ifstream f(chunkFileName(chunk_index).c_str(), std::ios::binary);
+        if(f)
+        {
+            f.read((char *)p, size*sizeof(T));
+            vigra_postcondition(!f.fail(),
+                "ChunkedArrayDirectory::loadChunk(): unable to read chunk file.");
+        }
+        else
+        {
+            std::fill(p, p + size, this->fill_value_);
+        }
+        (*chunk)->pointer_ = p;
+        (*chunk)->dirty_ = false;
+        return p;
+    }
+
+    virtual void flushChunk(Chunk * chunk)
+    {
+        if(chunk->pointer_ == 0 || !chunk->dirty_)
+            return;
+        std::ofstream f(chunkFileName(chunk->index_).c_str(), std::ios::binary);
+        f.write((char const *)chunk->pointer_, prod(chunk->shape_)*sizeof(T));
+        vigra_postcondition(!f.fail(),
+            "ChunkedArrayDirectory::flushChunk(): unable to write chunk file.");
+        chunk->dirty_ = false;
+    }
+
+    virtual bool unloadChunk(Chunk * chunk, bool destroy)
+    {
+        if(chunk->pointer_ == 0)
+            return false;
+        if(!destroy)
+            flushChunk(chunk);
+        delete [] chunk->pointer_;
+        chunk->pointer_ = 0;
+        chunk->dirty_ = false;
+        return true;
+    }
+
+    virtual bool hasBackingStore() const
+    {
+        return true;
+    }
+
+    std::string path_;
+};
+
+/********************************************************/
+/*                                                      */
+/*             point operators on chunked arrays        */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Apply a point functor to all elements of a chunked array.
+
+        This overload of \ref transformMultiArray() processes the arrays chunk by chunk,
+        so that memory consumption is bounded by the cache sizes of the arrays.
+        The chunk shapes of source and destination need not agree.
+
+        <b>\#include</b> \<vigra/multi_array_chunked.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T1, class T2, class Functor>
+void
+transformMultiArray(ChunkedArray<N, T1> const & source, ChunkedArray<N, T2> & dest, Functor const & f)
+{
+    vigra_precondition(source.shape() == dest.shape(),
+        "transformMultiArray(): shape mismatch between input and output.");
+    typedef typename MultiArrayShape<N>::type Shape;
+    typename ChunkedArray<N, T2>::chunk_iterator i   = dest.chunk_begin(Shape(), dest.shape()),
+                                                 end = dest.chunk_end(Shape(), dest.shape());
+    MultiArray<N, T1> buffer;
+    for(; i != end; ++i)
+    {
+        buffer.reshape(i->shape());
+        source.checkoutSubarray(i.chunkStart(), buffer);
+        transformMultiArray(srcMultiArrayRange(buffer), destMultiArray(*i), f);
+    }
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_ARRAY_CHUNKED_HXX
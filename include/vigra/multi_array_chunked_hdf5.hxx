@@ -0,0 +1,229 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2012-2014 by Ullrich Koethe                  */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_ARRAY_CHUNKED_HDF5_HXX
+#define VIGRA_MULTI_ARRAY_CHUNKED_HDF5_HXX
+
+#include "multi_array_chunked.hxx"
+#include "hdf5impex.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // The HDF5 library is usually not built thread-safe. Since several arrays
+    // may refer to the same file, all chunk I/O is serialized by a single lock.
+#ifdef VIGRA_HAS_STD_THREAD
+inline std::mutex & chunkedHDF5Mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+#endif
+
+class ChunkedHDF5Lock
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    std::lock_guard<std::mutex> lock_;
+
+  public:
+    ChunkedHDF5Lock()
+    : lock_(chunkedHDF5Mutex())
+    {}
+#endif
+};
+
+} // namespace detail
+
+/** \addtogroup ChunkedArrayClasses
+*/
+//@{
+
+    /** \brief Chunked array whose backing store is a chunked HDF5 dataset.
+
+        When the dataset already exists, the array's shape is taken from the file,
+        and chunks are read on demand. Otherwise, a new dataset with the given shape
+        is created whose HDF5 chunk shape equals the array's chunk shape, so that each
+        chunk of the array corresponds to exactly one HDF5 chunk. Compression
+        can be enabled by \ref ChunkedArrayOptions::compression(). Modified chunks
+        are written back when they are evicted from the cache, when \ref flush() is called,
+        and upon destruction. If the file was opened read-only, modifications are only
+        kept while the chunk is in memory.
+
+        The \ref vigra::HDF5File object must outlive the array.
+
+        \code
+        HDF5File file("volume.h5", HDF5File::Open);
+
+        // open an existing dataset and access it chunk by chunk
+        ChunkedArrayHDF5<3, float> data(file, "raw");
+
+        // create a new dataset of the same shape, keeping at most 100 chunks in RAM
+        ChunkedArrayHDF5<3, float> result(file, "result", data.shape(), Shape3(64),
+                                          ChunkedArrayOptions().cacheMax(100).compression(4));
+        transformMultiArray(data, result, sqrt(Arg1()));
+        \endcode
+
+        <b>\#include</b> \<vigra/multi_array_chunked_hdf5.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T>
+class ChunkedArrayHDF5
+: public ChunkedArray<N, T>
+{
+  public:
+    typedef ChunkedArray<N, T>                base_type;
+    typedef typename base_type::shape_type    shape_type;
+    typedef typename base_type::pointer       pointer;
+    typedef typename base_type::Chunk         Chunk;
+
+        /** Open the existing dataset \a dataset_name in \a file.
+        */
+    ChunkedArrayHDF5(HDF5File & file, std::string const & dataset_name,
+                     shape_type const & chunk_shape = shape_type(),
+                     ChunkedArrayOptions const & options = ChunkedArrayOptions())
+    : base_type(datasetShape(file, dataset_name), chunk_shape, options),
+      file_(file),
+      dataset_name_(dataset_name),
+      read_only_(file.isReadOnly())
+    {}
+
+        /** Create the dataset \a dataset_name in \a file with the given \a shape.
+            An existing dataset of the same name is overwritten.
+        */
+    ChunkedArrayHDF5(HDF5File & file, std::string const & dataset_name,
+                     shape_type const & shape,
+                     shape_type const & chunk_shape,
+                     ChunkedArrayOptions const & options = ChunkedArrayOptions())
+    : base_type(shape, chunk_shape, options),
+      file_(file),
+      dataset_name_(dataset_name),
+      read_only_(file.isReadOnly())
+    {
+        vigra_precondition(!read_only_,
+            "ChunkedArrayHDF5(): cannot create dataset in read-only file.");
+        file_.createDataset<N, T>(dataset_name_, this->shape(), this->fill_value_,
+                                  min(this->chunkShape(), this->shape()),
+                                  options.compression_level);
+    }
+
+    ~ChunkedArrayHDF5()
+    {
+        this->flush();
+        this->unloadAll(true);
+    }
+
+    virtual std::string backend() const
+    {
+        return "ChunkedArrayHDF5";
+    }
+
+        /** Name of the underlying dataset.
+        */
+    std::string const & datasetName() const
+    {
+        return dataset_name_;
+    }
+
+  protected:
+    static shape_type datasetShape(HDF5File & file, std::string const & dataset_name)
+    {
+        ArrayVector<hsize_t> fileShape = file.getDatasetShape(dataset_name);
+        vigra_precondition(fileShape.size() == N,
+            "ChunkedArrayHDF5(): dataset has wrong dimension.");
+        shape_type res;
+        for(unsigned int k=0; k<N; ++k)
+            res[k] = (MultiArrayIndex)fileShape[k];
+        return res;
+    }
+
+    virtual pointer loadChunk(Chunk ** chunk, shape_type const & chunk_index)
+    {
+        if(*chunk == 0)
+        {
+            *chunk = new Chunk;
+            (*chunk)->shape_ = this->chunkShape(chunk_index);
+            (*chunk)->strides_ = detail::defaultStride<N>((*chunk)->shape_);
+        }
+        pointer p = new T[prod((*chunk)->shape_)];
+        MultiArrayView<N, T> view((*chunk)->shape_, p);
+        detail::ChunkedHDF5Lock lock;
+        file_.readBlock(dataset_name_, this->chunkStart(chunk_index), (*chunk)->shape_, view);
+        (*chunk)->pointer_ = p;
+        (*chunk)->dirty_ = false;
+        return p;
+    }
+
+    virtual void flushChunk(Chunk * chunk)
+    {
+        if(chunk->pointer_ == 0 || !chunk->dirty_ || read_only_)
+            return;
+        MultiArrayView<N, T> view(chunk->shape_, chunk->pointer_);
+        detail::ChunkedHDF5Lock lock;
+        file_.writeBlock(dataset_name_, this->chunkStart(chunk->index_), view);
+        chunk->dirty_ = false;
+    }
+
+    virtual bool unloadChunk(Chunk * chunk, bool destroy)
+    {
+        if(chunk->pointer_ == 0)
+            return false;
+        if(!destroy)
+        {
+            if(read_only_ && chunk->dirty_)
+                return false;
+            flushChunk(chunk);
+        }
+        delete [] chunk->pointer_;
+        chunk->pointer_ = 0;
+        chunk->dirty_ = false;
+        return true;
+    }
+
+    virtual bool hasBackingStore() const
+    {
+        return true;
+    }
+
+    HDF5File & file_;
+    std::string dataset_name_;
+    bool read_only_;
+};
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_ARRAY_CHUNKED_HDF5_HXX
@@ -0,0 +1,690 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2012-2014 by Ullrich Koethe                  */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_ARRAY_MAPPED_HXX
+#define VIGRA_MULTI_ARRAY_MAPPED_HXX
+
+#include <string>
+#include <fstream>
+#include <cctype>
+#include "config.hxx"
+#include "error.hxx"
+#include "sized_int.hxx"
+#include "numerictraits.hxx"
+#include "multi_array.hxx"
+
+#ifdef _WIN32
+  #include "windows.h"
+#else
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace vigra {
+
+/** \addtogroup MappedArrayClasses Memory-Mapped Arrays
+
+    Zero-copy access to array data stored in files.
+
+    \ref vigra::MappedMultiArray maps a file region into the address space of the
+    process and exposes it as an ordinary \ref vigra::MultiArrayView. Pages are only
+    read from disk when they are first touched, and the operating system's page cache
+    is shared among all processes mapping the same file. The helper functions
+    \ref mapPNM(), \ref mapVIFF() and \ref mapHDF5Dataset() (in
+    <tt>\<vigra/multi_array_mapped_hdf5.hxx\></tt>) determine shape and data offset
+    from the respective file headers.
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                  MappedArrayOptions                  */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Options for \ref vigra::MappedMultiArray.
+
+        The access mode determines how the file is mapped:
+        <DL>
+        <DT><tt>ReadOnly</tt><DD> The default. Pages are shared with other processes.
+                    Writing to the array results in a segmentation fault (access violation).
+        <DT><tt>CopyOnWrite</tt><DD> The array can be modified, but modified pages are
+                    private copies and never written back to the file.
+        <DT><tt>ReadWrite</tt><DD> Modifications are written back to the file.
+        </DL>
+
+        The remaining options are hints to the virtual memory system. They are
+        silently ignored where the operating system doesn't support them.
+
+        <b>\#include</b> \<vigra/multi_array_mapped.hxx\><br>
+        Namespace: vigra
+    */
+class MappedArrayOptions
+{
+  public:
+    enum AccessMode { ReadOnly, CopyOnWrite, ReadWrite };
+    enum AccessPattern { NormalAccess, SequentialAccess, RandomAccess };
+
+        /** Initialize options with default values: read-only, no access
+            pattern hint, no read-ahead, no huge pages.
+        */
+    MappedArrayOptions()
+    : access_mode(ReadOnly),
+      access_pattern(NormalAccess),
+      will_need(false),
+      huge_pages(false)
+    {}
+
+        /** Map the file read-only (default).
+        */
+    MappedArrayOptions & readOnly()
+    {
+        access_mode = ReadOnly;
+        return *this;
+    }
+
+        /** Map the file copy-on-write: changes are private to this mapping.
+        */
+    MappedArrayOptions & copyOnWrite()
+    {
+        access_mode = CopyOnWrite;
+        return *this;
+    }
+
+        /** Map the file for reading and writing: changes are written back.
+        */
+    MappedArrayOptions & readWrite()
+    {
+        access_mode = ReadWrite;
+        return *this;
+    }
+
+        /** Hint that the data will be accessed in scan order
+            (enables aggressive read-ahead, <tt>MADV_SEQUENTIAL</tt>).
+        */
+    MappedArrayOptions & sequential()
+    {
+        access_pattern = SequentialAccess;
+        return *this;
+    }
+
+        /** Hint that the data will be accessed in random order
+            (disables read-ahead, <tt>MADV_RANDOM</tt>).
+        */
+    MappedArrayOptions & randomAccess()
+    {
+        access_pattern = RandomAccess;
+        return *this;
+    }
+
+        /** Start reading the entire region in the background
+            (<tt>MADV_WILLNEED</tt>).
+        */
+    MappedArrayOptions & willNeed(bool v = true)
+    {
+        will_need = v;
+        return *this;
+    }
+
+        /** Request transparent huge pages for the mapping (<tt>MADV_HUGEPAGE</tt>).
+            Depending on kernel configuration, this is only effective for
+            copy-on-write mappings or files on tmpfs.
+        */
+    MappedArrayOptions & hugePages(bool v = true)
+    {
+        huge_pages = v;
+        return *this;
+    }
+
+    AccessMode access_mode;
+    AccessPattern access_pattern;
+    bool will_need, huge_pages;
+};
+
+namespace detail {
+
+inline bool hostIsLittleEndian()
+{
+    UInt16 one = 1;
+    return *reinterpret_cast<UInt8 *>(&one) == 1;
+}
+
+    // Owns a mapped region of a file. The mapping starts at the page boundary
+    // preceding the requested offset, 'data()' points to the requested byte.
+class MemoryMappedFile
+{
+  public:
+    MemoryMappedFile()
+    : base_(0), length_(0), data_(0)
+    {}
+
+    ~MemoryMappedFile()
+    {
+        unmap();
+    }
+
+    static std::size_t pageSize()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (std::size_t)info.dwAllocationGranularity;
+#else
+        return (std::size_t)sysconf(_SC_PAGESIZE);
+#endif
+    }
+
+    static MultiArrayIndex fileSize(std::string const & filename)
+    {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA info;
+        if(!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &info))
+            return -1;
+        return (MultiArrayIndex)(((UInt64)info.nFileSizeHigh << 32) | info.nFileSizeLow);
+#else
+        struct stat info;
+        if(stat(filename.c_str(), &info) != 0)
+            return -1;
+        return (MultiArrayIndex)info.st_size;
+#endif
+    }
+
+    char * map(std::string const & filename, MultiArrayIndex offset, std::size_t size,
+               MappedArrayOptions const & options)
+    {
+        unmap();
+
+        MultiArrayIndex file_size = fileSize(filename);
+        vigra_precondition(file_size >= 0,
+            "MemoryMappedFile::map(): unable to open file '" + filename + "'.");
+        vigra_precondition(size > 0 && offset >= 0 && offset + (MultiArrayIndex)size <= file_size,
+            "MemoryMappedFile::map(): requested region exceeds the size of file '" + filename + "'.");
+
+        MultiArrayIndex page = (MultiArrayIndex)pageSize(),
+                        aligned_offset = (offset / page) * page;
+        std::size_t length = size + (std::size_t)(offset - aligned_offset);
+
+#ifdef _WIN32
+        DWORD file_access   = options.access_mode == MappedArrayOptions::ReadWrite
+                                 ? GENERIC_READ | GENERIC_WRITE
+                                 : GENERIC_READ,
+              page_access   = options.access_mode == MappedArrayOptions::ReadWrite
+                                 ? PAGE_READWRITE
+                                 : options.access_mode == MappedArrayOptions::CopyOnWrite
+                                     ? PAGE_WRITECOPY
+                                     : PAGE_READONLY,
+              mapping_access = options.access_mode == MappedArrayOptions::ReadWrite
+                                 ? FILE_MAP_WRITE
+                                 : options.access_mode == MappedArrayOptions::CopyOnWrite
+                                     ? FILE_MAP_COPY
+                                     : FILE_MAP_READ;
+        HANDLE file = CreateFileA(filename.c_str(), file_access, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                  0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        vigra_postcondition(file != INVALID_HANDLE_VALUE,
+            "MemoryMappedFile::map(): unable to open file '" + filename + "'.");
+        HANDLE mapping = CreateFileMappingA(file, 0, page_access, 0, 0, 0);
+        CloseHandle(file);
+        vigra_postcondition(mapping != 0,
+            "MemoryMappedFile::map(): unable to map file '" + filename + "'.");
+        void * base = MapViewOfFile(mapping, mapping_access,
+                                    (DWORD)((UInt64)aligned_offset >> 32),
+                                    (DWORD)((UInt64)aligned_offset & 0xFFFFFFFF),
+                                    length);
+        CloseHandle(mapping);
+        vigra_postcondition(base != 0,
+            "MemoryMappedFile::map(): unable to map file '" + filename + "'.");
+#else
+        int fd = open(filename.c_str(),
+                      options.access_mode == MappedArrayOptions::ReadWrite ? O_RDWR : O_RDONLY);
+        vigra_postcondition(fd >= 0,
+            "MemoryMappedFile::map(): unable to open file '" + filename + "'.");
+        int protection = options.access_mode == MappedArrayOptions::ReadOnly
+                            ? PROT_READ
+                            : PROT_READ | PROT_WRITE,
+            flags      = options.access_mode == MappedArrayOptions::CopyOnWrite
+                            ? MAP_PRIVATE
+                            : MAP_SHARED;
+        void * base = mmap(0, length, protection, flags, fd, (off_t)aligned_offset);
+        close(fd); // the mapping keeps its own reference to the file
+        vigra_postcondition(base != MAP_FAILED,
+            "MemoryMappedFile::map(): unable to map file '" + filename + "'.");
+#endif
+        base_ = base;
+        length_ = length;
+        data_ = static_cast<char *>(base) + (offset - aligned_offset);
+        advise(options);
+        return data_;
+    }
+
+    void unmap()
+    {
+        if(base_ == 0)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+#else
+        munmap(base_, length_);
+#endif
+        base_ = 0;
+        length_ = 0;
+        data_ = 0;
+    }
+
+    void flush()
+    {
+        if(base_ == 0)
+            return;
+#ifdef _WIN32
+        FlushViewOfFile(base_, length_);
+#else
+        msync(base_, length_, MS_SYNC);
+#endif
+    }
+
+        // Pass the hints in 'options' to the virtual memory system.
+        // Failures are ignored because hints never affect correctness.
+    void advise(MappedArrayOptions const & options)
+    {
+#ifndef _WIN32
+        if(base_ == 0)
+            return;
+        switch(options.access_pattern)
+        {
+          case MappedArrayOptions::SequentialAccess:
+            madvise(base_, length_, MADV_SEQUENTIAL);
+            break;
+          case MappedArrayOptions::RandomAccess:
+            madvise(base_, length_, MADV_RANDOM);
+            break;
+          default:
+            madvise(base_, length_, MADV_NORMAL);
+        }
+        if(options.will_need)
+            madvise(base_, length_, MADV_WILLNEED);
+  #ifdef MADV_HUGEPAGE
+        if(options.huge_pages)
+            madvise(base_, length_, MADV_HUGEPAGE);
+  #endif
+#endif
+    }
+
+    char * data() const
+    {
+        return data_;
+    }
+
+  private:
+    MemoryMappedFile(MemoryMappedFile const &);
+    MemoryMappedFile & operator=(MemoryMappedFile const &);
+
+    void * base_;
+    std::size_t length_;
+    char * data_;
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                   MappedMultiArray                   */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Array whose data are a memory-mapped region of a file.
+
+        The data must be stored contiguously in the file, in VIGRA's scan order (i.e. the
+        first axis changes fastest) and with the byte order of the host. No data are
+        copied: pages are loaded from the file on first access, and all processes mapping
+        the same file share the operating system's page cache. Since
+        <tt>MappedMultiArray</tt> is derived from \ref vigra::MultiArrayView, it can be
+        passed to all VIGRA algorithms accepting views.
+
+        Mapped arrays cannot be copied (use <tt>view()</tt> to obtain a view, or
+        construct a \ref vigra::MultiArray from the mapped array to get an in-memory copy).
+        The mapping is released in the destructor or by <tt>unmap()</tt>. All views to the
+        data become invalid at that point.
+
+        \code
+        // 20 GB volume stored as raw floats after a 512-byte header
+        MappedMultiArray<3, float> volume("volume.raw", Shape3(2048, 2048, 1200), 512,
+                                          MappedArrayOptions().sequential());
+        std::cout << "maximum: " << *argMax(volume.begin(), volume.end()) << "\n";
+
+        // modify a copy-on-write mapping without touching the file
+        MappedMultiArray<3, float> scratch("volume.raw", Shape3(2048, 2048, 1200), 512,
+                                           MappedArrayOptions().copyOnWrite());
+        scratch.bindOuter(0) = 0.0f;
+        \endcode
+
+        <b>\#include</b> \<vigra/multi_array_mapped.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class T>
+class MappedMultiArray
+: public MultiArrayView<N, T>
+{
+  public:
+    typedef MultiArrayView<N, T>                   view_type;
+    typedef typename view_type::difference_type    difference_type;
+    typedef typename view_type::pointer            pointer;
+
+        /** Create an empty array. Use <tt>map()</tt> to attach it to a file.
+        */
+    MappedMultiArray()
+    : access_mode_(MappedArrayOptions::ReadOnly)
+    {}
+
+        /** Map the array with the given \a shape, starting at byte \a offset of
+            file \a filename.
+        */
+    MappedMultiArray(std::string const & filename, difference_type const & shape,
+                     MultiArrayIndex offset = 0,
+                     MappedArrayOptions const & options = MappedArrayOptions())
+    : access_mode_(options.access_mode)
+    {
+        map(filename, shape, offset, options);
+    }
+
+        /** Map the array with the given \a shape, starting at byte \a offset of
+            file \a filename. An existing mapping is released first.
+        */
+    void map(std::string const & filename, difference_type const & shape,
+             MultiArrayIndex offset = 0,
+             MappedArrayOptions const & options = MappedArrayOptions())
+    {
+        unmap();
+        vigra_precondition(prod(shape) > 0 && min(shape) > 0,
+            "MappedMultiArray::map(): array shape must be positive.");
+        pointer p = reinterpret_cast<pointer>(
+                        file_.map(filename, offset, prod(shape)*sizeof(T), options));
+        this->m_shape = shape;
+        this->m_stride = detail::defaultStride<view_type::actual_dimension>(shape);
+        this->m_ptr = p;
+        access_mode_ = options.access_mode;
+    }
+
+        /** Release the mapping. Modifications in <tt>ReadWrite</tt> mode are
+            written back by the operating system.
+        */
+    void unmap()
+    {
+        file_.unmap();
+        this->m_shape = difference_type();
+        this->m_stride = difference_type();
+        this->m_ptr = 0;
+    }
+
+        /** True when the array is attached to a file.
+        */
+    bool isMapped() const
+    {
+        return this->m_ptr != 0;
+    }
+
+        /** Access mode of the current mapping.
+        */
+    MappedArrayOptions::AccessMode accessMode() const
+    {
+        return access_mode_;
+    }
+
+        /** In <tt>ReadWrite</tt> mode, synchronously write modified pages
+            to the file. Otherwise, this function has no effect.
+        */
+    void flush()
+    {
+        if(isMapped() && access_mode_ == MappedArrayOptions::ReadWrite)
+            file_.flush();
+    }
+
+        /** Change the access pattern, read-ahead, and huge page hints
+            of the current mapping. The access mode is not affected.
+        */
+    void advise(MappedArrayOptions const & options)
+    {
+        file_.advise(options);
+    }
+
+  private:
+    MappedMultiArray(MappedMultiArray const &);
+    MappedMultiArray & operator=(MappedMultiArray const &);
+
+    detail::MemoryMappedFile file_;
+    MappedArrayOptions::AccessMode access_mode_;
+};
+
+/********************************************************/
+/*                                                      */
+/*                        mapPNM                        */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Read a decimal number from a PNM header, skipping whitespace and comments.
+inline MultiArrayIndex readPNMHeaderField(std::istream & s)
+{
+    int c = s.get();
+    while(s.good() && (std::isspace(c) || c == '#'))
+    {
+        if(c == '#')
+            while(s.good() && c != '\n' && c != '\r')
+                c = s.get();
+        c = s.get();
+    }
+    MultiArrayIndex res = 0;
+    vigra_precondition(s.good() && std::isdigit(c),
+        "mapPNM(): invalid PNM header.");
+    while(s.good() && std::isdigit(c))
+    {
+        res = 10*res + (c - '0');
+        c = s.get();
+    }
+    // exactly one whitespace character separates the header from the data
+    vigra_precondition(std::isspace(c),
+        "mapPNM(): invalid PNM header.");
+    return res;
+}
+
+} // namespace detail
+
+    /** \brief Map the pixel data of a binary PGM or PPM file.
+
+        The file must be of type P5 (binary grayscale) or P6 (binary RGB). The size of
+        \a T must match the pixel size stored in the file, e.g. <tt>UInt8</tt> for
+        8-bit grayscale and <tt>RGBValue<UInt8></tt> for 8-bit color images. Since PNM
+        stores 16-bit values in big-endian byte order, such files can only be mapped
+        on big-endian machines.
+
+        <b> Declaration:</b>
+
+        \code
+        namespace vigra {
+            template <class T>
+            void
+            mapPNM(std::string const & filename, MappedMultiArray<2, T> & array,
+                   MappedArrayOptions const & options = MappedArrayOptions());
+        }
+        \endcode
+
+        <b> Usage:</b>
+
+        <b>\#include</b> \<vigra/multi_array_mapped.hxx\><br>
+        Namespace: vigra
+
+        \code
+        MappedMultiArray<2, RGBValue<UInt8> > image;
+        mapPNM("image.ppm", image);
+        std::cout << "image size: " << image.shape() << "\n";
+        \endcode
+    */
+template <class T>
+void
+mapPNM(std::string const & filename, MappedMultiArray<2, T> & array,
+       MappedArrayOptions const & options = MappedArrayOptions())
+{
+    std::ifstream s(filename.c_str(), std::ios::binary);
+    vigra_precondition(s.good(),
+        "mapPNM(): unable to open file '" + filename + "'.");
+    char magic[2];
+    s.read(magic, 2);
+    vigra_precondition(s.good() && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6'),
+        "mapPNM(): only binary PGM (P5) and PPM (P6) files can be mapped.");
+    MultiArrayIndex width    = detail::readPNMHeaderField(s),
+                    height   = detail::readPNMHeaderField(s),
+                    maxval   = detail::readPNMHeaderField(s),
+                    channels = magic[1] == '5' ? 1 : 3,
+                    bytes    = maxval < 256 ? 1 : 2;
+    vigra_precondition(bytes == 1 || !detail::hostIsLittleEndian(),
+        "mapPNM(): 16-bit PNM files cannot be mapped on little-endian machines.");
+    vigra_precondition(sizeof(T) == (std::size_t)(channels*bytes),
+        "mapPNM(): pixel type does not match the file's pixel size.");
+    MultiArrayIndex offset = (MultiArrayIndex)s.tellg();
+    s.close();
+    array.map(filename, Shape2(width, height), offset, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*                        mapVIFF                       */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Map the pixel data of a VIFF file.
+
+        VIFF stores multi-band images band by band. Therefore, a single-band image
+        can be mapped into a 2D array, whereas the bands of a multi-band image become
+        the third axis of a 3D array with shape <tt>(width, height, bands)</tt>.
+        The file must be uncompressed, must not use a color map, and must be stored
+        in the byte order of the host. The size and kind (integral or floating point)
+        of \a T must match the file's storage type.
+
+        <b> Declaration:</b>
+
+        \code
+        namespace vigra {
+            template <unsigned int N, class T>
+            void
+            mapVIFF(std::string const & filename, MappedMultiArray<N, T> & array,
+                    MappedArrayOptions const & options = MappedArrayOptions());
+        }
+        \endcode
+
+        <b> Usage:</b>
+
+        <b>\#include</b> \<vigra/multi_array_mapped.hxx\><br>
+        Namespace: vigra
+
+        \code
+        MappedMultiArray<3, float> bands;
+        mapVIFF("multiband.xv", bands);
+        MultiArrayView<2, float> first_band = bands.bindOuter(0);
+        \endcode
+    */
+template <unsigned int N, class T>
+void
+mapVIFF(std::string const & filename, MappedMultiArray<N, T> & array,
+        MappedArrayOptions const & options = MappedArrayOptions())
+{
+    vigra_precondition(N == 2 || N == 3,
+        "mapVIFF(): array must be 2- or 3-dimensional.");
+
+    std::ifstream s(filename.c_str(), std::ios::binary);
+    vigra_precondition(s.good(),
+        "mapVIFF(): unable to open file '" + filename + "'.");
+    UInt8 id[5];
+    s.read(reinterpret_cast<char *>(id), 5);
+    vigra_precondition(s.good() && id[0] == 0xab && id[1] == 1 && id[2] == 1 && id[3] == 3,
+        "mapVIFF(): invalid or unsupported VIFF header.");
+    // byte order: 0x2 is big-endian, 0x8 is little-endian
+    vigra_precondition(id[4] == (detail::hostIsLittleEndian() ? 0x8 : 0x2),
+        "mapVIFF(): file byte order differs from host byte order.");
+
+    // the header fields are stored in the file's (i.e. the host's) byte order
+    UInt32 row_size, col_size, location_type, num_images, num_bands,
+           storage_type, encode_scheme, map_scheme;
+    s.seekg(0x208, std::ios::beg);
+    s.read(reinterpret_cast<char *>(&row_size), 4);
+    s.read(reinterpret_cast<char *>(&col_size), 4);
+    s.seekg(0x224, std::ios::beg);
+    s.read(reinterpret_cast<char *>(&location_type), 4);
+    s.seekg(0x22c, std::ios::beg);
+    s.read(reinterpret_cast<char *>(&num_images), 4);
+    s.read(reinterpret_cast<char *>(&num_bands), 4);
+    s.read(reinterpret_cast<char *>(&storage_type), 4);
+    s.read(reinterpret_cast<char *>(&encode_scheme), 4);
+    s.read(reinterpret_cast<char *>(&map_scheme), 4);
+    vigra_precondition(s.good(),
+        "mapVIFF(): invalid VIFF header.");
+    s.close();
+
+    vigra_precondition(location_type != 2 && num_images < 2 && encode_scheme == 0 && map_scheme == 0,
+        "mapVIFF(): only uncompressed single images with implicit locations and without color map can be mapped.");
+
+    std::size_t storage_size = 0;
+    bool is_float = false;
+    switch(storage_type)
+    {
+      case 1: storage_size = 1; break;
+      case 2: storage_size = 2; break;
+      case 4: storage_size = 4; break;
+      case 5: storage_size = 4; is_float = true; break;
+      case 9: storage_size = 8; is_float = true; break;
+      default:
+        vigra_precondition(false, "mapVIFF(): unsupported storage type.");
+    }
+    vigra_precondition(sizeof(T) == storage_size &&
+                       is_float == !NumericTraits<T>::isIntegral::value,
+        "mapVIFF(): pixel type does not match the file's storage type.");
+
+    typename MultiArrayShape<N>::type shape;
+    shape[0] = row_size;
+    shape[1] = col_size;
+    if(N == 3)
+        shape[N-1] = num_bands;
+    else
+        vigra_precondition(num_bands == 1,
+            "mapVIFF(): multi-band images must be mapped into a 3D array.");
+    array.map(filename, shape, 1024, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_ARRAY_MAPPED_HXX
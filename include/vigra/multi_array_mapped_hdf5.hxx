@@ -0,0 +1,177 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2012-2014 by Ullrich Koethe                  */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_MULTI_ARRAY_MAPPED_HDF5_HXX
+#define VIGRA_MULTI_ARRAY_MAPPED_HDF5_HXX
+
+#include "multi_array_mapped.hxx"
+#include "hdf5impex.hxx"
+
+namespace vigra {
+
+/** \addtogroup MappedArrayClasses
+*/
+//@{
+
+namespace detail {
+
+template <unsigned int N, class T>
+void
+mapHDF5DatasetImpl(HDF5File & file, std::string const & dataset_name,
+                   MappedMultiArray<N, T> & array, hid_t datatype, int numBandsOfType,
+                   MappedArrayOptions const & options)
+{
+    HDF5Handle dataset = file.getDatasetHandle(dataset_name);
+
+    HDF5Handle plist(H5Dget_create_plist(dataset), &H5Pclose,
+                     "mapHDF5Dataset(): unable to access dataset properties.");
+    vigra_precondition(H5Pget_layout(plist) == H5D_CONTIGUOUS,
+        "mapHDF5Dataset(): dataset must be stored contiguously (without chunking or compression).");
+
+    HDF5Handle filetype(H5Dget_type(dataset), &H5Tclose,
+                        "mapHDF5Dataset(): unable to access dataset type.");
+    vigra_precondition(H5Tequal(filetype, datatype) > 0,
+        "mapHDF5Dataset(): dataset type differs from the array's value type or the host byte order.");
+
+    // the file may contain an additional dimension for the pixel type bands
+    // which comes first after conversion to VIGRA's axis order
+    ArrayVector<hsize_t> fileShape = file.getDatasetShape(dataset_name);
+    int offset = (numBandsOfType > 1)
+                    ? 1
+                    : 0;
+    vigra_precondition(fileShape.size() == N + offset,
+        "mapHDF5Dataset(): Array dimension disagrees with dataset dimension.");
+    vigra_precondition(offset == 0 || fileShape[0] == (hsize_t)numBandsOfType,
+        "mapHDF5Dataset(): Number of bands disagrees with dataset shape.");
+    typename MultiArrayShape<N>::type shape;
+    for(unsigned int k=0; k<N; ++k)
+        shape[k] = (MultiArrayIndex)fileShape[k+offset];
+
+    haddr_t address = H5Dget_offset(dataset);
+    vigra_precondition(address != HADDR_UNDEF,
+        "mapHDF5Dataset(): no storage has been allocated for the dataset yet.");
+
+    // make sure that data written via the HDF5 library are visible in the mapping
+    file.flushToDisk();
+    array.map(file.filename(), shape, (MultiArrayIndex)address, options);
+}
+
+} // namespace detail
+
+    /** \brief Map the data of an HDF5 dataset.
+
+        The dataset must be stored contiguously, i.e. without chunking and compression,
+        which is the default when \ref HDF5File::write() is called without chunk size,
+        and its element type must equal \a T including byte order. Arrays of
+        <tt>TinyVector</tt> and <tt>RGBValue</tt> are mapped to datasets with an
+        additional (in HDF5's axis order: last) dimension holding the bands, as written by
+        \ref HDF5File::write(). The axis order is reversed as in \ref HDF5File::read().
+
+        The file is flushed before mapping, but subsequent writes via the HDF5 library
+        may or may not become visible through the mapping. Use
+        <tt>MappedArrayOptions().copyOnWrite()</tt> or <tt>readWrite()</tt>
+        when the array shall be modifiable (the latter requires that the file is
+        not opened read-only elsewhere).
+
+        <b> Declarations:</b>
+
+        \code
+        namespace vigra {
+            template <unsigned int N, class T>
+            void
+            mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+                           MappedMultiArray<N, T> & array,
+                           MappedArrayOptions const & options = MappedArrayOptions());
+
+            template <unsigned int N, class T, int SIZE>
+            void
+            mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+                           MappedMultiArray<N, TinyVector<T, SIZE> > & array,
+                           MappedArrayOptions const & options = MappedArrayOptions());
+
+            template <unsigned int N, class T>
+            void
+            mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+                           MappedMultiArray<N, RGBValue<T> > & array,
+                           MappedArrayOptions const & options = MappedArrayOptions());
+        }
+        \endcode
+
+        <b> Usage:</b>
+
+        <b>\#include</b> \<vigra/multi_array_mapped_hdf5.hxx\><br>
+        Namespace: vigra
+
+        \code
+        HDF5File file("volume.h5", HDF5File::OpenReadOnly);
+        MappedMultiArray<3, float> volume;
+        mapHDF5Dataset(file, "raw", volume, MappedArrayOptions().sequential());
+        \endcode
+    */
+doxygen_overloaded_function(template <...> void mapHDF5Dataset)
+
+template <unsigned int N, class T>
+inline void
+mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+               MappedMultiArray<N, T> & array,
+               MappedArrayOptions const & options = MappedArrayOptions())
+{
+    detail::mapHDF5DatasetImpl(file, dataset_name, array, detail::getH5DataType<T>(), 1, options);
+}
+
+template <unsigned int N, class T, int SIZE>
+inline void
+mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+               MappedMultiArray<N, TinyVector<T, SIZE> > & array,
+               MappedArrayOptions const & options = MappedArrayOptions())
+{
+    detail::mapHDF5DatasetImpl(file, dataset_name, array, detail::getH5DataType<T>(), SIZE, options);
+}
+
+template <unsigned int N, class T>
+inline void
+mapHDF5Dataset(HDF5File & file, std::string const & dataset_name,
+               MappedMultiArray<N, RGBValue<T> > & array,
+               MappedArrayOptions const & options = MappedArrayOptions())
+{
+    detail::mapHDF5DatasetImpl(file, dataset_name, array, detail::getH5DataType<T>(), 3, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_ARRAY_MAPPED_HDF5_HXX
@@ -0,0 +1,754 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_MULTI_BLOCKWISE_HXX
+#define VIGRA_MULTI_BLOCKWISE_HXX
+
+#include <cstddef>
+#include <algorithm>
+#include "config.hxx"
+#include "error.hxx"
+#include "multi_array.hxx"
+#include "multi_array_chunked.hxx"
+#include "multi_convolution.hxx"
+#include "multi_tensorutilities.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+/** \addtogroup BlockwiseProcessing Blockwise processing of big arrays
+
+    Local filters can be applied to big arrays block by block: each block
+    is read together with a margin (the halo) that covers the filter's support,
+    the filter is applied to the enlarged block, and only the block's core
+    is written to the result. Since the halo is clipped at the array border,
+    the filters' own border treatment applies there exactly as if the whole
+    array had been processed at once. Blocks are processed in parallel,
+    and memory consumption is bounded by the block size, so that the
+    same code works for in-memory arrays (\ref vigra::MultiArrayView) and for
+    chunked, possibly file-backed arrays (\ref vigra::ChunkedArray, including
+    \ref vigra::ChunkedArrayHDF5).
+
+    \ref blockwiseCaller() implements the general scheme for arbitrary functors.
+    Blockwise versions of the Gaussian filters from \ref MultiArrayConvolutionFilters
+    and of the tensor functions from \ref MultiPointoperators are provided as
+    overloads taking a \ref vigra::BlockwiseOptions object. Their halo is derived
+    from the scales, step sizes, and window ratio given in the \ref vigra::ConvolutionOptions,
+    such that the results are the same as for the whole array (up to rounding).
+    When Deriche's recursive filters are used (see
+    \ref ConvolutionOptions::recursiveFilterThreshold()), a margin of
+    <tt>4*sigma</tt> is used, so that the results agree up to the filters'
+    approximation error. The number of threads is taken from the BlockwiseOptions,
+    the subarray option of the ConvolutionOptions is ignored. Since blocks are 
+    processed concurrently, a \ref ConvolutionOptions::scratchArena() is not used 
+    directly: each thread takes its temporary arrays from its 
+    \ref threadLocalScratchArena() instead (or from the system allocator if 
+    <tt>thread_local</tt> is not supported).
+
+    \code
+    HDF5File file("volume.h5", HDF5File::Open);
+    ChunkedArrayHDF5<3, float> data(file, "raw");
+    ChunkedArrayHDF5<3, TinyVector<float, 6> > hessian(file, "hessian", data.shape());
+    MultiArray<3, TinyVector<float, 3> > eigenvalues(data.shape());
+
+    BlockwiseOptions<3> bopt;
+    bopt.numThreads(8);
+    hessianOfGaussianMultiArray(data, hessian, 2.0, bopt);
+    tensorEigenvaluesMultiArray(hessian, eigenvalues, bopt);
+    \endcode
+
+    Source and destination must have the same shape and may be in-memory arrays
+    or chunked arrays in any combination. Since the destination is passed by
+    non-const reference, temporary views must be assigned to a variable first.
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                   BlockwiseOptions                   */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Options for blockwise processing.
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N>
+class BlockwiseOptions
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    Shape block_shape;
+    int n_threads;
+
+    BlockwiseOptions()
+    : block_shape(),
+      n_threads(0)
+    {}
+
+        /** Shape of the blocks (without halo).
+
+            Default: the chunk shape if the destination is a \ref vigra::ChunkedArray,
+            otherwise about 2^18 elements (64x64x64 in 3D).
+        */
+    BlockwiseOptions & blockShape(Shape const & s)
+    {
+        vigra_precondition(min(s) > 0,
+            "BlockwiseOptions::blockShape(): shape must be positive.");
+        block_shape = s;
+        return *this;
+    }
+
+        /** Use blocks of shape <tt>(s, s, ...)</tt>.
+        */
+    BlockwiseOptions & blockShape(MultiArrayIndex s)
+    {
+        return blockShape(Shape(s));
+    }
+
+        /** Number of threads processing blocks in parallel.
+
+            Default: 0 (use \ref defaultConcurrency() threads)
+        */
+    BlockwiseOptions & numThreads(int n)
+    {
+        n_threads = n;
+        return *this;
+    }
+};
+
+namespace detail {
+
+    // Access to the blocks of in-memory and chunked arrays: views of
+    // in-memory arrays refer to the original data, whereas blocks of
+    // chunked arrays are copied into a buffer.
+template <unsigned int N, class T, class S>
+inline MultiArrayView<N, T, StridedArrayTag>
+blockwiseCheckout(MultiArrayView<N, T, S> const & a,
+                  typename MultiArrayShape<N>::type const & start,
+                  typename MultiArrayShape<N>::type const & stop,
+                  MultiArray<N, T> &)
+{
+    MultiArrayView<N, T, S> v = a.subarray(start, stop);
+    return MultiArrayView<N, T, StridedArrayTag>(v.shape(), v.stride(), v.data());
+}
+
+template <unsigned int N, class T>
+inline MultiArrayView<N, T, StridedArrayTag>
+blockwiseCheckout(ChunkedArray<N, T> const & a,
+                  typename MultiArrayShape<N>::type const & start,
+                  typename MultiArrayShape<N>::type const & stop,
+                  MultiArray<N, T> & buffer)
+{
+    buffer.reshape(stop - start);
+    a.checkoutSubarray(start, buffer);
+    return MultiArrayView<N, T, StridedArrayTag>(buffer.shape(), buffer.stride(), buffer.data());
+}
+
+template <unsigned int N, class T, class S>
+inline MultiArrayView<N, T, StridedArrayTag>
+blockwiseDestination(MultiArrayView<N, T, S> const & a,
+                     typename MultiArrayShape<N>::type const & start,
+                     typename MultiArrayShape<N>::type const & stop,
+                     MultiArray<N, T> & buffer)
+{
+    return blockwiseCheckout(a, start, stop, buffer);
+}
+
+template <unsigned int N, class T>
+inline MultiArrayView<N, T, StridedArrayTag>
+blockwiseDestination(ChunkedArray<N, T> const &,
+                     typename MultiArrayShape<N>::type const & start,
+                     typename MultiArrayShape<N>::type const & stop,
+                     MultiArray<N, T> & buffer)
+{
+    buffer.reshape(stop - start);
+    return MultiArrayView<N, T, StridedArrayTag>(buffer.shape(), buffer.stride(), buffer.data());
+}
+
+template <unsigned int N, class T, class S>
+inline void
+blockwiseCommit(MultiArrayView<N, T, S> &,
+                typename MultiArrayShape<N>::type const &,
+                MultiArrayView<N, T, StridedArrayTag> const &)
+{}
+
+template <unsigned int N, class T>
+inline void
+blockwiseCommit(ChunkedArray<N, T> & a,
+                typename MultiArrayShape<N>::type const & start,
+                MultiArrayView<N, T, StridedArrayTag> const & block)
+{
+    a.commitSubarray(start, block);
+}
+
+template <unsigned int N, class T, class S>
+inline typename MultiArrayShape<N>::type
+blockwiseDefaultBlockShape(MultiArrayView<N, T, S> const &)
+{
+    return defaultChunkShape<N>();
+}
+
+template <unsigned int N, class T>
+inline typename MultiArrayShape<N>::type
+blockwiseDefaultBlockShape(ChunkedArray<N, T> const & a)
+{
+    return a.chunkShape();
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline bool
+blockwiseArraysOverlap(MultiArrayView<N, T1, S1> const & a, MultiArrayView<N, T2, S2> const & b)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    if(a.size() == 0 || b.size() == 0)
+        return false;
+    // compare address ranges in bytes, since the element types may differ
+    char const * a_first = (char const *)a.data(),
+               * a_last  = (char const *)(a.data() + dot(a.shape() - Shape(1), a.stride()) + 1),
+               * b_first = (char const *)b.data(),
+               * b_last  = (char const *)(b.data() + dot(b.shape() - Shape(1), b.stride()) + 1);
+    return a_first < b_last && b_first < a_last;
+}
+
+template <unsigned int N, class T1, class S1, class T2>
+inline bool
+blockwiseArraysOverlap(MultiArrayView<N, T1, S1> const &, ChunkedArray<N, T2> const &)
+{
+    return false;
+}
+
+template <unsigned int N, class T1, class T2, class S2>
+inline bool
+blockwiseArraysOverlap(ChunkedArray<N, T1> const &, MultiArrayView<N, T2, S2> const &)
+{
+    return false;
+}
+
+template <unsigned int N, class T1, class T2>
+inline bool
+blockwiseArraysOverlap(ChunkedArray<N, T1> const & a, ChunkedArray<N, T2> const & b)
+{
+    return (void const *)&a == (void const *)&b;
+}
+
+template <unsigned int N, class SrcArray, class DestArray, class Functor>
+class BlockwiseCallerTask
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename SrcArray::value_type     SrcType;
+    typedef typename DestArray::value_type    DestType;
+
+    BlockwiseCallerTask(SrcArray const & src, DestArray & dest, Functor const & f,
+                        Shape const & block_shape, Shape const & halo)
+    : src_(src), dest_(dest), f_(f),
+      shape_(src.shape()), block_shape_(block_shape), halo_(halo)
+    {
+        for(unsigned int k=0; k<N; ++k)
+            blocks_[k] = (shape_[k] + block_shape_[k] - 1) / block_shape_[k];
+    }
+
+    std::ptrdiff_t numberOfBlocks() const
+    {
+        return prod(blocks_);
+    }
+
+    void operator()(int, std::ptrdiff_t i) const
+    {
+        Shape block;
+        for(unsigned int k=0; k<N; ++k)
+        {
+            block[k] = i % blocks_[k];
+            i /= blocks_[k];
+        }
+        Shape start = block*block_shape_,
+              stop  = min(start + block_shape_, shape_),
+              outerStart = max(start - halo_, Shape()),
+              outerStop  = min(stop + halo_, shape_);
+
+        MultiArray<N, SrcType> src_buffer;
+        MultiArray<N, DestType> dest_buffer;
+        MultiArrayView<N, SrcType, StridedArrayTag> src =
+            blockwiseCheckout(src_, outerStart, outerStop, src_buffer);
+        MultiArrayView<N, DestType, StridedArrayTag> dest =
+            blockwiseDestination(dest_, start, stop, dest_buffer);
+        f_(src, dest, start - outerStart, stop - outerStart);
+        blockwiseCommit(dest_, start, dest);
+    }
+
+  private:
+    SrcArray const & src_;
+    DestArray & dest_;
+    Functor const & f_;
+    Shape shape_, block_shape_, halo_, blocks_;
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                   blockwiseCaller                    */
+/*                                                      */
+/********************************************************/
+
+/** \brief Apply a local operator to an array block by block.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class SrcArray, class DestArray, class Functor>
+        void
+        blockwiseCaller(SrcArray const & src, DestArray & dest, Functor const & f,
+                        typename MultiArrayShape<N>::type const & halo,
+                        BlockwiseOptions<N> const & opt = BlockwiseOptions<N>());
+    }
+    \endcode
+
+    \a src and \a dest must have the same shape and can be \ref vigra::MultiArrayView
+    (or \ref vigra::MultiArray) or \ref vigra::ChunkedArray objects in any combination.
+    The array is divided into blocks of shape <tt>opt.block_shape</tt>. For each block
+    <tt>[start, stop)</tt>, the enlarged block <tt>[start - halo, stop + halo)</tt>
+    (clipped at the array border) of \a src and the block itself in \a dest are
+    passed to the functor:
+
+    \code
+    f(MultiArrayView<N, SrcType, StridedArrayTag> const & srcBlock,
+      MultiArrayView<N, DestType, StridedArrayTag> destBlock,
+      Shape const & roiStart, Shape const & roiStop);
+    \endcode
+
+    where <tt>destBlock</tt> corresponds to <tt>srcBlock.subarray(roiStart, roiStop)</tt>.
+    This is exactly the convention of the subarray option of \ref ConvolutionOptions,
+    so that most filters can simply be called with <tt>ConvolutionOptions().subarray(roiStart, roiStop)</tt>.
+    The result is identical to processing the whole array at once if the halo covers
+    the operator's support (i.e. the maximal distance of pixels that influence the result).
+    In-memory blocks are accessed directly, whereas blocks of chunked arrays are copied
+    into temporary buffers, so that at most <tt>2*opt.n_threads</tt> blocks are in memory
+    at any time (in addition to the chunk caches).
+
+    Blocks are processed in parallel by <tt>opt.n_threads</tt> threads, so the
+    functor's call operator must be thread-safe. The source and destination arrays
+    must not overlap.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+    Namespace: vigra
+
+    \code
+    struct MedianOfGaussians
+    {
+        void operator()(MultiArrayView<3, float, StridedArrayTag> const & src,
+                        MultiArrayView<3, float, StridedArrayTag> dest,
+                        Shape3 const & start, Shape3 const & stop) const
+        {
+            ...
+        }
+    };
+
+    HDF5File file("volume.h5", HDF5File::OpenReadOnly);
+    ChunkedArrayHDF5<3, float> data(file, "raw");
+    MultiArray<3, float> result(data.shape());
+
+    blockwiseCaller(data, result, MedianOfGaussians(), Shape3(20),
+                    BlockwiseOptions<3>().blockShape(128).numThreads(8));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void blockwiseCaller)
+
+template <class SrcArray, class DestArray, class Functor, class Shape>
+void
+blockwiseCaller(SrcArray const & src, DestArray & dest, Functor const & f,
+                Shape const & halo,
+                BlockwiseOptions<Shape::static_size> const & opt = BlockwiseOptions<Shape::static_size>())
+{
+    enum { N = Shape::static_size };
+
+    vigra_precondition(Shape(src.shape()) == Shape(dest.shape()),
+        "blockwiseCaller(): shape mismatch between input and output.");
+    vigra_precondition(!detail::blockwiseArraysOverlap(src, dest),
+        "blockwiseCaller(): source and destination must not overlap.");
+    vigra_precondition(min(halo) >= 0,
+        "blockwiseCaller(): halo must not be negative.");
+    if(min(Shape(src.shape())) <= 0)
+        return;
+
+    Shape block_shape = opt.block_shape;
+    if(min(block_shape) <= 0)
+        block_shape = detail::blockwiseDefaultBlockShape(dest);
+
+    detail::BlockwiseCallerTask<N, SrcArray, DestArray, Functor> task(src, dest, f, block_shape, halo);
+    parallel_foreach(opt.n_threads, task.numberOfBlocks(), task);
+}
+
+namespace detail {
+
+    // Support of the Gaussian filter (or derivative) of the given order
+    // along each axis, see separableConvolveMultiArray().
+template <unsigned int N>
+typename MultiArrayShape<N>::type
+blockwiseGaussianHalo(ConvolutionOptions<N> const & opt, int order, const char * const function_name)
+{
+    typename MultiArrayShape<N>::type halo;
+    typename ConvolutionOptions<N>::ScaleIterator params = opt.scaleParams();
+    for(unsigned int k=0; k<N; ++k, ++params)
+    {
+        double sigma = params.sigma_scaled(function_name);
+        GaussianLineFilter<double> filter;
+        filter.init(sigma, order, opt.window_ratio, opt.useRecursiveFilter(sigma));
+        halo[k] = std::max(-filter.left(), filter.right());
+    }
+    return halo;
+}
+
+    // Options for filtering a single block. The filters run sequentially, 
+    // since blockwiseCaller() parallelizes over blocks. Concurrent blocks 
+    // must not share the caller's scratch arena, so each thread uses its 
+    // own arena instead (or none if thread-local storage is unavailable).
+template <unsigned int N, class Shape>
+ConvolutionOptions<N>
+blockwiseFilterOptions(ConvolutionOptions<N> const & opt, Shape const & start, Shape const & stop)
+{
+    ConvolutionOptions<N> o(opt);
+    o.subarray(start, stop).numThreads(1);
+    if(o.scratch_arena != 0)
+    {
+#ifdef VIGRA_HAS_THREAD_LOCAL
+        o.scratchArena(threadLocalScratchArena());
+#else
+        o.scratch_arena = 0;
+#endif
+    }
+    return o;
+}
+
+    // Functors that apply the filters to a single block.
+template <unsigned int N>
+struct BlockwiseGaussianSmoothFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                 blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseGaussianGradientFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                   blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseSymmetricGradientFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        symmetricGradientMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                    blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseLaplacianOfGaussianFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                      blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseHessianOfGaussianFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        hessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                    blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseStructureTensorFunctor
+{
+    ConvolutionOptions<N> opt;
+
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(dest),
+                                  blockwiseFilterOptions(opt, start, stop));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseTensorEigenvaluesFunctor
+{
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        tensorEigenvaluesMultiArray(srcMultiArrayRange(src.subarray(start, stop)), destMultiArray(dest));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseTensorTraceFunctor
+{
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        tensorTraceMultiArray(srcMultiArrayRange(src.subarray(start, stop)), destMultiArray(dest));
+    }
+};
+
+template <unsigned int N>
+struct BlockwiseTensorDeterminantFunctor
+{
+    template <class T1, class T2, class Shape>
+    void operator()(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                    MultiArrayView<N, T2, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        tensorDeterminantMultiArray(srcMultiArrayRange(src.subarray(start, stop)), destMultiArray(dest));
+    }
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*              blockwise Gaussian filters              */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Blockwise version of \ref gaussianSmoothMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+gaussianSmoothMultiArray(SrcArray const & src, DestArray & dest, double sigma,
+                         BlockwiseOptions<N> const & bopt,
+                         ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseGaussianSmoothFunctor<N> f;
+    f.opt = opt;
+    f.opt.stdDev(sigma);
+    blockwiseCaller(src, dest, f,
+                    detail::blockwiseGaussianHalo(f.opt, 0, "gaussianSmoothMultiArray"), bopt);
+}
+
+    /** \brief Blockwise version of \ref gaussianGradientMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+gaussianGradientMultiArray(SrcArray const & src, DestArray & dest, double sigma,
+                           BlockwiseOptions<N> const & bopt,
+                           ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseGaussianGradientFunctor<N> f;
+    f.opt = opt;
+    f.opt.stdDev(sigma);
+    blockwiseCaller(src, dest, f,
+                    detail::blockwiseGaussianHalo(f.opt, 1, "gaussianGradientMultiArray"), bopt);
+}
+
+    /** \brief Blockwise version of \ref symmetricGradientMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+symmetricGradientMultiArray(SrcArray const & src, DestArray & dest,
+                            BlockwiseOptions<N> const & bopt,
+                            ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseSymmetricGradientFunctor<N> f;
+    f.opt = opt;
+    blockwiseCaller(src, dest, f, typename MultiArrayShape<N>::type(1), bopt);
+}
+
+    /** \brief Blockwise version of \ref laplacianOfGaussianMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+laplacianOfGaussianMultiArray(SrcArray const & src, DestArray & dest, double sigma,
+                              BlockwiseOptions<N> const & bopt,
+                              ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseLaplacianOfGaussianFunctor<N> f;
+    f.opt = opt;
+    f.opt.stdDev(sigma);
+    blockwiseCaller(src, dest, f,
+                    detail::blockwiseGaussianHalo(f.opt, 2, "laplacianOfGaussianMultiArray"), bopt);
+}
+
+    /** \brief Blockwise version of \ref hessianOfGaussianMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+hessianOfGaussianMultiArray(SrcArray const & src, DestArray & dest, double sigma,
+                            BlockwiseOptions<N> const & bopt,
+                            ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseHessianOfGaussianFunctor<N> f;
+    f.opt = opt;
+    f.opt.stdDev(sigma);
+    blockwiseCaller(src, dest, f,
+                    detail::blockwiseGaussianHalo(f.opt, 2, "hessianOfGaussianMultiArray"), bopt);
+}
+
+    /** \brief Blockwise version of \ref structureTensorMultiArray().
+
+        The halo is the sum of the supports of the inner and outer filters.
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+structureTensorMultiArray(SrcArray const & src, DestArray & dest,
+                          double innerScale, double outerScale,
+                          BlockwiseOptions<N> const & bopt,
+                          ConvolutionOptions<N> const & opt = ConvolutionOptions<N>())
+{
+    detail::BlockwiseStructureTensorFunctor<N> f;
+    f.opt = opt;
+    f.opt.stdDev(innerScale).outerScale(outerScale);
+    blockwiseCaller(src, dest, f,
+                    detail::blockwiseGaussianHalo(f.opt, 1, "structureTensorMultiArray") +
+                    detail::blockwiseGaussianHalo(f.opt.outerOptions(), 0, "structureTensorMultiArray"),
+                    bopt);
+}
+
+    /** \brief Blockwise version of \ref tensorEigenvaluesMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+tensorEigenvaluesMultiArray(SrcArray const & src, DestArray & dest,
+                            BlockwiseOptions<N> const & bopt)
+{
+    blockwiseCaller(src, dest, detail::BlockwiseTensorEigenvaluesFunctor<N>(),
+                    typename MultiArrayShape<N>::type(), bopt);
+}
+
+    /** \brief Blockwise version of \ref tensorTraceMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+tensorTraceMultiArray(SrcArray const & src, DestArray & dest,
+                      BlockwiseOptions<N> const & bopt)
+{
+    blockwiseCaller(src, dest, detail::BlockwiseTensorTraceFunctor<N>(),
+                    typename MultiArrayShape<N>::type(), bopt);
+}
+
+    /** \brief Blockwise version of \ref tensorDeterminantMultiArray().
+
+        <b>\#include</b> \<vigra/multi_blockwise.hxx\><br>
+        Namespace: vigra
+    */
+template <unsigned int N, class SrcArray, class DestArray>
+void
+tensorDeterminantMultiArray(SrcArray const & src, DestArray & dest,
+                            BlockwiseOptions<N> const & bopt)
+{
+    blockwiseCaller(src, dest, detail::BlockwiseTensorDeterminantFunctor<N>(),
+                    typename MultiArrayShape<N>::type(), bopt);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_BLOCKWISE_HXX
@@ -38,7 +38,9 @@
 #ifndef VIGRA_MULTI_CONVOLUTION_H
 #define VIGRA_MULTI_CONVOLUTION_H
 
+#include <cstdlib>
 #include "separableconvolution.hxx"
+#include "recursiveconvolution.hxx"
 #include "array_vector.hxx"
 #include "multi_array.hxx"
 #include "accessor.hxx"
@@ -49,6 +51,8 @@
 #include "functorexpression.hxx"
 #include "tinyvector.hxx"
 #include "algorithm.hxx"
+#include "threadpool.hxx"
+#include "scratch_arena.hxx"
 
 namespace vigra
 {
@@ -333,13 +337,19 @@ class ConvolutionOptions
     ParamVec outer_scale;
     double window_ratio;
     Shape from_point, to_point;
+    int n_threads;
+    double recursive_threshold;
+    ScratchArena * scratch_arena;
      
     ConvolutionOptions()
     : sigma_eff(0.0),
       sigma_d(0.0),
       step_size(1.0),
       outer_scale(0.0),
-      window_ratio(0.0)
+      window_ratio(0.0),
+      n_threads(1),
+      recursive_threshold(NumericTraits<double>::max()),
+      scratch_arena(0)
     {}
 
     typedef typename detail::WrapDoubleIteratorTriple<ParamIt, ParamIt, ParamIt>
@@ -483,71 +493,567 @@ class ConvolutionOptions
         to_point = to;
         return *this;
     }
+
+        /** Number of threads used by the convolution.
+
+            The independent lines of each 1D convolution pass are distributed 
+            over the given number of threads, and each thread uses its own line buffer.
+            If <tt>n <= 0</tt>, \ref defaultConcurrency() threads are used. 
+            If the compiler doesn't support C++11 threads, the computation
+            is always sequential (see \ref ParallelProcessing).
+            
+            Default: <tt>1</tt> (i.e. sequential computation)
+        */
+    ConvolutionOptions<dim> & numThreads(int n)
+    {
+        n_threads = n;
+        return *this;
+    }
+
+        /** Use recursive filters for large scales.
+
+            The cost of an explicit Gaussian filter grows linearly with the scale.
+            When the scale (in pixels, i.e. after division by the step size) 
+            along an axis is at least <tt>sigma</tt>, Gaussian filters and their 
+            derivatives along that axis are instead computed by the fourth-order
+            recursive approximation of Deriche, whose cost per pixel is independent 
+            of the scale. Derivatives are obtained by central differences of the 
+            recursively smoothed signal. The error of the recursive Gaussian is about 
+            0.05% of its maximal response, so that the difference to an explicit kernel 
+            is dominated by the truncation of the latter. Recursive filtering
+            becomes faster than explicit kernels at about <tt>sigma = 4</tt>.
+            The array is extended by reflection at the borders (i.e. like
+            <tt>BORDER_TREATMENT_REFLECT</tt>), and when the recursive filter is 
+            combined with \ref subarray(), a margin of <tt>4*sigma</tt> around 
+            the subarray is taken into account.
+            The option is respected by \ref gaussianSmoothMultiArray(),
+            \ref gaussianGradientMultiArray(), \ref laplacianOfGaussianMultiArray(),
+            \ref hessianOfGaussianMultiArray() and the functions calling them. 
+            \ref filterWindowSize() has no effect on recursive filters.
+            
+            Default: infinity (i.e. always use explicit filter kernels).
+            <tt>sigma = 0</tt> means that recursive filters are always used.
+        */
+    ConvolutionOptions<dim> & recursiveFilterThreshold(double sigma)
+    {
+        vigra_precondition(sigma >= 0.0,
+            "ConvolutionOptions::recursiveFilterThreshold(): sigma must not be negative.");
+        recursive_threshold = sigma;
+        return *this;
+    }
+    
+    bool useRecursiveFilter(double sigma) const
+    {
+        return sigma >= recursive_threshold;
+    }
+
+        /** Take temporary arrays from the given arena.
+
+            Functions that need full-size temporary arrays (e.g. when the subarray 
+            option is active, when the destination type differs from the internal 
+            floating point type, or for the intermediate results of
+            \ref laplacianOfGaussianMultiArray() and \ref structureTensorMultiArray())
+            allocate them from <tt>arena</tt> instead of the system allocator. 
+            When the same arena is used for repeated calls on arrays of the same shape, 
+            only the first call allocates memory (see \ref ScratchMemory).
+            The arena must not be used by another thread while the filter is running.
+            
+            Default: no arena (i.e. temporary arrays are allocated in every call)
+        */
+    ConvolutionOptions<dim> & scratchArena(ScratchArena & arena)
+    {
+        scratch_arena = &arena;
+        return *this;
+    }
 };
 
 namespace detail
 {
 
+template <class K>
+void 
+scaleKernel(K & kernel, double a)
+{
+    for(int i = kernel.left(); i <= kernel.right(); ++i)
+        kernel[i] = detail::RequiresExplicitCast<typename K::value_type>::cast(kernel[i] * a);
+}
+
 /********************************************************/
 /*                                                      */
-/*        internalSeparableConvolveMultiArray           */
+/*                 GaussianLineFilter                   */
 /*                                                      */
 /********************************************************/
 
-template <class SrcIterator, class SrcShape, class SrcAccessor,
-          class DestIterator, class DestAccessor, class KernelIterator>
+    // Gaussian or Gaussian derivative filter along a single axis, realized
+    // either by an explicit Kernel1D or by Deriche's recursive filter
+    // (see ConvolutionOptions::recursiveFilterThreshold()). In the latter case,
+    // left() and right() return the margin that is added to each line 
+    // and must be included when only a subarray is to be computed.
+template <class T>
+class GaussianLineFilter
+{
+  public:
+    typedef T value_type;
+    
+    GaussianLineFilter()
+    : sigma_(0.0), scale_(1.0), order_(0), radius_(0), recursive_(false)
+    {}
+    
+    void init(double sigma, int order, double window_ratio, bool recursive)
+    {
+        sigma_ = sigma;
+        scale_ = 1.0;
+        order_ = order;
+        recursive_ = recursive;
+        if(recursive)
+        {
+            radius_ = std::max(3, (int)std::ceil(4.0*sigma) + order);
+            coefficients_ = DericheGaussianCoefficients(sigma);
+            kernel_ = Kernel1D<T>();
+        }
+        else if(order == 0)
+        {
+            kernel_.initGaussian(sigma, 1.0, window_ratio);
+        }
+        else
+        {
+            kernel_.initGaussianDerivative(sigma, order, 1.0, window_ratio);
+        }
+    }
+    
+    void scale(double a)
+    {
+        if(recursive_)
+            scale_ *= a;
+        else
+            scaleKernel(kernel_, a);
+    }
+    
+    int left() const
+    {
+        return recursive_
+                   ? -radius_
+                   : kernel_.left();
+    }
+    
+    int right() const
+    {
+        return recursive_
+                   ? radius_
+                   : kernel_.right();
+    }
+    
+    BorderTreatmentMode borderTreatment() const
+    {
+        return recursive_
+                   ? BORDER_TREATMENT_REFLECT
+                   : kernel_.borderTreatment();
+    }
+    
+    value_type operator[](int i) const
+    {
+        return kernel_[i];
+    }
+    
+    bool isRecursive() const
+    {
+        return recursive_;
+    }
+    
+    Kernel1D<T> const & kernel() const
+    {
+        return kernel_;
+    }
+    
+    double sigma_, scale_;
+    int order_, radius_;
+    bool recursive_;
+    Kernel1D<T> kernel_;
+    DericheGaussianCoefficients coefficients_;
+};
+
+    // Explicit kernels can be applied to tiles of lines (see ConvolveLinesAlongAxisFunctor),
+    // other line filters process the lines themselves in their filterLines() overload.
+template <class T>
+inline bool 
+supportsLineTiles(Kernel1D<T> const &)
+{
+    return true;
+}
+
+template <class T>
+inline bool 
+supportsLineTiles(GaussianLineFilter<T> const & filter)
+{
+    return !filter.isRecursive();
+}
+
+    // Filter all lines of the navigators (whose elements [start, stop) are
+    // written to the destination, beginning at 'doffset') line by line, 
+    // using 'buffer' as scratch memory.
+template <class SNavigator, class SrcAccessor, class DNavigator, class DestAccessor,
+          class T, class KernelValue>
 void
-internalSeparableConvolveMultiArrayTmp(
-                      SrcIterator si, SrcShape const & shape, SrcAccessor src,
-                      DestIterator di, DestAccessor dest, KernelIterator kit)
+filterLines(SNavigator & snav, SrcAccessor src, DNavigator & dnav, DestAccessor dest, int doffset,
+            Kernel1D<KernelValue> const & kernel, int start, int stop, ArrayVector<T> & buffer)
 {
-    enum { N = 1 + SrcIterator::level };
+    typename AccessorTraits<T>::default_accessor acc;
+    buffer.resize(snav.end() - snav.begin());
+        
+    for( ; snav.hasMore(); snav++, dnav++ )
+    {
+        // first copy source to buffer for maximum cache efficiency and
+        // because convolveLine() cannot work in-place
+        copyLine(snav.begin(), snav.end(), src, buffer.begin(), acc);
 
-    typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
-    typedef typename AccessorTraits<TmpType>::default_accessor TmpAcessor;
+        convolveLine(srcIterRange(buffer.begin(), buffer.end(), acc),
+                     destIter(dnav.begin() + doffset, dest),
+                     kernel1d(kernel), start, stop);
+    }
+}
 
-    // temporary array to hold the current line to enable in-place operation
-    ArrayVector<TmpType> tmp( shape[0] );
+    // Recursive filters process tiles of neighboring lines simultaneously,
+    // which are gathered into an interleaved buffer such that the innermost
+    // loops run across lines. The lines are extended by reflection.
+template <class SNavigator, class SrcAccessor, class DNavigator, class DestAccessor,
+          class T, class KernelValue>
+void
+filterLines(SNavigator & snav, SrcAccessor src, DNavigator & dnav, DestAccessor dest, int doffset,
+            GaussianLineFilter<KernelValue> const & filter, int start, int stop, ArrayVector<T> & buffer)
+{
+    if(!filter.isRecursive())
+    {
+        filterLines(snav, src, dnav, dest, doffset, filter.kernel(), start, stop, buffer);
+        return;
+    }
+    
+    enum { TileSize = 16 };
+    
+    int w = snav.end() - snav.begin();
+    if(stop == 0)
+        stop = w;
+    vigra_precondition(0 <= start && start < stop && stop <= w,
+                 "convolveLine(): invalid subrange (start, stop).\n");
+    
+    int margin = filter.right(),
+        size = w + 2*margin,
+        period = 2*(w - 1);
+    buffer.resize(3*size*TileSize);
+    
+    typename SNavigator::iterator slines[TileSize];
+    typename DNavigator::iterator dlines[TileSize];
+    
+    while(snav.hasMore())
+    {
+        int lines = 0;
+        for( ; lines < TileSize && snav.hasMore(); ++lines, snav++, dnav++)
+        {
+            slines[lines] = snav.begin();
+            dlines[lines] = dnav.begin() + doffset;
+        }
+        
+        // gather
+        typename ArrayVector<T>::iterator t = buffer.begin();
+        for(int p = -margin; p < w + margin; ++p, t += lines)
+        {
+            int q = period == 0
+                       ? 0
+                       : std::abs(p) % period;
+            if(q >= w)
+                q = period - q;
+            for(int j=0; j<lines; ++j)
+                t[j] = src(slines[j] + q);
+        }
+        
+        recursiveGaussianDerivativeLines(buffer.begin(), buffer.begin() + size*lines, size, lines,
+                                         filter.coefficients_, filter.order_);
+        
+        // scatter
+        t = buffer.begin() + (margin + start)*lines;
+        for(int p = start; p < stop; ++p, t += lines)
+            for(int j=0; j<lines; ++j)
+                dest.set(detail::RequiresExplicitCast<typename DestAccessor::value_type>::cast(filter.scale_*t[j]), 
+                         dlines[j] + (p - start));
+    }
+}
 
+/********************************************************/
+/*                                                      */
+/*               convolveLinesAlongAxis                 */
+/*                                                      */
+/********************************************************/
+
+    // Convolve all lines of the block [sstart, sstop) of the source along 'axis'
+    // and write the results to the block [dstart, dstop) of the destination
+    // (starting at position 'doffset' of each destination line). Both blocks
+    // must have the same extent along all other axes. Independent slices 
+    // are distributed over 'nThreads' threads, each of which uses its own
+    // line buffer.
+    //
+    // Lines along a strided axis are processed in tiles of neighboring lines
+    // (i.e. lines that are adjacent along axis 0): the tile is gathered into 
+    // a transposed buffer (including the border), convolved with the 
+    // innermost loop running across lines, and scattered back. Thus, all memory 
+    // accesses touch consecutive addresses, and the inner loop vectorizes. 
+    // The summation order is the same as in convolveLine(), so the results
+    // are identical. Modes BORDER_TREATMENT_AVOID and BORDER_TREATMENT_CLIP 
+    // always use the line-by-line algorithm. Filters for which supportsLineTiles()
+    // returns false (e.g. recursive filters) process the lines in their own
+    // filterLines() overload.
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor, class Kernel>
+class ConvolveLinesAlongAxisFunctor
+{
+  public:
+    enum { N = 1 + SrcIterator::level };
+    
+    typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
+    typedef typename AccessorTraits<TmpType>::default_accessor TmpAcessor;
+    typedef typename MultiArrayShape<N>::type Shape;
     typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
     typedef MultiArrayNavigator<DestIterator, N> DNavigator;
+    typedef typename Kernel::value_type KernelValue;
+    typedef typename PromoteTraits<TmpType, KernelValue>::Promote SumType;
     
-    TmpAcessor acc;
-
+    // number of lines per tile: about two cache lines worth of data
+    enum { TileSize = 128 / sizeof(TmpType) < 8
+                          ? 8
+                          : 128 / sizeof(TmpType) > 32
+                              ? 32
+                              : 128 / sizeof(TmpType) };
+
+    ConvolveLinesAlongAxisFunctor(SrcIterator si, Shape const & sstart, Shape const & sstop, SrcAccessor src,
+                                  DestIterator di, Shape const & dstart, Shape const & dstop, DestAccessor dest,
+                                  unsigned int axis, unsigned int outer_axis, MultiArrayIndex slice_size,
+                                  Kernel const & kernel, int lstart, int lstop, int doffset,
+                                  ArrayVector<ArrayVector<TmpType> > & buffers)
+    : si_(si), sstart_(sstart), sstop_(sstop), src_(src),
+      di_(di), dstart_(dstart), dstop_(dstop), dest_(dest),
+      axis_(axis), outer_axis_(outer_axis), slice_size_(slice_size), kernel_(kernel),
+      lstart_(lstart), lstop_(lstop), doffset_(doffset),
+      buffers_(buffers)
+    {}
+    
+        // process the lines in slice 'k' of the outer axis
+    void operator()(int threadId, MultiArrayIndex k) const
     {
-        // only operate on first dimension here
-        SNavigator snav( si, shape, 0 );
-        DNavigator dnav( di, shape, 0 );
+        Shape sstart(sstart_), sstop(sstop_), dstart(dstart_), dstop(dstop_);
+        if(outer_axis_ != axis_)
+        {
+            MultiArrayIndex size = std::min(slice_size_, sstop_[outer_axis_] - sstart_[outer_axis_] - k*slice_size_);
+            sstart[outer_axis_] += k*slice_size_;
+            sstop[outer_axis_]   = sstart[outer_axis_] + size;
+            dstart[outer_axis_] += k*slice_size_;
+            dstop[outer_axis_]   = dstart[outer_axis_] + size;
+        }
         
-        for( ; snav.hasMore(); snav++, dnav++ )
+        SNavigator snav(si_, sstart, sstop, axis_);
+        DNavigator dnav(di_, dstart, dstop, axis_);
+        
+        ArrayVector<TmpType> & tmp = buffers_[threadId];
+        
+        if(useTiles())
         {
-             // first copy source to tmp for maximum cache efficiency
-             copyLine(snav.begin(), snav.end(), src, tmp.begin(), acc);
-
-             convolveLine(srcIterRange(tmp.begin(), tmp.end(), acc),
-                          destIter( dnav.begin(), dest ),
-                          kernel1d( *kit ) );
+            convolveTiles(snav, dnav, sstop[0] - sstart[0], tmp);
+            return;
         }
-        ++kit;
+        
+        filterLines(snav, src_, dnav, dest_, doffset_, kernel_, lstart_, lstop_, tmp);
     }
-
-    // operate on further dimensions
-    for( int d = 1; d < N; ++d, ++kit )
+    
+    bool useTiles() const
     {
-        DNavigator dnav( di, shape, d );
-
-        tmp.resize( shape[d] );
+        if(axis_ == 0 || !supportsLineTiles(kernel_))
+            return false;
+        switch(kernel_.borderTreatment())
+        {
+            case BORDER_TREATMENT_REFLECT:
+            case BORDER_TREATMENT_REPEAT:
+            case BORDER_TREATMENT_WRAP:
+            case BORDER_TREATMENT_ZEROPAD:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+        // index of the source element corresponding to position 'p' of the
+        // line extended according to the border treatment mode, or -1 for zero padding
+    int borderIndex(int p, int w) const
+    {
+        if(0 <= p && p < w)
+            return p;
+        switch(kernel_.borderTreatment())
+        {
+            case BORDER_TREATMENT_REFLECT:
+                return p < 0
+                          ? -p
+                          : 2*w - 2 - p;
+            case BORDER_TREATMENT_REPEAT:
+                return p < 0
+                          ? 0
+                          : w - 1;
+            case BORDER_TREATMENT_WRAP:
+                return p < 0
+                          ? p + w
+                          : p - w;
+            default: // BORDER_TREATMENT_ZEROPAD
+                return -1;
+        }
+    }
+    
+    void convolveTiles(SNavigator & snav, DNavigator & dnav, 
+                       MultiArrayIndex row_length, ArrayVector<TmpType> & tmp) const
+    {
+        int w = snav.end() - snav.begin();
+        int kleft = kernel_.left(), kright = kernel_.right();
 
-        for( ; dnav.hasMore(); dnav++ )
+        vigra_precondition(w >= std::max(kright, -kleft) + 1,
+                     "convolveLine(): kernel longer than line.\n");
+        
+        int start = lstart_, 
+            stop  = lstop_ == 0 
+                        ? w 
+                        : lstop_;
+        vigra_precondition(0 <= start && start < stop && stop <= w,
+                     "convolveLine(): invalid subrange (start, stop).\n");
+        
+        // the tile buffer holds the required part of the lines, including the 
+        // border, such that element 'p' of line 'j' is at '(p-left_border)*lines + j' 
+        int left_border = start - kright, right_border = stop - kleft;
+        tmp.resize((right_border - left_border)*TileSize);
+        
+        typename SNavigator::iterator slines[TileSize];
+        typename DNavigator::iterator dlines[TileSize];
+        SumType sums[TileSize];
+        TmpAcessor acc;
+        MultiArrayIndex x = 0;
+        
+        while(snav.hasMore())
         {
-             // first copy source to tmp since convolveLine() cannot work in-place
-             copyLine(dnav.begin(), dnav.end(), dest, tmp.begin(), acc);
+            // collect a tile of lines that are adjacent along axis 0
+            int lines = 0;
+            do
+            {
+                slines[lines] = snav.begin();
+                dlines[lines] = dnav.begin() + doffset_;
+                ++lines;
+                ++x;
+                snav++;
+                dnav++;
+            }
+            while(lines < TileSize && x < row_length);
+            if(x == row_length)
+                x = 0;
 
-             convolveLine(srcIterRange(tmp.begin(), tmp.end(), acc),
-                          destIter( dnav.begin(), dest ),
-                          kernel1d( *kit ) );
+            // gather
+            typename ArrayVector<TmpType>::iterator t = tmp.begin();
+            for(int p = left_border; p < right_border; ++p, t += lines)
+            {
+                int q = borderIndex(p, w);
+                if(q < 0)
+                    for(int j=0; j<lines; ++j)
+                        t[j] = NumericTraits<TmpType>::zero();
+                else
+                    for(int j=0; j<lines; ++j)
+                        acc.set(src_(slines[j] + q), t + j);
+            }
+            
+            // convolve and scatter
+            for(int p = start; p < stop; ++p)
+            {
+                for(int j=0; j<lines; ++j)
+                    sums[j] = NumericTraits<SumType>::zero();
+                t = tmp.begin() + (p - kright - left_border)*lines;
+                for(int i = kright; i >= kleft; --i, t += lines)
+                {
+                    KernelValue k = kernel_[i];
+                    for(int j=0; j<lines; ++j)
+                        sums[j] += k * t[j];
+                }
+                for(int j=0; j<lines; ++j)
+                    dest_.set(detail::RequiresExplicitCast<typename DestAccessor::value_type>::cast(sums[j]), 
+                              dlines[j] + (p - start));
+            }
         }
     }
+    
+    SrcIterator si_;
+    Shape sstart_, sstop_;
+    SrcAccessor src_;
+    DestIterator di_;
+    Shape dstart_, dstop_;
+    DestAccessor dest_;
+    unsigned int axis_, outer_axis_;
+    MultiArrayIndex slice_size_;
+    Kernel const & kernel_;
+    int lstart_, lstop_, doffset_;
+    ArrayVector<ArrayVector<TmpType> > & buffers_;
+};
+
+template <class SrcIterator, class Shape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class Kernel>
+void
+convolveLinesAlongAxis(SrcIterator si, Shape const & sstart, Shape const & sstop, SrcAccessor src,
+                       DestIterator di, Shape const & dstart, Shape const & dstop, DestAccessor dest,
+                       unsigned int axis, Kernel const & kernel,
+                       int lstart, int lstop, int doffset, int nThreads)
+{
+    typedef ConvolveLinesAlongAxisFunctor<SrcIterator, SrcAccessor, 
+                                          DestIterator, DestAccessor, Kernel> Functor;
+    enum { N = Functor::N };
+    
+    // split along the longest of the remaining axes, but keep axis 0 intact 
+    // if possible (slicing along axis 0 would break up the tiles of lines) 
+    unsigned int outer_axis = axis;
+    for(unsigned int k=0; k<(unsigned int)N; ++k)
+        if(k != axis && (outer_axis == axis || outer_axis == 0 ||
+                         (k != 0 && sstop[k] - sstart[k] > sstop[outer_axis] - sstart[outer_axis])))
+            outer_axis = k;
+    MultiArrayIndex slice_size = (outer_axis == 0)
+                                     ? (MultiArrayIndex)Functor::TileSize
+                                     : 1;
+    MultiArrayIndex slices = outer_axis == axis
+                                 ? 1
+                                 : (sstop[outer_axis] - sstart[outer_axis] + slice_size - 1) / slice_size;
+    
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+    ArrayVector<ArrayVector<typename Functor::TmpType> > buffers(nThreads);
+    Functor f(si, sstart, sstop, src, di, dstart, dstop, dest,
+              axis, outer_axis, slice_size, kernel, lstart, lstop, doffset, buffers);
+    parallel_foreach(nThreads, slices, f);
+}
+
+/********************************************************/
+/*                                                      */
+/*        internalSeparableConvolveMultiArray           */
+/*                                                      */
+/********************************************************/
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class KernelIterator>
+void
+internalSeparableConvolveMultiArrayTmp(
+                      SrcIterator si, SrcShape const & shape, SrcAccessor src,
+                      DestIterator di, DestAccessor dest, KernelIterator kit,
+                      int nThreads = 1)
+{
+    enum { N = 1 + SrcIterator::level };
+    
+    typename MultiArrayShape<N>::type start, stop(shape);
+
+    // only operate on first dimension here
+    convolveLinesAlongAxis(si, start, stop, src, di, start, stop, dest,
+                           0, *kit, 0, 0, 0, nThreads);
+    ++kit;
+
+    // operate on further dimensions
+    for( int d = 1; d < N; ++d, ++kit )
+    {
+        convolveLinesAlongAxis(di, start, stop, dest, di, start, stop, dest,
+                               d, *kit, 0, 0, 0, nThreads);
+    }
 }
 
 /********************************************************/
@@ -562,13 +1068,13 @@ void
 internalSeparableConvolveSubarray(
                       SrcIterator si, SrcShape const & shape, SrcAccessor src,
                       DestIterator di, DestAccessor dest, KernelIterator kit,
-                      SrcShape const & start, SrcShape const & stop)
+                      SrcShape const & start, SrcShape const & stop,
+                      int nThreads = 1, ScratchArena * arena = 0)
 {
     enum { N = 1 + SrcIterator::level };
 
     typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
-    typedef MultiArray<N, TmpType> TmpArray;
-    typedef typename TmpArray::traverser TmpIterator;
+    typedef ScratchArray<N, TmpType> TmpArray;
     typedef typename AccessorTraits<TmpType>::default_accessor TmpAcessor;
     
     SrcShape sstart, sstop, axisorder, tmpshape;
@@ -590,54 +1096,29 @@ internalSeparableConvolveSubarray(
     dstop[axisorder[0]]  = stop[axisorder[0]] - start[axisorder[0]];
     
     // temporary array to hold the current line to enable in-place operation
-    MultiArray<N, TmpType> tmp(dstop);
-
-    typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
-    typedef MultiArrayNavigator<TmpIterator, N> TNavigator;
-    typedef MultiArrayNavigator<DestIterator, N> DNavigator;
+    TmpArray tmp(dstop, arena);
     
     TmpAcessor acc;
 
     {
         // only operate on first dimension here
-        SNavigator snav( si, sstart, sstop, axisorder[0]);
-        TNavigator tnav( tmp.traverser_begin(), dstart, dstop, axisorder[0]);
-        
-        ArrayVector<TmpType> tmpline(sstop[axisorder[0]] - sstart[axisorder[0]]);
-        
         int lstart = start[axisorder[0]] - sstart[axisorder[0]];
         int lstop  = lstart + (stop[axisorder[0]] - start[axisorder[0]]);
 
-        for( ; snav.hasMore(); snav++, tnav++ )
-        {
-            // first copy source to tmp for maximum cache efficiency
-            copyLine(snav.begin(), snav.end(), src, tmpline.begin(), acc);
-            
-            convolveLine(srcIterRange(tmpline.begin(), tmpline.end(), acc),
-                         destIter(tnav.begin(), acc),
-                         kernel1d( kit[axisorder[0]] ), lstart, lstop);
-        }
+        convolveLinesAlongAxis(si, sstart, sstop, src, 
+                               tmp.traverser_begin(), dstart, dstop, acc,
+                               axisorder[0], kit[axisorder[0]], lstart, lstop, 0, nThreads);
     }
     
     // operate on further dimensions
     for( int d = 1; d < N; ++d)
     {
-        TNavigator tnav( tmp.traverser_begin(), dstart, dstop, axisorder[d]);
-        
-        ArrayVector<TmpType> tmpline(dstop[axisorder[d]] - dstart[axisorder[d]]);
-        
         int lstart = start[axisorder[d]] - sstart[axisorder[d]];
         int lstop  = lstart + (stop[axisorder[d]] - start[axisorder[d]]);
 
-        for( ; tnav.hasMore(); tnav++ )
-        {
-            // first copy source to tmp because convolveLine() cannot work in-place
-            copyLine(tnav.begin(), tnav.end(), acc, tmpline.begin(), acc );
-
-            convolveLine(srcIterRange(tmpline.begin(), tmpline.end(), acc),
-                         destIter( tnav.begin() + lstart, acc ),
-                         kernel1d( kit[axisorder[d]] ), lstart, lstop);
-        }
+        convolveLinesAlongAxis(tmp.traverser_begin(), dstart, dstop, acc, 
+                               tmp.traverser_begin(), dstart, dstop, acc,
+                               axisorder[d], kit[axisorder[d]], lstart, lstop, lstart, nThreads);
         
         dstart[axisorder[d]] = lstart;
         dstop[axisorder[d]] = lstop;
@@ -647,15 +1128,6 @@ internalSeparableConvolveSubarray(
 }
 
 
-template <class K>
-void 
-scaleKernel(K & kernel, double a)
-{
-    for(int i = kernel.left(); i <= kernel.right(); ++i)
-        kernel[i] = detail::RequiresExplicitCast<typename K::value_type>::cast(kernel[i] * a);
-}
-
-
 } // namespace detail
 
 /** \addtogroup MultiArrayConvolutionFilters Convolution filters for multi-dimensional arrays.
@@ -699,6 +1171,12 @@ scaleKernel(K & kernel, double a)
     subarray, and it is assumed that the output array only refers to the
     subarray (i.e. <tt>diter</tt> points to the element corresponding to 
     <tt>start</tt>). 
+    
+    Alternatively, the subarray can be passed via a \ref ConvolutionOptions object.
+    This variant also supports parallel execution: when 
+    <tt>ConvolutionOptions::numThreads()</tt> is set to a value other than 1, 
+    the independent lines of each 1D pass are distributed over several threads.
+    The result is identical to the sequential computation.
 
     <b> Declarations:</b>
 
@@ -724,6 +1202,16 @@ scaleKernel(K & kernel, double a)
                                     KernelIterator kernels,
                                     SrcShape const & start = SrcShape(),
                                     SrcShape const & stop = SrcShape());
+
+        // take subarray and number of threads from the options object
+        // (likewise for a single Kernel1D)
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class KernelIterator>
+        void
+        separableConvolveMultiArray(SrcIterator siter, SrcShape const & shape, SrcAccessor src,
+                                    DestIterator diter, DestAccessor dest,
+                                    KernelIterator kernels,
+                                    ConvolutionOptions<SrcShape::static_size> const & opt);
     }
     \endcode
 
@@ -769,6 +1257,10 @@ scaleKernel(K & kernel, double a)
     // perform Gaussian smoothing on all dimensions
     separableConvolveMultiArray(srcMultiArrayRange(source), destMultiArray(dest), 
                                 kernels.begin());
+                                
+    // the same using 8 threads
+    separableConvolveMultiArray(srcMultiArrayRange(source), destMultiArray(dest), 
+                                kernels.begin(), ConvolutionOptions<3>().numThreads(8));
     \endcode
 
     <b> Required Interface:</b>
@@ -790,10 +1282,12 @@ void
 separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor src,
                              DestIterator d, DestAccessor dest, 
                              KernelIterator kernels,
-                             SrcShape const & start = SrcShape(),
-                             SrcShape const & stop = SrcShape())
+                             ConvolutionOptions<SrcShape::static_size> const & opt)
 {
     typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
+    
+    SrcShape const & start = opt.from_point,
+                   & stop  = opt.to_point;
 
     if(stop != SrcShape())
     {
@@ -802,23 +1296,50 @@ separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor
             vigra_precondition(0 <= start[k] && start[k] < stop[k] && stop[k] <= shape[k],
               "separableConvolveMultiArray(): invalid subarray shape.");
 
-        detail::internalSeparableConvolveSubarray(s, shape, src, d, dest, kernels, start, stop);
+        detail::internalSeparableConvolveSubarray(s, shape, src, d, dest, kernels, start, stop,
+                                                  opt.n_threads, opt.scratch_arena);
     }
     else if(!IsSameType<TmpType, typename DestAccessor::value_type>::boolResult)
     {
         // need a temporary array to avoid rounding errors
-        MultiArray<SrcShape::static_size, TmpType> tmpArray(shape);
+        ScratchArray<SrcShape::static_size, TmpType> tmpArray(shape, opt.scratch_arena);
         detail::internalSeparableConvolveMultiArrayTmp( s, shape, src,
-             tmpArray.traverser_begin(), typename AccessorTraits<TmpType>::default_accessor(), kernels );
+             tmpArray.traverser_begin(), typename AccessorTraits<TmpType>::default_accessor(), kernels,
+             opt.n_threads );
         copyMultiArray(srcMultiArrayRange(tmpArray), destIter(d, dest));
     }
     else
     {
         // work directly on the destination array
-        detail::internalSeparableConvolveMultiArrayTmp( s, shape, src, d, dest, kernels );
+        detail::internalSeparableConvolveMultiArrayTmp( s, shape, src, d, dest, kernels, opt.n_threads );
     }
 }
 
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class KernelIterator>
+inline void
+separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                             DestIterator d, DestAccessor dest, 
+                             KernelIterator kernels,
+                             SrcShape const & start = SrcShape(),
+                             SrcShape const & stop = SrcShape())
+{
+    separableConvolveMultiArray( s, shape, src, d, dest, kernels, 
+                                 ConvolutionOptions<SrcShape::static_size>().subarray(start, stop));
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class KernelIterator>
+inline void 
+separableConvolveMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                            pair<DestIterator, DestAccessor> const & dest, 
+                            KernelIterator kit,
+                            ConvolutionOptions<SrcShape::static_size> const & opt)
+{
+    separableConvolveMultiArray( source.first, source.second, source.third,
+                                 dest.first, dest.second, kit, opt );
+}
+
 template <class SrcIterator, class SrcShape, class SrcAccessor,
           class DestIterator, class DestAccessor, class KernelIterator>
 inline
@@ -847,6 +1368,33 @@ separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor
     separableConvolveMultiArray( s, shape, src, d, dest, kernels.begin(), start, stop);
 }
 
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void
+separableConvolveMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                             DestIterator d, DestAccessor dest,
+                             Kernel1D<T> const & kernel,
+                             ConvolutionOptions<SrcShape::static_size> const & opt)
+{
+    ArrayVector<Kernel1D<T> > kernels(shape.size(), kernel);
+
+    separableConvolveMultiArray( s, shape, src, d, dest, kernels.begin(), opt);
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void
+separableConvolveMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                            pair<DestIterator, DestAccessor> const & dest,
+                            Kernel1D<T> const & kernel,
+                            ConvolutionOptions<SrcShape::static_size> const & opt)
+{
+    ArrayVector<Kernel1D<T> > kernels(source.second.size(), kernel);
+
+    separableConvolveMultiArray( source.first, source.second, source.third,
+                                 dest.first, dest.second, kernels.begin(), opt);
+}
+
 template <class SrcIterator, class SrcShape, class SrcAccessor,
           class DestIterator, class DestAccessor, class T>
 inline void
@@ -911,6 +1459,15 @@ separableConvolveMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & s
                                        unsigned int dim, vigra::Kernel1D<T> const & kernel,
                                        SrcShape const & start = SrcShape(),
                                        SrcShape const & stop = SrcShape());
+
+        // take subarray and number of threads from the options object
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class T>
+        void
+        convolveMultiArrayOneDimension(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                       pair<DestIterator, DestAccessor> const & dest,
+                                       unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                                       ConvolutionOptions<SrcShape::static_size> const & opt);
     }
     \endcode
 
@@ -940,21 +1497,15 @@ void
 convolveMultiArrayOneDimension(SrcIterator s, SrcShape const & shape, SrcAccessor src,
                                DestIterator d, DestAccessor dest,
                                unsigned int dim, vigra::Kernel1D<T> const & kernel,
-                               SrcShape const & start = SrcShape(),
-                               SrcShape const & stop = SrcShape())
+                               ConvolutionOptions<SrcShape::static_size> const & opt)
 {
     enum { N = 1 + SrcIterator::level };
     vigra_precondition( dim < N,
                         "convolveMultiArrayOneDimension(): The dimension number to convolve must be smaller "
                         "than the data dimensionality" );
 
-    typedef typename NumericTraits<typename DestAccessor::value_type>::RealPromote TmpType;
-    typedef typename AccessorTraits<TmpType>::default_const_accessor TmpAccessor;
-    ArrayVector<TmpType> tmp( shape[dim] );
-
-    typedef MultiArrayNavigator<SrcIterator, N> SNavigator;
-    typedef MultiArrayNavigator<DestIterator, N> DNavigator;
-    
+    SrcShape const & start = opt.from_point,
+                   & stop  = opt.to_point;
     SrcShape sstart, sstop(shape), dstart, dstop(shape);
     
     if(stop != SrcShape())
@@ -966,19 +1517,21 @@ convolveMultiArrayOneDimension(SrcIterator s, SrcShape const & shape, SrcAccesso
         dstop = stop - start;
     }
 
-    SNavigator snav( s, sstart, sstop, dim );
-    DNavigator dnav( d, dstart, dstop, dim );
-
-    for( ; snav.hasMore(); snav++, dnav++ )
-    {
-         // first copy source to temp for maximum cache efficiency
-         copyLine( snav.begin(), snav.end(), src,
-           tmp.begin(), typename AccessorTraits<TmpType>::default_accessor() );
+    detail::convolveLinesAlongAxis(s, sstart, sstop, src, d, dstart, dstop, dest,
+                                   dim, kernel, start[dim], stop[dim], 0, opt.n_threads);
+}
 
-         convolveLine(srcIterRange( tmp.begin(), tmp.end(), TmpAccessor()),
-                      destIter( dnav.begin(), dest ),
-                      kernel1d( kernel), start[dim], stop[dim]);
-    }
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void
+convolveMultiArrayOneDimension(SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                               DestIterator d, DestAccessor dest,
+                               unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                               SrcShape const & start = SrcShape(),
+                               SrcShape const & stop = SrcShape())
+{
+    convolveMultiArrayOneDimension(s, shape, src, d, dest, dim, kernel,
+                                   ConvolutionOptions<SrcShape::static_size>().subarray(start, stop));
 }
 
 template <class SrcIterator, class SrcShape, class SrcAccessor,
@@ -994,6 +1547,18 @@ convolveMultiArrayOneDimension(triple<SrcIterator, SrcShape, SrcAccessor> const
                                    dest.first, dest.second, dim, kernel, start, stop);
 }
 
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void
+convolveMultiArrayOneDimension(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                               pair<DestIterator, DestAccessor> const & dest,
+                               unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                               ConvolutionOptions<SrcShape::static_size> const & opt)
+{
+    convolveMultiArrayOneDimension(source.first, source.second, source.third,
+                                   dest.first, dest.second, dim, kernel, opt);
+}
+
 /********************************************************/
 /*                                                      */
 /*             gaussianSmoothMultiArray                 */
@@ -1086,12 +1651,15 @@ gaussianSmoothMultiArray( SrcIterator s, SrcShape const & shape, SrcAccessor src
     static const int N = SrcShape::static_size;
 
     typename ConvolutionOptions<N>::ScaleIterator params = opt.scaleParams();
-    ArrayVector<Kernel1D<double> > kernels(N);
+    ArrayVector<detail::GaussianLineFilter<double> > kernels(N);
 
     for (int dim = 0; dim < N; ++dim, ++params)
-        kernels[dim].initGaussian(params.sigma_scaled(function_name), 1.0, opt.window_ratio);
+    {
+        double sigma = params.sigma_scaled(function_name);
+        kernels[dim].init(sigma, 0, opt.window_ratio, opt.useRecursiveFilter(sigma));
+    }
 
-    separableConvolveMultiArray(s, shape, src, d, dest, kernels.begin(), opt.from_point, opt.to_point);
+    separableConvolveMultiArray(s, shape, src, d, dest, kernels.begin(), opt);
 }
 
 template <class SrcIterator, class SrcShape, class SrcAccessor,
@@ -1242,11 +1810,11 @@ gaussianGradientMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor s
     ParamType params = opt.scaleParams();
     ParamType params2(params);
 
-    ArrayVector<Kernel1D<KernelType> > plain_kernels(N);
+    ArrayVector<detail::GaussianLineFilter<KernelType> > plain_kernels(N);
     for (int dim = 0; dim < N; ++dim, ++params)
     {
         double sigma = params.sigma_scaled(function_name);
-        plain_kernels[dim].initGaussian(sigma, 1.0, opt.window_ratio);
+        plain_kernels[dim].init(sigma, 0, opt.window_ratio, opt.useRecursiveFilter(sigma));
     }
 
     typedef VectorElementAccessor<DestAccessor> ElementAccessor;
@@ -1254,11 +1822,11 @@ gaussianGradientMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor s
     // compute gradient components
     for (int dim = 0; dim < N; ++dim, ++params2)
     {
-        ArrayVector<Kernel1D<KernelType> > kernels(plain_kernels);
-        kernels[dim].initGaussianDerivative(params2.sigma_scaled(), 1, 1.0, opt.window_ratio);
-        detail::scaleKernel(kernels[dim], 1.0 / params2.step_size());
-        separableConvolveMultiArray(si, shape, src, di, ElementAccessor(dim, dest), kernels.begin(), 
-                                    opt.from_point, opt.to_point);
+        ArrayVector<detail::GaussianLineFilter<KernelType> > kernels(plain_kernels);
+        double sigma = params2.sigma_scaled();
+        kernels[dim].init(sigma, 1, opt.window_ratio, opt.useRecursiveFilter(sigma));
+        kernels[dim].scale(1.0 / params2.step_size());
+        separableConvolveMultiArray(si, shape, src, di, ElementAccessor(dim, dest), kernels.begin(), opt);
     }
 }
 
@@ -1418,7 +1986,7 @@ symmetricGradientMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor
         detail::scaleKernel(symmetric, 1 / *step_size_it);
         convolveMultiArrayOneDimension(si, shape, src,
                                        di, ElementAccessor(d, dest),
-                                       d, symmetric, opt.from_point, opt.to_point);
+                                       d, symmetric, opt);
     }
 }
 
@@ -1537,36 +2105,37 @@ laplacianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccesso
     ParamType params = opt.scaleParams();
     ParamType params2(params);
 
-    ArrayVector<Kernel1D<KernelType> > plain_kernels(N);
+    ArrayVector<detail::GaussianLineFilter<KernelType> > plain_kernels(N);
     for (int dim = 0; dim < N; ++dim, ++params)
     {
         double sigma = params.sigma_scaled("laplacianOfGaussianMultiArray");
-        plain_kernels[dim].initGaussian(sigma, 1.0, opt.window_ratio);
+        plain_kernels[dim].init(sigma, 0, opt.window_ratio, opt.useRecursiveFilter(sigma));
     }
     
     SrcShape dshape(shape);
     if(opt.to_point != SrcShape())
         dshape = opt.to_point - opt.from_point;
     
-    MultiArray<N, KernelType> derivative(dshape);
+    ScratchArray<N, KernelType> derivative(dshape, opt.scratch_arena);
 
     // compute 2nd derivatives and sum them up
     for (int dim = 0; dim < N; ++dim, ++params2)
     {
-        ArrayVector<Kernel1D<KernelType> > kernels(plain_kernels);
-        kernels[dim].initGaussianDerivative(params2.sigma_scaled(), 2, 1.0, opt.window_ratio);
-        detail::scaleKernel(kernels[dim], 1.0 / sq(params2.step_size()));
+        ArrayVector<detail::GaussianLineFilter<KernelType> > kernels(plain_kernels);
+        double sigma = params2.sigma_scaled();
+        kernels[dim].init(sigma, 2, opt.window_ratio, opt.useRecursiveFilter(sigma));
+        kernels[dim].scale(1.0 / sq(params2.step_size()));
 
         if (dim == 0)
         {
             separableConvolveMultiArray( si, shape, src, 
-                                         di, dest, kernels.begin(), opt.from_point, opt.to_point);
+                                         di, dest, kernels.begin(), opt);
         }
         else
         {
             separableConvolveMultiArray( si, shape, src, 
                                          derivative.traverser_begin(), DerivativeAccessor(), 
-                                         kernels.begin(), opt.from_point, opt.to_point);
+                                         kernels.begin(), opt);
             combineTwoMultiArrays(di, dshape, dest, derivative.traverser_begin(), DerivativeAccessor(), 
                                   di, dest, Arg1() + Arg2() );
         }
@@ -1717,12 +2286,12 @@ hessianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor
 
     ParamType params_init = opt.scaleParams();
 
-    ArrayVector<Kernel1D<KernelType> > plain_kernels(N);
+    ArrayVector<detail::GaussianLineFilter<KernelType> > plain_kernels(N);
     ParamType params(params_init);
     for (int dim = 0; dim < N; ++dim, ++params)
     {
         double sigma = params.sigma_scaled("hessianOfGaussianMultiArray");
-        plain_kernels[dim].initGaussian(sigma, 1.0, opt.window_ratio);
+        plain_kernels[dim].init(sigma, 0, opt.window_ratio, opt.useRecursiveFilter(sigma));
     }
 
     typedef VectorElementAccessor<DestAccessor> ElementAccessor;
@@ -1734,20 +2303,22 @@ hessianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor
         ParamType params_j(params_i);
         for (int j=i; j<N; ++j, ++b, ++params_j)
         {
-            ArrayVector<Kernel1D<KernelType> > kernels(plain_kernels);
+            ArrayVector<detail::GaussianLineFilter<KernelType> > kernels(plain_kernels);
+            double sigma_i = params_i.sigma_scaled(),
+                   sigma_j = params_j.sigma_scaled();
             if(i == j)
             {
-                kernels[i].initGaussianDerivative(params_i.sigma_scaled(), 2, 1.0, opt.window_ratio);
+                kernels[i].init(sigma_i, 2, opt.window_ratio, opt.useRecursiveFilter(sigma_i));
             }
             else
             {
-                kernels[i].initGaussianDerivative(params_i.sigma_scaled(), 1, 1.0, opt.window_ratio);
-                kernels[j].initGaussianDerivative(params_j.sigma_scaled(), 1, 1.0, opt.window_ratio);
+                kernels[i].init(sigma_i, 1, opt.window_ratio, opt.useRecursiveFilter(sigma_i));
+                kernels[j].init(sigma_j, 1, opt.window_ratio, opt.useRecursiveFilter(sigma_j));
             }
-            detail::scaleKernel(kernels[i], 1 / params_i.step_size());
-            detail::scaleKernel(kernels[j], 1 / params_j.step_size());
+            kernels[i].scale(1 / params_i.step_size());
+            kernels[j].scale(1 / params_j.step_size());
             separableConvolveMultiArray(si, shape, src, di, ElementAccessor(b, dest),
-                                        kernels.begin(), opt.from_point, opt.to_point);
+                                        kernels.begin(), opt);
         }
     }
 }
@@ -1786,6 +2357,252 @@ hessianOfGaussianMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & s
                                  dest.first, dest.second, sigma, opt );
 }
 
+/********************************************************/
+/*                                                      */
+/*          recursiveGaussianSmoothMultiArray           */
+/*                                                      */
+/********************************************************/
+
+/** \brief Recursive approximation of Gaussian smoothing of a multi-dimensional array.
+
+    This function computes the same result as \ref gaussianSmoothMultiArray(), 
+    but all axes are filtered with the recursive approximation of the Gaussian
+    by R. Deriche (fourth order, maximal error about 0.05% of the peak). Thus, the 
+    computation time per pixel does not depend on <tt>sigma</tt>, which makes this
+    function much faster than its exact counterpart at large scales. Use
+    \ref ConvolutionOptions::recursiveFilterThreshold() in order to switch
+    between the exact and the recursive filters automatically.
+    
+    Step sizes, resolution standard deviations, subarrays and the number of threads
+    are taken from the \ref ConvolutionOptions <tt>opt</tt> as usual. The 
+    array's extent must be at least 4 along every axis.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveGaussianSmoothMultiArray(SrcIterator siter, SrcShape const & shape, SrcAccessor src,
+                                          DestIterator diter, DestAccessor dest,
+                                          double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveGaussianSmoothMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                          pair<DestIterator, DestAccessor> const & dest,
+                                          double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_convolution.hxx\>
+
+    \code
+    MultiArray<3, float> source(shape), dest(shape);
+    ...
+    recursiveGaussianSmoothMultiArray(srcMultiArrayRange(source), destMultiArray(dest), 20.0);
+    
+    // equivalently: use the recursive filter whenever sigma >= 5 pixels
+    gaussianSmoothMultiArray(srcMultiArrayRange(source), destMultiArray(dest), 20.0,
+                             ConvolutionOptions<3>().recursiveFilterThreshold(5.0));
+    \endcode
+
+    \see gaussianSmoothMultiArray(), recursiveGaussianGradientMultiArray(), 
+          recursiveHessianOfGaussianMultiArray()
+*/
+doxygen_overloaded_function(template <...> void recursiveGaussianSmoothMultiArray)
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveGaussianSmoothMultiArray(SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                                  DestIterator d, DestAccessor dest, double sigma,
+                                  const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    ConvolutionOptions<SrcShape::static_size> par = opt;
+    gaussianSmoothMultiArray(s, shape, src, d, dest, 
+                             par.stdDev(sigma).recursiveFilterThreshold(0.0),
+                             "recursiveGaussianSmoothMultiArray");
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveGaussianSmoothMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                  pair<DestIterator, DestAccessor> const & dest, double sigma,
+                                  const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    recursiveGaussianSmoothMultiArray(source.first, source.second, source.third,
+                                      dest.first, dest.second, sigma, opt);
+}
+
+/********************************************************/
+/*                                                      */
+/*         recursiveGaussianGradientMultiArray          */
+/*                                                      */
+/********************************************************/
+
+/** \brief Recursive approximation of the Gaussian gradient of a multi-dimensional array.
+
+    This function computes the same result as \ref gaussianGradientMultiArray(), 
+    but all axes are filtered with the recursive approximation of the Gaussian
+    by R. Deriche, and derivatives are computed by central differences 
+    of the smoothed signal. The computation time per pixel does not depend on 
+    <tt>sigma</tt>. See \ref recursiveGaussianSmoothMultiArray() for details.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveGaussianGradientMultiArray(SrcIterator siter, SrcShape const & shape, SrcAccessor src,
+                                            DestIterator diter, DestAccessor dest,
+                                            double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveGaussianGradientMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                            pair<DestIterator, DestAccessor> const & dest,
+                                            double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_convolution.hxx\>
+
+    \code
+    MultiArray<3, float> source(shape);
+    MultiArray<3, TinyVector<float, 3> > gradient(shape);
+    ...
+    recursiveGaussianGradientMultiArray(srcMultiArrayRange(source), destMultiArray(gradient), 15.0);
+    \endcode
+
+    \see gaussianGradientMultiArray()
+*/
+doxygen_overloaded_function(template <...> void recursiveGaussianGradientMultiArray)
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveGaussianGradientMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor src,
+                                    DestIterator di, DestAccessor dest, double sigma,
+                                    const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    ConvolutionOptions<SrcShape::static_size> par = opt;
+    gaussianGradientMultiArray(si, shape, src, di, dest, 
+                               par.stdDev(sigma).recursiveFilterThreshold(0.0),
+                               "recursiveGaussianGradientMultiArray");
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveGaussianGradientMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                    pair<DestIterator, DestAccessor> const & dest, double sigma,
+                                    const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    recursiveGaussianGradientMultiArray(source.first, source.second, source.third,
+                                        dest.first, dest.second, sigma, opt);
+}
+
+/********************************************************/
+/*                                                      */
+/*         recursiveHessianOfGaussianMultiArray         */
+/*                                                      */
+/********************************************************/
+
+/** \brief Recursive approximation of the Hessian of Gaussian of a multi-dimensional array.
+
+    This function computes the same result as \ref hessianOfGaussianMultiArray(), 
+    but all axes are filtered with the recursive approximation of the Gaussian
+    by R. Deriche, and derivatives are computed by central differences 
+    of the smoothed signal. The computation time per pixel does not depend on 
+    <tt>sigma</tt>. See \ref recursiveGaussianSmoothMultiArray() for details.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveHessianOfGaussianMultiArray(SrcIterator siter, SrcShape const & shape, SrcAccessor src,
+                                             DestIterator diter, DestAccessor dest,
+                                             double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor>
+        void
+        recursiveHessianOfGaussianMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                             pair<DestIterator, DestAccessor> const & dest,
+                                             double sigma, const ConvolutionOptions<N> & opt);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_convolution.hxx\>
+
+    \code
+    MultiArray<3, float> source(shape);
+    MultiArray<3, TinyVector<float, 6> > hessian(shape);
+    ...
+    recursiveHessianOfGaussianMultiArray(srcMultiArrayRange(source), destMultiArray(hessian), 15.0);
+    \endcode
+
+    \see hessianOfGaussianMultiArray()
+*/
+doxygen_overloaded_function(template <...> void recursiveHessianOfGaussianMultiArray)
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveHessianOfGaussianMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor src,
+                                     DestIterator di, DestAccessor dest, double sigma,
+                                     const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    ConvolutionOptions<SrcShape::static_size> par = opt;
+    hessianOfGaussianMultiArray(si, shape, src, di, dest, 
+                                par.stdDev(sigma).recursiveFilterThreshold(0.0));
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+inline void
+recursiveHessianOfGaussianMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                     pair<DestIterator, DestAccessor> const & dest, double sigma,
+                                     const ConvolutionOptions<SrcShape::static_size> & opt = ConvolutionOptions<SrcShape::static_size>())
+{
+    recursiveHessianOfGaussianMultiArray(source.first, source.second, source.third,
+                                         dest.first, dest.second, sigma, opt);
+}
+
 namespace detail {
 
 template<int N, class VectorType>
@@ -1947,8 +2764,8 @@ structureTensorMultiArray(SrcIterator si, SrcShape const & shape, SrcAccessor sr
         gradientShape = innerOptions.to_point - innerOptions.from_point;
     }
 
-    MultiArray<N, GradientVector> gradient(gradientShape);
-    MultiArray<N, DestType> gradientTensor(gradientShape);
+    ScratchArray<N, GradientVector> gradient(gradientShape, opt.scratch_arena);
+    ScratchArray<N, DestType> gradientTensor(gradientShape, opt.scratch_arena);
     gaussianGradientMultiArray(si, shape, src, 
                                gradient.traverser_begin(), GradientAccessor(), 
                                innerOptions,
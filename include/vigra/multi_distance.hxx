@@ -39,14 +39,17 @@
 
 #include <vector>
 #include <functional>
+#include <limits>
 #include "array_vector.hxx"
 #include "multi_array.hxx"
+#include "multi_iterator_coupled.hxx"
 #include "accessor.hxx"
 #include "numerictraits.hxx"
 #include "navigator.hxx"
 #include "metaprogramming.hxx"
 #include "multi_pointoperators.hxx"
 #include "functorexpression.hxx"
+#include "threadpool.hxx"
 
 namespace vigra
 {
@@ -227,6 +230,186 @@ inline void internalSeparableMultiArrayDistTmp( SrcIterator si, SrcShape const &
     internalSeparableMultiArrayDistTmp( si, shape, src, di, dest, sigmas, false );
 }
 
+/********************************************************/
+/*                                                      */
+/*           FeatureTransformLinesFunctor               */
+/*                                                      */
+/********************************************************/
+
+    // Update the squared distances 'dist' and nearest object points 'features'
+    // along all lines parallel to 'axis'. Each line is replaced by the lower 
+    // envelope of the parabolas rooted at its elements (Felzenszwalb/Huttenlocher), 
+    // and every element inherits the nearest object point of the winning parabola.
+    // Elements with infinite distance (no object point found so far) do not
+    // contribute a parabola. The lines are distributed over the threads by slicing 
+    // along 'outer_axis', and each thread uses its own line buffers.
+template <unsigned int N>
+class FeatureTransformLinesFunctor
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef TinyVector<MultiArrayIndex, N> Feature;
+    typedef MultiArrayView<N, double, StridedArrayTag> DistArray;
+    typedef MultiArrayView<N, Feature, StridedArrayTag> FeatureArray;
+    typedef MultiArrayNavigator<typename DistArray::traverser, N> DNavigator;
+    typedef MultiArrayNavigator<typename FeatureArray::traverser, N> FNavigator;
+    
+    struct Buffer
+    {
+        ArrayVector<double> f, z;
+        ArrayVector<MultiArrayIndex> v;
+        ArrayVector<Feature> features;
+    };
+
+    FeatureTransformLinesFunctor(DistArray dist, FeatureArray features,
+                                 unsigned int axis, unsigned int outer_axis, double pitch,
+                                 ArrayVector<Buffer> & buffers)
+    : dist_(dist), features_(features),
+      axis_(axis), outer_axis_(outer_axis), pitch2_(sq(pitch)),
+      buffers_(buffers)
+    {}
+    
+        // process the lines in slice 'k' of the outer axis
+    void operator()(int threadId, MultiArrayIndex k) const
+    {
+        Shape start, stop(dist_.shape());
+        if(outer_axis_ != axis_)
+        {
+            start[outer_axis_] = k;
+            stop[outer_axis_]  = k + 1;
+        }
+        
+        DistArray dist(dist_);
+        FeatureArray features(features_);
+        DNavigator dnav(dist.traverser_begin(), start, stop, axis_);
+        FNavigator fnav(features.traverser_begin(), start, stop, axis_);
+        
+        Buffer & buffer = buffers_[threadId];
+        MultiArrayIndex n = dist_.shape(axis_);
+        buffer.f.resize(n);
+        buffer.z.resize(n+1);
+        buffer.v.resize(n);
+        buffer.features.resize(n);
+        
+        for(; dnav.hasMore(); dnav++, fnav++)
+            processLine(dnav.begin(), fnav.begin(), n, buffer);
+    }
+    
+    void processLine(typename DNavigator::iterator d, typename FNavigator::iterator fl,
+                     MultiArrayIndex n, Buffer & buffer) const
+    {
+        double inf = std::numeric_limits<double>::infinity();
+        double * f = buffer.f.begin(), * z = buffer.z.begin();
+        MultiArrayIndex * v = buffer.v.begin();
+        Feature * features = buffer.features.begin();
+        
+        for(MultiArrayIndex i = 0; i < n; ++i)
+        {
+            f[i] = d[i];
+            features[i] = fl[i];
+        }
+        
+        // compute the lower envelope of the finite parabolas
+        MultiArrayIndex k = -1;
+        for(MultiArrayIndex q = 0; q < n; ++q)
+        {
+            if(f[q] == inf)
+                continue;
+            double fq = f[q] + pitch2_*sq(double(q)), s = -inf;
+            for(; k >= 0; --k)
+            {
+                double r = double(v[k]);
+                s = (fq - f[v[k]] - pitch2_*sq(r)) / (2.0*pitch2_*(q - r));
+                if(s > z[k])
+                    break;
+            }
+            if(k < 0)
+                s = -inf;
+            ++k;
+            v[k] = q;
+            z[k] = s;
+        }
+        if(k < 0)
+            return; // no object point has been reached yet
+        z[k+1] = inf;
+        
+        // assign each element to the parabola that is lowest at its position
+        k = 0;
+        for(MultiArrayIndex x = 0; x < n; ++x)
+        {
+            while(z[k+1] < x)
+                ++k;
+            d[x]  = f[v[k]] + pitch2_*sq(double(x - v[k]));
+            fl[x] = features[v[k]];
+        }
+    }
+    
+    DistArray dist_;
+    FeatureArray features_;
+    unsigned int axis_, outer_axis_;
+    double pitch2_;
+    ArrayVector<Buffer> & buffers_;
+};
+
+/********************************************************/
+/*                                                      */
+/*          internalSeparableMultiFeatureTransform      */
+/*                                                      */
+/********************************************************/
+
+template <unsigned int N, class T1, class S1, class Array>
+void
+internalSeparableMultiFeatureTransform(MultiArrayView<N, T1, S1> const & source,
+                                       MultiArrayView<N, TinyVector<MultiArrayIndex, (int)N>, StridedArrayTag> features,
+                                       MultiArrayView<N, double, StridedArrayTag> dist,
+                                       bool background, Array const & pixelPitch, int nThreads)
+{
+    typedef FeatureTransformLinesFunctor<N> Functor;
+    typedef typename CoupledIteratorType<N, T1, typename Functor::Feature, double>::type Iterator;
+    
+    // object points are their own nearest object point, all other points 
+    // start at infinite distance
+    T1 zero = NumericTraits<T1>::zero();
+    double inf = std::numeric_limits<double>::infinity();
+    bool hasObjects = false;
+    Iterator i   = createCoupledIterator(source, features, dist),
+             end = i.getEndIterator();
+    for(; i != end; ++i)
+    {
+        if((i.template get<1>() != zero) == background)
+        {
+            i.template get<2>() = i.point();
+            i.template get<3>() = 0.0;
+            hasObjects = true;
+        }
+        else
+        {
+            i.template get<3>() = inf;
+        }
+    }
+    vigra_precondition(hasObjects,
+        "separableMultiFeatureTransform(): the array contains no object points.");
+    
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+    ArrayVector<typename Functor::Buffer> buffers(nThreads);
+    
+    for(unsigned int d = 0; d < N; ++d)
+    {
+        // distribute the slices of the longest remaining axis over the threads
+        unsigned int outer_axis = d;
+        for(unsigned int k = 0; k < N; ++k)
+            if(k != d && (outer_axis == d || source.shape(k) > source.shape(outer_axis)))
+                outer_axis = k;
+        MultiArrayIndex slices = outer_axis == d
+                                     ? 1
+                                     : source.shape(outer_axis);
+        
+        Functor f(dist, features, d, outer_axis, pixelPitch[d], buffers);
+        parallel_foreach(nThreads, slices, f);
+    }
+}
+
 } // namespace detail
 
 /** \addtogroup MultiArrayDistanceTransform Euclidean distance transform for multi-dimensional arrays.
@@ -552,6 +735,189 @@ inline void separableMultiDistance( triple<SrcIterator, SrcShape, SrcAccessor> c
                             dest.first, dest.second, background );
 }
 
+/********************************************************/
+/*                                                      */
+/*          separableMultiFeatureTransform              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Nearest object point for every element of a multi-dimensional array.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // explicitly specify pixel pitch for each coordinate and the number of threads
+        template <unsigned int N, class T1, class S1, class S2, class Array>
+        void 
+        separableMultiFeatureTransform(MultiArrayView<N, T1, S1> const & source,
+                                       MultiArrayView<N, TinyVector<MultiArrayIndex, N>, S2> dest,
+                                       bool background,
+                                       Array const & pixelPitch, int nThreads = 1);
+                                        
+        // use default pixel pitch = 1.0 for each coordinate
+        template <unsigned int N, class T1, class S1, class S2>
+        void 
+        separableMultiFeatureTransform(MultiArrayView<N, T1, S1> const & source,
+                                       MultiArrayView<N, TinyVector<MultiArrayIndex, N>, S2> dest,
+                                       bool background);
+    }
+    \endcode
+
+    This function computes the feature transform (also known as nearest-neighbor
+    or Voronoi transform) of the given array: every element of 'dest' receives 
+    the coordinates of the object point which is closest to it in the Euclidean 
+    sense. Object points (which map onto themselves) are determined exactly as in 
+    \ref separableMultiDistSquared(): if <tt>background == true</tt>, all non-zero 
+    elements of 'source' are object points, otherwise all zero elements. When 
+    several object points are equally close, one of them is chosen arbitrarily.
+    
+    The result is computed in the same linear-time separable pass as 
+    \ref separableMultiDistSquared() (the nearest object point is carried along
+    with the lower envelope of parabolas), so it is much faster than seeded region 
+    growing. Anisotropic data are supported via 'pixelPitch', which must provide
+    the spacing along each axis. The lines along each axis are distributed over 
+    'nThreads' threads (<tt>nThreads <= 0</tt> means \ref defaultConcurrency()); 
+    the result does not depend on the number of threads.
+    
+    Since the coordinates of the nearest object point are returned, the feature
+    transform can be used to propagate object properties, e.g. to compute a Voronoi
+    tessellation of a label array via <tt>labels[dest[p]]</tt>. The (squared) 
+    Euclidean distance of element 'p' is <tt>(pixelPitch*(dest[p] - p)).squaredMagnitude()</tt>.
+    See \ref separableMultiVectorDistance() if only the offset is needed.
+    
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_distance.hxx\>
+
+    \code
+    MultiArray<3, UInt32> labels(Shape3(width, height, depth));
+    MultiArray<3, TinyVector<MultiArrayIndex, 3> > nearest(labels.shape());
+    ...
+
+    // find the nearest seed for every voxel, using 4 threads
+    separableMultiFeatureTransform(labels, nearest, true, TinyVector<double, 3>(1.0, 1.0, 2.5), 4);
+    
+    // assign every voxel to the region of its nearest seed
+    MultiArray<3, UInt32> voronoi(labels.shape());
+    for(MultiArrayIndex k=0; k<labels.size(); ++k)
+        voronoi[k] = labels[nearest[k]];
+    \endcode
+
+    <b> Required Interface:</b>
+    
+    \code
+    T1 v;
+    v != NumericTraits<T1>::zero();
+    \endcode
+
+    \see vigra::separableMultiDistSquared(), vigra::separableMultiVectorDistance()
+*/
+doxygen_overloaded_function(template <...> void separableMultiFeatureTransform)
+
+template <unsigned int N, class T1, class S1, class S2, class Array>
+void
+separableMultiFeatureTransform(MultiArrayView<N, T1, S1> const & source,
+                               MultiArrayView<N, TinyVector<MultiArrayIndex, (int)N>, S2> dest,
+                               bool background,
+                               Array const & pixelPitch, int nThreads = 1)
+{
+    vigra_precondition(source.shape() == dest.shape(),
+        "separableMultiFeatureTransform(): shape mismatch between input and output.");
+
+    MultiArray<N, double> dist(source.shape());
+    detail::internalSeparableMultiFeatureTransform(source, 
+                         MultiArrayView<N, TinyVector<MultiArrayIndex, N>, StridedArrayTag>(dest), 
+                         MultiArrayView<N, double, StridedArrayTag>(dist), 
+                         background, pixelPitch, nThreads);
+}
+
+template <unsigned int N, class T1, class S1, class S2>
+inline void
+separableMultiFeatureTransform(MultiArrayView<N, T1, S1> const & source,
+                               MultiArrayView<N, TinyVector<MultiArrayIndex, (int)N>, S2> dest,
+                               bool background)
+{
+    separableMultiFeatureTransform(source, dest, background, TinyVector<double, N>(1.0));
+}
+
+/********************************************************/
+/*                                                      */
+/*          separableMultiVectorDistance                */
+/*                                                      */
+/********************************************************/
+
+/** \brief Offset to the nearest object point on multi-dimensional arrays.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // explicitly specify pixel pitch for each coordinate and the number of threads
+        template <unsigned int N, class T1, class S1, class S2, class Array>
+        void 
+        separableMultiVectorDistance(MultiArrayView<N, T1, S1> const & source,
+                                     MultiArrayView<N, TinyVector<MultiArrayIndex, N>, S2> dest,
+                                     bool background,
+                                     Array const & pixelPitch, int nThreads = 1);
+                                        
+        // use default pixel pitch = 1.0 for each coordinate
+        template <unsigned int N, class T1, class S1, class S2>
+        void 
+        separableMultiVectorDistance(MultiArrayView<N, T1, S1> const & source,
+                                     MultiArrayView<N, TinyVector<MultiArrayIndex, N>, S2> dest,
+                                     bool background);
+    }
+    \endcode
+
+    This function computes the vector distance transform: every element 'p' of 
+    'dest' receives the offset <tt>q - p</tt> (in pixels) to the nearest object point 
+    <tt>q</tt>. It is identical to \ref separableMultiFeatureTransform() (see there 
+    for the meaning of the arguments), except that the element's own coordinates
+    are subtracted from the result. Object points therefore get the offset zero,
+    and the squared Euclidean distance is <tt>(pixelPitch*dest[p]).squaredMagnitude()</tt>.
+    
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_distance.hxx\>
+
+    \code
+    MultiArray<2, unsigned char> mask(Shape2(width, height));
+    MultiArray<2, TinyVector<MultiArrayIndex, 2> > offsets(mask.shape());
+    ...
+
+    separableMultiVectorDistance(mask, offsets, true);
+    \endcode
+
+    \see vigra::separableMultiDistSquared(), vigra::separableMultiFeatureTransform()
+*/
+doxygen_overloaded_function(template <...> void separableMultiVectorDistance)
+
+template <unsigned int N, class T1, class S1, class S2, class Array>
+void
+separableMultiVectorDistance(MultiArrayView<N, T1, S1> const & source,
+                             MultiArrayView<N, TinyVector<MultiArrayIndex, (int)N>, S2> dest,
+                             bool background,
+                             Array const & pixelPitch, int nThreads = 1)
+{
+    separableMultiFeatureTransform(source, dest, background, pixelPitch, nThreads);
+    
+    typedef typename CoupledIteratorType<N, TinyVector<MultiArrayIndex, N> >::type Iterator;
+    Iterator i   = createCoupledIterator(dest),
+             end = i.getEndIterator();
+    for(; i != end; ++i)
+        i.template get<1>() -= i.point();
+}
+
+template <unsigned int N, class T1, class S1, class S2>
+inline void
+separableMultiVectorDistance(MultiArrayView<N, T1, S1> const & source,
+                             MultiArrayView<N, TinyVector<MultiArrayIndex, (int)N>, S2> dest,
+                             bool background)
+{
+    separableMultiVectorDistance(source, dest, background, TinyVector<double, N>(1.0));
+}
+
 //@}
 
 } //-- namespace vigra
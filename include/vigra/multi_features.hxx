@@ -0,0 +1,654 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_MULTI_FEATURES_HXX
+#define VIGRA_MULTI_FEATURES_HXX
+
+#include <cmath>
+#include <algorithm>
+#include "config.hxx"
+#include "error.hxx"
+#include "array_vector.hxx"
+#include "tinyvector.hxx"
+#include "mathutil.hxx"
+#include "metaprogramming.hxx"
+#include "multi_array.hxx"
+#include "multi_convolution.hxx"
+
+namespace vigra {
+
+/** \addtogroup MultiArrayConvolutionFilters
+*/
+//@{
+
+    /** \brief Pixel features computed by \ref vigra::PixelFeatureBank.
+
+        <b>\#include</b> \<vigra/multi_features.hxx\><br>
+        Namespace: vigra
+    */
+enum PixelFeature
+{
+    FEATURE_GAUSSIAN_SMOOTHING,             ///< 1 channel, see gaussianSmoothMultiArray()
+    FEATURE_GRADIENT_MAGNITUDE,             ///< 1 channel, see gaussianGradientMultiArray()
+    FEATURE_LAPLACIAN_OF_GAUSSIAN,          ///< 1 channel, see laplacianOfGaussianMultiArray()
+    FEATURE_STRUCTURE_TENSOR_EIGENVALUES,   ///< N channels, see structureTensorMultiArray()
+    FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES ///< N channels, see hessianOfGaussianMultiArray()
+};
+
+namespace detail {
+
+template <class Tensor, class Result>
+inline void
+featureEigenvalues(Tensor const & t, Result & r, MetaInt<1>)
+{
+    r[0] = t[0];
+}
+
+template <class Tensor, class Result>
+inline void
+featureEigenvalues(Tensor const & t, Result & r, MetaInt<2>)
+{
+    symmetric2x2Eigenvalues(t[0], t[1], t[2], &r[0], &r[1]);
+}
+
+template <class Tensor, class Result>
+inline void
+featureEigenvalues(Tensor const & t, Result & r, MetaInt<3>)
+{
+    symmetric3x3Eigenvalues(t[0], t[1], t[2], t[3], t[4], t[5], &r[0], &r[1], &r[2]);
+}
+
+template <class Tensor, class Result, int N>
+inline void
+featureEigenvalues(Tensor const &, Result &, MetaInt<N>)
+{
+    vigra_fail("PixelFeatureBank::compute(): Sorry, eigenvalue features can only be computed up to dimension 3.");
+}
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                   PixelFeatureBank                   */
+/*                                                      */
+/********************************************************/
+
+    /** \brief Compute many Gaussian pixel features at once.
+
+        Typical pixel classification pipelines compute a bank of filter responses
+        (smoothed intensity, gradient magnitude, Laplacian of Gaussian, eigenvalues
+        of structure tensor and Hessian) at several scales. Calling the individual
+        filter functions repeats much of the work: the smoothing along the first axes
+        is the same for many derivatives, and the same scale is often used by several
+        features. PixelFeatureBank collects a list of (feature, scale) pairs and plans
+        a shared computation:
+
+        <ul>
+        <li> All features at the same scale share their separable filter passes. The
+             required partial derivatives are arranged in a prefix tree over the axes,
+             so that each distinct combination of derivative orders along axes
+             <tt>0...k</tt> is filtered only once.
+        <li> Scales are processed in ascending order. The smoothed image at scale
+             <tt>s1</tt> is used as input for scale <tt>s2 > s1</tt>, which then only
+             requires the residual scale <tt>sqrt(s2*s2 - s1*s1)</tt>. Since sampled
+             Gaussian kernels become inaccurate for very small scales, this incremental
+             smoothing is only applied when the residual scale is at least
+             \ref minimumIncrementalScale() (default: 1.0 pixels) along every axis.
+        <li> All results are written directly into a single <tt>float</tt> array with
+             the channels along axis 0, i.e. the channels of each pixel are stored
+             contiguously (interleaved).
+        </ul>
+
+        The channels are arranged in the order in which the features were
+        \ref add()ed. Scalar features occupy one channel, eigenvalue features
+        N channels with the eigenvalues in descending order. The ConvolutionOptions
+        passed to \ref compute() determine step sizes, resolution standard deviations,
+        the window ratio, the recursive filter threshold, and the number of threads
+        used for each filter pass (the subarray option is ignored). Up to rounding
+        errors and the incremental smoothing, the results are identical to those
+        of the corresponding individual filter functions.
+
+        <b>Usage:</b>
+
+        <b>\#include</b> \<vigra/multi_features.hxx\><br>
+        Namespace: vigra
+
+        \code
+        MultiArray<3, UInt8> volume(shape);
+        ...
+        PixelFeatureBank<3> bank;
+        double scales[] = { 0.7, 1.0, 1.6, 3.5, 5.0 };
+        for(int k=0; k<5; ++k)
+        {
+            bank.add(FEATURE_GAUSSIAN_SMOOTHING, scales[k])
+                .add(FEATURE_GRADIENT_MAGNITUDE, scales[k])
+                .add(FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES, scales[k]);
+        }
+
+        MultiArray<4, float> features(Shape4(bank.numberOfChannels(),
+                                             shape[0], shape[1], shape[2]));
+        bank.compute(volume, features, ConvolutionOptions<3>().numThreads(4));
+        \endcode
+    */
+template <unsigned int N>
+class PixelFeatureBank
+{
+  public:
+        /** Shape of the source array.
+        */
+    typedef typename MultiArrayShape<N>::type Shape;
+
+        /** Shape of the feature array.
+        */
+    typedef typename MultiArrayShape<N+1>::type FeatureShape;
+
+        /** Order of the partial derivative along each axis.
+        */
+    typedef TinyVector<int, N> DerivativeOrder;
+
+        /** Create an empty feature bank.
+        */
+    PixelFeatureBank()
+    : min_incremental_scale_(1.0)
+    {}
+
+        /** Add a feature at the given scale. For \ref FEATURE_STRUCTURE_TENSOR_EIGENVALUES,
+            \a scale is the inner scale (of the gradient) and \a outerScale the scale
+            of the tensor smoothing, which defaults to <tt>0.5*scale</tt>. \a outerScale
+            is ignored for the other features.
+        */
+    PixelFeatureBank & add(PixelFeature feature, double scale, double outerScale = 0.0)
+    {
+        vigra_precondition(scale > 0.0,
+            "PixelFeatureBank::add(): scale must be positive.");
+        vigra_precondition(outerScale >= 0.0,
+            "PixelFeatureBank::add(): outer scale must not be negative.");
+        if(feature != FEATURE_STRUCTURE_TENSOR_EIGENVALUES)
+            outerScale = 0.0;
+        else if(outerScale == 0.0)
+            outerScale = 0.5*scale;
+        features_.push_back(Entry(feature, scale, outerScale));
+        return *this;
+    }
+
+        /** Smallest residual scale (in pixels) for which a feature scale is computed
+            from the smoothed result of a smaller scale rather than from the source.
+            Pass <tt>NumericTraits<double>::max()</tt> to disable incremental smoothing.
+        */
+    PixelFeatureBank & minimumIncrementalScale(double s)
+    {
+        vigra_precondition(s > 0.0,
+            "PixelFeatureBank::minimumIncrementalScale(): scale must be positive.");
+        min_incremental_scale_ = s;
+        return *this;
+    }
+
+        /** Number of features added so far.
+        */
+    unsigned int size() const
+    {
+        return features_.size();
+    }
+
+        /** The k-th feature.
+        */
+    PixelFeature feature(unsigned int k) const
+    {
+        return features_[k].feature;
+    }
+
+        /** Scale of the k-th feature.
+        */
+    double scale(unsigned int k) const
+    {
+        return features_[k].scale;
+    }
+
+        /** Outer scale of the k-th feature (0 if it is not a structure tensor feature).
+        */
+    double outerScale(unsigned int k) const
+    {
+        return features_[k].outer_scale;
+    }
+
+        /** Number of channels of the k-th feature.
+        */
+    unsigned int channelCount(unsigned int k) const
+    {
+        return isTensorFeature(features_[k].feature)
+                   ? N
+                   : 1;
+    }
+
+        /** Index of the first channel of the k-th feature.
+        */
+    unsigned int channelOffset(unsigned int k) const
+    {
+        unsigned int c = 0;
+        for(unsigned int j=0; j<k; ++j)
+            c += channelCount(j);
+        return c;
+    }
+
+        /** Total number of channels, i.e. the required size of axis 0
+            of the feature array.
+        */
+    unsigned int numberOfChannels() const
+    {
+        return channelOffset(size());
+    }
+
+        /** Number of 1-dimensional filter passes over the whole array that
+            \ref compute() will perform with the given options.
+        */
+    unsigned int numberOfFilterPasses(ConvolutionOptions<N> const & opt = ConvolutionOptions<N>()) const
+    {
+        ArrayVector<Level> levels;
+        plan(opt, levels);
+        unsigned int passes = 0;
+        for(unsigned int l=0; l<levels.size(); ++l)
+        {
+            Level const & level = levels[l];
+            for(unsigned int axis=0; axis<N; ++axis)
+            {
+                ArrayVector<DerivativeOrder> prefixes;
+                for(unsigned int k=0; k<level.orders.size(); ++k)
+                {
+                    DerivativeOrder p(0);
+                    for(unsigned int j=0; j<=axis; ++j)
+                        p[j] = level.orders[k][j];
+                    if(std::find(prefixes.begin(), prefixes.end(), p) == prefixes.end())
+                        prefixes.push_back(p);
+                }
+                passes += prefixes.size();
+            }
+        }
+        for(unsigned int k=0; k<size(); ++k)
+            if(features_[k].feature == FEATURE_STRUCTURE_TENSOR_EIGENVALUES)
+                passes += N;
+        return passes;
+    }
+
+        /** The scale whose smoothed result \ref compute() uses as input for the
+            features at \a scale, or 0.0 if they are computed from the source array
+            (see \ref minimumIncrementalScale()). \a scale must be one of the
+            scales of the added features.
+        */
+    double incrementalBaseScale(double scale, ConvolutionOptions<N> const & opt = ConvolutionOptions<N>()) const
+    {
+        ArrayVector<Level> levels;
+        plan(opt, levels);
+        for(unsigned int l=0; l<levels.size(); ++l)
+            if(levels[l].scale == scale)
+                return levels[l].base < 0
+                           ? 0.0
+                           : levels[levels[l].base].scale;
+        vigra_precondition(false,
+            "PixelFeatureBank::incrementalBaseScale(): no feature with this scale.");
+        return 0.0;
+    }
+
+        /** Compute all features of \a src and write them into \a features.
+            \a features must have shape <tt>(numberOfChannels(), src.shape(0), ..., src.shape(N-1))</tt>.
+        */
+    template <class T, class S1, class S2>
+    void compute(MultiArrayView<N, T, S1> const & src,
+                 MultiArrayView<N+1, float, S2> features,
+                 ConvolutionOptions<N> const & opt = ConvolutionOptions<N>()) const
+    {
+        Shape shape(src.shape());
+        vigra_precondition(features.shape(0) == (MultiArrayIndex)numberOfChannels(),
+            "PixelFeatureBank::compute(): feature array has wrong number of channels.");
+        for(unsigned int k=0; k<N; ++k)
+            vigra_precondition(features.shape(k+1) == shape[k],
+                "PixelFeatureBank::compute(): shape mismatch between input and output.");
+        for(unsigned int k=0; k<N; ++k)
+            if(shape[k] <= 0)
+                return;
+
+        ArrayVector<Level> levels;
+        plan(opt, levels);
+
+        ArrayVector<MultiArray<N, float> > smoothed(levels.size());
+        for(unsigned int l=0; l<levels.size(); ++l)
+        {
+            Level const & level = levels[l];
+            ArrayVector<MultiArray<N, float> > results(level.orders.size());
+            if(level.base < 0)
+                filterAxis(src.traverser_begin(), StandardConstValueAccessor<T>(), shape,
+                           level, 0, DerivativeOrder(0), results, opt);
+            else
+                filterAxis(smoothed[level.base].traverser_begin(), StandardConstValueAccessor<float>(), shape,
+                           level, 0, DerivativeOrder(0), results, opt);
+
+            for(unsigned int k=0; k<size(); ++k)
+                if(features_[k].scale == level.scale)
+                    computeFeature(k, level, results, features, opt);
+
+            if(level.keep)
+                smoothed[l].swap(results[orderIndex(level, DerivativeOrder(0))]);
+            // release smoothed images that are no longer needed
+            for(unsigned int j=0; j<l; ++j)
+            {
+                bool used = false;
+                for(unsigned int i=l+1; i<levels.size(); ++i)
+                    if(levels[i].base == (int)j)
+                        used = true;
+                if(!used)
+                    MultiArray<N, float>().swap(smoothed[j]);
+            }
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        Entry(PixelFeature f = FEATURE_GAUSSIAN_SMOOTHING, double s = 0.0, double o = 0.0)
+        : feature(f), scale(s), outer_scale(o)
+        {}
+
+        PixelFeature feature;
+        double scale, outer_scale;
+    };
+
+        // all computations at the same (inner) scale
+    struct Level
+    {
+        double scale;
+        int base;                        // level providing the input, -1 for the source
+        TinyVector<double, N> sigma;     // effective scale per axis in pixels
+        TinyVector<double, N> residual;  // scale of the filters applied to the input
+        ArrayVector<DerivativeOrder> orders;
+        bool keep;                       // smoothed result is the input of a later level
+    };
+
+    static bool isTensorFeature(PixelFeature f)
+    {
+        return f == FEATURE_STRUCTURE_TENSOR_EIGENVALUES ||
+               f == FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES;
+    }
+
+    static DerivativeOrder unitOrder(unsigned int a, unsigned int b)
+    {
+        DerivativeOrder o(0);
+        ++o[a];
+        ++o[b];
+        return o;
+    }
+
+    static DerivativeOrder unitOrder(unsigned int a)
+    {
+        DerivativeOrder o(0);
+        ++o[a];
+        return o;
+    }
+
+    static int orderIndex(Level const & level, DerivativeOrder const & o)
+    {
+        return std::find(level.orders.begin(), level.orders.end(), o) - level.orders.begin();
+    }
+
+    static void require(Level & level, DerivativeOrder const & o)
+    {
+        if(std::find(level.orders.begin(), level.orders.end(), o) == level.orders.end())
+            level.orders.push_back(o);
+    }
+
+    void plan(ConvolutionOptions<N> const & opt, ArrayVector<Level> & levels) const
+    {
+        ArrayVector<double> scales;
+        for(unsigned int k=0; k<size(); ++k)
+            scales.push_back(features_[k].scale);
+        std::sort(scales.begin(), scales.end());
+        scales.erase(std::unique(scales.begin(), scales.end()), scales.end());
+
+        for(unsigned int l=0; l<scales.size(); ++l)
+        {
+            Level level;
+            level.scale = scales[l];
+            level.keep = false;
+            ConvolutionOptions<N> o(opt);
+            typename ConvolutionOptions<N>::ScaleIterator params = o.stdDev(scales[l]).scaleParams();
+            for(unsigned int k=0; k<N; ++k, ++params)
+                level.sigma[k] = params.sigma_scaled("PixelFeatureBank::compute");
+
+            // use the largest smaller scale whose residual is big enough
+            level.base = -1;
+            level.residual = level.sigma;
+            for(int j=(int)l-1; j>=0 && level.base < 0; --j)
+            {
+                TinyVector<double, N> residual;
+                bool ok = true;
+                for(unsigned int k=0; k<N; ++k)
+                {
+                    residual[k] = std::sqrt(sq(level.sigma[k]) - sq(levels[j].sigma[k]));
+                    if(!(residual[k] >= min_incremental_scale_))
+                        ok = false;
+                }
+                if(ok)
+                {
+                    level.base = j;
+                    level.residual = residual;
+                }
+            }
+            levels.push_back(level);
+        }
+
+        for(unsigned int k=0; k<size(); ++k)
+        {
+            Level & level = levels[std::find(scales.begin(), scales.end(), features_[k].scale) - scales.begin()];
+            switch(features_[k].feature)
+            {
+              case FEATURE_GAUSSIAN_SMOOTHING:
+                require(level, DerivativeOrder(0));
+                break;
+              case FEATURE_GRADIENT_MAGNITUDE:
+              case FEATURE_STRUCTURE_TENSOR_EIGENVALUES:
+                for(unsigned int a=0; a<N; ++a)
+                    require(level, unitOrder(a));
+                break;
+              case FEATURE_LAPLACIAN_OF_GAUSSIAN:
+                for(unsigned int a=0; a<N; ++a)
+                    require(level, unitOrder(a, a));
+                break;
+              case FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES:
+                for(unsigned int a=0; a<N; ++a)
+                    for(unsigned int b=a; b<N; ++b)
+                        require(level, unitOrder(a, b));
+                break;
+            }
+        }
+
+        for(unsigned int l=0; l<levels.size(); ++l)
+        {
+            if(levels[l].base >= 0)
+            {
+                levels[levels[l].base].keep = true;
+                require(levels[levels[l].base], DerivativeOrder(0));
+            }
+        }
+    }
+
+        // Filter along 'axis' with all derivative orders that are needed
+        // after 'prefix' (the orders along the preceding axes), and recurse.
+    template <class SrcIterator, class SrcAccessor>
+    void filterAxis(SrcIterator si, SrcAccessor src, Shape const & shape,
+                    Level const & level, unsigned int axis, DerivativeOrder prefix,
+                    ArrayVector<MultiArray<N, float> > & results,
+                    ConvolutionOptions<N> const & opt) const
+    {
+        typename ConvolutionOptions<N>::StepIterator step = opt.stepParams();
+        for(unsigned int k=0; k<axis; ++k)
+            ++step;
+
+        for(int order=0; order<=2; ++order)
+        {
+            bool needed = false;
+            for(unsigned int k=0; k<level.orders.size() && !needed; ++k)
+            {
+                needed = level.orders[k][axis] == order;
+                for(unsigned int j=0; j<axis; ++j)
+                    if(level.orders[k][j] != prefix[j])
+                        needed = false;
+            }
+            if(!needed)
+                continue;
+
+            double sigma = level.residual[axis];
+            detail::GaussianLineFilter<float> filter;
+            filter.init(sigma, order, opt.window_ratio, opt.useRecursiveFilter(sigma));
+            if(order > 0)
+                filter.scale(1.0 / std::pow(*step, order));
+
+            MultiArray<N, float> tmp(shape);
+            detail::convolveLinesAlongAxis(si, Shape(), shape, src,
+                                           tmp.traverser_begin(), Shape(), shape, StandardValueAccessor<float>(),
+                                           axis, filter, 0, 0, 0, opt.n_threads);
+            prefix[axis] = order;
+            if(axis == N-1)
+                results[orderIndex(level, prefix)].swap(tmp);
+            else
+                filterAxis(tmp.traverser_begin(), StandardConstValueAccessor<float>(), shape,
+                           level, axis+1, prefix, results, opt);
+        }
+    }
+
+    template <class S>
+    void computeFeature(unsigned int k, Level const & level,
+                        ArrayVector<MultiArray<N, float> > & results,
+                        MultiArrayView<N+1, float, S> features,
+                        ConvolutionOptions<N> const & opt) const
+    {
+        enum { TensorSize = N*(N+1)/2 };
+        typedef TinyVector<float, TensorSize> Tensor;
+        typedef TinyVector<float, N> Eigenvalues;
+        typedef typename MultiArrayView<N, float, StridedArrayTag>::iterator ChannelIterator;
+
+        unsigned int c = channelOffset(k);
+        MultiArrayIndex size = results[0].size();
+        ArrayVector<ChannelIterator> channels;
+        for(unsigned int j=0; j<channelCount(k); ++j)
+            channels.push_back(features.bindInner(MultiArrayIndex(c + j)).begin());
+
+        switch(features_[k].feature)
+        {
+          case FEATURE_GAUSSIAN_SMOOTHING:
+          {
+            float const * s = results[orderIndex(level, DerivativeOrder(0))].data();
+            for(MultiArrayIndex i=0; i<size; ++i, ++channels[0])
+                *channels[0] = s[i];
+            break;
+          }
+          case FEATURE_GRADIENT_MAGNITUDE:
+          case FEATURE_LAPLACIAN_OF_GAUSSIAN:
+          {
+            bool gradient = features_[k].feature == FEATURE_GRADIENT_MAGNITUDE;
+            ArrayVector<float const *> d;
+            for(unsigned int a=0; a<N; ++a)
+                d.push_back(results[orderIndex(level, gradient ? unitOrder(a) : unitOrder(a, a))].data());
+            for(MultiArrayIndex i=0; i<size; ++i, ++channels[0])
+            {
+                float sum = 0.0f;
+                for(unsigned int a=0; a<N; ++a)
+                    sum += gradient
+                               ? sq(d[a][i])
+                               : d[a][i];
+                *channels[0] = gradient
+                                   ? std::sqrt(sum)
+                                   : sum;
+            }
+            break;
+          }
+          case FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES:
+          {
+            ArrayVector<float const *> d;
+            for(unsigned int a=0; a<N; ++a)
+                for(unsigned int b=a; b<N; ++b)
+                    d.push_back(results[orderIndex(level, unitOrder(a, b))].data());
+            Tensor t;
+            Eigenvalues e;
+            for(MultiArrayIndex i=0; i<size; ++i)
+            {
+                for(int j=0; j<TensorSize; ++j)
+                    t[j] = d[j][i];
+                detail::featureEigenvalues(t, e, MetaInt<N>());
+                for(unsigned int j=0; j<N; ++j)
+                {
+                    *channels[j] = e[j];
+                    ++channels[j];
+                }
+            }
+            break;
+          }
+          case FEATURE_STRUCTURE_TENSOR_EIGENVALUES:
+          {
+            ArrayVector<float const *> d;
+            for(unsigned int a=0; a<N; ++a)
+                d.push_back(results[orderIndex(level, unitOrder(a))].data());
+            MultiArray<N, Tensor> tensor(results[0].shape());
+            for(MultiArrayIndex i=0; i<size; ++i)
+                for(unsigned int a=0, j=0; a<N; ++a)
+                    for(unsigned int b=a; b<N; ++b, ++j)
+                        tensor.data()[i][j] = d[a][i]*d[b][i];
+
+            ConvolutionOptions<N> outer(opt);
+            gaussianSmoothMultiArray(srcMultiArrayRange(tensor), destMultiArray(tensor),
+                                     outer.stdDev(features_[k].outer_scale).resolutionStdDev(0.0)
+                                          .subarray(Shape(), Shape()));
+            Eigenvalues e;
+            for(MultiArrayIndex i=0; i<size; ++i)
+            {
+                detail::featureEigenvalues(tensor.data()[i], e, MetaInt<N>());
+                for(unsigned int j=0; j<N; ++j)
+                {
+                    *channels[j] = e[j];
+                    ++channels[j];
+                }
+            }
+            break;
+          }
+        }
+    }
+
+    ArrayVector<Entry> features_;
+    double min_incremental_scale_;
+};
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_FEATURES_HXX
@@ -36,10 +36,19 @@
 #ifndef VIGRA_MULTI_FFT_HXX
 #define VIGRA_MULTI_FFT_HXX
 
+#include <cmath>
+#include <list>
+#include <string>
 #include "fftw3.hxx"
 #include "multi_array.hxx"
 #include "navigator.hxx"
 #include "copyimage.hxx"
+#include "stdconvolution.hxx"
+#include "multi_convolution.hxx"
+
+#ifdef VIGRA_HAS_STD_THREAD
+#include <mutex>
+#endif
 
 namespace vigra {
 
@@ -364,6 +373,258 @@ fftwPlanExecute(fftwl_plan plan, FFTWComplex<long double> * in,  long double * o
     fftwl_execute_dft_c2r(plan, (fftwl_complex *)in, out);
 }
 
+inline int fftwAlignmentOf(double * p)
+{
+    return fftw_alignment_of(p);
+}
+
+inline int fftwAlignmentOf(float * p)
+{
+    return fftwf_alignment_of(p);
+}
+
+inline int fftwAlignmentOf(long double * p)
+{
+    return fftwl_alignment_of(p);
+}
+
+    // Multi-threaded planning requires the FFTW threads libraries, which are 
+    // only used when VIGRA_FFTW_THREADS is defined. Must be called with the 
+    // planner lock held.
+inline void fftwPlanWithNThreads(double *, int nThreads)
+{
+#ifdef VIGRA_FFTW_THREADS
+    static bool initialized = fftw_init_threads() != 0;
+    if(initialized)
+        fftw_plan_with_nthreads(nThreads);
+#else
+    (void)nThreads;
+#endif
+}
+
+inline void fftwPlanWithNThreads(float *, int nThreads)
+{
+#ifdef VIGRA_FFTW_THREADS
+    static bool initialized = fftwf_init_threads() != 0;
+    if(initialized)
+        fftwf_plan_with_nthreads(nThreads);
+#else
+    (void)nThreads;
+#endif
+}
+
+inline void fftwPlanWithNThreads(long double *, int nThreads)
+{
+#ifdef VIGRA_FFTW_THREADS
+    static bool initialized = fftwl_init_threads() != 0;
+    if(initialized)
+        fftwl_plan_with_nthreads(nThreads);
+#else
+    (void)nThreads;
+#endif
+}
+
+#ifdef VIGRA_HAS_STD_THREAD
+inline std::mutex & fftwPlannerMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+#endif
+
+    // FFTW's planner (including wisdom handling and plan destruction) is not 
+    // thread-safe, whereas the execution of plans is. All planner calls are
+    // therefore protected by a single process-wide lock.
+class FFTWPlannerLock
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    std::lock_guard<std::mutex> lock_;
+    
+  public:
+    FFTWPlannerLock()
+    : lock_(fftwPlannerMutex())
+    {}
+#endif
+};
+
+    // Everything that determines if a plan can be reused: FFTW plans may be 
+    // executed on new arrays when the shapes, strides, and memory alignment 
+    // are the same, and the transform is in-place iff the original one was.
+struct FFTWPlanKey
+{
+    ArrayVector<int> shape, itotal, ototal;
+    int kind, sign, istride, ostride, ialign, oalign, nThreads;
+    unsigned int flags;
+    bool inPlace;
+    
+    bool operator==(FFTWPlanKey const & o) const
+    {
+        return kind == o.kind && sign == o.sign && flags == o.flags && 
+               istride == o.istride && ostride == o.ostride && 
+               ialign == o.ialign && oalign == o.oalign && 
+               inPlace == o.inPlace && nThreads == o.nThreads &&
+               shape == o.shape && itotal == o.itotal && ototal == o.ototal;
+    }
+};
+
+    // The caches register themselves on first use, so that fftwClearPlanCache()
+    // only refers to the FFTW libraries (double, float, long double) which are 
+    // actually used by the program.
+    //
+    // The caches and the registry are allocated on the heap and never destroyed:
+    // FFTWPlan objects with static storage duration may release their plans 
+    // after a function-local static cache would already have been destroyed, 
+    // and destroying the remaining plans at exit would call into FFTW after 
+    // the application may have called fftw_cleanup(). The operating system
+    // reclaims the plans' memory when the process terminates.
+class FFTWPlanCacheBase
+{
+  public:
+    virtual ~FFTWPlanCacheBase()
+    {}
+    
+    virtual std::size_t clear() = 0;
+    virtual std::size_t size() const = 0;
+    virtual void trim() = 0;
+    
+    static ArrayVector<FFTWPlanCacheBase *> & registry()
+    {
+        static ArrayVector<FFTWPlanCacheBase *> * caches = new ArrayVector<FFTWPlanCacheBase *>();
+        return *caches;
+    }
+    
+        // maximum number of unused plans kept per cache
+    static std::size_t & unusedLimit()
+    {
+        static std::size_t limit = 64;
+        return limit;
+    }
+};
+
+    // Process-wide cache of the plans created by FFTWPlan. Plans are reference
+    // counted. When they are no longer used, they stay in the cache until 
+    // fftwClearPlanCache() is called or more than unusedLimit() unused plans
+    // have accumulated, in which case the least recently used ones are destroyed.
+    // The list is kept in least-recently-used order. All functions must be 
+    // called with the planner lock held.
+template <class PlanType>
+class FFTWPlanCache
+: public FFTWPlanCacheBase
+{
+    struct Entry
+    {
+        FFTWPlanKey key;
+        PlanType plan;
+        int refcount;
+    };
+    
+    typedef typename std::list<Entry>::iterator iterator;
+    
+  public:
+    static FFTWPlanCache & instance()
+    {
+        static FFTWPlanCache * cache = new FFTWPlanCache();
+        return *cache;
+    }
+    
+        // return a cached plan for 'key' (incrementing its reference count) or 0
+    PlanType acquire(FFTWPlanKey const & key)
+    {
+        for(iterator i = entries_.begin(); i != entries_.end(); ++i)
+        {
+            if(i->key == key)
+            {
+                if(i->refcount++ == 0)
+                    --unused_;
+                entries_.splice(entries_.end(), entries_, i);
+                return i->plan;
+            }
+        }
+        return 0;
+    }
+    
+    void insert(FFTWPlanKey const & key, PlanType plan)
+    {
+        entries_.push_back(Entry());
+        entries_.back().key = key;
+        entries_.back().plan = plan;
+        entries_.back().refcount = 1;
+    }
+    
+    void release(PlanType plan)
+    {
+        if(plan == 0)
+            return;
+        for(iterator i = entries_.begin(); i != entries_.end(); ++i)
+        {
+            if(i->plan == plan)
+            {
+                if(--i->refcount == 0)
+                {
+                    ++unused_;
+                    entries_.splice(entries_.end(), entries_, i);
+                    trim();
+                }
+                return;
+            }
+        }
+    }
+    
+        // destroy the least recently used plans until at most unusedLimit() unused plans remain
+    void trim()
+    {
+        for(iterator i = entries_.begin(); unused_ > unusedLimit() && i != entries_.end(); )
+        {
+            if(i->refcount == 0)
+            {
+                fftwPlanDestroy(i->plan);
+                i = entries_.erase(i);
+                --unused_;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    
+        // destroy all plans that are currently unused
+    std::size_t clear()
+    {
+        std::size_t count = 0;
+        for(iterator i = entries_.begin(); i != entries_.end(); )
+        {
+            if(i->refcount == 0)
+            {
+                fftwPlanDestroy(i->plan);
+                i = entries_.erase(i);
+                ++count;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        unused_ = 0;
+        return count;
+    }
+    
+    std::size_t size() const
+    {
+        return entries_.size();
+    }
+    
+  private:
+    FFTWPlanCache()
+    : unused_(0)
+    {
+        registry().push_back(this);
+    }
+    
+    std::list<Entry> entries_;
+    std::size_t unused_;
+};
+
 inline 
 int fftwPaddingSize(int s)
 {
@@ -833,14 +1094,18 @@ class FFTWPlan
             \arg planner_flags must be a combination of the <a href="http://www.fftw.org/doc/Planner-Flags.html">planner 
             flags</a> defined by the FFTW library. The default <tt>FFTW_ESTIMATE</tt> will guess
             optimal algorithm settings or read them from pre-loaded <a href="http://www.fftw.org/doc/Wisdom.html">"wisdom"</a>.
+            \arg nThreads is the number of threads FFTW shall use to execute the plan. 
+            This only has an effect when VIGRA was configured with FFTW's threads library
+            (i.e. <tt>VIGRA_FFTW_THREADS</tt> is defined).
         */
     template <class C1, class C2>
     FFTWPlan(MultiArrayView<N, FFTWComplex<Real>, C1> in, 
              MultiArrayView<N, FFTWComplex<Real>, C2> out,
-             int SIGN, unsigned int planner_flags = FFTW_ESTIMATE)
+             int SIGN, unsigned int planner_flags = FFTW_ESTIMATE,
+             int nThreads = 1)
     : plan(0)
     {
-        init(in, out, SIGN, planner_flags);
+        init(in, out, SIGN, planner_flags, nThreads);
     }
     
         /** \brief Create a plan for a real-to-complex transform.
@@ -853,14 +1118,16 @@ class FFTWPlan
             \arg planner_flags must be a combination of the <a href="http://www.fftw.org/doc/Planner-Flags.html">planner 
             flags</a> defined by the FFTW library. The default <tt>FFTW_ESTIMATE</tt> will guess
             optimal algorithm settings or read them from pre-loaded <a href="http://www.fftw.org/doc/Wisdom.html">"wisdom"</a>.
+            \arg nThreads is the number of threads FFTW shall use (see above).
         */
     template <class C1, class C2>
     FFTWPlan(MultiArrayView<N, Real, C1> in, 
              MultiArrayView<N, FFTWComplex<Real>, C2> out,
-             unsigned int planner_flags = FFTW_ESTIMATE)
+             unsigned int planner_flags = FFTW_ESTIMATE,
+             int nThreads = 1)
     : plan(0)
     {
-        init(in, out, planner_flags);
+        init(in, out, planner_flags, nThreads);
     }
 
         /** \brief Create a plan for a complex-to-real transform.
@@ -873,14 +1140,16 @@ class FFTWPlan
             \arg planner_flags must be a combination of the <a href="http://www.fftw.org/doc/Planner-Flags.html">planner 
             flags</a> defined by the FFTW library. The default <tt>FFTW_ESTIMATE</tt> will guess
             optimal algorithm settings or read them from pre-loaded <a href="http://www.fftw.org/doc/Wisdom.html">"wisdom"</a>.
+            \arg nThreads is the number of threads FFTW shall use (see above).
         */
     template <class C1, class C2>
     FFTWPlan(MultiArrayView<N, FFTWComplex<Real>, C1> in, 
              MultiArrayView<N, Real, C2> out,
-             unsigned int planner_flags = FFTW_ESTIMATE)
+             unsigned int planner_flags = FFTW_ESTIMATE,
+             int nThreads = 1)
     : plan(0)
     {
-        init(in, out, planner_flags);
+        init(in, out, planner_flags, nThreads);
     }
     
         /** \brief Copy constructor.
@@ -903,6 +1172,10 @@ class FFTWPlan
         if(this != &other)
         {
             FFTWPlan & o = const_cast<FFTWPlan &>(other);
+            {
+                detail::FFTWPlannerLock lock;
+                detail::FFTWPlanCache<PlanType>::instance().release(plan);
+            }
             plan = o.plan;
             shape.swap(o.shape);
             instrides.swap(o.instrides);
@@ -914,10 +1187,13 @@ class FFTWPlan
     }
 
         /** \brief Destructor.
+        
+            The underlying FFTW plan remains in the plan cache, see \ref fftwClearPlanCache().
         */
     ~FFTWPlan()
     {
-        detail::fftwPlanDestroy(plan);
+        detail::FFTWPlannerLock lock;
+        detail::FFTWPlanCache<PlanType>::instance().release(plan);
     }
 
         /** \brief Init a complex-to-complex transform.
@@ -927,13 +1203,14 @@ class FFTWPlan
     template <class C1, class C2>
     void init(MultiArrayView<N, FFTWComplex<Real>, C1> in, 
               MultiArrayView<N, FFTWComplex<Real>, C2> out,
-              int SIGN, unsigned int planner_flags = FFTW_ESTIMATE)
+              int SIGN, unsigned int planner_flags = FFTW_ESTIMATE,
+              int nThreads = 1)
     {
         vigra_precondition(in.strideOrdering() == out.strideOrdering(),
             "FFTWPlan.init(): input and output must have the same stride ordering.");
             
         initImpl(in.permuteStridesDescending(), out.permuteStridesDescending(), 
-                 SIGN, planner_flags);
+                 SIGN, planner_flags, nThreads);
     }
         
         /** \brief Init a real-to-complex transform.
@@ -943,13 +1220,14 @@ class FFTWPlan
     template <class C1, class C2>
     void init(MultiArrayView<N, Real, C1> in, 
               MultiArrayView<N, FFTWComplex<Real>, C2> out,
-              unsigned int planner_flags = FFTW_ESTIMATE)
+              unsigned int planner_flags = FFTW_ESTIMATE,
+              int nThreads = 1)
     {
         vigra_precondition(in.strideOrdering() == out.strideOrdering(),
             "FFTWPlan.init(): input and output must have the same stride ordering.");
 
         initImpl(in.permuteStridesDescending(), out.permuteStridesDescending(), 
-                 FFTW_FORWARD, planner_flags);
+                 FFTW_FORWARD, planner_flags, nThreads);
     }
         
         /** \brief Init a complex-to-real transform.
@@ -959,13 +1237,14 @@ class FFTWPlan
     template <class C1, class C2>
     void init(MultiArrayView<N, FFTWComplex<Real>, C1> in, 
               MultiArrayView<N, Real, C2> out,
-              unsigned int planner_flags = FFTW_ESTIMATE)
+              unsigned int planner_flags = FFTW_ESTIMATE,
+              int nThreads = 1)
     {
         vigra_precondition(in.strideOrdering() == out.strideOrdering(),
             "FFTWPlan.init(): input and output must have the same stride ordering.");
 
         initImpl(in.permuteStridesDescending(), out.permuteStridesDescending(), 
-                 FFTW_BACKWARD, planner_flags);
+                 FFTW_BACKWARD, planner_flags, nThreads);
     }
     
         /** \brief Execute a complex-to-complex transform.
@@ -1013,7 +1292,7 @@ class FFTWPlan
   private:
     
     template <class MI, class MO>
-    void initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flags);
+    void initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flags, int nThreads);
     
     template <class MI, class MO>
     void executeImpl(MI ins, MO outs) const;
@@ -1049,7 +1328,7 @@ class FFTWPlan
 template <unsigned int N, class Real>
 template <class MI, class MO>
 void
-FFTWPlan<N, Real>::initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flags)
+FFTWPlan<N, Real>::initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flags, int nThreads)
 {
     checkShapes(ins, outs);
     
@@ -1069,11 +1348,44 @@ FFTWPlan<N, Real>::initImpl(MI ins, MO outs, int SIGN, unsigned int planner_flag
         ototal[j] = outs.stride(j-1) / outs.stride(j);
     }
     
-    PlanType newPlan = detail::fftwPlanCreate(N, newShape.begin(), 
+#ifdef VIGRA_FFTW_THREADS
+    if(nThreads < 1)
+        nThreads = 1;
+#else
+    // the thread count is ignored without threaded FFTW, don't let it split the cache
+    nThreads = 1;
+#endif
+    
+    detail::FFTWPlanKey key;
+    key.shape = newShape;
+    key.itotal = itotal;
+    key.ototal = ototal;
+    key.kind = (sizeof(typename MI::value_type) == sizeof(Real) ? 1 : 0) +
+               (sizeof(typename MO::value_type) == sizeof(Real) ? 2 : 0);
+    key.sign = SIGN;
+    key.istride = ins.stride(N-1);
+    key.ostride = outs.stride(N-1);
+    key.ialign = detail::fftwAlignmentOf((Real *)ins.data());
+    key.oalign = detail::fftwAlignmentOf((Real *)outs.data());
+    key.nThreads = nThreads;
+    key.flags = planner_flags;
+    key.inPlace = (void *)ins.data() == (void *)outs.data();
+    
+    detail::FFTWPlannerLock lock;
+    detail::FFTWPlanCache<PlanType> & cache = detail::FFTWPlanCache<PlanType>::instance();
+    PlanType newPlan = cache.acquire(key);
+    if(newPlan == 0)
+    {
+        detail::fftwPlanWithNThreads((Real *)0, nThreads);
+        newPlan = detail::fftwPlanCreate(N, newShape.begin(), 
                                   ins.data(), itotal.begin(), ins.stride(N-1),
                                   outs.data(), ototal.begin(), outs.stride(N-1),
                                   SIGN, planner_flags);
-    detail::fftwPlanDestroy(plan);
+        vigra_postcondition(newPlan != 0,
+            "FFTWPlan.init(): FFTW could not create a plan.");
+        cache.insert(key, newPlan);
+    }
+    cache.release(plan);
     plan = newPlan;
     shape.swap(newShape);
     instrides.swap(newIStrides);
@@ -1105,6 +1417,195 @@ void FFTWPlan<N, Real>::executeImpl(MI ins, MO outs) const
         outs *= V(1.0) / Real(outs.size());
 }
 
+/********************************************************/
+/*                                                      */
+/*                FFTW plan cache and wisdom            */
+/*                                                      */
+/********************************************************/
+
+/** \brief Number of FFTW plans in the process-wide plan cache.
+
+    All plans created by \ref FFTWPlan (and, therefore, by \ref fourierTransform(), 
+    \ref FFTWConvolvePlan etc.) are stored in a thread-safe cache. When a plan for 
+    the same shapes, strides, memory alignment, transform type, planner flags and 
+    number of threads is requested again, the cached plan is reused instead of running 
+    FFTW's planner (which is slow and must not be called concurrently). Plans remain in 
+    the cache after the last FFTWPlan referring to them has been destroyed, until 
+    \ref fftwClearPlanCache() is called or the number of unused plans exceeds
+    \ref fftwPlanCacheLimit(). 
+    
+    The cache is never destroyed, so that FFTWPlan objects with static storage
+    duration stay valid during program termination. If your program calls 
+    <tt>fftw_cleanup()</tt>, call \ref fftwClearPlanCache() before.
+    
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+inline std::size_t fftwPlanCacheSize()
+{
+    detail::FFTWPlannerLock lock;
+    ArrayVector<detail::FFTWPlanCacheBase *> const & caches = detail::FFTWPlanCacheBase::registry();
+    std::size_t count = 0;
+    for(unsigned int k=0; k<caches.size(); ++k)
+        count += caches[k]->size();
+    return count;
+}
+
+/** \brief Destroy all unused plans in the FFTW plan cache.
+
+    Plans that are still referenced by an \ref FFTWPlan object are kept. 
+    Returns the number of destroyed plans.
+    
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+inline std::size_t fftwClearPlanCache()
+{
+    detail::FFTWPlannerLock lock;
+    ArrayVector<detail::FFTWPlanCacheBase *> const & caches = detail::FFTWPlanCacheBase::registry();
+    std::size_t count = 0;
+    for(unsigned int k=0; k<caches.size(); ++k)
+        count += caches[k]->clear();
+    return count;
+}
+
+/** \brief Maximum number of unused plans kept in the FFTW plan cache.
+
+    When more plans (for the same FFTW precision) are no longer referenced 
+    by an \ref FFTWPlan, the least recently used ones are destroyed. 
+    The default is 64.
+    
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+inline std::size_t fftwPlanCacheLimit()
+{
+    detail::FFTWPlannerLock lock;
+    return detail::FFTWPlanCacheBase::unusedLimit();
+}
+
+/** \brief Set the maximum number of unused plans kept in the FFTW plan cache.
+
+    Surplus unused plans are destroyed immediately, least recently used first. 
+    With a limit of 0, plans are destroyed as soon as the last \ref FFTWPlan 
+    referring to them goes away. See \ref fftwPlanCacheLimit().
+    
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+inline void fftwSetPlanCacheLimit(std::size_t limit)
+{
+    detail::FFTWPlannerLock lock;
+    detail::FFTWPlanCacheBase::unusedLimit() = limit;
+    ArrayVector<detail::FFTWPlanCacheBase *> const & caches = detail::FFTWPlanCacheBase::registry();
+    for(unsigned int k=0; k<caches.size(); ++k)
+        caches[k]->trim();
+}
+
+namespace detail {
+
+inline int fftwImportWisdomFromFile(double *, const char * f)  { return fftw_import_wisdom_from_filename(f); }
+inline int fftwImportWisdomFromFile(float *, const char * f)   { return fftwf_import_wisdom_from_filename(f); }
+inline int fftwImportWisdomFromFile(long double *, const char * f) { return fftwl_import_wisdom_from_filename(f); }
+
+inline int fftwExportWisdomToFile(double *, const char * f)  { return fftw_export_wisdom_to_filename(f); }
+inline int fftwExportWisdomToFile(float *, const char * f)   { return fftwf_export_wisdom_to_filename(f); }
+inline int fftwExportWisdomToFile(long double *, const char * f) { return fftwl_export_wisdom_to_filename(f); }
+
+inline int fftwImportWisdomFromString(double *, const char * s)  { return fftw_import_wisdom_from_string(s); }
+inline int fftwImportWisdomFromString(float *, const char * s)   { return fftwf_import_wisdom_from_string(s); }
+inline int fftwImportWisdomFromString(long double *, const char * s) { return fftwl_import_wisdom_from_string(s); }
+
+inline char * fftwExportWisdomToString(double *)  { return fftw_export_wisdom_to_string(); }
+inline char * fftwExportWisdomToString(float *)   { return fftwf_export_wisdom_to_string(); }
+inline char * fftwExportWisdomToString(long double *) { return fftwl_export_wisdom_to_string(); }
+
+inline void fftwForgetWisdom(double *)  { fftw_forget_wisdom(); }
+inline void fftwForgetWisdom(float *)   { fftwf_forget_wisdom(); }
+inline void fftwForgetWisdom(long double *) { fftwl_forget_wisdom(); }
+
+inline void fftwFreeWisdomString(double *, char * s)  { fftw_free(s); }
+inline void fftwFreeWisdomString(float *, char * s)   { fftwf_free(s); }
+inline void fftwFreeWisdomString(long double *, char * s) { fftwl_free(s); }
+
+} // namespace detail
+
+/** \brief Load and store FFTW's <a href="http://www.fftw.org/doc/Wisdom.html">wisdom</a>.
+
+    FFTW accumulates knowledge about the fastest algorithms for the transforms 
+    planned so far (in particular with <tt>FFTW_MEASURE</tt> or <tt>FFTW_PATIENT</tt>). 
+    Saving this wisdom at the end of a program and loading it at the start of the next
+    run makes the expensive planning step essentially free. Wisdom is kept separately 
+    for each precision, so the template parameter must match the <tt>Real</tt> type
+    of the plans in question. All functions are protected by the same lock as
+    plan creation, so that they may be called from several threads.
+    
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+
+    \code
+    FFTWWisdom<double>::importFromFile("fftw_wisdom.dat"); // ignore failure on first run
+    
+    FFTWPlan<2, double> plan(src, fourier, FFTW_MEASURE);  // fast when wisdom was loaded
+    ...
+    FFTWWisdom<double>::exportToFile("fftw_wisdom.dat");
+    \endcode
+*/
+template <class Real = double>
+class FFTWWisdom
+{
+  public:
+        /** Import wisdom from the given file. Returns false if the file 
+            could not be read or didn't contain valid wisdom.
+        */
+    static bool importFromFile(std::string const & filename)
+    {
+        detail::FFTWPlannerLock lock;
+        return detail::fftwImportWisdomFromFile((Real *)0, filename.c_str()) != 0;
+    }
+    
+        /** Export the accumulated wisdom to the given file. 
+            Returns false if the file could not be written.
+        */
+    static bool exportToFile(std::string const & filename)
+    {
+        detail::FFTWPlannerLock lock;
+        return detail::fftwExportWisdomToFile((Real *)0, filename.c_str()) != 0;
+    }
+    
+        /** Import wisdom from a string previously created by exportToString().
+            Returns false if the string didn't contain valid wisdom.
+        */
+    static bool importFromString(std::string const & wisdom)
+    {
+        detail::FFTWPlannerLock lock;
+        return detail::fftwImportWisdomFromString((Real *)0, wisdom.c_str()) != 0;
+    }
+    
+        /** Export the accumulated wisdom to a string.
+        */
+    static std::string exportToString()
+    {
+        detail::FFTWPlannerLock lock;
+        char * s = detail::fftwExportWisdomToString((Real *)0);
+        if(s == 0)
+            return std::string();
+        std::string res(s);
+        detail::fftwFreeWisdomString((Real *)0, s);
+        return res;
+    }
+    
+        /** Forget all accumulated wisdom. Existing plans are not affected.
+        */
+    static void forget()
+    {
+        detail::FFTWPlannerLock lock;
+        detail::fftwForgetWisdom((Real *)0);
+    }
+};
+
 /********************************************************/
 /*                                                      */
 /*                  FFTWConvolvePlan                    */
@@ -2234,6 +2735,708 @@ convolveFFTComplexMany(MultiArrayView<N, FFTWComplex<Real>, C1> in,
     plan.executeMany(in, kernels, kernelsEnd, outs);
 }
 
+/********************************************************/
+/*                                                      */
+/*         automatic selection of FFT convolution       */
+/*                                                      */
+/********************************************************/
+
+/** \brief Choice between direct and FFT-based convolution.
+
+    Used by the overloads of \ref convolveImage() and \ref convolveMultiArrayOneDimension()
+    that are defined in <tt>vigra/multi_fft.hxx</tt>.
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+enum ConvolutionMethod
+{
+    CONVOLUTION_AUTO,    ///< choose the faster method according to \ref fftConvolutionIsFaster()
+    CONVOLUTION_DIRECT,  ///< always convolve in the spatial domain
+    CONVOLUTION_FFT      ///< always convolve in the Fourier domain
+};
+
+namespace detail {
+
+    // Cost estimates in units of one multiply-add of the (non-vectorized) direct 
+    // convolution. The constants were fitted to the timings of FFTW_ESTIMATE plans
+    // reported by test/fourier/speedtest.cxx.
+inline double fftConvolutionTransformCost()  // per padded element and log2(padded size)
+{
+    return 0.5;
+}
+
+inline double fftConvolutionElementCost()    // per padded element: padding, spectral product, copying
+{
+    return 3.0;
+}
+
+inline double directConvolutionTapCost(bool vectorized)
+{
+    return vectorized && simdInstructionSet() != SIMD_NONE
+               ? 0.25
+               : 1.0;
+}
+
+template <class T, int N>
+double
+directConvolutionCost(TinyVector<T, N> const & shape, TinyVector<T, N> const & kernelShape, 
+                      bool vectorized)
+{
+    double cost = directConvolutionTapCost(vectorized);
+    for(int k=0; k<N; ++k)
+        cost *= double(shape[k]) * double(kernelShape[k]);
+    return cost;
+}
+
+    // 'transforms' is the number of real FFTs per convolution: 2 when the 
+    // kernel's spectrum is reused for many arrays, 3 otherwise
+template <class T, int N>
+double
+fftConvolutionCost(TinyVector<T, N> const & shape, TinyVector<T, N> const & kernelShape, 
+                   int transforms)
+{
+    TinyVector<T, N> padded = fftwBestPaddedShapeR2C(shape + kernelShape - TinyVector<T, N>(1));
+    double size = 1.0;
+    for(int k=0; k<N; ++k)
+        size *= double(padded[k]);
+    return size * (transforms * fftConvolutionTransformCost() * std::log(size) / std::log(2.0)
+                   + fftConvolutionElementCost());
+}
+
+} // namespace detail
+
+/** \brief Predict if FFT-based convolution is faster than direct convolution.
+
+    Direct convolution of an array of the given <tt>shape</tt> with a non-separable
+    kernel of shape <tt>kernelShape</tt> requires <tt>prod(shape)*prod(kernelShape)</tt> 
+    multiply-adds. FFT-based convolution (see \ref convolveFFT()) needs three real
+    Fourier transforms of the padded array (whose size <tt>P</tt> is at least 
+    <tt>prod(shape + kernelShape - 1)</tt>), i.e. <tt>O(P log P)</tt> operations. 
+    This function compares estimates of both costs and returns <tt>true</tt> if 
+    FFT-based convolution is expected to be faster. Typically, this is the case for 
+    2D kernels larger than about 7x7. The cost model is used by the automatic variants 
+    of \ref convolveImage() and \ref convolveMultiArrayOneDimension(). 
+    Run <tt>test/fourier/speedtest.cxx</tt> to find the actual crossover points on 
+    your machine.
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+*/
+template <class T, int N>
+inline bool
+fftConvolutionIsFaster(TinyVector<T, N> const & shape, TinyVector<T, N> const & kernelShape)
+{
+    return detail::fftConvolutionCost(shape, kernelShape, 3) < 
+           detail::directConvolutionCost(shape, kernelShape, false);
+}
+
+namespace detail {
+
+    // Index of the array element corresponding to position 'p' of an array of 
+    // length 'n' that is extended according to the border treatment mode, 
+    // or -1 for zero padding.
+inline MultiArrayIndex
+fftBorderIndex(MultiArrayIndex p, MultiArrayIndex n, BorderTreatmentMode border)
+{
+    switch(border)
+    {
+        case BORDER_TREATMENT_ZEROPAD:
+            return -1;
+        case BORDER_TREATMENT_REPEAT:
+            return p < 0
+                      ? 0
+                      : n - 1;
+        case BORDER_TREATMENT_WRAP:
+            p %= n;
+            return p < 0
+                      ? p + n
+                      : p;
+        default: // BORDER_TREATMENT_REFLECT, BORDER_TREATMENT_AVOID
+        {
+            if(n == 1)
+                return 0;
+            MultiArrayIndex period = 2*(n - 1);
+            p = (p < 0 ? -p : p) % period;
+            return p < n
+                      ? p
+                      : period - p;
+        }
+    }
+}
+
+    // Fill the margin of 'a' around the block [offset, offset + shape) 
+    // according to the border treatment mode.
+template <unsigned int N, class Real, class C>
+void 
+fftPadArray(MultiArrayView<N, Real, C> a, 
+            typename MultiArrayShape<N>::type const & offset,
+            typename MultiArrayShape<N>::type const & shape,
+            BorderTreatmentMode border)
+{
+    typedef typename MultiArrayView<N, Real, C>::traverser Traverser;
+    typedef MultiArrayNavigator<Traverser, N> Navigator;
+    typedef typename Navigator::iterator Iterator;
+    
+    for(unsigned int d = 0; d < N; ++d)
+    {
+        MultiArrayIndex n = shape[d],
+                        begin = -offset[d],
+                        end = a.shape(d) - offset[d];
+        Navigator nav(a.traverser_begin(), a.shape(), d);
+
+        for( ; nav.hasMore(); nav++ )
+        {
+            Iterator i = nav.begin() + offset[d];
+            for(MultiArrayIndex p = begin; p < end; ++p)
+            {
+                if(p == 0)
+                    p = n;  // skip the data
+                if(p == end)
+                    break;
+                MultiArrayIndex q = fftBorderIndex(p, n, border);
+                i[p] = q < 0
+                          ? Real(0.0)
+                          : i[q];
+            }
+        }
+    }
+}
+
+    // Convolve arrays of a fixed shape with a fixed kernel in the Fourier domain.
+    // The array is embedded into a padded array whose margin is filled according
+    // to the border treatment mode and is wide enough to avoid wrap-around in the 
+    // cyclic convolution. The kernel's spectrum is computed only once. The padded
+    // array and its spectrum reside in a separate work array, so that several 
+    // threads can share one FFTWKernelConvolution object.
+template <unsigned int N, class Real>
+class FFTWKernelConvolution
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef FFTWComplex<Real> Complex;
+    typedef MultiArray<N, Complex, FFTWAllocator<Complex> > WorkArray;
+    typedef MultiArrayView<N, Real> RealView;
+    
+        // 'kernel' contains the coefficients for the offsets 
+        // [kernelLeft, kernelLeft + kernel.shape()), where kernelLeft <= 0 
+    template <class C>
+    FFTWKernelConvolution(Shape const & shape, 
+                          MultiArrayView<N, Real, C> const & kernel, Shape const & kernelLeft,
+                          BorderTreatmentMode border)
+    : shape_(shape),
+      padded_shape_(fftwBestPaddedShapeR2C(shape + kernel.shape() - Shape(1))),
+      offset_(kernelLeft + kernel.shape() - Shape(1)),
+      border_(border),
+      spectrum_(fftwCorrespondingShapeR2C(padded_shape_))
+    {
+        vigra_precondition(border == BORDER_TREATMENT_AVOID   ||
+                           border == BORDER_TREATMENT_REFLECT ||
+                           border == BORDER_TREATMENT_REPEAT  ||
+                           border == BORDER_TREATMENT_WRAP    ||
+                           border == BORDER_TREATMENT_ZEROPAD,
+            "FFT convolution: border treatment must be one of AVOID, REFLECT, REPEAT, WRAP, ZEROPAD.");
+        for(unsigned int d=0; d<N; ++d)
+            vigra_precondition(kernelLeft[d] <= 0 && offset_[d] >= 0,
+                "FFT convolution: kernel must contain the origin.");
+        
+        initPlans();
+        
+        // the coefficient for offset k is placed at position (k mod padded_shape_)
+        RealView real = realView(spectrum_);
+        real.init(Real(0.0));
+        typename MultiArrayView<N, Real, C>::const_iterator k = kernel.begin(), kend = kernel.end();
+        for(; k != kend; ++k)
+        {
+            Shape p = k.point() + kernelLeft;
+            for(unsigned int d=0; d<N; ++d)
+                if(p[d] < 0)
+                    p[d] += padded_shape_[d];
+            real[p] = *k;
+        }
+        forward_.execute(real, spectrum_);
+    }
+    
+        // FFTWPlan has move semantics on copy, so that copies get their own 
+        // plan objects (which are found in the plan cache)
+    FFTWKernelConvolution(FFTWKernelConvolution const & other)
+    : shape_(other.shape_),
+      padded_shape_(other.padded_shape_),
+      offset_(other.offset_),
+      border_(other.border_),
+      spectrum_(other.spectrum_)
+    {
+        initPlans();
+    }
+    
+    Shape const & shape() const
+    {
+        return shape_;
+    }
+    
+    Shape const & workShape() const
+    {
+        return spectrum_.shape();
+    }
+    
+        // the part of the work array that receives the input and the result
+    RealView interior(WorkArray & work) const
+    {
+        return realView(work).subarray(offset_, offset_ + shape_);
+    }
+    
+        // pad the data in interior(work) and replace them with the convolution result
+    void execute(WorkArray & work) const
+    {
+        vigra_precondition(work.shape() == workShape(),
+            "FFTWKernelConvolution::execute(): work array has wrong shape.");
+        RealView real = realView(work);
+        fftPadArray(real, offset_, shape_, border_);
+        forward_.execute(real, work);
+        work *= spectrum_;
+        backward_.execute(work, real);
+    }
+    
+  private:
+    FFTWKernelConvolution & operator=(FFTWKernelConvolution const &); // not assignable
+    
+        // in-place plans on spectrum_, which are also valid for the work arrays
+        // because both are allocated with the same (FFTW) alignment
+    void initPlans()
+    {
+        RealView real = realView(spectrum_);
+        forward_.init(real, spectrum_);
+        backward_.init(spectrum_, real);
+    }
+    
+    RealView realView(WorkArray & work) const
+    {
+        Shape realStrides = 2*work.stride();
+        realStrides[0] = 1;
+        return RealView(padded_shape_, realStrides, (Real*)work.data());
+    }
+    
+    Shape shape_, padded_shape_, offset_;
+    BorderTreatmentMode border_;
+    WorkArray spectrum_;
+    FFTWPlan<N, Real> forward_, backward_;
+};
+
+    // Line filter for convolveLinesAlongAxis() that convolves each line 
+    // in the Fourier domain.
+template <class T, class Real>
+class FFTLineFilter
+{
+  public:
+    typedef T value_type;
+    typedef FFTWKernelConvolution<1, Real> Convolution;
+    typedef typename Convolution::Shape Shape;
+    
+    FFTLineFilter(Kernel1D<T> const & kernel, MultiArrayIndex length)
+    : kernel_(kernel),
+      convolution_(Shape(length), coefficients(kernel), Shape(kernel.left()), 
+                   kernel.borderTreatment())
+    {}
+    
+    int left() const
+    {
+        return kernel_.left();
+    }
+    
+    int right() const
+    {
+        return kernel_.right();
+    }
+    
+    BorderTreatmentMode borderTreatment() const
+    {
+        return kernel_.borderTreatment();
+    }
+    
+    value_type operator[](int i) const
+    {
+        return kernel_[i];
+    }
+    
+    Convolution const & convolution() const
+    {
+        return convolution_;
+    }
+    
+  private:
+    static MultiArray<1, Real> coefficients(Kernel1D<T> const & kernel)
+    {
+        MultiArray<1, Real> res(Shape(kernel.size()));
+        for(int i=kernel.left(); i<=kernel.right(); ++i)
+            res(i - kernel.left()) = kernel[i];
+        return res;
+    }
+    
+    Kernel1D<T> kernel_;
+    Convolution convolution_;
+};
+
+template <class T, class Real>
+inline bool 
+supportsLineTiles(FFTLineFilter<T, Real> const &)
+{
+    return false;
+}
+
+template <class SNavigator, class SrcAccessor, class DNavigator, class DestAccessor,
+          class T, class KernelValue, class Real>
+void
+filterLines(SNavigator & snav, SrcAccessor src, DNavigator & dnav, DestAccessor dest, int doffset,
+            FFTLineFilter<KernelValue, Real> const & filter, int start, int stop, ArrayVector<T> &)
+{
+    typedef typename FFTLineFilter<KernelValue, Real>::Convolution Convolution;
+    typedef typename DestAccessor::value_type DestType;
+    
+    Convolution const & convolution = filter.convolution();
+    int w = snav.end() - snav.begin();
+    vigra_precondition(w == convolution.shape()[0],
+                 "filterLines(): line length doesn't match the FFT filter.\n");
+    vigra_precondition(w >= std::max(filter.right(), -filter.left()) + 1,
+                 "convolveLine(): kernel longer than line.\n");
+    if(stop == 0)
+        stop = w;
+    vigra_precondition(0 <= start && start < stop && stop <= w,
+                 "convolveLine(): invalid subrange (start, stop).\n");
+    
+    // like convolveLine(), BORDER_TREATMENT_AVOID only writes points where the kernel fits
+    int begin = start, end = stop;
+    if(filter.borderTreatment() == BORDER_TREATMENT_AVOID)
+    {
+        begin = std::max(start, filter.right());
+        end   = std::min(stop, w + filter.left());
+    }
+    
+    typename Convolution::WorkArray work(convolution.workShape());
+    typename Convolution::RealView line = convolution.interior(work);
+    
+    for( ; snav.hasMore(); snav++, dnav++ )
+    {
+        typename SNavigator::iterator s = snav.begin();
+        for(int p = 0; p < w; ++p, ++s)
+            line(p) = src(s);
+        
+        convolution.execute(work);
+        
+        typename DNavigator::iterator d = dnav.begin() + doffset;
+        for(int p = begin; p < end; ++p)
+            dest.set(detail::RequiresExplicitCast<DestType>::cast(line(p)), d + (p - start));
+    }
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void 
+convolveImageFFT(SrcIterator, SrcIterator, SrcAccessor,
+                 DestIterator, DestAccessor,
+                 Kernel2D<T> const &, VigraFalseType /* isScalar */)
+{
+    vigra_precondition(false,
+        "convolveImage(): FFT convolution requires scalar pixel types.");
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void 
+convolveImageFFT(SrcIterator src_ul, SrcIterator src_lr, SrcAccessor src_acc,
+                 DestIterator dest_ul, DestAccessor dest_acc,
+                 Kernel2D<T> const & kernel, VigraTrueType /* isScalar */)
+{
+    typedef typename NumericTraits<typename SrcAccessor::value_type>::RealPromote SrcReal;
+    typedef typename NumericTraits<T>::RealPromote KernelReal;
+    typedef typename PromoteTraits<SrcReal, KernelReal>::Promote Real;
+    typedef typename DestAccessor::value_type DestType;
+    typedef FFTWKernelConvolution<2, Real> Convolution;
+    typedef typename Convolution::Shape Shape;
+    
+    int w = src_lr.x - src_ul.x;
+    int h = src_lr.y - src_ul.y;
+    Diff2D kul = kernel.upperLeft(), 
+           klr = kernel.lowerRight();
+    
+    vigra_precondition(w >= std::max(klr.x, -kul.x) + 1 && h >= std::max(klr.y, -kul.y) + 1,
+                       "convolveImage(): kernel larger than image.");
+    
+    MultiArray<2, Real> coefficients(Shape(kernel.width(), kernel.height()));
+    for(int y = kul.y; y <= klr.y; ++y)
+        for(int x = kul.x; x <= klr.x; ++x)
+            coefficients(x - kul.x, y - kul.y) = kernel(x, y);
+            
+    Convolution convolution(Shape(w, h), coefficients, Shape(kul.x, kul.y), kernel.borderTreatment());
+    typename Convolution::WorkArray work(convolution.workShape());
+    typename Convolution::RealView image = convolution.interior(work);
+    
+    copyImage(srcIterRange(src_ul, src_lr, src_acc), destImage(image));
+    
+    convolution.execute(work);
+    
+    // like the direct algorithm, BORDER_TREATMENT_AVOID leaves the border untouched
+    Diff2D begin(0, 0), end(w, h);
+    if(kernel.borderTreatment() == BORDER_TREATMENT_AVOID)
+    {
+        begin = klr;
+        end  += kul;
+    }
+    for(int y = begin.y; y < end.y; ++y)
+    {
+        typename DestIterator::row_iterator d = (dest_ul + Diff2D(begin.x, y)).rowIterator();
+        for(int x = begin.x; x < end.x; ++x, ++d)
+            dest_acc.set(detail::RequiresExplicitCast<DestType>::cast(image(x, y)), d);
+    }
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void
+convolveMultiArrayOneDimensionFFT(SrcIterator, SrcShape const &, SrcAccessor,
+                                  DestIterator, DestAccessor,
+                                  unsigned int, Kernel1D<T> const &,
+                                  ConvolutionOptions<SrcShape::static_size> const &,
+                                  VigraFalseType /* isScalar */)
+{
+    vigra_precondition(false,
+        "convolveMultiArrayOneDimension(): FFT convolution requires scalar pixel types.");
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void
+convolveMultiArrayOneDimensionFFT(SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                                  DestIterator d, DestAccessor dest,
+                                  unsigned int dim, Kernel1D<T> const & kernel,
+                                  ConvolutionOptions<SrcShape::static_size> const & opt,
+                                  VigraTrueType /* isScalar */)
+{
+    typedef typename NumericTraits<typename SrcAccessor::value_type>::RealPromote SrcReal;
+    typedef typename NumericTraits<T>::RealPromote KernelReal;
+    typedef typename PromoteTraits<SrcReal, KernelReal>::Promote Real;
+    
+    SrcShape const & start = opt.from_point,
+                   & stop  = opt.to_point;
+    SrcShape sstart, sstop(shape), dstart, dstop(shape);
+    
+    if(stop != SrcShape())
+    {
+        sstart = start;
+        sstop  = stop;
+        sstart[dim] = 0;
+        sstop[dim]  = shape[dim];
+        dstop = stop - start;
+    }
+    
+    FFTLineFilter<T, Real> filter(kernel, shape[dim]);
+    convolveLinesAlongAxis(s, sstart, sstop, src, d, dstart, dstop, dest,
+                           dim, filter, start[dim], stop[dim], 0, opt.n_threads);
+}
+
+} // namespace detail
+
+/** \brief Convolve an image with a 2D kernel, choosing between direct and FFT-based convolution.
+
+    These overloads of \ref convolveImage() are available when <tt>vigra/multi_fft.hxx</tt> 
+    is included. They accept the <tt>Kernel2D</tt> object directly (instead of the result of 
+    <tt>kernel2d()</tt>). When <tt>method</tt> is <tt>CONVOLUTION_AUTO</tt> (the default), 
+    the convolution is computed in the Fourier domain (see \ref convolveFFT()) if 
+    \ref fftConvolutionIsFaster() predicts a speed-up for the given image and kernel sizes.
+    This is typically the case for large non-separable kernels (e.g. Gabor filters).
+    
+    The kernel's border treatment is realized by padding the image accordingly before 
+    the Fourier transform, so that both methods give the same results up to round-off. 
+    This works for <tt>BORDER_TREATMENT_AVOID</tt>, <tt>BORDER_TREATMENT_REFLECT</tt>, 
+    <tt>BORDER_TREATMENT_REPEAT</tt>, <tt>BORDER_TREATMENT_WRAP</tt>, and 
+    <tt>BORDER_TREATMENT_ZEROPAD</tt>. <tt>BORDER_TREATMENT_CLIP</tt> and non-scalar pixel 
+    types always use direct convolution in automatic mode. FFTW plans are cached 
+    for each padded shape, so that repeated convolutions of images of the same size 
+    don't plan again.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class T>
+        void 
+        convolveImage(SrcIterator src_ul, SrcIterator src_lr, SrcAccessor src_acc,
+                      DestIterator dest_ul, DestAccessor dest_acc,
+                      Kernel2D<T> const & kernel, 
+                      ConvolutionMethod method = CONVOLUTION_AUTO);
+    }
+    \endcode
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class T>
+        void 
+        convolveImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                      pair<DestIterator, DestAccessor> dest,
+                      Kernel2D<T> const & kernel, 
+                      ConvolutionMethod method = CONVOLUTION_AUTO);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+
+    \code
+    FImage src(w,h), dest(w,h);
+    ...
+    Kernel2D<double> gauss;
+    gauss.initGaussian(4.0);   // 33x33 kernel
+    
+    convolveImage(srcImageRange(src), destImage(dest), gauss);   // uses the FFT
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void convolveImage)
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void 
+convolveImage(SrcIterator src_ul, SrcIterator src_lr, SrcAccessor src_acc,
+              DestIterator dest_ul, DestAccessor dest_acc,
+              Kernel2D<T> const & kernel, 
+              ConvolutionMethod method = CONVOLUTION_AUTO)
+{
+    typedef typename And<typename NumericTraits<typename SrcAccessor::value_type>::isScalar,
+                         typename NumericTraits<typename DestAccessor::value_type>::isScalar>::type IsScalar;
+    typedef MultiArrayShape<2>::type Shape;
+    
+    bool useFFT = method == CONVOLUTION_FFT;
+    if(method == CONVOLUTION_AUTO)
+        useFFT = IsScalar::value && 
+                 kernel.borderTreatment() != BORDER_TREATMENT_CLIP &&
+                 fftConvolutionIsFaster(Shape(src_lr.x - src_ul.x, src_lr.y - src_ul.y),
+                                        Shape(kernel.width(), kernel.height()));
+    if(useFFT)
+        detail::convolveImageFFT(src_ul, src_lr, src_acc, dest_ul, dest_acc, kernel, IsScalar());
+    else
+        convolveImage(src_ul, src_lr, src_acc, dest_ul, dest_acc, 
+                      kernel.center(), kernel.accessor(), 
+                      kernel.upperLeft(), kernel.lowerRight(), kernel.borderTreatment());
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void 
+convolveImage(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+              pair<DestIterator, DestAccessor> dest,
+              Kernel2D<T> const & kernel, 
+              ConvolutionMethod method = CONVOLUTION_AUTO)
+{
+    convolveImage(src.first, src.second, src.third,
+                  dest.first, dest.second, kernel, method);
+}
+
+/** \brief Convolution along a single dimension, choosing between direct and FFT-based convolution.
+
+    These overloads of \ref convolveMultiArrayOneDimension() are available when 
+    <tt>vigra/multi_fft.hxx</tt> is included. When <tt>method</tt> is <tt>CONVOLUTION_AUTO</tt>, 
+    each line is convolved in the Fourier domain if this is expected to be faster 
+    according to the same cost model as in \ref fftConvolutionIsFaster(), taking into
+    account that the kernel's spectrum is computed only once and that the direct
+    algorithm is vectorized. This only pays off for long kernels (typically more than 
+    50 to 100 coefficients, e.g. Gaussians with large <tt>sigma</tt>). The border treatment
+    of the kernel is realized by padding as explained for \ref convolveImage(), 
+    the subarray and thread options are respected by both methods.
+
+    <b> Declarations:</b>
+
+    pass arguments explicitly:
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class T>
+        void
+        convolveMultiArrayOneDimension(SrcIterator siter, SrcShape const & shape, SrcAccessor src,
+                                       DestIterator diter, DestAccessor dest,
+                                       unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                                       ConvolutionOptions<SrcShape::static_size> const & opt,
+                                       ConvolutionMethod method);
+    }
+    \endcode
+
+    use argument objects in conjunction with \ref ArgumentObjectFactories :
+    \code
+    namespace vigra {
+        template <class SrcIterator, class SrcShape, class SrcAccessor,
+                  class DestIterator, class DestAccessor, class T>
+        void
+        convolveMultiArrayOneDimension(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                                       pair<DestIterator, DestAccessor> const & dest,
+                                       unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                                       ConvolutionOptions<SrcShape::static_size> const & opt,
+                                       ConvolutionMethod method);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_fft.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> source(Shape3(400, 300, 200)), dest(source.shape());
+    ...
+    Kernel1D<double> gauss;
+    gauss.initGaussian(60.0);
+    
+    // smooth along the z-axis
+    convolveMultiArrayOneDimension(srcMultiArrayRange(source), destMultiArray(dest), 2, gauss,
+                                   ConvolutionOptions<3>(), CONVOLUTION_AUTO);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void convolveMultiArrayOneDimension)
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+void
+convolveMultiArrayOneDimension(SrcIterator s, SrcShape const & shape, SrcAccessor src,
+                               DestIterator d, DestAccessor dest,
+                               unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                               ConvolutionOptions<SrcShape::static_size> const & opt,
+                               ConvolutionMethod method)
+{
+    typedef typename And<typename NumericTraits<typename SrcAccessor::value_type>::isScalar,
+                         typename NumericTraits<typename DestAccessor::value_type>::isScalar>::type IsScalar;
+    typedef MultiArrayShape<1>::type Shape;
+    enum { N = 1 + SrcIterator::level };
+    vigra_precondition( dim < N,
+                        "convolveMultiArrayOneDimension(): The dimension number to convolve must be smaller "
+                        "than the data dimensionality" );
+    
+    bool useFFT = method == CONVOLUTION_FFT;
+    if(method == CONVOLUTION_AUTO)
+        useFFT = IsScalar::value && 
+                 kernel.borderTreatment() != BORDER_TREATMENT_CLIP &&
+                 detail::fftConvolutionCost(Shape(shape[dim]), Shape(kernel.size()), 2) <
+                     detail::directConvolutionCost(Shape(shape[dim]), Shape(kernel.size()), true);
+    if(useFFT)
+        detail::convolveMultiArrayOneDimensionFFT(s, shape, src, d, dest, dim, kernel, opt, IsScalar());
+    else
+        convolveMultiArrayOneDimension(s, shape, src, d, dest, dim, kernel, opt);
+}
+
+template <class SrcIterator, class SrcShape, class SrcAccessor,
+          class DestIterator, class DestAccessor, class T>
+inline void
+convolveMultiArrayOneDimension(triple<SrcIterator, SrcShape, SrcAccessor> const & source,
+                               pair<DestIterator, DestAccessor> const & dest,
+                               unsigned int dim, vigra::Kernel1D<T> const & kernel,
+                               ConvolutionOptions<SrcShape::static_size> const & opt,
+                               ConvolutionMethod method)
+{
+    convolveMultiArrayOneDimension(source.first, source.second, source.third,
+                                   dest.first, dest.second, dim, kernel, opt, method);
+}
+
 //@}
 
 } // namespace vigra
@@ -40,8 +40,15 @@
 #include "tinyvector.hxx"
 #include "rgbvalue.hxx"
 #include "mathutil.hxx"
+#include "array_vector.hxx"
+#include "threadpool.hxx"
 #include <complex>
 
+#ifndef VIGRA_MULTI_MATH_PARALLEL_THRESHOLD
+    // minimal number of elements for multi-threaded evaluation of array expressions
+#  define VIGRA_MULTI_MATH_PARALLEL_THRESHOLD (1 << 18)
+#endif
+
 namespace vigra {
 
 /** \defgroup MultiMathModule vigra::multi_math
@@ -85,8 +92,26 @@ namespace vigra {
     bool b = all(i > 0.0);  // check if all elements of i are positive
     \endcode
     
-    Expressions are expanded so that no temporary arrays have to be created. To optimize cache locality,
-    loops are executed in the stride ordering of the left-hand-side array.
+    Expressions are expanded so that no temporary arrays have to be created. This also holds for
+    the reduction functions, so that e.g. the squared distance between two arrays
+    \code
+    double d = sum<double>(sq(i - j));
+    \endcode
+    is computed in a single pass over <tt>i</tt> and <tt>j</tt>. To optimize cache locality,
+    loops are executed in the stride ordering of the left-hand-side array. Axes which are 
+    contiguous in all arrays are merged into a single loop, and when all arrays involved have 
+    unit stride along this loop, it is executed with indexed access that the compiler can 
+    vectorize. 
+    
+    Multi-threaded evaluation is disabled by default, because array expressions are 
+    often used inside code that is already parallel. It is enabled by 
+    \ref multi_math::setMultiMathThreads(). Then, arrays with at least 
+    <tt>VIGRA_MULTI_MATH_PARALLEL_THRESHOLD</tt> elements (default: 2<sup>18</sup>, 
+    can be changed by defining this macro before including the header) are evaluated 
+    by the given number of threads. Expressions evaluated within another parallel 
+    loop (see \ref parallel_foreach()) always run sequentially. Reductions split large 
+    arrays into a fixed number of parts regardless of the number of threads, so that 
+    their results don't depend on the number of threads.
     
     <b>\#include</b> \<vigra/multi_math.hxx\>
 
@@ -94,6 +119,51 @@ namespace vigra {
 */
 namespace multi_math {
 
+namespace detail {
+
+inline int & multiMathThreadsSetting()
+{
+    static int n = 1;
+    return n;
+}
+
+} // namespace detail
+
+    /** \brief Number of threads used to evaluate large array expressions.
+
+        Returns 1 (i.e. sequential evaluation) unless changed by 
+        \ref setMultiMathThreads().
+
+        <b>\#include</b> \<vigra/multi_math.hxx\><br>
+        Namespace: vigra::multi_math
+    */
+inline int multiMathThreads()
+{
+    int n = detail::multiMathThreadsSetting();
+    return n > 0
+               ? n
+               : defaultConcurrency();
+}
+
+    /** \brief Enable multi-threaded evaluation of large array expressions.
+
+        Arrays with at least <tt>VIGRA_MULTI_MATH_PARALLEL_THRESHOLD</tt> elements
+        are evaluated by \a n threads. If <tt>n <= 0</tt>, \ref defaultConcurrency()
+        threads are used, <tt>n == 1</tt> restores sequential evaluation. The previous 
+        setting is returned, so that it can be restored later. Like 
+        \ref setDefaultConcurrency(), this function is not thread-safe and should 
+        be called before array expressions are evaluated concurrently.
+
+        <b>\#include</b> \<vigra/multi_math.hxx\><br>
+        Namespace: vigra::multi_math
+    */
+inline int setMultiMathThreads(int n)
+{
+    int old = detail::multiMathThreadsSetting();
+    detail::multiMathThreadsSetting() = n;
+    return old;
+}
+
 template <class ARG>
 struct MultiMathOperand
 {
@@ -128,12 +198,39 @@ struct MultiMathOperand
         arg_.reset(axis);
     }
     
+    // move the pointer of all RHS arrays by 'd' steps along the given 'axis'
+    void move(unsigned int axis, MultiArrayIndex d) const
+    {
+        arg_.move(axis, d);
+    }
+    
+    // Check if all RHS arrays have unit stride along the given 'axis'
+    // (i.e. if the expression can be evaluated with get() along this axis).
+    bool isUnstrided(unsigned int axis) const
+    {
+        return arg_.isUnstrided(axis);
+    }
+    
+    // Check if the 'outer' axis directly continues the 'inner' axis in
+    // memory in all RHS arrays, so that both can be traversed by a single loop.
+    bool isMergeable(unsigned int inner, unsigned int outer) const
+    {
+        return arg_.isMergeable(inner, outer);
+    }
+    
     // get the value of the expression at the current pointer location
     result_type operator*() const
     {
         return *arg_;
     }
     
+    // get the value of the expression at offset 'i' of the current pointer 
+    // location (only valid along an unstrided axis)
+    result_type get(MultiArrayIndex i) const
+    {
+        return arg_.get(i);
+    }
+    
     // get the value of the expression at an offset of the current pointer location
     template <class SHAPE>
     result_type operator[](SHAPE const & s) const
@@ -203,11 +300,31 @@ struct MultiMathOperand<MultiArrayView<N, T, C> >
         p_ -= shape_[axis]*strides_[axis];
     }
     
+    void move(unsigned int axis, MultiArrayIndex d) const
+    {
+        p_ += d*strides_[axis];
+    }
+    
+    bool isUnstrided(unsigned int axis) const
+    {
+        return strides_[axis] == 1;
+    }
+    
+    bool isMergeable(unsigned int inner, unsigned int outer) const
+    {
+        return strides_[outer] == shape_[inner]*strides_[inner];
+    }
+    
     result_type operator*() const
     {
         return *p_;
     }
     
+    T const & get(MultiArrayIndex i) const
+    {
+        return p_[i];
+    }
+    
     mutable T const * p_;
     Shape shape_, strides_;
 };
@@ -253,11 +370,29 @@ struct MultiMathScalarOperand
     void reset(unsigned int /* axis */) const
     {}
     
+    void move(unsigned int /* axis */, MultiArrayIndex /* d */) const
+    {}
+    
+    bool isUnstrided(unsigned int /* axis */) const
+    {
+        return true;
+    }
+    
+    bool isMergeable(unsigned int /* inner */, unsigned int /* outer */) const
+    {
+        return true;
+    }
+    
     T const & operator*() const
     {
         return v_;
     }
     
+    T const & get(MultiArrayIndex /* i */) const
+    {
+        return v_;
+    }
+    
     T v_;
 };
 
@@ -328,6 +463,21 @@ struct MultiMathUnaryOperator
         o_.reset(axis);
     }
     
+    void move(unsigned int axis, MultiArrayIndex d) const
+    {
+        o_.move(axis, d);
+    }
+    
+    bool isUnstrided(unsigned int axis) const
+    {
+        return o_.isUnstrided(axis);
+    }
+    
+    bool isMergeable(unsigned int inner, unsigned int outer) const
+    {
+        return o_.isMergeable(inner, outer);
+    }
+    
     template <class POINT>
     result_type operator[](POINT const & p) const
     {
@@ -339,6 +489,11 @@ struct MultiMathUnaryOperator
         return f_(*o_);
     }
     
+    result_type get(MultiArrayIndex i) const
+    {
+        return f_(o_.get(i));
+    }
+    
     O o_;
     F f_;
 };
@@ -489,11 +644,32 @@ struct MultiMathBinaryOperator
         o2_.reset(axis);
     }
     
+    void move(unsigned int axis, MultiArrayIndex d) const
+    {
+        o1_.move(axis, d);
+        o2_.move(axis, d);
+    }
+    
+    bool isUnstrided(unsigned int axis) const
+    {
+        return o1_.isUnstrided(axis) && o2_.isUnstrided(axis);
+    }
+    
+    bool isMergeable(unsigned int inner, unsigned int outer) const
+    {
+        return o1_.isMergeable(inner, outer) && o2_.isMergeable(inner, outer);
+    }
+    
     result_type operator*() const
     {
         return f_(*o1_, *o2_);
     }
     
+    result_type get(MultiArrayIndex i) const
+    {
+        return f_(o1_.get(i), o2_.get(i));
+    }
+    
     O1 o1_;
     O2 o2_;
     F f_;
@@ -674,57 +850,250 @@ VIGRA_MULTIMATH_BINARY_OPERATOR(Maximum, std::max, maximum, VIGRA_COMMA, VIGRA_P
 
 namespace detail {
 
-// We pass 'strideOrder' to the recursion in order to make sure
-// that the inner loop iterates over the output's major axis.
-// Of course, this does not help when the RHS arrays are ordered 
-// differently -- maybe it is better to find the most common order
-// among all arguments (both RHS and LHS)?
-//
-template <unsigned int N, class Assign>
-struct MultiMathExec
+    // Loop structure for the evaluation of an array expression. The axes are
+    // visited in the given order (usually the stride ordering of the LHS array),
+    // singleton axes are dropped, and adjacent axes that are contiguous in the
+    // LHS and in all RHS arrays are merged, so that the inner loop becomes
+    // as long as possible. If the inner strides of all arrays are 1, the inner
+    // loop uses indexed access via MultiMathOperand::get() and can be 
+    // vectorized by the compiler. The outer axes are enumerated as 'lines', 
+    // which can be further divided into segments. Each segment of a line is an
+    // item of parallel work.
+    //
+    // A kernel is called as 'kernel(e, offset, length)', where 'e' points to
+    // the first element of a segment, and 'offset' is that element's offset
+    // in the LHS array. The kernel must leave the position of 'e' unchanged.
+    //
+template <unsigned int N>
+class MultiMathLoop
 {
-    enum { LEVEL = N-1 };
-    
-    template <class T, class Shape, class Expression>
-    static void exec(T * data, Shape const & shape, Shape const & strides, 
-                     Shape const & strideOrder, Expression const & e)
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    template <class Expression>
+    MultiMathLoop(Shape const & shape, Shape const & strides, Shape const & order,
+                  Expression const & e)
+    : dims_(0),
+      lines_(1),
+      segments_(1)
     {
-        MultiArrayIndex axis = strideOrder[LEVEL];
-        for(MultiArrayIndex k=0; k<shape[axis]; ++k, data += strides[axis], e.inc(axis))
+        for(unsigned int k=0; k<N; ++k)
         {
-            MultiMathExec<N-1, Assign>::exec(data, shape, strides, strideOrder, e);
+            unsigned int d = order[k];
+            if(shape[d] == 1)
+                continue;
+            int m = dims_ - 1;
+            if(m >= 0 && strides_[m]*shape_[m] == strides[d] && e.isMergeable(last_[m], d))
+            {
+                shape_[m] *= shape[d];
+                last_[m] = d;
+                continue;
+            }
+            m = dims_++;
+            shape_[m] = shape[d];
+            strides_[m] = strides[d];
+            axes_[m] = last_[m] = d;
         }
-        e.reset(axis);
-        data -= shape[axis]*strides[axis];
+        if(dims_ == 0)
+        {
+            // the array has a single element
+            dims_ = 1;
+            shape_[0] = 1;
+            strides_[0] = strides[order[0]];
+            axes_[0] = last_[0] = order[0];
+        }
+        for(int d=1; d<dims_; ++d)
+            lines_ *= shape_[d];
+        if(shape_[0] == 0)
+            lines_ = 0;
+        segment_length_ = shape_[0];
+        unstrided_ = strides_[0] == 1 && e.isUnstrided(axes_[0]);
+    }
+
+        // split the lines into segments, so that there are at least
+        // 'minimumItems' items if possible
+    void setMinimumNumberOfItems(MultiArrayIndex minimumItems)
+    {
+        if(lines_ == 0 || lines_ >= minimumItems)
+            return;
+        segments_ = std::min(shape_[0], (minimumItems + lines_ - 1) / lines_);
+        segment_length_ = (shape_[0] + segments_ - 1) / segments_;
+        segments_ = (shape_[0] + segment_length_ - 1) / segment_length_;
     }
+
+    MultiArrayIndex numberOfItems() const
+    {
+        return lines_*segments_;
+    }
+
+    unsigned int innerAxis() const
+    {
+        return axes_[0];
+    }
+
+    MultiArrayIndex innerStride() const
+    {
+        return strides_[0];
+    }
+
+    bool isUnstrided() const
+    {
+        return unstrided_;
+    }
+
+        // call the kernel for the items in [begin, end) on a copy of 'e'
+    template <class Expression, class Kernel>
+    void run(Expression const & e, Kernel & kernel, 
+             MultiArrayIndex begin, MultiArrayIndex end) const
+    {
+        if(begin >= end)
+            return;
+        Expression le(e);
+        if(segments_ == 1)
+        {
+            // step through complete lines incrementally
+            MultiArrayIndex c[N] = { 0 }, offset = 0, line = begin;
+            for(int d=1; d<dims_; ++d)
+            {
+                c[d] = line % shape_[d];
+                line /= shape_[d];
+                offset += c[d]*strides_[d];
+                le.move(axes_[d], c[d]);
+            }
+            for(MultiArrayIndex item=begin; item<end; ++item)
+            {
+                kernel(le, offset, shape_[0]);
+                for(int d=1; d<dims_; ++d)
+                {
+                    le.move(axes_[d], 1);
+                    offset += strides_[d];
+                    if(++c[d] < shape_[d])
+                        break;
+                    le.move(axes_[d], -shape_[d]);
+                    offset -= shape_[d]*strides_[d];
+                    c[d] = 0;
+                }
+            }
+        }
+        else
+        {
+            for(MultiArrayIndex item=begin; item<end; ++item)
+            {
+                MultiArrayIndex line   = item / segments_,
+                                start  = (item % segments_)*segment_length_,
+                                length = std::min(segment_length_, shape_[0] - start),
+                                offset = start*strides_[0];
+                Expression se(le);
+                se.move(axes_[0], start);
+                for(int d=1; d<dims_; ++d)
+                {
+                    MultiArrayIndex c = line % shape_[d];
+                    line /= shape_[d];
+                    offset += c*strides_[d];
+                    se.move(axes_[d], c);
+                }
+                kernel(se, offset, length);
+            }
+        }
+    }
+
+  private:
+    Shape shape_, strides_;
+    unsigned int axes_[N], last_[N];
+    int dims_;
+    MultiArrayIndex lines_, segments_, segment_length_;
+    bool unstrided_;
 };
 
-template <class Assign>
-struct MultiMathExec<1, Assign>
+    // Evaluate the items of 'loop' in 'ranges' contiguous ranges, using the 
+    // same kernel for all ranges.
+template <unsigned int N, class Expression, class Kernel>
+struct MultiMathLoopTask
 {
-    enum { LEVEL = 0 };
-    
-    template <class T, class Shape, class Expression>
-    static void exec(T * data, Shape const & shape, Shape const & strides, 
-                     Shape const & strideOrder, Expression const & e)
+    MultiMathLoop<N> const & loop;
+    Expression const & e;
+    Kernel const & kernel;
+    MultiArrayIndex ranges;
+
+    void operator()(int, std::ptrdiff_t r) const
     {
-        MultiArrayIndex axis = strideOrder[LEVEL];
-        for(MultiArrayIndex k=0; k<shape[axis]; ++k, data += strides[axis], e.inc(axis))
+        MultiArrayIndex items = loop.numberOfItems();
+        loop.run(e, kernel, r*items / ranges, (r+1)*items / ranges);
+    }
+};
+
+template <class T, class Assign>
+struct MultiMathAssignKernel
+{
+    T * data;
+    MultiArrayIndex stride;
+    unsigned int axis;
+    bool unstrided;
+
+    template <class Expression>
+    void operator()(Expression const & e, MultiArrayIndex offset, MultiArrayIndex length) const
+    {
+        T * d = data + offset;
+        if(unstrided)
         {
-            Assign::assign(data, e);
+            for(MultiArrayIndex i=0; i<length; ++i)
+                Assign::assign(d+i, e.get(i));
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i, d += stride, e.inc(axis))
+                Assign::assign(d, *e);
+            e.move(axis, -length);
         }
-        e.reset(axis);
-        data -= shape[axis]*strides[axis];
     }
 };
 
+    // Evaluate the expression into the LHS array. The axes are traversed in the
+    // stride ordering of the LHS array, so that the inner loop iterates over its
+    // major axis. Of course, this does not help when the RHS arrays are ordered
+    // differently. When enabled by setMultiMathThreads(), large arrays are split 
+    // into items which are evaluated by multiMathThreads() threads.
+    //
+template <class Assign, unsigned int N, class T, class C, class Expression>
+void multiMathExec(MultiArrayView<N, T, C> const & a, Expression const & e)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    
+    // singleton axes are moved to the end of the order, because they are dropped
+    Shape order(a.strideOrdering()), o;
+    int k = 0;
+    for(unsigned int d=0; d<N; ++d)
+        if(a.shape(order[d]) != 1)
+            o[k++] = order[d];
+    for(unsigned int d=0; d<N; ++d)
+        if(a.shape(order[d]) == 1)
+            o[k++] = order[d];
+
+    MultiMathLoop<N> loop(a.shape(), a.stride(), o, e);
+    MultiMathAssignKernel<T, Assign> kernel = { a.data(), loop.innerStride(), 
+                                                loop.innerAxis(), loop.isUnstrided() };
+    int nThreads = multiMathThreads();
+    if(nThreads > 1 && a.size() >= VIGRA_MULTI_MATH_PARALLEL_THRESHOLD)
+    {
+        loop.setMinimumNumberOfItems(4*nThreads);
+        MultiArrayIndex ranges = std::min<MultiArrayIndex>(4*nThreads, loop.numberOfItems());
+        MultiMathLoopTask<N, Expression, MultiMathAssignKernel<T, Assign> > 
+            task = { loop, e, kernel, ranges };
+        parallel_foreach(nThreads, ranges, task);
+    }
+    else
+    {
+        loop.run(e, kernel, 0, loop.numberOfItems());
+    }
+}
+
 #define VIGRA_MULTIMATH_ASSIGN(NAME, OP) \
 struct MultiMath##NAME \
 { \
-    template <class T, class Expression> \
-    static void assign(T * data, Expression const & e) \
+    template <class T, class V> \
+    static void assign(T * data, V const & v) \
     { \
-        *data OP vigra::detail::RequiresExplicitCast<T>::cast(*e); \
+        *data OP vigra::detail::RequiresExplicitCast<T>::cast(v); \
     } \
 }; \
  \
@@ -736,8 +1105,7 @@ void NAME(MultiArrayView<N, T, C> a, MultiMathOperand<Expression> const & e) \
     vigra_precondition(e.checkShape(shape), \
        "multi_math: shape mismatch in expression."); \
         \
-    MultiMathExec<N, MultiMath##NAME>::exec(a.data(), a.shape(), a.stride(), \
-                                            a.strideOrdering(), e); \
+    multiMathExec<MultiMath##NAME>(a, e); \
 } \
  \
 template <unsigned int N, class T, class A, class Expression> \
@@ -751,8 +1119,7 @@ void NAME##OrResize(MultiArray<N, T, A> & a, MultiMathOperand<Expression> const
     if(a.size() == 0) \
         a.reshape(shape); \
          \
-    MultiMathExec<N, MultiMath##NAME>::exec(a.data(), a.shape(), a.stride(), \
-                                            a.strideOrdering(), e); \
+    multiMathExec<MultiMath##NAME>(a, e); \
 }
 
 VIGRA_MULTIMATH_ASSIGN(assign, =)
@@ -763,56 +1130,105 @@ VIGRA_MULTIMATH_ASSIGN(divideAssign, /=)
 
 #undef VIGRA_MULTIMATH_ASSIGN
 
-template <unsigned int N, class Assign>
-struct MultiMathReduce
+struct MultiMathReduceAll
 {
-    enum { LEVEL = N-1 };
-    
-    template <class T, class Shape, class Expression>
-    static void exec(T & t, Shape const & shape, Expression const & e)
+    template <class T, class V>
+    static void assign(T * data, V const & v)
     {
-        for(MultiArrayIndex k=0; k<shape[LEVEL]; ++k, e.inc(LEVEL))
-        {
-            MultiMathReduce<N-1, Assign>::exec(t, shape, e);
-        }
-        e.reset(LEVEL);
+        *data = *data && (v != NumericTraits<V>::zero());
+    }
+};
+
+struct MultiMathReduceAny
+{
+    template <class T, class V>
+    static void assign(T * data, V const & v)
+    {
+        *data = *data || (v != NumericTraits<V>::zero());
     }
 };
 
-template <class Assign>
-struct MultiMathReduce<1, Assign>
+template <class U, class Assign>
+struct MultiMathReduceKernel
 {
-    enum { LEVEL = 0 };
-    
-    template <class T, class Shape, class Expression>
-    static void exec(T & t, Shape const & shape, Expression const & e)
+    U * result;
+    unsigned int axis;
+    bool unstrided;
+
+    template <class Expression>
+    void operator()(Expression const & e, MultiArrayIndex, MultiArrayIndex length) const
     {
-        for(MultiArrayIndex k=0; k<shape[0]; ++k, e.inc(0))
+        U t = *result;
+        if(unstrided)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                Assign::assign(&t, e.get(i));
+        }
+        else
         {
-            Assign::assign(&t, e);
+            for(MultiArrayIndex i=0; i<length; ++i, e.inc(axis))
+                Assign::assign(&t, *e);
+            e.move(axis, -length);
         }
-        e.reset(0);
+        *result = t;
     }
 };
 
-struct MultiMathReduceAll
+template <unsigned int N, class Expression, class U, class Assign>
+struct MultiMathReduceTask
 {
-    template <class T, class Expression>
-    static void assign(T * data, Expression const & e)
+    MultiMathLoop<N> const & loop;
+    Expression const & e;
+    U * results;
+    MultiArrayIndex ranges;
+
+    void operator()(int, std::ptrdiff_t r) const
     {
-        *data = *data && (*e != NumericTraits<typename Expression::result_type>::zero());
+        MultiMathReduceKernel<U, Assign> kernel = { results + r, loop.innerAxis(), 
+                                                    loop.isUnstrided() };
+        MultiArrayIndex items = loop.numberOfItems();
+        loop.run(e, kernel, r*items / ranges, (r+1)*items / ranges);
     }
 };
 
-struct MultiMathReduceAny
+    // Reduce the expression to a single value in the same pass that evaluates 
+    // it, without creating a temporary array. The axes are traversed in their
+    // natural order. Large arrays are split into a fixed number of ranges 
+    // (independent of the number of threads), whose partial results are 
+    // initialized with 'neutral' and combined in order at the end. Thus, the 
+    // result is reproducible regardless of how many threads are used.
+    //
+template <class Assign, class U, class Expression>
+void multiMathReduce(U & res, U const & neutral, Expression const & e)
 {
-    template <class T, class Expression>
-    static void assign(T * data, Expression const & e)
+    static const int N = Expression::ndim;
+    typedef typename MultiArrayShape<N>::type Shape;
+    
+    Shape shape, order;
+    e.checkShape(shape);
+    for(int k=0; k<N; ++k)
+        order[k] = k;
+        
+    MultiMathLoop<N> loop(shape, vigra::detail::defaultStride<N>(shape), order, e);
+    if(prod(shape) >= VIGRA_MULTI_MATH_PARALLEL_THRESHOLD)
     {
-        *data = *data || (*e != NumericTraits<typename Expression::result_type>::zero());
+        loop.setMinimumNumberOfItems(64);
+        MultiArrayIndex ranges = std::min<MultiArrayIndex>(64, loop.numberOfItems());
+        ArrayVector<U> partial(ranges, neutral);
+        partial[0] = res;
+        MultiMathReduceTask<N, Expression, U, Assign> task = { loop, e, partial.begin(), ranges };
+        parallel_foreach(multiMathThreads(), ranges, task);
+        res = partial[0];
+        for(MultiArrayIndex r=1; r<ranges; ++r)
+            Assign::assign(&res, partial[r]);
     }
-};
-
+    else
+    {
+        MultiMathReduceKernel<U, Assign> kernel = { &res, loop.innerAxis(), 
+                                                    loop.isUnstrided() };
+        loop.run(e, kernel, 0, loop.numberOfItems());
+    }
+}
 
 } // namespace detail
 
@@ -820,10 +1236,7 @@ template <class U, class T>
 U
 sum(MultiMathOperand<T> const & v, U res = NumericTraits<U>::zero()) 
 { 
-    static const int ndim = MultiMathOperand<T>::ndim;
-    typename MultiArrayShape<ndim>::type shape;
-    v.checkShape(shape);
-    detail::MultiMathReduce<ndim, detail::MultiMathplusAssign>::exec(res, shape, v);
+    detail::multiMathReduce<detail::MultiMathplusAssign>(res, U(NumericTraits<U>::zero()), v);
     return res;
 }
 
@@ -838,10 +1251,7 @@ template <class U, class T>
 U
 product(MultiMathOperand<T> const & v, U res = NumericTraits<U>::one()) 
 { 
-    static const int ndim = MultiMathOperand<T>::ndim;
-    typename MultiArrayShape<ndim>::type shape;
-    v.checkShape(shape);
-    detail::MultiMathReduce<ndim, detail::MultiMathmultiplyAssign>::exec(res, shape, v);
+    detail::multiMathReduce<detail::MultiMathmultiplyAssign>(res, U(NumericTraits<U>::one()), v);
     return res;
 }
 
@@ -856,11 +1266,8 @@ template <class T>
 bool
 all(MultiMathOperand<T> const & v) 
 { 
-    static const int ndim = MultiMathOperand<T>::ndim;
-    typename MultiArrayShape<ndim>::type shape;
-    v.checkShape(shape);
     bool res = true;
-    detail::MultiMathReduce<ndim, detail::MultiMathReduceAll>::exec(res, shape, v);
+    detail::multiMathReduce<detail::MultiMathReduceAll>(res, true, v);
     return res;
 }
 
@@ -868,11 +1275,8 @@ template <class T>
 bool
 any(MultiMathOperand<T> const & v) 
 { 
-    static const int ndim = MultiMathOperand<T>::ndim;
-    typename MultiArrayShape<ndim>::type shape;
-    v.checkShape(shape);
     bool res = false;
-    detail::MultiMathReduce<ndim, detail::MultiMathReduceAny>::exec(res, shape, v);
+    detail::multiMathReduce<detail::MultiMathReduceAny>(res, false, v);
     return res;
 }
 
@@ -48,6 +48,7 @@
 #include "metaprogramming.hxx"
 #include "multi_pointoperators.hxx"
 #include "functorexpression.hxx"
+#include "threadpool.hxx"
 
 namespace vigra
 {
@@ -131,6 +132,251 @@ struct MultiBinaryMorphologyImpl<bool, bool>
     }
 };
 
+/********************************************************/
+/*                                                      */
+/*                BoxMorphologyFunctor                  */
+/*                                                      */
+/********************************************************/
+
+template <class T>
+struct BoxMorphologyMinimum
+{
+    static T neutral() 
+    { 
+        return NumericTraits<T>::max(); 
+    }
+    
+    T operator()(T a, T b) const 
+    { 
+        return b < a ? b : a; 
+    }
+};
+
+template <class T>
+struct BoxMorphologyMaximum
+{
+    static T neutral() 
+    { 
+        return NumericTraits<T>::min(); 
+    }
+    
+    T operator()(T a, T b) const 
+    { 
+        return a < b ? b : a; 
+    }
+};
+
+    // Compute the running minimum or maximum (depending on 'Operator') over 
+    // windows of size 2*radius+1 along all lines parallel to 'axis' with the
+    // van Herk/Gil-Werman algorithm: the padded line is split into blocks of 
+    // the window size, and the result at each position is combined from the 
+    // suffix extremum of one block and the prefix extremum of the next, i.e.
+    // the cost per pixel is independent of the radius. Positions outside the
+    // array are padded with the neutral element, so they never win.
+    //
+    // Like convolveLinesAlongAxis(), tiles of lines are gathered into a transposed 
+    // buffer, such that all inner loops run across lines and vectorize. The lines
+    // are distributed over the threads by slicing along 'outer_axis', and each
+    // thread uses its own buffer.
+template <unsigned int N, class T1, class T2, class Operator>
+class BoxMorphologyFunctor
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef MultiArrayView<N, T1, StridedArrayTag> SrcArray;
+    typedef MultiArrayView<N, T2, StridedArrayTag> DestArray;
+    typedef MultiArrayNavigator<typename SrcArray::traverser, N> SNavigator;
+    typedef MultiArrayNavigator<typename DestArray::traverser, N> DNavigator;
+    
+    // number of lines per tile: about two cache lines worth of data
+    enum { TileSize = 128 / sizeof(T2) < 8
+                          ? 8
+                          : 128 / sizeof(T2) > 32
+                              ? 32
+                              : 128 / sizeof(T2) };
+
+    BoxMorphologyFunctor(SrcArray src, DestArray dest,
+                         unsigned int axis, unsigned int outer_axis, MultiArrayIndex slice_size,
+                         MultiArrayIndex radius, ArrayVector<ArrayVector<T2> > & buffers)
+    : src_(src), dest_(dest),
+      axis_(axis), outer_axis_(outer_axis), slice_size_(slice_size), radius_(radius),
+      buffers_(buffers)
+    {}
+    
+        // process the lines in slice 'k' of the outer axis
+    void operator()(int threadId, MultiArrayIndex k) const
+    {
+        Shape start, stop(src_.shape());
+        if(outer_axis_ != axis_)
+        {
+            start[outer_axis_] = k*slice_size_;
+            stop[outer_axis_]  = std::min(stop[outer_axis_], start[outer_axis_] + slice_size_);
+        }
+        
+        SrcArray src(src_);
+        DestArray dest(dest_);
+        SNavigator snav(src.traverser_begin(), start, stop, axis_);
+        DNavigator dnav(dest.traverser_begin(), start, stop, axis_);
+        
+        // the padded line covers [-radius, n+radius) and consists of whole windows
+        MultiArrayIndex n = src_.shape(axis_), 
+                        w = 2*radius_ + 1,
+                        m = (n + 2*radius_ + w - 1) / w * w;
+        
+        ArrayVector<T2> & buffer = buffers_[threadId];
+        buffer.resize(2*m*TileSize);
+        
+        typename SNavigator::iterator slines[TileSize];
+        typename DNavigator::iterator dlines[TileSize];
+        Operator op;
+        T2 neutral = Operator::neutral();
+        
+        while(snav.hasMore())
+        {
+            int lines = 0;
+            for(; lines < TileSize && snav.hasMore(); ++lines, snav++, dnav++)
+            {
+                slines[lines] = snav.begin();
+                dlines[lines] = dnav.begin();
+            }
+            
+            // gather: element 'p' of padded line 'j' is at 'h[(p+radius)*lines + j]'
+            T2 * g = buffer.begin(), * h = g + m*lines;
+            for(MultiArrayIndex p = 0; p < radius_*lines; ++p)
+                h[p] = neutral;
+            for(MultiArrayIndex p = (n + radius_)*lines; p < m*lines; ++p)
+                h[p] = neutral;
+            if(axis_ == 0) // read the lines sequentially
+            {
+                for(int j = 0; j < lines; ++j)
+                    for(MultiArrayIndex x = 0; x < n; ++x)
+                        h[(x + radius_)*lines + j] = detail::RequiresExplicitCast<T2>::cast(slines[j][x]);
+            }
+            else           // read neighboring lines simultaneously
+            {
+                for(MultiArrayIndex x = 0; x < n; ++x)
+                    for(int j = 0; j < lines; ++j)
+                        h[(x + radius_)*lines + j] = detail::RequiresExplicitCast<T2>::cast(slines[j][x]);
+            }
+                
+            // prefix extrema (g) and suffix extrema (h, in-place) of each block
+            for(MultiArrayIndex b = 0; b < m; b += w)
+            {
+                T2 * gb = g + b*lines, * hb = h + b*lines;
+                for(int j = 0; j < lines; ++j)
+                    gb[j] = hb[j];
+                for(MultiArrayIndex i = 1; i < w; ++i)
+                {
+                    T2 const * gp = gb + (i-1)*lines, * hi = hb + i*lines;
+                    T2 * gi = gb + i*lines;
+                    for(int j = 0; j < lines; ++j)
+                        gi[j] = op(gp[j], hi[j]);
+                }
+                for(MultiArrayIndex i = w-2; i >= 0; --i)
+                {
+                    T2 const * hn = hb + (i+1)*lines;
+                    T2 * hi = hb + i*lines;
+                    for(int j = 0; j < lines; ++j)
+                        hi[j] = op(hi[j], hn[j]);
+                }
+            }
+            
+            // scatter: the window of 'x' covers the padded positions [x, x+w-1]
+            for(MultiArrayIndex x = 0; x < n; ++x)
+            {
+                T2 * hx = h + x*lines, * gx = g + (x + w - 1)*lines;
+                for(int j = 0; j < lines; ++j)
+                    hx[j] = op(hx[j], gx[j]);
+            }
+            if(axis_ == 0)
+            {
+                for(int j = 0; j < lines; ++j)
+                    for(MultiArrayIndex x = 0; x < n; ++x)
+                        dlines[j][x] = h[x*lines + j];
+            }
+            else
+            {
+                for(MultiArrayIndex x = 0; x < n; ++x)
+                    for(int j = 0; j < lines; ++j)
+                        dlines[j][x] = h[x*lines + j];
+            }
+        }
+    }
+    
+    SrcArray src_;
+    DestArray dest_;
+    unsigned int axis_, outer_axis_;
+    MultiArrayIndex slice_size_, radius_;
+    ArrayVector<ArrayVector<T2> > & buffers_;
+};
+
+template <unsigned int N, class T1, class T2, class Operator>
+void
+boxMorphologyAlongAxis(MultiArrayView<N, T1, StridedArrayTag> const & src,
+                       MultiArrayView<N, T2, StridedArrayTag> const & dest,
+                       unsigned int axis, MultiArrayIndex radius, int nThreads, Operator)
+{
+    typedef BoxMorphologyFunctor<N, T1, T2, Operator> Functor;
+    
+    // split along the longest of the remaining axes, but keep axis 0 intact 
+    // if possible (tiles of lines that are adjacent along axis 0 are gathered 
+    // from consecutive addresses); every slice should hold at least a full tile 
+    unsigned int outer_axis = axis;
+    for(unsigned int k=0; k<N; ++k)
+        if(k != axis && (outer_axis == axis || outer_axis == 0 ||
+                         (k != 0 && src.shape(k) > src.shape(outer_axis))))
+            outer_axis = k;
+    MultiArrayIndex slice_size = 1, 
+                    slices = 1;
+    if(outer_axis != axis)
+    {
+        MultiArrayIndex lines = src.size() / src.shape(axis) / src.shape(outer_axis);
+        slice_size = std::max<MultiArrayIndex>(1, ((MultiArrayIndex)Functor::TileSize + lines - 1) / lines);
+        slices = (src.shape(outer_axis) + slice_size - 1) / slice_size;
+    }
+    
+    ArrayVector<ArrayVector<T2> > buffers(nThreads);
+    Functor f(src, dest, axis, outer_axis, slice_size, radius, buffers);
+    parallel_foreach(nThreads, slices, f);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2, class Operator>
+void
+internalBoxMorphology(MultiArrayView<N, T1, S1> const & source,
+                      MultiArrayView<N, T2, S2> dest,
+                      typename MultiArrayShape<N>::type const & radius,
+                      int nThreads, Operator op)
+{
+    vigra_precondition(source.shape() == dest.shape(),
+        "multiBoxMorphology(): shape mismatch between input and output.");
+    vigra_precondition(radius.minimum() >= 0,
+        "multiBoxMorphology(): radius must not be negative.");
+    
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+        
+    bool first = true;
+    for(unsigned int k=0; k<N; ++k)
+    {
+        // a window of radius 'shape(k)-1' already covers every line completely,
+        // larger radii would only inflate the padded line buffers
+        MultiArrayIndex r = std::min<MultiArrayIndex>(radius[k], source.shape(k) - 1);
+        if(r <= 0)
+            continue;
+        if(first)
+            boxMorphologyAlongAxis(MultiArrayView<N, T1, StridedArrayTag>(source),
+                                   MultiArrayView<N, T2, StridedArrayTag>(dest), 
+                                   k, r, nThreads, op);
+        else
+            boxMorphologyAlongAxis(MultiArrayView<N, T2, StridedArrayTag>(dest),
+                                   MultiArrayView<N, T2, StridedArrayTag>(dest), 
+                                   k, r, nThreads, op);
+        first = false;
+    }
+    if(first) // all radii are zero
+        copyMultiArray(srcMultiArrayRange(source), destMultiArray(dest));
+}
+
 } // namespace detail
 
 /** \addtogroup MultiArrayMorphology Morphological operators for multi-dimensional arrays.
@@ -576,6 +822,273 @@ void multiGrayscaleDilation(
             dest.first, dest.second, sigma);
 }
 
+/********************************************************/
+/*                                                      */
+/*             multiBoxErosion                          */
+/*                                                      */
+/********************************************************/
+/** \brief Flat erosion with a box structuring element on multi-dimensional arrays.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // box with individual radius along each axis
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxErosion(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        typename MultiArrayShape<N>::type const & radius,
+                        int nThreads = 1);
+        
+        // box with the same radius along all axes
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxErosion(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        MultiArrayIndex radius, int nThreads = 1);
+    }
+    \endcode
+
+    This function computes the minimum of 'source' over an axis-aligned box 
+    which extends <tt>radius[k]</tt> pixels to either side of the center along axis 'k'
+    (i.e. the box has size <tt>2*radius[k]+1</tt>) and writes it into 'dest'. Axes with 
+    zero radius are not filtered, so line structuring elements are obtained by setting
+    the radius of all axes but one to zero. Pixels outside the array are ignored.
+    
+    The box is decomposed into one line filter per axis, and each line is processed 
+    with the van Herk/Gil-Werman algorithm, which requires three comparisons per
+    pixel regardless of the radius (in contrast to \ref discErosion(), whose cost grows 
+    with the radius, and to \ref multiGrayscaleErosion(), which uses parabolic 
+    structuring elements). Like the separable convolution functions, tiles of 
+    neighboring lines are processed simultaneously, so that the inner loops vectorize, 
+    and the lines are distributed over 'nThreads' threads (<tt>nThreads <= 0</tt> means 
+    \ref defaultConcurrency()). The function works in-place, i.e. 'source' and 'dest' 
+    may refer to the same data.
+    
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_morphology.hxx\>
+
+    \code
+    MultiArray<3, unsigned char> source(Shape3(width, height, depth)), dest(source.shape());
+    ...
+
+    // erosion with a 5x5x3 box, using 4 threads
+    multiBoxErosion(source, dest, Shape3(2, 2, 1), 4);
+    
+    // erosion with a line of length 7 along the z-axis
+    multiBoxErosion(source, dest, Shape3(0, 0, 3));
+    \endcode
+
+    <b> Required Interface:</b>
+    
+    \code
+    T2 u, v;
+    u < v;
+    NumericTraits<T2>::max();
+    \endcode
+
+    \see vigra::multiBoxDilation(), vigra::multiBoxOpening(), vigra::multiBoxClosing()
+*/
+doxygen_overloaded_function(template <...> void multiBoxErosion)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+multiBoxErosion(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                typename MultiArrayShape<N>::type const & radius,
+                int nThreads = 1)
+{
+    detail::internalBoxMorphology(source, dest, radius, nThreads, 
+                                  detail::BoxMorphologyMinimum<T2>());
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+multiBoxErosion(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                MultiArrayIndex radius, int nThreads = 1)
+{
+    multiBoxErosion(source, dest, typename MultiArrayShape<N>::type(radius), nThreads);
+}
+
+/********************************************************/
+/*                                                      */
+/*             multiBoxDilation                         */
+/*                                                      */
+/********************************************************/
+/** \brief Flat dilation with a box structuring element on multi-dimensional arrays.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // box with individual radius along each axis
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxDilation(MultiArrayView<N, T1, S1> const & source,
+                         MultiArrayView<N, T2, S2> dest,
+                         typename MultiArrayShape<N>::type const & radius,
+                         int nThreads = 1);
+        
+        // box with the same radius along all axes
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxDilation(MultiArrayView<N, T1, S1> const & source,
+                         MultiArrayView<N, T2, S2> dest,
+                         MultiArrayIndex radius, int nThreads = 1);
+    }
+    \endcode
+
+    This function computes the maximum of 'source' over the box defined by 'radius'.
+    See \ref multiBoxErosion() for details.
+    
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_morphology.hxx\>
+
+    \code
+    MultiArray<2, float> source(Shape2(width, height)), dest(source.shape());
+    ...
+
+    // dilation with a 7x7 square
+    multiBoxDilation(source, dest, 3);
+    \endcode
+
+    \see vigra::multiBoxErosion(), vigra::multiBoxOpening(), vigra::multiBoxClosing()
+*/
+doxygen_overloaded_function(template <...> void multiBoxDilation)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+multiBoxDilation(MultiArrayView<N, T1, S1> const & source,
+                 MultiArrayView<N, T2, S2> dest,
+                 typename MultiArrayShape<N>::type const & radius,
+                 int nThreads = 1)
+{
+    detail::internalBoxMorphology(source, dest, radius, nThreads, 
+                                  detail::BoxMorphologyMaximum<T2>());
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+multiBoxDilation(MultiArrayView<N, T1, S1> const & source,
+                 MultiArrayView<N, T2, S2> dest,
+                 MultiArrayIndex radius, int nThreads = 1)
+{
+    multiBoxDilation(source, dest, typename MultiArrayShape<N>::type(radius), nThreads);
+}
+
+/********************************************************/
+/*                                                      */
+/*             multiBoxOpening                          */
+/*                                                      */
+/********************************************************/
+/** \brief Flat opening with a box structuring element on multi-dimensional arrays.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // box with individual radius along each axis
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxOpening(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        typename MultiArrayShape<N>::type const & radius,
+                        int nThreads = 1);
+        
+        // box with the same radius along all axes
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxOpening(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        MultiArrayIndex radius, int nThreads = 1);
+    }
+    \endcode
+
+    Erosion followed by dilation with the same box, see \ref multiBoxErosion() 
+    for details. The intermediate result is stored in 'dest'.
+    
+    \see vigra::multiBoxErosion(), vigra::multiBoxDilation(), vigra::multiBoxClosing()
+*/
+doxygen_overloaded_function(template <...> void multiBoxOpening)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+multiBoxOpening(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                typename MultiArrayShape<N>::type const & radius,
+                int nThreads = 1)
+{
+    multiBoxErosion(source, dest, radius, nThreads);
+    multiBoxDilation(dest, dest, radius, nThreads);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+multiBoxOpening(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                MultiArrayIndex radius, int nThreads = 1)
+{
+    multiBoxOpening(source, dest, typename MultiArrayShape<N>::type(radius), nThreads);
+}
+
+/********************************************************/
+/*                                                      */
+/*             multiBoxClosing                          */
+/*                                                      */
+/********************************************************/
+/** \brief Flat closing with a box structuring element on multi-dimensional arrays.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // box with individual radius along each axis
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxClosing(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        typename MultiArrayShape<N>::type const & radius,
+                        int nThreads = 1);
+        
+        // box with the same radius along all axes
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        multiBoxClosing(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        MultiArrayIndex radius, int nThreads = 1);
+    }
+    \endcode
+
+    Dilation followed by erosion with the same box, see \ref multiBoxErosion() 
+    for details. The intermediate result is stored in 'dest'.
+    
+    \see vigra::multiBoxErosion(), vigra::multiBoxDilation(), vigra::multiBoxOpening()
+*/
+doxygen_overloaded_function(template <...> void multiBoxClosing)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+multiBoxClosing(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                typename MultiArrayShape<N>::type const & radius,
+                int nThreads = 1)
+{
+    multiBoxDilation(source, dest, radius, nThreads);
+    multiBoxErosion(dest, dest, radius, nThreads);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+multiBoxClosing(MultiArrayView<N, T1, S1> const & source,
+                MultiArrayView<N, T2, S2> dest,
+                MultiArrayIndex radius, int nThreads = 1)
+{
+    multiBoxClosing(source, dest, typename MultiArrayShape<N>::type(radius), nThreads);
+}
 
 //@}
 
@@ -45,6 +45,8 @@
 #include "multi_array.hxx"
 #include "metaprogramming.hxx"
 #include "inspector_passes.hxx"
+#include "threadpool.hxx"
+#include "array_vector.hxx"
 
 
 
@@ -62,6 +64,285 @@ namespace vigra
 */
 //@{
 
+/********************************************************/
+/*                                                      */
+/*             loops over MultiArrayView data           */
+/*                                                      */
+/********************************************************/
+
+namespace detail {
+
+    // Loop over the elements of K arrays of the same shape in scan order.
+    // Adjacent dimensions that are contiguous in all arrays are merged (as
+    // are singleton dimensions), so that the innermost loop becomes as long
+    // as possible and can be vectorized by the compiler if all inner strides
+    // are 1. The remaining outer dimensions are enumerated as 'lines', which
+    // can be further divided into segments. Each segment of a line is an item
+    // of parallel work. The kernel is called as
+    //
+    //     kernel(offsets, innerStrides, length)
+    //
+    // where offsets[k] is the offset of the segment's first element in array k.
+template <unsigned int N, int K>
+class MultiArrayPointLoop
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayPointLoop(Shape const & shape, Shape const * strides)
+    : dims_(1),
+      lines_(1),
+      segments_(1),
+      segment_length_(shape[0])
+    {
+        shape_ = Shape(1);
+        shape_[0] = shape[0];
+        for(int k=0; k<K; ++k)
+        {
+            strides_[k] = Shape();
+            strides_[k][0] = strides[k][0];
+        }
+        for(unsigned int d=1; d<N; ++d)
+        {
+            if(shape[d] == 1)
+                continue;
+            int m = dims_ - 1;
+            bool replace = shape_[m] == 1,
+                 merge   = true;
+            for(int k=0; k<K; ++k)
+                merge = merge && strides_[k][m]*shape_[m] == strides[k][d];
+            if(merge && !replace)
+            {
+                shape_[m] *= shape[d];
+                continue;
+            }
+            if(!replace)
+                m = dims_++;
+            shape_[m] = shape[d];
+            for(int k=0; k<K; ++k)
+                strides_[k][m] = strides[k][d];
+        }
+        for(int d=1; d<dims_; ++d)
+            lines_ *= shape_[d];
+        if(shape_[0] == 0)
+            lines_ = 0;
+        segment_length_ = shape_[0];
+        for(int k=0; k<K; ++k)
+            inner_strides_[k] = strides_[k][0];
+    }
+
+        // split the lines into segments, so that there are at least
+        // 'minimumItems' items if possible
+    void setMinimumNumberOfItems(MultiArrayIndex minimumItems)
+    {
+        if(lines_ == 0 || lines_ >= minimumItems)
+            return;
+        segments_ = std::min(shape_[0], (minimumItems + lines_ - 1) / lines_);
+        segment_length_ = (shape_[0] + segments_ - 1) / segments_;
+        segments_ = (shape_[0] + segment_length_ - 1) / segment_length_;
+    }
+
+    MultiArrayIndex numberOfItems() const
+    {
+        return lines_*segments_;
+    }
+
+    template <class Kernel>
+    void operator()(Kernel & kernel, MultiArrayIndex item) const
+    {
+        MultiArrayIndex line   = item / segments_,
+                        begin  = (item % segments_)*segment_length_,
+                        length = std::min(segment_length_, shape_[0] - begin);
+        MultiArrayIndex offsets[K];
+        for(int k=0; k<K; ++k)
+            offsets[k] = begin*strides_[k][0];
+        for(int d=1; d<dims_; ++d)
+        {
+            MultiArrayIndex c = line % shape_[d];
+            line /= shape_[d];
+            for(int k=0; k<K; ++k)
+                offsets[k] += c*strides_[k][d];
+        }
+        kernel(offsets, inner_strides_, length);
+    }
+
+    template <class Kernel>
+    void run(Kernel & kernel, MultiArrayIndex begin, MultiArrayIndex end) const
+    {
+        for(MultiArrayIndex item=begin; item<end; ++item)
+            (*this)(kernel, item);
+    }
+
+    template <class Kernel>
+    void run(Kernel & kernel) const
+    {
+        run(kernel, 0, numberOfItems());
+    }
+
+    template <class Kernel>
+    void run(Kernel const & kernel, ParallelOptions const & opt);
+
+  private:
+    Shape shape_, strides_[K];
+    MultiArrayIndex inner_strides_[K];
+    int dims_;
+    MultiArrayIndex lines_, segments_, segment_length_;
+};
+
+template <unsigned int N, int K, class Kernel>
+struct MultiArrayPointLoopTask
+{
+    MultiArrayPointLoop<N, K> const & loop;
+    Kernel const & kernel;
+
+    void operator()(int, std::ptrdiff_t item) const
+    {
+        loop(kernel, item);
+    }
+};
+
+template <unsigned int N, int K>
+template <class Kernel>
+void
+MultiArrayPointLoop<N, K>::run(Kernel const & kernel, ParallelOptions const & opt)
+{
+    int nThreads = opt.actualNumThreads();
+    setMinimumNumberOfItems(4*nThreads);
+    MultiArrayPointLoopTask<N, K, Kernel> task = { *this, kernel };
+    parallel_foreach(nThreads, numberOfItems(), task);
+}
+
+template <class T, class VALUETYPE>
+struct InitMultiArrayKernel
+{
+    T * d;
+    VALUETYPE v;
+
+    void operator()(MultiArrayIndex const * offsets, MultiArrayIndex const * strides,
+                    MultiArrayIndex length) const
+    {
+        T * pd = d + offsets[0];
+        if(strides[0] == 1)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                pd[i] = v;
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i, pd += strides[0])
+                *pd = v;
+        }
+    }
+};
+
+template <class T1, class T2, class Functor>
+struct TransformMultiArrayKernel
+{
+    T1 const * s;
+    T2 * d;
+    Functor const & f;
+
+    void operator()(MultiArrayIndex const * offsets, MultiArrayIndex const * strides,
+                    MultiArrayIndex length) const
+    {
+        T1 const * ps = s + offsets[0];
+        T2 * pd = d + offsets[1];
+        if(strides[0] == 1 && strides[1] == 1)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                pd[i] = detail::RequiresExplicitCast<T2>::cast(f(ps[i]));
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i, ps += strides[0], pd += strides[1])
+                *pd = detail::RequiresExplicitCast<T2>::cast(f(*ps));
+        }
+    }
+};
+
+template <class T1, class T2, class T3, class Functor>
+struct CombineTwoMultiArraysKernel
+{
+    T1 const * s1;
+    T2 const * s2;
+    T3 * d;
+    Functor const & f;
+
+    void operator()(MultiArrayIndex const * offsets, MultiArrayIndex const * strides,
+                    MultiArrayIndex length) const
+    {
+        T1 const * ps1 = s1 + offsets[0];
+        T2 const * ps2 = s2 + offsets[1];
+        T3 * pd = d + offsets[2];
+        if(strides[0] == 1 && strides[1] == 1 && strides[2] == 1)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                pd[i] = detail::RequiresExplicitCast<T3>::cast(f(ps1[i], ps2[i]));
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i,
+                    ps1 += strides[0], ps2 += strides[1], pd += strides[2])
+                *pd = detail::RequiresExplicitCast<T3>::cast(f(*ps1, *ps2));
+        }
+    }
+};
+
+template <class T1, class T2, class T3, class T4, class Functor>
+struct CombineThreeMultiArraysKernel
+{
+    T1 const * s1;
+    T2 const * s2;
+    T3 const * s3;
+    T4 * d;
+    Functor const & f;
+
+    void operator()(MultiArrayIndex const * offsets, MultiArrayIndex const * strides,
+                    MultiArrayIndex length) const
+    {
+        T1 const * ps1 = s1 + offsets[0];
+        T2 const * ps2 = s2 + offsets[1];
+        T3 const * ps3 = s3 + offsets[2];
+        T4 * pd = d + offsets[3];
+        if(strides[0] == 1 && strides[1] == 1 && strides[2] == 1 && strides[3] == 1)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                pd[i] = detail::RequiresExplicitCast<T4>::cast(f(ps1[i], ps2[i], ps3[i]));
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i,
+                    ps1 += strides[0], ps2 += strides[1], ps3 += strides[2], pd += strides[3])
+                *pd = detail::RequiresExplicitCast<T4>::cast(f(*ps1, *ps2, *ps3));
+        }
+    }
+};
+
+template <class T, class Functor>
+struct InspectMultiArrayKernel
+{
+    T const * s;
+    Functor & f;
+
+    void operator()(MultiArrayIndex const * offsets, MultiArrayIndex const * strides,
+                    MultiArrayIndex length) const
+    {
+        T const * ps = s + offsets[0];
+        if(strides[0] == 1)
+        {
+            for(MultiArrayIndex i=0; i<length; ++i)
+                f(ps[i]);
+        }
+        else
+        {
+            for(MultiArrayIndex i=0; i<length; ++i, ps += strides[0])
+                f(*ps);
+        }
+    }
+};
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*                    initMultiArray                    */
@@ -133,6 +414,26 @@ initMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,
         initMultiArray(triple<Iterator, Shape, Accessor> const & s, FUNCTOR const & f);
     }
     \endcode
+
+    pass arrays as \ref vigra::MultiArrayView objects, optionally with options for
+    parallel execution:
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S, class VALUETYPE>
+        void
+        initMultiArray(MultiArrayView<N, T, S> s, VALUETYPE const & v,
+                       ParallelOptions const & opt = <sequential>);
+
+        template <unsigned int N, class T, class S, class FUNCTOR>
+        void
+        initMultiArray(MultiArrayView<N, T, S> s, FUNCTOR const & f);
+    }
+    \endcode
+
+    The \ref vigra::MultiArrayView versions merge dimensions that are contiguous in memory
+    into a single long loop, which the compiler can vectorize. When \ref vigra::ParallelOptions
+    are given, the array is divided into parts that are processed concurrently
+    (see \ref ParallelProcessing). Initializer functors are always called sequentially.
     
     <b> Usage:</b>
     
@@ -145,6 +446,9 @@ initMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,
     
     // zero the array
     vigra::initMultiArray(destMultiArrayRange(array), 0);
+
+    // the same, using 4 threads
+    vigra::initMultiArray(array, 0, ParallelOptions().numThreads(4));
     \endcode
 
     <b> Required Interface:</b>
@@ -196,6 +500,49 @@ initMultiArray(triple<Iterator, Shape, Accessor> const & s, VALUETYPE const & v)
     initMultiArray(s.first, s.second, s.third, v);
 }
 
+namespace detail {
+
+template <unsigned int N, class T, class S, class VALUETYPE>
+inline void
+initMultiArrayImpl(MultiArrayView<N, T, S> s, VALUETYPE const & v,
+                   ParallelOptions const * opt, VigraFalseType)
+{
+    typename MultiArrayShape<N>::type strides[1] = { s.stride() };
+    MultiArrayPointLoop<N, 1> loop(s.shape(), strides);
+    InitMultiArrayKernel<T, T> kernel = { s.data(), detail::RequiresExplicitCast<T>::cast(v) };
+    if(opt)
+        loop.run(kernel, *opt);
+    else
+        loop.run(kernel);
+}
+
+template <unsigned int N, class T, class S, class FUNCTOR>
+inline void
+initMultiArrayImpl(MultiArrayView<N, T, S> s, FUNCTOR const & f,
+                   ParallelOptions const *, VigraTrueType)
+{
+    // initializers are called sequentially in scan order
+    initMultiArray(destMultiArrayRange(s), f);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T, class S, class VALUETYPE>
+inline void
+initMultiArray(MultiArrayView<N, T, S> s, VALUETYPE const & v)
+{
+    detail::initMultiArrayImpl(s, v, (ParallelOptions const *)0,
+                               typename FunctorTraits<VALUETYPE>::isInitializer());
+}
+
+template <unsigned int N, class T, class S, class VALUETYPE>
+inline void
+initMultiArray(MultiArrayView<N, T, S> s, VALUETYPE const & v, ParallelOptions const & opt)
+{
+    detail::initMultiArrayImpl(s, v, &opt,
+                               typename FunctorTraits<VALUETYPE>::isInitializer());
+}
+
 /********************************************************/
 /*                                                      */
 /*                  initMultiArrayBorder                */
@@ -654,6 +1001,27 @@ transformMultiArrayImpl(SrcIterator s, SrcShape const & sshape, SrcAccessor src,
     }
     \endcode
 
+    pass arrays as \ref vigra::MultiArrayView objects, optionally with options for
+    parallel execution:
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1,
+                  class T2, class S2,
+                  class Functor>
+        void
+        transformMultiArray(MultiArrayView<N, T1, S1> const & source,
+                            MultiArrayView<N, T2, S2> dest, Functor const & f,
+                            ParallelOptions const & opt = <sequential>);
+    }
+    \endcode
+
+    In standard mode, the \ref vigra::MultiArrayView versions merge dimensions that are
+    contiguous in memory into a single long loop, which the compiler can vectorize.
+    When \ref vigra::ParallelOptions are given, the arrays are divided into parts
+    that are processed concurrently (see \ref ParallelProcessing), so the functor's
+    call operator must be thread-safe. Expand and reduce mode as well as
+    analyser-initializer functors are executed sequentially.
+
     <b> Usage - Standard Mode:</b>
 
     Source and destination array have the same size.
@@ -670,6 +1038,9 @@ transformMultiArrayImpl(SrcIterator s, SrcShape const & sshape, SrcAccessor src,
                                destMultiArray(dest),
                                (float(*)(float))&std::sqrt );
 
+    // the same, using the default number of threads
+    vigra::transformMultiArray(src, dest, (float(*)(float))&std::sqrt,
+                               ParallelOptions());
     \endcode
 
     <b> Usage - Expand Mode:</b>
@@ -819,6 +1190,75 @@ transformMultiArray(triple<SrcIterator, SrcShape, SrcAccessor> const & src,
                         dest.first, dest.second, dest.third, f);
 }
 
+namespace detail {
+
+template <unsigned int N, class T1, class S1,
+          class T2, class S2,
+          class Functor>
+void
+transformMultiArrayImpl(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        Functor const & f, ParallelOptions const * opt, VigraFalseType)
+{
+    if(source.shape() != dest.shape())
+    {
+        // expand or reduce mode
+        transformMultiArray(srcMultiArrayRange(source), destMultiArrayRange(dest), f);
+        return;
+    }
+    typename MultiArrayShape<N>::type strides[2] = { source.stride(), dest.stride() };
+    MultiArrayPointLoop<N, 2> loop(source.shape(), strides);
+    TransformMultiArrayKernel<T1, T2, Functor> kernel = { source.data(), dest.data(), f };
+    if(opt)
+        loop.run(kernel, *opt);
+    else
+        loop.run(kernel);
+}
+
+template <unsigned int N, class T1, class S1,
+          class T2, class S2,
+          class Functor>
+inline void
+transformMultiArrayImpl(MultiArrayView<N, T1, S1> const & source,
+                        MultiArrayView<N, T2, S2> dest,
+                        Functor const & f, ParallelOptions const *, VigraTrueType)
+{
+    // analyser-initializer functors must be called sequentially
+    transformMultiArray(srcMultiArrayRange(source), destMultiArrayRange(dest), f);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T1, class S1,
+          class T2, class S2,
+          class Functor>
+inline void
+transformMultiArray(MultiArrayView<N, T1, S1> const & source,
+                    MultiArrayView<N, T2, S2> dest, Functor const & f)
+{
+    typedef FunctorTraits<Functor> FT;
+    typedef typename
+        And<typename FT::isInitializer, typename FT::isUnaryAnalyser>::result
+        isAnalyserInitializer;
+    detail::transformMultiArrayImpl(source, dest, f, (ParallelOptions const *)0,
+                                    isAnalyserInitializer());
+}
+
+template <unsigned int N, class T1, class S1,
+          class T2, class S2,
+          class Functor>
+inline void
+transformMultiArray(MultiArrayView<N, T1, S1> const & source,
+                    MultiArrayView<N, T2, S2> dest, Functor const & f,
+                    ParallelOptions const & opt)
+{
+    typedef FunctorTraits<Functor> FT;
+    typedef typename
+        And<typename FT::isInitializer, typename FT::isUnaryAnalyser>::result
+        isAnalyserInitializer;
+    detail::transformMultiArrayImpl(source, dest, f, &opt, isAnalyserInitializer());
+}
+
 /********************************************************/
 /*                                                      */
 /*                combineTwoMultiArrays                 */
@@ -1081,6 +1521,29 @@ combineTwoMultiArraysImpl(
                        Functor const & f);
     }
     \endcode
+
+    pass arrays as \ref vigra::MultiArrayView objects, optionally with options for
+    parallel execution:
+    \code
+    namespace vigra {
+        template <unsigned int N, class T11, class S11,
+                  class T12, class S12,
+                  class T2, class S2,
+                  class Functor>
+        void
+        combineTwoMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                              MultiArrayView<N, T12, S12> const & source2,
+                              MultiArrayView<N, T2, S2> dest, Functor const & f,
+                              ParallelOptions const & opt = <sequential>);
+    }
+    \endcode
+
+    In standard mode, the \ref vigra::MultiArrayView versions merge dimensions that are
+    contiguous in memory into a single long loop, which the compiler can vectorize.
+    When \ref vigra::ParallelOptions are given, the arrays are divided into parts
+    that are processed concurrently (see \ref ParallelProcessing), so the functor's
+    call operator must be thread-safe. Expand and reduce mode as well as
+    analyser-initializer functors are executed sequentially.
     
     <b> Usage - Standard Mode:</b>
     
@@ -1100,7 +1563,10 @@ combineTwoMultiArraysImpl(
                 srcMultiArray(src2), 
                 destMultiArray(dest),  
                 std::plus<int>());
-    
+
+    // the same, using 4 threads
+    vigra::combineTwoMultiArrays(src1, src2, dest, std::plus<int>(),
+                                 ParallelOptions().numThreads(4));
     \endcode
     
     <b> Usage - Expand Mode:</b>
@@ -1282,6 +1748,87 @@ combineTwoMultiArrays(
                           dest.first, dest.second, dest.third, f);
 }
 
+namespace detail {
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T2, class S2,
+          class Functor>
+void
+combineTwoMultiArraysImpl(MultiArrayView<N, T11, S11> const & source1,
+                          MultiArrayView<N, T12, S12> const & source2,
+                          MultiArrayView<N, T2, S2> dest,
+                          Functor const & f, ParallelOptions const * opt, VigraFalseType)
+{
+    if(source1.shape() != dest.shape() || source2.shape() != dest.shape())
+    {
+        // expand or reduce mode
+        combineTwoMultiArrays(srcMultiArrayRange(source1), srcMultiArrayRange(source2),
+                              destMultiArrayRange(dest), f);
+        return;
+    }
+    typename MultiArrayShape<N>::type strides[3] = { source1.stride(), source2.stride(), dest.stride() };
+    MultiArrayPointLoop<N, 3> loop(dest.shape(), strides);
+    CombineTwoMultiArraysKernel<T11, T12, T2, Functor> kernel =
+                                       { source1.data(), source2.data(), dest.data(), f };
+    if(opt)
+        loop.run(kernel, *opt);
+    else
+        loop.run(kernel);
+}
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T2, class S2,
+          class Functor>
+inline void
+combineTwoMultiArraysImpl(MultiArrayView<N, T11, S11> const & source1,
+                          MultiArrayView<N, T12, S12> const & source2,
+                          MultiArrayView<N, T2, S2> dest,
+                          Functor const & f, ParallelOptions const *, VigraTrueType)
+{
+    // analyser-initializer functors must be called sequentially
+    combineTwoMultiArrays(srcMultiArrayRange(source1), srcMultiArrayRange(source2),
+                          destMultiArrayRange(dest), f);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T2, class S2,
+          class Functor>
+inline void
+combineTwoMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                      MultiArrayView<N, T12, S12> const & source2,
+                      MultiArrayView<N, T2, S2> dest, Functor const & f)
+{
+    typedef FunctorTraits<Functor> FT;
+    typedef typename
+        And<typename FT::isInitializer, typename FT::isBinaryAnalyser>::result
+        isAnalyserInitializer;
+    detail::combineTwoMultiArraysImpl(source1, source2, dest, f, (ParallelOptions const *)0,
+                                      isAnalyserInitializer());
+}
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T2, class S2,
+          class Functor>
+inline void
+combineTwoMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                      MultiArrayView<N, T12, S12> const & source2,
+                      MultiArrayView<N, T2, S2> dest, Functor const & f,
+                      ParallelOptions const & opt)
+{
+    typedef FunctorTraits<Functor> FT;
+    typedef typename
+        And<typename FT::isInitializer, typename FT::isBinaryAnalyser>::result
+        isAnalyserInitializer;
+    detail::combineTwoMultiArraysImpl(source1, source2, dest, f, &opt,
+                                      isAnalyserInitializer());
+}
+
 /********************************************************/
 /*                                                      */
 /*               combineThreeMultiArrays                */
@@ -1364,6 +1911,24 @@ combineThreeMultiArraysImpl(SrcIterator1 s1, SrcShape const & shape, SrcAccessor
                        pair<DestIterator, DestAccessor> const & dest, Functor const & f);
     }
     \endcode
+
+    pass arrays as \ref vigra::MultiArrayView objects, optionally with options for
+    parallel execution (all arrays must have the same shape):
+    \code
+    namespace vigra {
+        template <unsigned int N, class T11, class S11,
+                  class T12, class S12,
+                  class T13, class S13,
+                  class T2, class S2,
+                  class Functor>
+        void
+        combineThreeMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                                MultiArrayView<N, T12, S12> const & source2,
+                                MultiArrayView<N, T13, S13> const & source3,
+                                MultiArrayView<N, T2, S2> dest, Functor const & f,
+                                ParallelOptions const & opt = <sequential>);
+    }
+    \endcode
     
     <b> Usage:</b>
     
@@ -1423,6 +1988,66 @@ combineThreeMultiArrays(triple<SrcIterator1, SrcShape, SrcAccessor1> const & src
            src2.first, src2.second, src3.first, src3.second, dest.first, dest.second, f);
 }
 
+namespace detail {
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T13, class S13,
+          class T2, class S2,
+          class Functor>
+void
+combineThreeMultiArraysImpl(MultiArrayView<N, T11, S11> const & source1,
+                            MultiArrayView<N, T12, S12> const & source2,
+                            MultiArrayView<N, T13, S13> const & source3,
+                            MultiArrayView<N, T2, S2> dest,
+                            Functor const & f, ParallelOptions const * opt)
+{
+    vigra_precondition(source1.shape() == dest.shape() && source2.shape() == dest.shape() &&
+                       source3.shape() == dest.shape(),
+        "combineThreeMultiArrays(): shape mismatch between inputs and/or output.");
+    typename MultiArrayShape<N>::type strides[4] = { source1.stride(), source2.stride(),
+                                                     source3.stride(), dest.stride() };
+    MultiArrayPointLoop<N, 4> loop(dest.shape(), strides);
+    CombineThreeMultiArraysKernel<T11, T12, T13, T2, Functor> kernel =
+                         { source1.data(), source2.data(), source3.data(), dest.data(), f };
+    if(opt)
+        loop.run(kernel, *opt);
+    else
+        loop.run(kernel);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T13, class S13,
+          class T2, class S2,
+          class Functor>
+inline void
+combineThreeMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                        MultiArrayView<N, T12, S12> const & source2,
+                        MultiArrayView<N, T13, S13> const & source3,
+                        MultiArrayView<N, T2, S2> dest, Functor const & f)
+{
+    detail::combineThreeMultiArraysImpl(source1, source2, source3, dest, f,
+                                        (ParallelOptions const *)0);
+}
+
+template <unsigned int N, class T11, class S11,
+          class T12, class S12,
+          class T13, class S13,
+          class T2, class S2,
+          class Functor>
+inline void
+combineThreeMultiArrays(MultiArrayView<N, T11, S11> const & source1,
+                        MultiArrayView<N, T12, S12> const & source2,
+                        MultiArrayView<N, T13, S13> const & source3,
+                        MultiArrayView<N, T2, S2> dest, Functor const & f,
+                        ParallelOptions const & opt)
+{
+    detail::combineThreeMultiArraysImpl(source1, source2, source3, dest, f, &opt);
+}
+
 /********************************************************/
 /*                                                      */
 /*                  inspectMultiArray                   */
@@ -1478,6 +2103,31 @@ inspectMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,  Functor & f,
     }
     \endcode
 
+    pass arrays as \ref vigra::MultiArrayView objects, optionally with options for
+    parallel execution:
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S, class Functor>
+        void
+        inspectMultiArray(MultiArrayView<N, T, S> const & s, Functor & f);
+
+        template <unsigned int N, class T, class S, class Functor>
+        void
+        inspectMultiArray(MultiArrayView<N, T, S> const & s, Functor & f,
+                          ParallelOptions const & opt);
+    }
+    \endcode
+
+    The \ref vigra::MultiArrayView versions merge dimensions that are contiguous in memory
+    into a single long loop. The parallel version performs a reduction: the array is
+    divided into a fixed number of ranges (independent of the number of threads, so that
+    the result is reproducible), each range is inspected by its own copy of the functor,
+    and the copies are finally merged into \a f in the order of the ranges. Therefore,
+    the functor must provide <tt>reset()</tt> to obtain an empty copy and a call operator
+    that merges another functor of the same type, as all statistics functors in
+    \ref InspectFunctor do (e.g. \ref vigra::FindMinMax and \ref vigra::FindAverage).
+    Functors that require several passes over the data are executed sequentially.
+
     <b> Usage:</b>
 
     <b>\#include</b> \<vigra/multi_pointoperators.hxx\><br>
@@ -1494,6 +2144,10 @@ inspectMultiArrayImpl(Iterator s, Shape const & shape, Accessor a,  Functor & f,
 
     cout << "Min: " << minmax.min << " Max: " << minmax.max;
 
+    // the same, using the default number of threads
+    vigra::FindMinMax<int> parallelMinmax;
+    vigra::inspectMultiArray(array, parallelMinmax, ParallelOptions());
+
     \endcode
 
     <b> Required Interface:</b>
@@ -1539,6 +2193,98 @@ inspectMultiArray(triple<Iterator, Shape, Accessor> const & s, Functor & f)
 {
     inspectMultiArray(s.first, s.second, s.third, f);
 }
+
+namespace detail {
+
+template <unsigned int N, class T, class S>
+struct InspectMultiArrayViewBinder
+{
+    MultiArrayView<N, T, S> const & s;
+
+    template <class Functor>
+    void operator()(Functor & f) const
+    {
+        typename MultiArrayShape<N>::type strides[1] = { s.stride() };
+        MultiArrayPointLoop<N, 1> loop(s.shape(), strides);
+        InspectMultiArrayKernel<T, Functor> kernel = { s.data(), f };
+        loop.run(kernel);
+    }
+};
+
+template <unsigned int N, class T, class Functor>
+struct InspectMultiArrayTask
+{
+    MultiArrayPointLoop<N, 1> const & loop;
+    T const * data;
+    ArrayVector<Functor> & functors;
+    MultiArrayIndex items;
+
+    void operator()(int, std::ptrdiff_t r) const
+    {
+        MultiArrayIndex ranges = (MultiArrayIndex)functors.size();
+        InspectMultiArrayKernel<T, Functor> kernel = { data, functors[r] };
+        loop.run(kernel, r*items / ranges, (r+1)*items / ranges);
+    }
+};
+
+template <unsigned int N, class T, class S, class Functor>
+void
+inspectMultiArrayImpl(MultiArrayView<N, T, S> const & s, Functor & f,
+                      ParallelOptions const & opt, VigraFalseType)
+{
+    // The partitioning into ranges doesn't depend on the number of threads,
+    // so that the results are always the same.
+    static const MultiArrayIndex maximumRanges = 64;
+    typename MultiArrayShape<N>::type strides[1] = { s.stride() };
+    MultiArrayPointLoop<N, 1> loop(s.shape(), strides);
+    loop.setMinimumNumberOfItems(maximumRanges);
+    MultiArrayIndex items  = loop.numberOfItems(),
+                    ranges = std::min(items, maximumRanges);
+    if(ranges <= 1)
+    {
+        InspectMultiArrayKernel<T, Functor> kernel = { s.data(), f };
+        loop.run(kernel);
+        return;
+    }
+    Functor empty(f);
+    empty.reset();
+    ArrayVector<Functor> functors(ranges, empty);
+    functors[0] = f;
+    InspectMultiArrayTask<N, T, Functor> task = { loop, s.data(), functors, items };
+    parallel_foreach(opt.actualNumThreads(), ranges, task);
+    f = functors[0];
+    for(MultiArrayIndex r=1; r<ranges; ++r)
+        f(functors[r]);
+}
+
+template <unsigned int N, class T, class S, class Functor>
+inline void
+inspectMultiArrayImpl(MultiArrayView<N, T, S> const & s, Functor & f,
+                      ParallelOptions const &, VigraTrueType)
+{
+    // functors requiring several passes are executed sequentially
+    InspectMultiArrayViewBinder<N, T, S> g = { s };
+    extra_passes_select(g, f);
+}
+
+} // namespace detail
+
+template <unsigned int N, class T, class S, class Functor>
+inline void
+inspectMultiArray(MultiArrayView<N, T, S> const & s, Functor & f)
+{
+    detail::InspectMultiArrayViewBinder<N, T, S> g = { s };
+    detail::extra_passes_select(g, f);
+}
+
+template <unsigned int N, class T, class S, class Functor>
+inline void
+inspectMultiArray(MultiArrayView<N, T, S> const & s, Functor & f, ParallelOptions const & opt)
+{
+    typedef typename IfBool<detail::get_extra_passes<Functor>::value,
+                            VigraTrueType, VigraFalseType>::type HasExtraPasses;
+    detail::inspectMultiArrayImpl(s, f, opt, HasExtraPasses());
+}
     
 /********************************************************/
 /*                                                      */
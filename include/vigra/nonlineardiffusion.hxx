@@ -41,6 +41,7 @@
 #include "stdimagefunctions.hxx"
 #include "imageiteratoradapter.hxx"
 #include "functortraits.hxx"
+#include "scratch_arena.hxx"
 
 namespace vigra {
 
@@ -181,6 +182,55 @@ void internalNonlinearDiffusionAOSStep(
     }
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class DiffusivityFunc>
+void internalNonlinearDiffusion(SrcIterator sul, SrcIterator slr, SrcAccessor as,
+                   DestIterator dul, DestAccessor ad,
+                   DiffusivityFunc const & weight, double scale, ScratchArena * arena)
+{
+    vigra_precondition(scale > 0.0, "nonlinearDiffusion(): scale must be > 0");
+    
+    double total_time = scale*scale/2.0;
+    static const double time_step = 5.0;
+    int number_of_steps = (int)(total_time / time_step);
+    double rest_time = total_time - time_step * number_of_steps;
+    
+    Size2D size(slr.x - sul.x, slr.y - sul.y);
+
+    typedef typename
+        NumericTraits<typename SrcAccessor::value_type>::RealPromote
+        TmpType;
+    typedef typename DiffusivityFunc::value_type WeightType;
+    
+    ScratchImage<TmpType> smooth1(size, arena);
+    ScratchImage<TmpType> smooth2(size, arena);
+    
+    ScratchImage<WeightType> weights(size, arena);
+    
+    typename ScratchImage<TmpType>::Iterator s1 = smooth1.upperLeft(),
+                                    s2 = smooth2.upperLeft();
+    typename ScratchImage<TmpType>::Accessor a = smooth1.accessor();
+    
+    typename ScratchImage<WeightType>::Iterator wi = weights.upperLeft();
+    typename ScratchImage<WeightType>::Accessor wa = weights.accessor();
+
+    gradientBasedTransform(sul, slr, as, wi, wa, weight);
+
+    internalNonlinearDiffusionAOSStep(sul, slr, as, wi, wa, s1, a, rest_time);
+
+    for(int i = 0; i < number_of_steps; ++i)
+    {
+        gradientBasedTransform(s1, s1+size, a, wi, wa, weight);
+                      
+        internalNonlinearDiffusionAOSStep(s1, s1+size, a, wi, wa, s2, a, time_step);
+    
+        std::swap(s1, s2);
+    }
+    
+    copyImage(s1, s1+size, a, dul, ad);
+}
+
 /** \addtogroup NonLinearDiffusion Non-linear Diffusion and Total Variation
     
     Perform edge-preserving smoothing.
@@ -242,6 +292,11 @@ void internalNonlinearDiffusionAOSStep(
     but the explicit scheme gives slightly more accurate approximations of
     the diffusion process at the cost of much slower processing.
     
+    <TT>nonlinearDiffusion()</TT> needs three temporary images of the source size. 
+    When a \ref vigra::ScratchArena is passed, they are allocated from the arena, 
+    so that repeated calls on images of the same size don't allocate any 
+    memory (see \ref ScratchMemory).
+    
     <b> Declarations:</b>
     
     pass arguments explicitly:
@@ -253,6 +308,15 @@ void internalNonlinearDiffusionAOSStep(
         void nonlinearDiffusion(SrcIterator sul, SrcIterator slr, SrcAccessor as,
                                 DestIterator dul, DestAccessor ad,
                                 DiffusivityFunctor const & weight, double scale);
+
+        // take the temporary images from 'arena'
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class DiffusivityFunctor>
+        void nonlinearDiffusion(SrcIterator sul, SrcIterator slr, SrcAccessor as,
+                                DestIterator dul, DestAccessor ad,
+                                DiffusivityFunctor const & weight, double scale,
+                                ScratchArena & arena);
     }
     \endcode
     
@@ -267,6 +331,15 @@ void internalNonlinearDiffusionAOSStep(
                   triple<SrcIterator, SrcIterator, SrcAccessor> src,
                   pair<DestIterator, DestAccessor> dest,
                   DiffusivityFunctor const & weight, double scale);
+
+        template <class SrcIterator, class SrcAccessor,
+                  class DestIterator, class DestAccessor,
+                  class DiffusivityFunctor>
+        void nonlinearDiffusion(
+                  triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                  pair<DestIterator, DestAccessor> dest,
+                  DiffusivityFunctor const & weight, double scale,
+                  ScratchArena & arena);
     }
     \endcode
     
@@ -282,6 +355,11 @@ void internalNonlinearDiffusionAOSStep(
     
     nonlinearDiffusion(srcImageRange(src), destImage(dest),
                        DiffusivityFunctor<float>(edge_threshold), scale);
+    
+    // the same, but reuse the temporary memory in subsequent calls
+    ScratchArena arena;
+    nonlinearDiffusion(srcImageRange(src), destImage(dest),
+                       DiffusivityFunctor<float>(edge_threshold), scale, arena);
     \endcode
 
     <b> Required Interface:</b>
@@ -306,50 +384,24 @@ doxygen_overloaded_function(template <...> void nonlinearDiffusion)
 template <class SrcIterator, class SrcAccessor,
           class DestIterator, class DestAccessor,
           class DiffusivityFunc>
+inline
 void nonlinearDiffusion(SrcIterator sul, SrcIterator slr, SrcAccessor as,
                    DestIterator dul, DestAccessor ad,
                    DiffusivityFunc const & weight, double scale)
 {
-    vigra_precondition(scale > 0.0, "nonlinearDiffusion(): scale must be > 0");
-    
-    double total_time = scale*scale/2.0;
-    static const double time_step = 5.0;
-    int number_of_steps = (int)(total_time / time_step);
-    double rest_time = total_time - time_step * number_of_steps;
-    
-    Size2D size(slr.x - sul.x, slr.y - sul.y);
-
-    typedef typename
-        NumericTraits<typename SrcAccessor::value_type>::RealPromote
-        TmpType;
-    typedef typename DiffusivityFunc::value_type WeightType;
-    
-    BasicImage<TmpType> smooth1(size);
-    BasicImage<TmpType> smooth2(size);
-    
-    BasicImage<WeightType> weights(size);
-    
-    typename BasicImage<TmpType>::Iterator s1 = smooth1.upperLeft(),
-                                  s2 = smooth2.upperLeft();
-    typename BasicImage<TmpType>::Accessor a = smooth1.accessor();
-    
-    typename BasicImage<WeightType>::Iterator wi = weights.upperLeft();
-    typename BasicImage<WeightType>::Accessor wa = weights.accessor();
-
-    gradientBasedTransform(sul, slr, as, wi, wa, weight);
-
-    internalNonlinearDiffusionAOSStep(sul, slr, as, wi, wa, s1, a, rest_time);
+    internalNonlinearDiffusion(sul, slr, as, dul, ad, weight, scale, 0);
+}
 
-    for(int i = 0; i < number_of_steps; ++i)
-    {
-        gradientBasedTransform(s1, s1+size, a, wi, wa, weight);
-                      
-        internalNonlinearDiffusionAOSStep(s1, s1+size, a, wi, wa, s2, a, time_step);
-    
-        std::swap(s1, s2);
-    }
-    
-    copyImage(s1, s1+size, a, dul, ad);
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class DiffusivityFunc>
+inline
+void nonlinearDiffusion(SrcIterator sul, SrcIterator slr, SrcAccessor as,
+                   DestIterator dul, DestAccessor ad,
+                   DiffusivityFunc const & weight, double scale,
+                   ScratchArena & arena)
+{
+    internalNonlinearDiffusion(sul, slr, as, dul, ad, weight, scale, &arena);
 }
 
 template <class SrcIterator, class SrcAccessor,
@@ -366,6 +418,21 @@ void nonlinearDiffusion(
                            weight, scale);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class DiffusivityFunc>
+inline
+void nonlinearDiffusion(
+    triple<SrcIterator, SrcIterator, SrcAccessor> src,
+    pair<DestIterator, DestAccessor> dest,
+    DiffusivityFunc const & weight, double scale,
+    ScratchArena & arena)
+{
+    nonlinearDiffusion(src.first, src.second, src.third,
+                           dest.first, dest.second,
+                           weight, scale, arena);
+}
+
 template <class SrcIterator, class SrcAccessor,
           class WeightIterator, class WeightAccessor,
           class DestIterator, class DestAccessor>
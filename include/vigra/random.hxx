@@ -613,6 +613,44 @@ inline RandomTT800   & randomTT800()   { return RandomTT800::global(); }
     */
 inline RandomMT19937 & randomMT19937() { return RandomMT19937::global(); }
 
+    /** \brief Create the random number generator for stream \a streamIndex of \a seed.
+
+        The generator is initialized with the seed sequence <tt>{seed, streamIndex}</tt>,
+        so that different stream indices give independent random sequences, and the
+        same pair <tt>(seed, streamIndex)</tt> always gives the same sequence.
+        This is the recommended way to use random numbers in parallel code: the
+        global generators and generators shared between threads are not thread-safe,
+        and one generator per thread makes the results depend on how work is distributed
+        over the threads. Instead, create one stream per work item (e.g. per block or
+        per tree of a random forest), and the results are reproducible regardless of
+        the number of threads.
+
+        <b>Usage:</b>
+
+        \code
+        struct AddNoise
+        {
+            MultiArrayView<2, float> & image;
+
+            void operator()(int threadId, std::ptrdiff_t row) const
+            {
+                RandomMT19937 random = randomStream<RandomMT19937>(42, (UInt32)row);
+                for(int x=0; x<image.shape(0); ++x)
+                    image(x, row) += random.normal();
+            }
+        };
+
+        AddNoise f = { image };
+        parallel_foreach(0, image.shape(1), f);  // see vigra/threadpool.hxx
+        \endcode
+    */
+template <class RNG>
+inline RNG randomStream(UInt32 seed, UInt32 streamIndex)
+{
+    UInt32 init[2] = { seed, streamIndex };
+    return RNG(init, 2);
+}
+
 template <class Engine>
 class FunctorTraits<RandomNumberGenerator<Engine> >
 {
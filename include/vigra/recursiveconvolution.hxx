@@ -39,6 +39,8 @@
 
 #include <cmath>
 #include <vector>
+#include <complex>
+#include <iterator>
 #include "utilities.hxx"
 #include "numerictraits.hxx"
 #include "imageiteratoradapter.hxx"
@@ -517,6 +519,227 @@ recursiveGaussianFilterLine(SrcIterator is, SrcIterator isend, SrcAccessor as,
     }
 }
 
+
+namespace detail {
+
+    // Coefficients of the fourth-order recursive approximation of the 
+    // Gaussian proposed in 
+    //
+    // R. Deriche: "Recursively implementing the Gaussian and its derivatives",
+    // INRIA Research Report 1893, 1993
+    //
+    // The impulse response is split into a causal part (n >= 0) and
+    // an anti-causal part (n < 0). Both parts are the sum of four complex 
+    // exponentials whose poles and weights are expanded into the coefficients
+    // of the recursions
+    //
+    //     y+(n) = b+[0] x(n) + ... + b+[3] x(n-3) - a[1] y+(n-1) - ... - a[4] y+(n-4)
+    //     y-(n) = b-[1] x(n+1) + ... + b-[4] x(n+4) - a[1] y-(n+1) - ... - a[4] y-(n+4)
+    //
+    // and normalized such that y+ + y- has unit DC gain. The maximal 
+    // error of the impulse response is about 0.05% of its peak value.
+class DericheGaussianCoefficients
+{
+  public:
+    explicit DericheGaussianCoefficients(double sigma = 1.0)
+    {
+        vigra_precondition(sigma > 0.0,
+            "DericheGaussianCoefficients(): sigma must be positive.");
+            
+        typedef std::complex<double> C;
+        static const C alpha[4]  = { C( 0.84,    1.8675), C( 0.84,   -1.8675),
+                                     C(-0.34015, -0.1299), C(-0.34015,  0.1299) };
+        static const C lambda[4] = { C(1.783, 0.6318), C(1.783, -0.6318),
+                                     C(1.723, 1.997),  C(1.723, -1.997) };
+        C poles[4];
+        for(int k=0; k<4; ++k)
+            poles[k] = std::exp(-lambda[k] / sigma);
+            
+        // denominator: product of (1 - pole z^-1)
+        C denominator[5] = { C(1.0), C(0.0), C(0.0), C(0.0), C(0.0) };
+        for(int k=0; k<4; ++k)
+            for(int j=k+1; j>0; --j)
+                denominator[j] -= poles[k]*denominator[j-1];
+                
+        // numerator of the causal part: sum of alpha[k] times the other factors
+        C numerator[4] = { C(0.0), C(0.0), C(0.0), C(0.0) };
+        for(int k=0; k<4; ++k)
+        {
+            C term[4] = { alpha[k], C(0.0), C(0.0), C(0.0) };
+            for(int j=0, n=1; j<4; ++j)
+            {
+                if(j == k)
+                    continue;
+                for(int i=n; i>0; --i)
+                    term[i] -= poles[j]*term[i-1];
+                ++n;
+            }
+            for(int i=0; i<4; ++i)
+                numerator[i] += term[i];
+        }
+        
+        for(int i=0; i<5; ++i)
+            a[i] = denominator[i].real();
+        for(int i=0; i<4; ++i)
+            b_causal[i] = numerator[i].real();
+        b_anticausal[0] = 0.0;
+        for(int i=1; i<4; ++i)
+            b_anticausal[i] = b_causal[i] - a[i]*b_causal[0];
+        b_anticausal[4] = -a[4]*b_causal[0];
+        
+        double sum_a = 0.0, sum_causal = 0.0, sum_anticausal = 0.0;
+        for(int i=0; i<5; ++i)
+        {
+            sum_a += a[i];
+            sum_anticausal += b_anticausal[i];
+        }
+        for(int i=0; i<4; ++i)
+            sum_causal += b_causal[i];
+        double norm = sum_a / (sum_causal + sum_anticausal);
+        for(int i=0; i<4; ++i)
+            b_causal[i] *= norm;
+        for(int i=0; i<5; ++i)
+            b_anticausal[i] *= norm;
+            
+        // responses to a constant signal of value 1
+        steady_causal = sum_causal * norm / sum_a;
+        steady_anticausal = sum_anticausal * norm / sum_a;
+    }
+    
+    double b_causal[4], b_anticausal[5], a[5];
+    double steady_causal, steady_anticausal;
+};
+
+    // Apply the recursive Gaussian filter with the given coefficients to 
+    // 'lines' interleaved lines of length 'w' (i.e. element x of line j is 
+    // at y[x*lines + j]) and compute the derivative of the given order (0, 1, or 2) 
+    // of the result by central differences, as proposed in 
+    //
+    // L. van Vliet, I. Young, P. Verbeek: "Recursive Gaussian derivative filters",
+    // Proc. 14th Intl. Conf. on Pattern Recognition, pp. 509-514, 1998.
+    //
+    // The innermost loops run across lines and can be vectorized. The result 
+    // overwrites y, and 'tmp' must point to scratch memory for 2*w*lines elements. 
+    // The lines are assumed to be constant outside of [0, w), so the caller 
+    // should extend them by a sufficient margin (about 4*sigma) according 
+    // to the desired border treatment.
+template <class Iterator>
+void 
+recursiveGaussianDerivativeLines(Iterator y, Iterator tmp, int w, int lines,
+                                 DericheGaussianCoefficients const & c, int order = 0)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type TempType;
+    typedef detail::RequiresExplicitCast<TempType> Cast;
+
+    vigra_precondition(w >= 2,
+        "recursiveGaussianDerivativeLines(): lines must have at least length 2.");
+    vigra_precondition(0 <= order && order <= 2,
+        "recursiveGaussianDerivativeLines(): derivative order must be 0, 1, or 2.");
+    
+    const double b0 = c.b_causal[0], b1 = c.b_causal[1], b2 = c.b_causal[2], b3 = c.b_causal[3],
+                 d1 = c.b_anticausal[1], d2 = c.b_anticausal[2], d3 = c.b_anticausal[3], d4 = c.b_anticausal[4],
+                 a1 = c.a[1], a2 = c.a[2], a3 = c.a[3], a4 = c.a[4];
+    const int l1 = lines, l2 = 2*lines, l3 = 3*lines, l4 = 4*lines;
+    Iterator causal = tmp, 
+             anticausal = tmp + w*lines,
+             last = y + (w-1)*lines;
+    int x, j;
+    
+    // causal part; outside of the line, the input equals the first element
+    // and the output equals the steady-state response
+    for(x=0; x < std::min(w, 4); ++x)
+    {
+        for(j=0; j<lines; ++j)
+        {
+            TempType xk[4], yk[5];
+            for(int k=0; k<4; ++k)
+                xk[k] = x - k >= 0
+                           ? y[(x-k)*lines + j]
+                           : y[j];
+            for(int k=1; k<5; ++k)
+                yk[k] = x - k >= 0
+                           ? causal[(x-k)*lines + j]
+                           : Cast::cast(c.steady_causal*y[j]);
+            causal[x*lines + j] = Cast::cast(b0*xk[0] + b1*xk[1] + b2*xk[2] + b3*xk[3]
+                                             - (a1*yk[1] + a2*yk[2] + a3*yk[3] + a4*yk[4]));
+        }
+    }
+    for(; x < w; ++x)
+    {
+        Iterator xs = y + x*lines, ys = causal + x*lines;
+        for(j=0; j<lines; ++j)
+            ys[j] = Cast::cast(b0*xs[j] + b1*xs[j-l1] + b2*xs[j-l2] + b3*xs[j-l3]
+                               - (a1*ys[j-l1] + a2*ys[j-l2] + a3*ys[j-l3] + a4*ys[j-l4]));
+    }
+    
+    // anti-causal part; outside of the line, the input equals the last element
+    // and the output equals the steady-state response
+    for(x=w-1; x >= std::max(0, w-4); --x)
+    {
+        for(j=0; j<lines; ++j)
+        {
+            TempType xk[5], yk[5];
+            for(int k=1; k<5; ++k)
+            {
+                xk[k] = x + k < w
+                           ? y[(x+k)*lines + j]
+                           : last[j];
+                yk[k] = x + k < w
+                           ? anticausal[(x+k)*lines + j]
+                           : Cast::cast(c.steady_anticausal*last[j]);
+            }
+            anticausal[x*lines + j] = Cast::cast(d1*xk[1] + d2*xk[2] + d3*xk[3] + d4*xk[4]
+                                                 - (a1*yk[1] + a2*yk[2] + a3*yk[3] + a4*yk[4]));
+        }
+    }
+    for(; x >= 0; --x)
+    {
+        Iterator xs = y + x*lines, ys = anticausal + x*lines;
+        for(j=0; j<lines; ++j)
+            ys[j] = Cast::cast(d1*xs[j+l1] + d2*xs[j+l2] + d3*xs[j+l3] + d4*xs[j+l4]
+                               - (a1*ys[j+l1] + a2*ys[j+l2] + a3*ys[j+l3] + a4*ys[j+l4]));
+    }
+    
+    // the smoothed signal is the sum of both parts
+    Iterator smoothed = order == 0
+                           ? y
+                           : anticausal;
+    for(x=0; x < w*lines; ++x)
+        smoothed[x] = anticausal[x] + causal[x];
+    
+    // derivatives by central differences, reflected at the ends
+    if(order == 1)
+    {
+        for(j=0; j<lines; ++j)
+        {
+            y[j] = NumericTraits<TempType>::zero();
+            last[j] = NumericTraits<TempType>::zero();
+        }
+        for(x=1; x < w-1; ++x)
+        {
+            Iterator ss = smoothed + x*lines, ys = y + x*lines;
+            for(j=0; j<lines; ++j)
+                ys[j] = Cast::cast(0.5*(ss[j+l1] - ss[j-l1]));
+        }
+    }
+    else if(order == 2)
+    {
+        Iterator slast = smoothed + (w-1)*lines;
+        for(j=0; j<lines; ++j)
+        {
+            y[j] = Cast::cast(2.0*(smoothed[j+l1] - smoothed[j]));
+            last[j] = Cast::cast(2.0*(slast[j-l1] - slast[j]));
+        }
+        for(x=1; x < w-1; ++x)
+        {
+            Iterator ss = smoothed + x*lines, ys = y + x*lines;
+            for(j=0; j<lines; ++j)
+                ys[j] = Cast::cast(ss[j+l1] - 2.0*ss[j] + ss[j-l1]);
+        }
+    }
+}
+
+} // namespace detail
             
 /********************************************************/
 /*                                                      */
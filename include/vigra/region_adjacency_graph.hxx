@@ -0,0 +1,578 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_REGION_ADJACENCY_GRAPH_HXX
+#define VIGRA_REGION_ADJACENCY_GRAPH_HXX
+
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include "config.hxx"
+#include "error.hxx"
+#include "array_vector.hxx"
+#include "multi_array.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // Split an N-D array into 'count' slabs along the last axis and return the
+    // range of voxels p in slab 'i' whose neighbor p + e_k along axis 'k' is
+    // inside the array (k == N means the voxels of the slab themselves).
+template <int N>
+bool
+regionAdjacencySlab(TinyVector<MultiArrayIndex, N> const & shape, unsigned int k,
+                    std::ptrdiff_t i, std::ptrdiff_t count,
+                    TinyVector<MultiArrayIndex, N> & start, TinyVector<MultiArrayIndex, N> & stop)
+{
+    start = TinyVector<MultiArrayIndex, N>();
+    stop  = shape;
+    start[N-1] = shape[N-1] * i / count;
+    stop[N-1]  = shape[N-1] * (i + 1) / count;
+    if(k < (unsigned int)N)
+        stop[k] = std::min(stop[k], shape[k] - 1);
+    for(int j=0; j<N; ++j)
+        if(start[j] >= stop[j])
+            return false;
+    return true;
+}
+
+template <class T>
+void regionAdjacencyRemoveDuplicates(ArrayVector<std::pair<T, T> > & edges)
+{
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+}
+
+    // collect the adjacent label pairs of one slab, removing duplicates
+    // whenever the buffer has doubled, so that memory stays proportional
+    // to the number of distinct edges
+template <unsigned int N, class T, class S>
+struct RegionAdjacencyEdgesFunctor
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    MultiArrayView<N, T, S> const & labels_;
+    ArrayVector<ArrayVector<std::pair<T, T> > > & edges_;
+
+    RegionAdjacencyEdgesFunctor(MultiArrayView<N, T, S> const & labels,
+                                ArrayVector<ArrayVector<std::pair<T, T> > > & edges)
+    : labels_(labels), edges_(edges)
+    {}
+
+    void operator()(int, std::ptrdiff_t i) const
+    {
+        ArrayVector<std::pair<T, T> > & edges = edges_[i];
+        std::size_t limit = 1024;
+        for(unsigned int k=0; k<N; ++k)
+        {
+            Shape start, stop, e;
+            if(!regionAdjacencySlab(labels_.shape(), k, i, (std::ptrdiff_t)edges_.size(), start, stop))
+                continue;
+            e[k] = 1;
+            MultiArrayView<N, T, StridedArrayTag> a = labels_.subarray(start, stop),
+                                                  b = labels_.subarray(start + e, stop + e);
+            typename MultiArrayView<N, T, StridedArrayTag>::iterator ia = a.begin(), ib = b.begin(),
+                                                                           end = a.end();
+            for(; ia != end; ++ia, ++ib)
+            {
+                if(*ia == *ib)
+                    continue;
+                edges.push_back(*ia < *ib ? std::make_pair(*ia, *ib) : std::make_pair(*ib, *ia));
+                if(edges.size() > limit)
+                {
+                    regionAdjacencyRemoveDuplicates(edges);
+                    limit = std::max(limit, 2*edges.size());
+                }
+            }
+        }
+        regionAdjacencyRemoveDuplicates(edges);
+    }
+};
+
+    // update the node and edge accumulators of one slab
+template <class GRAPH, unsigned int N, class T, class S1, class U, class S2,
+          class NodeAccumulator, class EdgeAccumulator>
+struct RegionAdjacencyFeaturesFunctor
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    GRAPH const & graph_;
+    MultiArrayView<N, T, S1> const & labels_;
+    MultiArrayView<N, U, S2> const & data_;
+    ArrayVector<ArrayVector<NodeAccumulator> > & node_features_;
+    ArrayVector<ArrayVector<EdgeAccumulator> > & edge_features_;
+    unsigned int pass_;
+
+    RegionAdjacencyFeaturesFunctor(GRAPH const & graph,
+                                   MultiArrayView<N, T, S1> const & labels,
+                                   MultiArrayView<N, U, S2> const & data,
+                                   ArrayVector<ArrayVector<NodeAccumulator> > & node_features,
+                                   ArrayVector<ArrayVector<EdgeAccumulator> > & edge_features,
+                                   unsigned int pass)
+    : graph_(graph), labels_(labels), data_(data),
+      node_features_(node_features), edge_features_(edge_features),
+      pass_(pass)
+    {}
+
+    void operator()(int, std::ptrdiff_t i) const
+    {
+        std::ptrdiff_t count = (std::ptrdiff_t)node_features_.size();
+        Shape start, stop, e;
+
+        ArrayVector<NodeAccumulator> & nodes = node_features_[i];
+        if(regionAdjacencySlab(labels_.shape(), N, i, count, start, stop))
+        {
+            MultiArrayView<N, T, StridedArrayTag> l = labels_.subarray(start, stop);
+            MultiArrayView<N, U, StridedArrayTag> d = data_.subarray(start, stop);
+            typename MultiArrayView<N, T, StridedArrayTag>::iterator il = l.begin(), end = l.end();
+            typename MultiArrayView<N, U, StridedArrayTag>::iterator id = d.begin();
+            for(; il != end; ++il, ++id)
+                nodes[(std::ptrdiff_t)*il].updatePassN(*id, pass_);
+        }
+
+        // each face between two regions contributes the data on both sides
+        ArrayVector<EdgeAccumulator> & edges = edge_features_[i];
+        for(unsigned int k=0; k<N; ++k)
+        {
+            if(!regionAdjacencySlab(labels_.shape(), k, i, count, start, stop))
+                continue;
+            e = Shape();
+            e[k] = 1;
+            MultiArrayView<N, T, StridedArrayTag> la = labels_.subarray(start, stop),
+                                                  lb = labels_.subarray(start + e, stop + e);
+            MultiArrayView<N, U, StridedArrayTag> da = data_.subarray(start, stop),
+                                                  db = data_.subarray(start + e, stop + e);
+            typename MultiArrayView<N, T, StridedArrayTag>::iterator ila = la.begin(), ilb = lb.begin(),
+                                                                           end = la.end();
+            typename MultiArrayView<N, U, StridedArrayTag>::iterator ida = da.begin(), idb = db.begin();
+            for(; ila != end; ++ila, ++ilb, ++ida, ++idb)
+            {
+                if(*ila == *ilb)
+                    continue;
+                EdgeAccumulator & a = edges[graph_.findEdge(*ila, *ilb)];
+                a.updatePassN(*ida, pass_);
+                a.updatePassN(*idb, pass_);
+            }
+        }
+    }
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                 RegionAdjacencyGraph                 */
+/*                                                      */
+/********************************************************/
+
+/** \brief Region adjacency graph of a label array.
+
+    The nodes of the graph are the labels <tt>0, ..., maxLabel</tt> of an N-dimensional
+    label array (e.g. the result of \ref watersheds3D() or \ref labelVolume()), 
+    and two nodes are connected by an edge when the corresponding regions touch,
+    i.e. when there is at least one pair of direct neighbors (differing by one
+    along a single axis) with these labels. This is the same notion of adjacency as 
+    represented by the crack edges of \ref regionImageToCrackEdgeImage(). 
+    Labels not occurring in the array are isolated nodes, and label 0 is 
+    treated like any other label.
+
+    The edges <tt>0, ..., edgeCount()-1</tt> are sorted lexicographically by their
+    end nodes <tt>u(e) < v(e)</tt>. The adjacency is stored in compressed sparse row (CSR)
+    format: the neighbors of each node are stored contiguously and in ascending order
+    together with the ids of the connecting edges, so that memory consumption is 
+    proportional to the number of nodes and edges, and \ref findEdge() is a binary search.
+    The graph is constructed in parallel, and the intermediate memory is also proportional 
+    to the number of edges (per thread), not to the number of voxels.
+    
+    Features of the regions and of their common boundaries are computed by 
+    \ref extractRegionAdjacencyFeatures().
+
+    <b>\#include</b> \<vigra/region_adjacency_graph.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float>  boundaries(shape);
+    MultiArray<3, UInt32> labels(shape);
+    ...
+    watersheds3D(boundaries, labels, NeighborCode3DSix(), BlockwiseOptions<3>());
+
+    RegionAdjacencyGraph<UInt32> rag(labels);
+    for(std::ptrdiff_t k=0; k<rag.degree(5); ++k)
+        std::cout << "region 5 touches region " << rag.neighbor(5, k) 
+                  << " (edge " << rag.incidentEdge(5, k) << ")\n";
+    \endcode
+*/
+template <class LabelType>
+class RegionAdjacencyGraph
+{
+  public:
+        /** the type of the node ids, i.e. the labels
+        */
+    typedef LabelType                         node_type;
+
+        /** iterator over the neighbors of a node
+        */
+    typedef LabelType const *                 neighbor_iterator;
+
+        /** iterator over the incident edges of a node
+        */
+    typedef std::ptrdiff_t const *            edge_iterator;
+
+        /** Construct an empty graph.
+        */
+    RegionAdjacencyGraph()
+    : offsets_(1, 0)
+    {}
+
+        /** Construct the graph of the given label array, see \ref build().
+        */
+    template <unsigned int N, class S>
+    explicit RegionAdjacencyGraph(MultiArrayView<N, LabelType, S> const & labels,
+                                  ParallelOptions const & opt = ParallelOptions())
+    : offsets_(1, 0)
+    {
+        build(labels, opt);
+    }
+
+        /** Construct the graph of the given label array, replacing the current graph.
+            The labels must be non-negative. The array is divided into slabs along its 
+            last axis which are processed by <tt>opt.n_threads</tt> threads.
+        */
+    template <unsigned int N, class S>
+    void build(MultiArrayView<N, LabelType, S> const & labels,
+               ParallelOptions const & opt = ParallelOptions())
+    {
+        ArrayVector<std::ptrdiff_t>(1, 0).swap(offsets_);
+        ArrayVector<LabelType>().swap(neighbors_);
+        ArrayVector<std::ptrdiff_t>().swap(edge_ids_);
+        ArrayVector<std::pair<LabelType, LabelType> >().swap(edges_);
+        if(labels.size() == 0)
+            return;
+
+        LabelType minLabel, maxLabel;
+        labels.minmax(&minLabel, &maxLabel);
+        vigra_precondition(minLabel >= 0,
+            "RegionAdjacencyGraph::build(): labels must be non-negative.");
+
+        // collect the edges of each slab in parallel
+        std::ptrdiff_t slabCount = std::min<std::ptrdiff_t>(opt.actualNumThreads(), 
+                                                            labels.shape(N-1));
+        ArrayVector<ArrayVector<std::pair<LabelType, LabelType> > > slabEdges(slabCount);
+        parallel_foreach(opt.n_threads, slabCount, 
+            detail::RegionAdjacencyEdgesFunctor<N, LabelType, S>(labels, slabEdges));
+        edges_.swap(slabEdges[0]);
+        for(std::ptrdiff_t i=1; i<slabCount; ++i)
+        {
+            edges_.insert(edges_.end(), slabEdges[i].begin(), slabEdges[i].end());
+            ArrayVector<std::pair<LabelType, LabelType> >().swap(slabEdges[i]);
+        }
+        detail::regionAdjacencyRemoveDuplicates(edges_);
+
+        // convert to CSR format
+        std::ptrdiff_t nodeCount = (std::ptrdiff_t)maxLabel + 1,
+                       edgeCount = (std::ptrdiff_t)edges_.size();
+        offsets_.resize(nodeCount + 1, 0);
+        for(std::ptrdiff_t e=0; e<edgeCount; ++e)
+        {
+            ++offsets_[(std::ptrdiff_t)edges_[e].first + 1];
+            ++offsets_[(std::ptrdiff_t)edges_[e].second + 1];
+        }
+        for(std::ptrdiff_t n=0; n<nodeCount; ++n)
+            offsets_[n+1] += offsets_[n];
+        neighbors_.resize(2*edgeCount);
+        edge_ids_.resize(2*edgeCount);
+        // since edges are sorted, the neighbor lists come out sorted as well:
+        // for each node, all neighbors u < node precede all neighbors v > node
+        ArrayVector<std::ptrdiff_t> fill(offsets_.begin(), offsets_.end() - 1);
+        for(std::ptrdiff_t e=0; e<edgeCount; ++e)
+        {
+            std::ptrdiff_t v = (std::ptrdiff_t)edges_[e].second;
+            neighbors_[fill[v]] = edges_[e].first;
+            edge_ids_[fill[v]++] = e;
+        }
+        for(std::ptrdiff_t e=0; e<edgeCount; ++e)
+        {
+            std::ptrdiff_t u = (std::ptrdiff_t)edges_[e].first;
+            neighbors_[fill[u]] = edges_[e].second;
+            edge_ids_[fill[u]++] = e;
+        }
+    }
+
+        /** Number of nodes, i.e. the largest label + 1.
+        */
+    std::ptrdiff_t nodeCount() const
+    {
+        return (std::ptrdiff_t)offsets_.size() - 1;
+    }
+
+        /** Number of edges.
+        */
+    std::ptrdiff_t edgeCount() const
+    {
+        return (std::ptrdiff_t)edges_.size();
+    }
+
+        /** First end node of edge \a e (the smaller label).
+        */
+    LabelType u(std::ptrdiff_t e) const
+    {
+        return edges_[e].first;
+    }
+
+        /** Second end node of edge \a e (the larger label).
+        */
+    LabelType v(std::ptrdiff_t e) const
+    {
+        return edges_[e].second;
+    }
+
+        /** Number of neighbors of node \a n.
+        */
+    std::ptrdiff_t degree(LabelType n) const
+    {
+        return offsets_[(std::ptrdiff_t)n+1] - offsets_[(std::ptrdiff_t)n];
+    }
+
+        /** The <tt>k</tt>-th neighbor of node \a n (in ascending order).
+        */
+    LabelType neighbor(LabelType n, std::ptrdiff_t k) const
+    {
+        return neighbors_[offsets_[(std::ptrdiff_t)n] + k];
+    }
+
+        /** The id of the edge between node \a n and its <tt>k</tt>-th neighbor.
+        */
+    std::ptrdiff_t incidentEdge(LabelType n, std::ptrdiff_t k) const
+    {
+        return edge_ids_[offsets_[(std::ptrdiff_t)n] + k];
+    }
+
+        /** Iterators over the neighbors of node \a n.
+        */
+    neighbor_iterator neighborsBegin(LabelType n) const
+    {
+        return neighbors_.begin() + offsets_[(std::ptrdiff_t)n];
+    }
+
+    neighbor_iterator neighborsEnd(LabelType n) const
+    {
+        return neighbors_.begin() + offsets_[(std::ptrdiff_t)n+1];
+    }
+
+        /** Iterators over the edges incident to node \a n (in the 
+            order of the corresponding neighbors).
+        */
+    edge_iterator edgesBegin(LabelType n) const
+    {
+        return edge_ids_.begin() + offsets_[(std::ptrdiff_t)n];
+    }
+
+    edge_iterator edgesEnd(LabelType n) const
+    {
+        return edge_ids_.begin() + offsets_[(std::ptrdiff_t)n+1];
+    }
+
+        /** The id of the edge between nodes \a a and \a b, or -1 
+            if these nodes are not adjacent.
+        */
+    std::ptrdiff_t findEdge(LabelType a, LabelType b) const
+    {
+        neighbor_iterator begin = neighborsBegin(a), 
+                          end   = neighborsEnd(a),
+                          n     = std::lower_bound(begin, end, b);
+        return (n != end && *n == b)
+                   ? edge_ids_[n - neighbors_.begin()]
+                   : -1;
+    }
+
+  private:
+    ArrayVector<std::ptrdiff_t> offsets_;
+    ArrayVector<LabelType> neighbors_;
+    ArrayVector<std::ptrdiff_t> edge_ids_;
+    ArrayVector<std::pair<LabelType, LabelType> > edges_;
+};
+
+/** \addtogroup FeatureAccumulators
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*            extractRegionAdjacencyFeatures            */
+/*                                                      */
+/********************************************************/
+
+/** \brief Compute statistics of the regions and region boundaries of a label array.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <class T, unsigned int N, class S1, class U, class S2,
+                  class NodeAccumulator, class EdgeAccumulator>
+        void
+        extractRegionAdjacencyFeatures(RegionAdjacencyGraph<T> const & graph,
+                                       MultiArrayView<N, T, S1> const & labels,
+                                       MultiArrayView<N, U, S2> const & data,
+                                       ArrayVector<NodeAccumulator> & node_features,
+                                       ArrayVector<EdgeAccumulator> & edge_features,
+                                       ParallelOptions const & opt = ParallelOptions());
+    }
+    \endcode
+
+    \a graph must have been built from \a labels. For each node \a n, 
+    <tt>node_features[n]</tt> is updated with the \a data values of all voxels 
+    in region \a n. For each edge \a e, <tt>edge_features[e]</tt> is updated with 
+    the \a data values on both sides of every voxel face between the regions
+    <tt>graph.u(e)</tt> and <tt>graph.v(e)</tt>, so that <tt>Count</tt> is twice the 
+    number of faces (the boundary size). The accumulators can be any
+    \ref acc::AccumulatorChain or \ref acc::DynamicAccumulatorChain whose 
+    data type is compatible with \a U.
+    
+    If \a node_features or \a edge_features are empty, they are resized to
+    <tt>graph.nodeCount()</tt> and <tt>graph.edgeCount()</tt> default-constructed 
+    accumulators. Otherwise, they must already have these sizes and contain 
+    accumulators that haven't seen any data yet, which allows to activate 
+    statistics or to set histogram options beforehand.
+
+    All statistics are computed in a single scan over the arrays (or one scan
+    per pass for multi-pass statistics). When all statistics need only one pass, 
+    the arrays are divided into <tt>opt.n_threads</tt> slabs along the last axis 
+    which are processed in parallel with a private copy of the accumulators each;
+    the copies are merged at the end. This requires the statistics to support merging
+    (see \ref FeatureAccumulators), which is the case for all single-pass statistics. 
+    For quantiles, use a histogram with known range, e.g. <tt>UserRangeHistogram</tt>
+    for boundary probabilities in [0, 1]. Multi-pass statistics 
+    (e.g. <tt>AutoRangeHistogram</tt>) are computed sequentially. Memory consumption 
+    is proportional to the number of nodes and edges times the number of slabs.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/region_adjacency_graph.hxx\><br>
+    Namespace: vigra
+
+    \code
+    using namespace vigra::acc;
+    MultiArray<3, float>  probabilities(shape);
+    MultiArray<3, UInt32> labels(shape);
+    ...
+    RegionAdjacencyGraph<UInt32> rag(labels);
+
+    typedef AccumulatorChain<float, Select<Count, Mean, StandardQuantiles<UserRangeHistogram<64> > > > 
+            EdgeFeatures;
+    typedef AccumulatorChain<float, Select<Count, Mean> > NodeFeatures;
+    
+    ArrayVector<NodeFeatures> nodes;
+    ArrayVector<EdgeFeatures> edges(rag.edgeCount());
+    for(int e=0; e<rag.edgeCount(); ++e)
+        edges[e].setHistogramOptions(HistogramOptions().setMinMax(0.0, 1.0));
+    
+    extractRegionAdjacencyFeatures(rag, labels, probabilities, nodes, edges);
+
+    for(int e=0; e<rag.edgeCount(); ++e)
+        std::cout << rag.u(e) << " - " << rag.v(e) << ": boundary size " << get<Count>(edges[e]) / 2
+                  << ", mean probability " << get<Mean>(edges[e]) 
+                  << ", median probability " << get<StandardQuantiles<UserRangeHistogram<64> > >(edges[e])[3] << "\n";
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void extractRegionAdjacencyFeatures)
+
+template <class T, unsigned int N, class S1, class U, class S2,
+          class NodeAccumulator, class EdgeAccumulator>
+void
+extractRegionAdjacencyFeatures(RegionAdjacencyGraph<T> const & graph,
+                               MultiArrayView<N, T, S1> const & labels,
+                               MultiArrayView<N, U, S2> const & data,
+                               ArrayVector<NodeAccumulator> & node_features,
+                               ArrayVector<EdgeAccumulator> & edge_features,
+                               ParallelOptions const & opt = ParallelOptions())
+{
+    typedef detail::RegionAdjacencyFeaturesFunctor<RegionAdjacencyGraph<T>, N, T, S1, U, S2,
+                                                   NodeAccumulator, EdgeAccumulator> Functor;
+
+    vigra_precondition(labels.shape() == data.shape(),
+        "extractRegionAdjacencyFeatures(): shape mismatch between labels and data.");
+    if(node_features.size() == 0)
+        node_features.resize(graph.nodeCount());
+    if(edge_features.size() == 0)
+        edge_features.resize(graph.edgeCount());
+    vigra_precondition((std::ptrdiff_t)node_features.size() == graph.nodeCount() &&
+                       (std::ptrdiff_t)edge_features.size() == graph.edgeCount(),
+        "extractRegionAdjacencyFeatures(): feature arrays must have the size of the graph.");
+    if(labels.size() == 0)
+        return;
+
+    unsigned int passes = std::max(NodeAccumulator().passesRequired(), 
+                                   EdgeAccumulator().passesRequired());
+    std::ptrdiff_t slabCount = passes == 1
+                                  ? std::min<std::ptrdiff_t>(opt.actualNumThreads(), labels.shape(N-1))
+                                  : 1;
+
+    // slab 0 works on the given accumulators, the others on copies
+    ArrayVector<ArrayVector<NodeAccumulator> > nodes(slabCount);
+    ArrayVector<ArrayVector<EdgeAccumulator> > edges(slabCount);
+    nodes[0].swap(node_features);
+    edges[0].swap(edge_features);
+    for(std::ptrdiff_t i=1; i<slabCount; ++i)
+    {
+        nodes[i] = nodes[0];
+        edges[i] = edges[0];
+    }
+
+    for(unsigned int pass=1; pass <= passes; ++pass)
+        parallel_foreach(opt.n_threads, slabCount, 
+                         Functor(graph, labels, data, nodes, edges, pass));
+
+    for(std::ptrdiff_t i=1; i<slabCount; ++i)
+    {
+        for(std::ptrdiff_t n=0; n<graph.nodeCount(); ++n)
+            nodes[0][n] += nodes[i][n];
+        for(std::ptrdiff_t e=0; e<graph.edgeCount(); ++e)
+            edges[0][e] += edges[i][e];
+        ArrayVector<NodeAccumulator>().swap(nodes[i]);
+        ArrayVector<EdgeAccumulator>().swap(edges[i]);
+    }
+    nodes[0].swap(node_features);
+    edges[0].swap(edge_features);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_REGION_ADJACENCY_GRAPH_HXX
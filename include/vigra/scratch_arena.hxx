@@ -0,0 +1,443 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_SCRATCH_ARENA_HXX
+#define VIGRA_SCRATCH_ARENA_HXX
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include "config.hxx"
+#include "error.hxx"
+#include "memory.hxx"
+#include "array_vector.hxx"
+#include "multi_array.hxx"
+#include "basicimageview.hxx"
+
+namespace vigra {
+
+/** \addtogroup ScratchMemory Reusable Scratch Memory
+
+    Many filters (e.g. \ref separableConvolveMultiArray(), \ref gaussianGradientMultiArray(),
+    \ref structureTensorMultiArray(), \ref boundaryTensor(), \ref nonlinearDiffusion())
+    need full-size temporary arrays. When such a filter is called repeatedly
+    (e.g. for every frame of a video), allocating and releasing these arrays
+    in every call causes a lot of memory management overhead and page faults.
+    A \ref vigra::ScratchArena can be passed to these functions instead. It hands
+    out memory in stack order and keeps it for the next call, so that
+    repeated calls on the same shape don't allocate any memory after the first one.
+*/
+//@{
+
+/** \brief Stack-like memory pool for temporary arrays.
+
+    The arena owns a list of memory blocks. Requests are served consecutively
+    from the current block, and memory is returned in reverse order of
+    allocation by \ref rewind() to a previously taken \ref mark(). When a request
+    doesn't fit into the remaining blocks, a new block of at least the current
+    capacity is allocated. Whenever the arena becomes empty again, multiple blocks
+    are merged into a single block of the high-water mark's size, so that the
+    next call requiring the same amount of memory is served from one block
+    without touching the system allocator.
+
+    All addresses handed out are aligned to <tt>ScratchArena::alignment</tt> bytes (64).
+    An arena must only be used by one thread at a time. Usually, one doesn't call
+    \ref allocate() directly, but uses \ref vigra::ScratchArray and
+    \ref vigra::ScratchImage, which take their memory from an arena and release it
+    automatically.
+
+    <b>Usage:</b>
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br>
+    Namespace: vigra
+
+    \code
+    ScratchArena arena;
+    MultiArray<3, TinyVector<float, 6> > tensor(shape);
+
+    for(int frame = 0; frame < frameCount; ++frame)
+    {
+        MultiArrayView<3, float> volume = getFrame(frame);
+        // the temporary arrays are only allocated in the first iteration
+        structureTensorMultiArray(volume, tensor, 1.0, 2.0,
+                                  ConvolutionOptions<3>().scratchArena(arena));
+    }
+    std::cerr << "peak scratch memory: " << arena.highWaterMark() << " bytes, "
+              << arena.systemAllocations() << " system allocations\n";
+    \endcode
+*/
+class ScratchArena
+{
+  public:
+        /** Alignment (in bytes) of all memory handed out by the arena.
+        */
+    enum { alignment = 64 };
+
+        /** Position in the arena as returned by \ref mark().
+        */
+    struct Mark
+    {
+        std::size_t block, offset, used;
+    };
+
+        /** Create an arena. When <tt>capacity > 0</tt>, a block of this
+            size (in bytes) is allocated right away.
+        */
+    explicit ScratchArena(std::size_t capacity = 0)
+    : current_(0), offset_(0), used_(0), capacity_(0),
+      high_water_(0), system_allocations_(0)
+    {
+        if(capacity > 0)
+            addBlock(roundUp(capacity));
+    }
+
+    ~ScratchArena()
+    {
+        freeBlocks();
+    }
+
+        /** Get <tt>bytes</tt> bytes of uninitialized memory. The memory stays valid until
+            the arena is rewound to a mark taken before this call.
+        */
+    void * allocate(std::size_t bytes)
+    {
+        bytes = roundUp(bytes);
+        while(current_ < blocks_.size() && offset_ + bytes > blocks_[current_].size)
+        {
+            ++current_;
+            offset_ = 0;
+        }
+        if(current_ == blocks_.size())
+            addBlock(std::max(bytes, capacity_));
+        void * res = blocks_[current_].data + offset_;
+        offset_ += bytes;
+        used_ += bytes;
+        high_water_ = std::max(high_water_, used_);
+        return res;
+    }
+
+        /** Current position of the arena.
+        */
+    Mark mark() const
+    {
+        Mark m = { current_, offset_, used_ };
+        return m;
+    }
+
+        /** Release all memory allocated since <tt>m</tt> was taken.
+            When the arena becomes empty and holds more than one block,
+            the blocks are merged.
+        */
+    void rewind(Mark const & m)
+    {
+        vigra_precondition(m.used <= used_,
+            "ScratchArena::rewind(): marks must be rewound in reverse order.");
+        current_ = m.block;
+        offset_ = m.offset;
+        used_ = m.used;
+        if(used_ == 0 && blocks_.size() > 1)
+        {
+            freeBlocks();
+            addBlock(high_water_);
+        }
+    }
+
+        /** Make sure that the arena can hold <tt>bytes</tt> bytes without
+            further system allocations. Must only be called when the arena is empty.
+        */
+    void reserve(std::size_t bytes)
+    {
+        vigra_precondition(used_ == 0,
+            "ScratchArena::reserve(): arena is in use.");
+        bytes = roundUp(bytes);
+        if(blocks_.size() == 1 && blocks_[0].size >= bytes)
+            return;
+        freeBlocks();
+        addBlock(bytes);
+    }
+
+        /** Return all memory to the system. Must only be called when the arena is empty.
+        */
+    void release()
+    {
+        vigra_precondition(used_ == 0,
+            "ScratchArena::release(): arena is in use.");
+        freeBlocks();
+    }
+
+        /** Total size (in bytes) of the memory blocks owned by the arena.
+        */
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+        /** Number of bytes currently handed out (including alignment padding).
+        */
+    std::size_t bytesInUse() const
+    {
+        return used_;
+    }
+
+        /** Maximum of \ref bytesInUse() since construction or the last
+            call to \ref resetStatistics().
+        */
+    std::size_t highWaterMark() const
+    {
+        return high_water_;
+    }
+
+        /** Number of blocks requested from the system allocator since construction
+            or the last call to \ref resetStatistics().
+        */
+    std::size_t systemAllocations() const
+    {
+        return system_allocations_;
+    }
+
+        /** Reset \ref highWaterMark() to \ref bytesInUse() and \ref systemAllocations() to zero.
+        */
+    void resetStatistics()
+    {
+        high_water_ = used_;
+        system_allocations_ = 0;
+    }
+
+  private:
+    struct Block
+    {
+        char * data;
+        std::size_t size;
+    };
+
+    ScratchArena(ScratchArena const &);
+    ScratchArena & operator=(ScratchArena const &);
+
+    static std::size_t roundUp(std::size_t bytes)
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    void addBlock(std::size_t size)
+    {
+        Block b = { alloc_.allocate(size), size };
+        blocks_.push_back(b);
+        capacity_ += size;
+        ++system_allocations_;
+    }
+
+    void freeBlocks()
+    {
+        for(unsigned int k=0; k<blocks_.size(); ++k)
+            alloc_.deallocate(blocks_[k].data, blocks_[k].size);
+        blocks_.clear();
+        current_ = 0;
+        offset_ = 0;
+        capacity_ = 0;
+    }
+
+    ArrayVector<Block> blocks_;
+    AlignedAllocator<char, alignment> alloc_;
+    std::size_t current_, offset_, used_, capacity_, high_water_, system_allocations_;
+};
+
+#ifdef VIGRA_HAS_THREAD_LOCAL
+
+    /** \brief Scratch arena of the calling thread.
+
+        Each thread owns one arena which is created on first use and destroyed when
+        the thread ends. This is convenient when filters are called from many places
+        (or by several threads) that shouldn't pass an arena around:
+        \code
+        gaussianGradientMultiArray(volume, gradient,
+                                   ConvolutionOptions<3>().stdDev(2.0).scratchArena(threadLocalScratchArena()));
+        \endcode
+        Only available when the compiler supports <tt>thread_local</tt>
+        (the macro <tt>VIGRA_HAS_THREAD_LOCAL</tt> is then defined in vigra/config.hxx).
+
+        <b>\#include</b> \<vigra/scratch_arena.hxx\><br>
+        Namespace: vigra
+    */
+inline ScratchArena & threadLocalScratchArena()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+#endif
+
+/** \brief Temporary multi-dimensional array that may take its memory from a \ref vigra::ScratchArena.
+
+    When constructed with an arena, the array's memory is allocated from
+    the arena and returned to it by the destructor. Otherwise, the array owns
+    its memory like a \ref vigra::MultiArray. In either case, the elements
+    are initialized with <tt>init</tt>. Since arena memory is released in stack
+    order, ScratchArrays using the same arena must be destroyed in reverse
+    order of construction, which is automatically the case for local variables.
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T>
+class ScratchArray
+: public MultiArrayView<N, T>
+{
+  public:
+    typedef MultiArrayView<N, T>                    view_type;
+    typedef typename view_type::value_type          value_type;
+    typedef typename view_type::const_reference     const_reference;
+    typedef typename view_type::difference_type     difference_type;
+
+        /** Construct an array of the given shape, using memory from <tt>arena</tt>
+            if it is not zero.
+        */
+    explicit ScratchArray(difference_type const & shape, ScratchArena * arena = 0,
+                          const_reference init = value_type())
+    : view_type(shape, vigra::detail::defaultStride<view_type::actual_dimension>(shape), 0),
+      arena_(arena)
+    {
+        MultiArrayIndex size = this->elementCount();
+        if(arena_)
+        {
+            mark_ = arena_->mark();
+            this->m_ptr = static_cast<T *>(arena_->allocate(size*sizeof(T)));
+            try
+            {
+                std::uninitialized_fill(this->m_ptr, this->m_ptr + size, init);
+            }
+            catch(...)
+            {
+                // the destructor won't run, return the memory here
+                arena_->rewind(mark_);
+                throw;
+            }
+        }
+        else
+        {
+            buffer_.resize(size, init);
+            this->m_ptr = buffer_.data();
+        }
+    }
+
+    ~ScratchArray()
+    {
+        if(arena_)
+        {
+            detail::destroy_n(this->m_ptr, this->elementCount());
+            arena_->rewind(mark_);
+        }
+    }
+
+  private:
+    ScratchArray(ScratchArray const &);
+    ScratchArray & operator=(ScratchArray const &);
+
+    ScratchArena * arena_;
+    ScratchArena::Mark mark_;
+    ArrayVector<T> buffer_;
+};
+
+/** \brief Temporary image that may take its memory from a \ref vigra::ScratchArena.
+
+    This is the \ref vigra::BasicImageView counterpart of \ref vigra::ScratchArray,
+    for functions working on 2D image iterators.
+
+    <b>\#include</b> \<vigra/scratch_arena.hxx\><br>
+    Namespace: vigra
+*/
+template <class T>
+class ScratchImage
+: public BasicImageView<T>
+{
+  public:
+    typedef BasicImageView<T>                   view_type;
+    typedef typename view_type::value_type      value_type;
+    typedef typename view_type::const_reference const_reference;
+    typedef typename view_type::size_type       size_type;
+
+        /** Construct an image of the given size, using memory from <tt>arena</tt>
+            if it is not zero.
+        */
+    explicit ScratchImage(size_type const & size, ScratchArena * arena = 0,
+                          const_reference init = value_type())
+    : arena_(arena)
+    {
+        std::size_t count = (std::size_t)size.x*size.y;
+        T * data;
+        if(arena_)
+        {
+            mark_ = arena_->mark();
+            data = static_cast<T *>(arena_->allocate(count*sizeof(T)));
+            try
+            {
+                std::uninitialized_fill(data, data + count, init);
+            }
+            catch(...)
+            {
+                arena_->rewind(mark_);
+                throw;
+            }
+        }
+        else
+        {
+            buffer_.resize(count, init);
+            data = buffer_.data();
+        }
+        view_type::operator=(view_type(data, size));
+    }
+
+    ~ScratchImage()
+    {
+        if(arena_)
+        {
+            detail::destroy_n(this->data(), this->width()*this->height());
+            arena_->rewind(mark_);
+        }
+    }
+
+  private:
+    ScratchImage(ScratchImage const &);
+    ScratchImage & operator=(ScratchImage const &);
+
+    ScratchArena * arena_;
+    ScratchArena::Mark mark_;
+    ArrayVector<T> buffer_;
+};
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_SCRATCH_ARENA_HXX
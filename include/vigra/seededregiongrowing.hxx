@@ -39,6 +39,7 @@
 #include <vector>
 #include <stack>
 #include <queue>
+#include <cmath>
 #include "utilities.hxx"
 #include "stdimage.hxx"
 #include "stdimagefunctions.hxx"
@@ -151,6 +152,239 @@ public:
     };
 };
 
+    // Candidate record for the bucket queue variant of seeded region growing.
+    // The bucket is given by the truncated cost, and ties are resolved in FIFO order.
+template <class Location, class COST>
+struct SeedRgBucketRecord
+{
+    Location location_;
+    COST cost_;
+    int label_;
+
+    SeedRgBucketRecord()
+    : location_(), cost_(), label_(0)
+    {}
+
+    SeedRgBucketRecord(Location const & location, COST const & cost, int label)
+    : location_(location), cost_(cost), label_(label)
+    {}
+};
+
+    // Ascending bucket queue with FIFO order within each bucket. In contrast
+    // to BucketQueue, the elements of all buckets are stored by value in 
+    // a common pool of fixed-size chunks and linked by indices, so that
+    // push() and pop() never allocate after warm-up and empty buckets
+    // cost only two indices (important for 16-bit priorities).
+template <class T>
+class SeedRgBucketQueue
+{
+    struct Node
+    {
+        T value;
+        std::ptrdiff_t next;
+    };
+    
+    enum { ChunkShift = 12, ChunkSize = 1 << ChunkShift, ChunkMask = ChunkSize - 1 };
+
+    ArrayVector<Node *> chunks_;
+    ArrayVector<std::ptrdiff_t> head_, tail_;
+    std::ptrdiff_t free_, allocated_, top_;
+    std::size_t size_;
+    
+    SeedRgBucketQueue(SeedRgBucketQueue const &);              // not implemented
+    SeedRgBucketQueue & operator=(SeedRgBucketQueue const &);  // not implemented
+
+    Node & node(std::ptrdiff_t i)
+    {
+        return chunks_[i >> ChunkShift][i & ChunkMask];
+    }
+
+    Node const & node(std::ptrdiff_t i) const
+    {
+        return chunks_[i >> ChunkShift][i & ChunkMask];
+    }
+
+  public:
+    SeedRgBucketQueue(std::ptrdiff_t bucket_count)
+    : head_(bucket_count, -1),
+      tail_(bucket_count, -1),
+      free_(-1), allocated_(0), top_(bucket_count),
+      size_(0)
+    {}
+
+    ~SeedRgBucketQueue()
+    {
+        for(unsigned int k=0; k<chunks_.size(); ++k)
+            delete [] chunks_[k];
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    std::ptrdiff_t topPriority() const
+    {
+        return top_;
+    }
+
+    T const & top() const
+    {
+        return node(head_[top_]).value;
+    }
+
+    void pop()
+    {
+        std::ptrdiff_t i = head_[top_];
+        head_[top_] = node(i).next;
+        if(head_[top_] < 0)
+            tail_[top_] = -1;
+        node(i).next = free_;
+        free_ = i;
+        --size_;
+        
+        while(top_ < (std::ptrdiff_t)head_.size() && head_[top_] < 0)
+            ++top_;
+    }
+
+    void push(T const & v, std::ptrdiff_t priority)
+    {
+        vigra_precondition(0 <= priority && priority < (std::ptrdiff_t)head_.size(),
+            "seededRegionGrowing(): cost must be in the range [0, ..., bucket_count-1].");
+        std::ptrdiff_t i = free_;
+        if(i >= 0)
+        {
+            free_ = node(i).next;
+        }
+        else
+        {
+            if(allocated_ == (std::ptrdiff_t)chunks_.size()*ChunkSize)
+                chunks_.push_back(new Node[ChunkSize]);
+            i = allocated_++;
+        }
+        node(i).value = v;
+        node(i).next = -1;
+        if(tail_[priority] < 0)
+            head_[priority] = i;
+        else
+            node(tail_[priority]).next = i;
+        tail_[priority] = i;
+        ++size_;
+        
+        if(priority < top_)
+            top_ = priority;
+    }
+};
+
+    // Candidate queues for seededRegionGrowing() and seededRegionGrowing3D().
+    // SeedRgHeapCandidates keeps pooled SeedRgPixel or SeedRgVoxel objects
+    // in a heap, so ties are resolved by the distance to the region's seed 
+    // and then by insertion order. SeedRgBucketCandidates sorts by the
+    // truncated integer cost in a SeedRgBucketQueue, so ties are resolved in
+    // FIFO order. pop() returns the original cost in both cases. After a 
+    // candidate above the threshold has been popped, candidatesAbove() tells if
+    // all remaining candidates are above the threshold as well: this holds 
+    // for the heap, but a bucket may still contain cheaper candidates.
+template <class Candidate, class Location, class COST>
+class SeedRgHeapCandidates
+{
+    typedef std::priority_queue<Candidate *, std::vector<Candidate *>,
+                                typename Candidate::Compare> Heap;
+
+    typename Candidate::Allocator allocator_;
+    Heap heap_;
+    int count_;
+
+  public:
+    typedef COST cost_type;
+
+    SeedRgHeapCandidates()
+    : count_(0)
+    {}
+
+    ~SeedRgHeapCandidates()
+    {
+        while(!heap_.empty())
+        {
+            allocator_.dismiss(heap_.top());
+            heap_.pop();
+        }
+    }
+
+    bool empty() const
+    {
+        return heap_.empty();
+    }
+
+    void push(Location const & location, Location const & nearest, 
+              COST const & cost, int label)
+    {
+        heap_.push(allocator_.create(location, nearest, cost, count_++, label));
+    }
+
+    void pop(Location & location, Location & nearest, COST & cost, int & label)
+    {
+        Candidate * candidate = heap_.top();
+        heap_.pop();
+        location = candidate->location_;
+        nearest = candidate->nearest_;
+        cost = candidate->cost_;
+        label = candidate->label_;
+        allocator_.dismiss(candidate);
+    }
+
+    bool candidatesAbove(double) const
+    {
+        return true;
+    }
+};
+
+template <class Location, class COST>
+class SeedRgBucketCandidates
+{
+    typedef SeedRgBucketRecord<Location, COST> Record;
+
+    SeedRgBucketQueue<Record> queue_;
+
+  public:
+    typedef COST cost_type;
+
+    SeedRgBucketCandidates(std::ptrdiff_t bucket_count)
+    : queue_(bucket_count)
+    {}
+
+    bool empty() const
+    {
+        return queue_.empty();
+    }
+
+    void push(Location const & location, Location const &, 
+              COST const & cost, int label)
+    {
+        queue_.push(Record(location, cost, label), (std::ptrdiff_t)cost);
+    }
+
+    void pop(Location & location, Location &, COST & cost, int & label)
+    {
+        Record const & record = queue_.top();
+        location = record.location_;
+        cost = record.cost_;
+        label = record.label_;
+        queue_.pop();
+    }
+
+    bool candidatesAbove(double threshold) const
+    {
+        // bucket 'b' holds the costs in [b, b+1)
+        return queue_.empty() || queue_.topPriority() > std::floor(threshold);
+    }
+};
+
 struct UnlabelWatersheds
 {
     int operator()(int label) const
@@ -180,6 +414,143 @@ enum SRGType {
     SRGWatershedLabel = -1 
 };
 
+namespace detail {
+
+    // Implementation of seededRegionGrowing() for the given candidate queue, 
+    // see SeedRgHeapCandidates and SeedRgBucketCandidates.
+template <class SrcIterator, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood,
+          class CandidateQueue>
+typename SeedAccessor::value_type
+seededRegionGrowingImpl(SrcIterator srcul,
+                        SrcIterator srclr, SrcAccessor as,
+                        SeedImageIterator seedsul, SeedAccessor aseeds,
+                        DestIterator destul, DestAccessor ad,
+                        RegionStatisticsArray & stats,
+                        SRGType srgType,
+                        Neighborhood,
+                        double max_cost,
+                        CandidateQueue & pqueue)
+{
+    int w = srclr.x - srcul.x;
+    int h = srclr.y - srcul.y;
+
+    SrcIterator isy = srcul, isx = srcul;  // iterators for the src image
+
+    typedef typename SeedAccessor::value_type LabelType;
+    typedef typename CandidateQueue::cost_type CostType;
+
+    // copy seed image in an image with border
+    IImage regions(w+2, h+2);
+    IImage::Iterator ir = regions.upperLeft() + Diff2D(1,1);
+    IImage::Iterator iry, irx;
+
+    initImageBorder(destImageRange(regions), 1, SRGWatershedLabel);
+    copyImage(seedsul, seedsul+Diff2D(w,h), aseeds, ir, regions.accessor());
+
+    int cneighbor, maxRegionLabel = 0;
+    
+    typedef typename Neighborhood::Direction Direction;
+    int directionCount = Neighborhood::DirectionCount;
+    
+    Point2D pos(0,0);
+    for(isy=srcul, iry=ir, pos.y=0; pos.y<h;
+        ++pos.y, ++isy.y, ++iry.y)
+    {
+        for(isx=isy, irx=iry, pos.x=0; pos.x<w;
+            ++pos.x, ++isx.x, ++irx.x)
+        {
+            if(*irx == 0)
+            {
+                // find candidate pixels for growing and fill queue
+                for(int i=0; i<directionCount; i++)
+                {
+                    // cneighbor = irx[dist[i]];
+                    cneighbor = irx[Neighborhood::diff((Direction)i)];
+                    if(cneighbor > 0)
+                    {
+                        CostType cost = stats[cneighbor].cost(as(isx));
+
+                        pqueue.push(pos, pos+Neighborhood::diff((Direction)i), cost, cneighbor);
+                    }
+                }
+            }
+            else
+            {
+                vigra_precondition((LabelType)*irx <= stats.maxRegionLabel(),
+                    "seededRegionGrowing(): Largest label exceeds size of RegionStatisticsArray.");
+                if(maxRegionLabel < *irx)
+                    maxRegionLabel = *irx;
+            }
+        }
+    }
+    
+    // perform region growing
+    while(!pqueue.empty())
+    {
+        Point2D pos, nearest;
+        int lab;
+        CostType cost;
+        pqueue.pop(pos, nearest, cost, lab);
+
+        if((srgType & StopAtThreshold) != 0 && cost > max_cost)
+        {
+            if(pqueue.candidatesAbove(max_cost))
+                break;
+            continue;
+        }
+
+        irx = ir + pos;
+        isx = srcul + pos;
+
+        if(*irx) // already labelled region / watershed?
+            continue;
+
+        if((srgType & KeepContours) != 0)
+        {
+            for(int i=0; i<directionCount; i++)
+            {
+                cneighbor = irx[Neighborhood::diff((Direction)i)];
+                if((cneighbor>0) && (cneighbor != lab))
+                {
+                    lab = SRGWatershedLabel;
+                    break;
+                }
+            }
+        }
+
+        *irx = lab;
+
+        if((srgType & KeepContours) == 0 || lab > 0)
+        {
+            // update statistics
+            stats[*irx](as(isx));
+
+            // search neighborhood
+            // second pass: find new candidate pixels
+            for(int i=0; i<directionCount; i++)
+            {
+                if(irx[Neighborhood::diff((Direction)i)] == 0)
+                {
+                    CostType cost = stats[lab].cost(as(isx, Neighborhood::diff((Direction)i)));
+
+                    pqueue.push(pos+Neighborhood::diff((Direction)i), nearest, cost, lab);
+                }
+            }
+        }
+    }
+
+    // write result
+    transformImage(ir, ir+Point2D(w,h), regions.accessor(), destul, ad,
+                   detail::UnlabelWatersheds());
+
+    return (LabelType)maxRegionLabel;
+}
+
+} // namespace detail
+
 /** \brief Region Segmentation by means of Seeded Region Growing.
 
     This algorithm implements seeded region growing as described in
@@ -269,6 +640,18 @@ enum SRGType {
     \ref SeedRgDirectValueFunctor. With <tt>SRGType == KeepContours</tt>,
     this is equivalent to the watershed algorithm.
 
+    When the costs are integers in a small range (e.g. for <tt>UInt8</tt> or 
+    <tt>UInt16</tt> images), pass a non-zero <tt>bucket_count</tt>. The candidates
+    are then kept in a bucket queue with <tt>bucket_count</tt> buckets instead of a heap, 
+    and their records are stored by value in a memory pool, which makes the algorithm 
+    run in linear time. All costs (truncated to integers) must be in the range 
+    <tt>[0, ..., bucket_count-1]</tt>. All <tt>SRGType</tt>s are supported, and
+    <tt>max_cost</tt> is compared with the original (not truncated) costs. Candidates with 
+    identical cost are processed in first-in first-out order, i.e. the distance 
+    to the nearest region is not considered. On plateaus, regions thus grow 
+    in breadth-first fashion, and the result may differ from the heap-based version
+    where ties occur.
+
     <b> Declarations:</b>
 
     pass arguments explicitly:
@@ -286,6 +669,19 @@ enum SRGType {
                             SRGType srgType = CompleteGrow,
                             Neighborhood neighborhood = FourNeighborCode(),
                             double max_cost = NumericTraits<double>::max());
+
+        // bucket queue version for integer costs in [0, ..., bucket_count-1]
+        template <class SrcIterator, class SrcAccessor,
+                  class SeedImageIterator, class SeedAccessor,
+                  class DestIterator, class DestAccessor,
+                  class RegionStatisticsArray, class Neighborhood>
+        typename SeedAccessor::value_type 
+        seededRegionGrowing(SrcIterator srcul, SrcIterator srclr, SrcAccessor as,
+                            SeedImageIterator seedsul, SeedAccessor aseeds,
+                            DestIterator destul, DestAccessor ad,
+                            RegionStatisticsArray & stats,
+                            SRGType srgType, Neighborhood neighborhood,
+                            double max_cost, std::ptrdiff_t bucket_count);
     }
     \endcode
 
@@ -304,6 +700,19 @@ enum SRGType {
                             SRGType srgType = CompleteGrow,
                             Neighborhood neighborhood = FourNeighborCode(),
                             double max_cost = NumericTraits<double>::max());
+
+        // bucket queue version for integer costs in [0, ..., bucket_count-1]
+        template <class SrcIterator, class SrcAccessor,
+                  class SeedImageIterator, class SeedAccessor,
+                  class DestIterator, class DestAccessor,
+                  class RegionStatisticsArray, class Neighborhood>
+        typename SeedAccessor::value_type
+        seededRegionGrowing(triple<SrcIterator, SrcIterator, SrcAccessor> src,
+                            pair<SeedImageIterator, SeedAccessor> seeds,
+                            pair<DestIterator, DestAccessor> dest,
+                            RegionStatisticsArray & stats,
+                            SRGType srgType, Neighborhood neighborhood,
+                            double max_cost, std::ptrdiff_t bucket_count);
     }
     \endcode
 
@@ -382,145 +791,48 @@ seededRegionGrowing(SrcIterator srcul,
                     DestIterator destul, DestAccessor ad,
                     RegionStatisticsArray & stats,
                     SRGType srgType,
-                    Neighborhood,
+                    Neighborhood n,
                     double max_cost)
 {
-    int w = srclr.x - srcul.x;
-    int h = srclr.y - srcul.y;
-    int count = 0;
-
-    SrcIterator isy = srcul, isx = srcul;  // iterators for the src image
-
-    typedef typename SeedAccessor::value_type LabelType;
     typedef typename RegionStatisticsArray::value_type RegionStatistics;
     typedef typename RegionStatistics::cost_type CostType;
-    typedef detail::SeedRgPixel<CostType> Pixel;
-
-    typename Pixel::Allocator allocator;
-
-    typedef std::priority_queue<Pixel *, std::vector<Pixel *>,
-                                typename Pixel::Compare>  SeedRgPixelHeap;
 
-    // copy seed image in an image with border
-    IImage regions(w+2, h+2);
-    IImage::Iterator ir = regions.upperLeft() + Diff2D(1,1);
-    IImage::Iterator iry, irx;
-
-    initImageBorder(destImageRange(regions), 1, SRGWatershedLabel);
-    copyImage(seedsul, seedsul+Diff2D(w,h), aseeds, ir, regions.accessor());
-
-    // allocate and init memory for the results
-
-    SeedRgPixelHeap pheap;
-    int cneighbor, maxRegionLabel = 0;
-    
-    typedef typename Neighborhood::Direction Direction;
-    int directionCount = Neighborhood::DirectionCount;
-    
-    Point2D pos(0,0);
-    for(isy=srcul, iry=ir, pos.y=0; pos.y<h;
-        ++pos.y, ++isy.y, ++iry.y)
-    {
-        for(isx=isy, irx=iry, pos.x=0; pos.x<w;
-            ++pos.x, ++isx.x, ++irx.x)
-        {
-            if(*irx == 0)
-            {
-                // find candidate pixels for growing and fill heap
-                for(int i=0; i<directionCount; i++)
-                {
-                    // cneighbor = irx[dist[i]];
-                    cneighbor = irx[Neighborhood::diff((Direction)i)];
-                    if(cneighbor > 0)
-                    {
-                        CostType cost = stats[cneighbor].cost(as(isx));
-
-                        Pixel * pixel =
-                            allocator.create(pos, pos+Neighborhood::diff((Direction)i), cost, count++, cneighbor);
-                        pheap.push(pixel);
-                    }
-                }
-            }
-            else
-            {
-                vigra_precondition((LabelType)*irx <= stats.maxRegionLabel(),
-                    "seededRegionGrowing(): Largest label exceeds size of RegionStatisticsArray.");
-                if(maxRegionLabel < *irx)
-                    maxRegionLabel = *irx;
-            }
-        }
-    }
-    
-    // perform region growing
-    while(pheap.size() != 0)
-    {
-        Pixel * pixel = pheap.top();
-        pheap.pop();
-
-        Point2D pos = pixel->location_;
-        Point2D nearest = pixel->nearest_;
-        int lab = pixel->label_;
-        CostType cost = pixel->cost_;
-
-        allocator.dismiss(pixel);
-
-        if((srgType & StopAtThreshold) != 0 && cost > max_cost)
-            break;
-
-        irx = ir + pos;
-        isx = srcul + pos;
-
-        if(*irx) // already labelled region / watershed?
-            continue;
-
-        if((srgType & KeepContours) != 0)
-        {
-            for(int i=0; i<directionCount; i++)
-            {
-                cneighbor = irx[Neighborhood::diff((Direction)i)];
-                if((cneighbor>0) && (cneighbor != lab))
-                {
-                    lab = SRGWatershedLabel;
-                    break;
-                }
-            }
-        }
-
-        *irx = lab;
-
-        if((srgType & KeepContours) == 0 || lab > 0)
-        {
-            // update statistics
-            stats[*irx](as(isx));
+    detail::SeedRgHeapCandidates<detail::SeedRgPixel<CostType>, Point2D, CostType> pqueue;
+    return detail::seededRegionGrowingImpl(srcul, srclr, as,
+                                           seedsul, aseeds,
+                                           destul, ad,
+                                           stats, srgType, n, max_cost, pqueue);
+}
 
-            // search neighborhood
-            // second pass: find new candidate pixels
-            for(int i=0; i<directionCount; i++)
-            {
-                if(irx[Neighborhood::diff((Direction)i)] == 0)
-                {
-                    CostType cost = stats[lab].cost(as(isx, Neighborhood::diff((Direction)i)));
+template <class SrcIterator, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood>
+inline typename SeedAccessor::value_type
+seededRegionGrowing(SrcIterator srcul,
+                    SrcIterator srclr, SrcAccessor as,
+                    SeedImageIterator seedsul, SeedAccessor aseeds,
+                    DestIterator destul, DestAccessor ad,
+                    RegionStatisticsArray & stats,
+                    SRGType srgType,
+                    Neighborhood n,
+                    double max_cost,
+                    std::ptrdiff_t bucket_count)
+{
+    typedef typename RegionStatisticsArray::value_type RegionStatistics;
+    typedef typename RegionStatistics::cost_type CostType;
 
-                    Pixel * new_pixel =
-                        allocator.create(pos+Neighborhood::diff((Direction)i), nearest, cost, count++, lab);
-                    pheap.push(new_pixel);
-                }
-            }
-        }
-    }
+    if(bucket_count == 0)
+        return seededRegionGrowing(srcul, srclr, as,
+                                   seedsul, aseeds,
+                                   destul, ad,
+                                   stats, srgType, n, max_cost);
     
-    // free temporary memory
-    while(pheap.size() != 0)
-    {
-        allocator.dismiss(pheap.top());
-        pheap.pop();
-    }
-
-    // write result
-    transformImage(ir, ir+Point2D(w,h), regions.accessor(), destul, ad,
-                   detail::UnlabelWatersheds());
-
-    return (LabelType)maxRegionLabel;
+    detail::SeedRgBucketCandidates<Point2D, CostType> pqueue(bucket_count);
+    return detail::seededRegionGrowingImpl(srcul, srclr, as,
+                                           seedsul, aseeds,
+                                           destul, ad,
+                                           stats, srgType, n, max_cost, pqueue);
 }
 
 template <class SrcIterator, class SrcAccessor,
@@ -579,6 +891,26 @@ seededRegionGrowing(SrcIterator srcul,
                                 stats, CompleteGrow);
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood>
+inline typename SeedAccessor::value_type
+seededRegionGrowing(triple<SrcIterator, SrcIterator, SrcAccessor> img1,
+                    pair<SeedImageIterator, SeedAccessor> img3,
+                    pair<DestIterator, DestAccessor> img4,
+                    RegionStatisticsArray & stats,
+                    SRGType srgType, 
+                    Neighborhood n,
+                    double max_cost,
+                    std::ptrdiff_t bucket_count)
+{
+    return seededRegionGrowing(img1.first, img1.second, img1.third,
+                                img3.first, img3.second,
+                                img4.first, img4.second,
+                                stats, srgType, n, max_cost, bucket_count);
+}
+
 template <class SrcIterator, class SrcAccessor,
           class SeedImageIterator, class SeedAccessor,
           class DestIterator, class DestAccessor,
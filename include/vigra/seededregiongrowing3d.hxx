@@ -160,6 +160,137 @@ public:
     };
 };
 
+    // Implementation of seededRegionGrowing3D() for the given candidate queue,
+    // see SeedRgHeapCandidates and SeedRgBucketCandidates.
+template <class SrcImageIterator, class Diff_type, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestImageIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood,
+          class CandidateQueue>
+void 
+seededRegionGrowing3DImpl(SrcImageIterator srcul, Diff_type shape, SrcAccessor as,
+                          SeedImageIterator seedsul, SeedAccessor aseeds,
+                          DestImageIterator destul, DestAccessor ad,
+                          RegionStatisticsArray & stats, 
+                          SRGType srgType,
+                          Neighborhood,
+                          double max_cost,
+                          CandidateQueue & pqueue)
+{
+    int w = shape[0];
+    int h = shape[1];
+    int d = shape[2];
+
+    SrcImageIterator isy = srcul, isx = srcul, isz = srcul;  // iterators for the src image
+
+    typedef typename CandidateQueue::cost_type CostType;
+    typedef MultiArray<3, int> IVolume;
+
+    // copy seed image in an image with border
+    Diff_type regionshape = shape + Diff_type(2,2,2);
+    IVolume regions(regionshape);
+    MultiIterator<3,int> ir = regions.traverser_begin();
+    ir = ir + Diff_type(1,1,1);
+    
+    MultiIterator<3,int> iry, irx, irz;
+
+    initMultiArrayBorder(destMultiArrayRange(regions), 1, SRGWatershedLabel); 
+    copyMultiArray(seedsul, Diff_type(w,h,d), aseeds, ir, AccessorTraits<int>::default_accessor());
+
+    int cneighbor;
+
+    typedef typename Neighborhood::Direction Direction;
+    int directionCount = Neighborhood::DirectionCount;
+
+    Diff_type pos(0,0,0);
+
+    for(isz=srcul, irz=ir, pos[2]=0; pos[2]<d;
+            pos[2]++, isz.dim2()++, irz.dim2()++)
+    {
+        for(isy=isz, iry=irz, pos[1]=0; pos[1]<h;
+            pos[1]++, isy.dim1()++, iry.dim1()++)
+        {
+            for(isx=isy, irx=iry, pos[0]=0; pos[0]<w;
+                pos[0]++, isx.dim0()++, irx.dim0()++)
+            {
+                if(*irx == 0)
+                {
+                    // find candidate voxels for growing and fill queue
+                    for(int i=0; i<directionCount; i++)
+                    {
+                        cneighbor = *(irx + Neighborhood::diff((Direction)i));
+                        if(cneighbor > 0)
+                        {
+                            CostType cost = stats[cneighbor].cost(as(isx));
+
+                            pqueue.push(pos, pos+Neighborhood::diff((Direction)i), cost, cneighbor);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    // perform region growing
+    while(!pqueue.empty())
+    {
+        Diff_type pos, nearest;
+        int lab;
+        CostType cost;
+        pqueue.pop(pos, nearest, cost, lab);
+
+        if((srgType & StopAtThreshold) != 0 && cost > max_cost)
+        {
+            if(pqueue.candidatesAbove(max_cost))
+                break;
+            continue;
+        }
+
+        irx = ir + pos;
+        isx = srcul + pos;
+
+        if(*irx) // already labelled region / watershed?
+            continue;
+
+        if((srgType & KeepContours) != 0)
+        {
+            for(int i=0; i<directionCount; i++)
+            {
+                cneighbor = * (irx + Neighborhood::diff((Direction)i));
+                if((cneighbor>0) && (cneighbor != lab))
+                {
+                    lab = SRGWatershedLabel;
+                    break;
+                }
+            }
+        }
+
+        *irx = lab;
+
+        if((srgType & KeepContours) == 0 || lab > 0)
+        {
+            // update statistics
+            stats[*irx](as(isx));
+
+            // search neighborhood
+            // second pass: find new candidate voxels
+            for(int i=0; i<directionCount; i++)
+            {
+                if(*(irx + Neighborhood::diff((Direction)i)) == 0)
+                {
+                    CostType cost = stats[lab].cost(as(isx, Neighborhood::diff((Direction)i)));
+
+                    pqueue.push(pos+Neighborhood::diff((Direction)i), nearest, cost, lab);
+                }
+            }
+        }
+    }
+
+    // write result
+    transformMultiArray(ir, Diff_type(w,h,d), AccessorTraits<int>::default_accessor(), 
+                        destul, ad, detail::UnlabelWatersheds());
+}
+
 } // namespace detail
 
 /** \addtogroup SeededRegionGrowing
@@ -248,6 +379,12 @@ public:
     function returns its argument. This behavior is implemented by the
     \ref SeedRgDirectValueFunctor.
 
+    For integer costs in the range <tt>[0, ..., bucket_count-1]</tt> (e.g. <tt>UInt8</tt> 
+    or <tt>UInt16</tt> volumes), pass a non-zero <tt>bucket_count</tt> to replace the heap
+    with a bucket queue. This makes 3D seeded watersheds run in linear time.
+    Candidates with equal cost are then processed in first-in first-out order,
+    see \ref seededRegionGrowing() for details.
+
     <b> Declarations:</b>
 
     pass arguments explicitly:
@@ -265,6 +402,19 @@ public:
                               SRGType srgType = CompleteGrow,
                               Neighborhood neighborhood = NeighborCode3DSix(),
                               double max_cost = NumericTraits<double>::max());
+
+        // bucket queue version for integer costs in [0, ..., bucket_count-1]
+        template <class SrcImageIterator, class Shape, class SrcAccessor,
+                  class SeedImageIterator, class SeedAccessor,
+                  class DestImageIterator, class DestAccessor,
+                  class RegionStatisticsArray, class Neighborhood>
+        void 
+        seededRegionGrowing3D(SrcImageIterator srcul, Shape shape, SrcAccessor as,
+                              SeedImageIterator seedsul, SeedAccessor aseeds,
+                              DestImageIterator destul, DestAccessor ad,
+                              RegionStatisticsArray & stats, 
+                              SRGType srgType, Neighborhood neighborhood,
+                              double max_cost, std::ptrdiff_t bucket_count);
     }
     \endcode
 
@@ -283,6 +433,19 @@ public:
                               SRGType srgType = CompleteGrow,
                               Neighborhood neighborhood = NeighborCode3DSix(), 
                               double max_cost = NumericTraits<double>::max());
+
+        // bucket queue version for integer costs in [0, ..., bucket_count-1]
+        template <class SrcImageIterator, class Shape, class SrcAccessor,
+                  class SeedImageIterator, class SeedAccessor,
+                  class DestImageIterator, class DestAccessor,
+                  class RegionStatisticsArray, class Neighborhood>
+        void
+        seededRegionGrowing3D(triple<SrcImageIterator, Shape, SrcAccessor> src,
+                              pair<SeedImageIterator, SeedAccessor> seeds,
+                              pair<DestImageIterator, DestAccessor> dest,
+                              RegionStatisticsArray & stats, 
+                              SRGType srgType, Neighborhood neighborhood, 
+                              double max_cost, std::ptrdiff_t bucket_count);
     }
     \endcode
 
@@ -299,164 +462,44 @@ seededRegionGrowing3D(SrcImageIterator srcul, Diff_type shape, SrcAccessor as,
                       DestImageIterator destul, DestAccessor ad,
                       RegionStatisticsArray & stats, 
                       SRGType srgType,
-                      Neighborhood,
+                      Neighborhood n,
                       double max_cost)
 {
-    //SrcImageIterator srclr = srcul + shape;
-    //int w = srclr.x - srcul.x;
-    int w = shape[0];
-    //int h = srclr.y - srcul.y;
-    int h = shape[1];
-    //int d = srclr.z - srcul.z;
-    int d = shape[2];
-    int count = 0;
-
-    SrcImageIterator isy = srcul, isx = srcul, isz = srcul;  // iterators for the src image
-
     typedef typename RegionStatisticsArray::value_type RegionStatistics;
     typedef typename PromoteTraits<typename RegionStatistics::cost_type, double>::Promote CostType;
-    typedef detail::SeedRgVoxel<CostType, Diff_type> Voxel;
-
-    typename Voxel::Allocator allocator;
-
-    typedef std::priority_queue< Voxel *,
-                                 std::vector<Voxel *>,
-                                 typename Voxel::Compare >  SeedRgVoxelHeap;
-    typedef MultiArray<3, int> IVolume;
-
-    // copy seed image in an image with border
-    Diff_type regionshape = shape + Diff_type(2,2,2);
-    IVolume regions(regionshape);
-    MultiIterator<3,int> ir = regions.traverser_begin();
-    ir = ir + Diff_type(1,1,1);
-    
-    //IVolume::Iterator iry, irx, irz;
-    MultiIterator<3,int> iry, irx, irz;
-
-    //initImageBorder(destImageRange(regions), 1, SRGWatershedLabel);
-    initMultiArrayBorder(destMultiArrayRange(regions), 1, SRGWatershedLabel); 
-    
-    copyMultiArray(seedsul, Diff_type(w,h,d), aseeds, ir, AccessorTraits<int>::default_accessor());
-
-    // allocate and init memory for the results
-
-    SeedRgVoxelHeap pheap;
-    int cneighbor;
-
-    #if 0
-    static const Diff_type dist[] = { Diff_type(-1, 0, 0), Diff_type( 0,-1, 0),
-                                      Diff_type( 1, 0, 0), Diff_type( 0, 1, 0),
-                                      Diff_type( 0, 0,-1), Diff_type( 0, 0, 1) };
-    #endif
-
-    typedef typename Neighborhood::Direction Direction;
-    int directionCount = Neighborhood::DirectionCount;
-
-    Diff_type pos(0,0,0);
-
-    for(isz=srcul, irz=ir, pos[2]=0; pos[2]<d;
-            pos[2]++, isz.dim2()++, irz.dim2()++)
-    {
-        //std::cerr << "Z = " << pos[2] << std::endl;
-
-        for(isy=isz, iry=irz, pos[1]=0; pos[1]<h;
-            pos[1]++, isy.dim1()++, iry.dim1()++)
-        {
-            //std::cerr << "Y = " << pos[1] << std::endl;
-            
-            for(isx=isy, irx=iry, pos[0]=0; pos[0]<w;
-                pos[0]++, isx.dim0()++, irx.dim0()++)
-            {
-                //std::cerr << "X = " << pos[0] << std::endl;
-                
-                if(*irx == 0)
-                {
-                    // find candidate pixels for growing and fill heap
-                    for(int i=0; i<directionCount; i++)
-                    {
-                        cneighbor = *(irx + Neighborhood::diff((Direction)i));
-                        if(cneighbor > 0)
-                        {
-                            CostType cost = stats[cneighbor].cost(as(isx));
-
-                            Voxel * voxel =
-                                allocator.create(pos, pos+Neighborhood::diff((Direction)i), cost, count++, cneighbor);
-                            pheap.push(voxel);
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    // perform region growing
-    while(pheap.size() != 0)
-    {
-        Voxel * voxel = pheap.top();
-        pheap.pop();
-
-        Diff_type pos = voxel->location_;
-        Diff_type nearest = voxel->nearest_;
-        int lab = voxel->label_;
-        CostType cost = voxel->cost_;
-
-        allocator.dismiss(voxel);
-
-        if((srgType & StopAtThreshold) != 0 && cost > max_cost)
-            break;
-
-        irx = ir + pos;
-        isx = srcul + pos;
 
-        if(*irx) // already labelled region / watershed?
-            continue;
-
-        if((srgType & KeepContours) != 0)
-        {
-            for(int i=0; i<directionCount; i++)
-            {
-                cneighbor = * (irx + Neighborhood::diff((Direction)i));
-                if((cneighbor>0) && (cneighbor != lab))
-                {
-                    lab = SRGWatershedLabel;
-                    break;
-                }
-            }
-        }
-
-        *irx = lab;
-
-        if((srgType & KeepContours) == 0 || lab > 0)
-        {
-            // update statistics
-            stats[*irx](as(isx));
+    detail::SeedRgHeapCandidates<detail::SeedRgVoxel<CostType, Diff_type>, Diff_type, CostType> pqueue;
+    detail::seededRegionGrowing3DImpl(srcul, shape, as, seedsul, aseeds, 
+                                      destul, ad, stats, srgType, n, max_cost, pqueue);
+}
 
-            // search neighborhood
-            // second pass: find new candidate pixels
-            for(int i=0; i<directionCount; i++)
-            {
-                if(*(irx + Neighborhood::diff((Direction)i)) == 0)
-                {
-                    CostType cost = stats[lab].cost(as(isx, Neighborhood::diff((Direction)i)));
+template <class SrcImageIterator, class Diff_type, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestImageIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood>
+inline void 
+seededRegionGrowing3D(SrcImageIterator srcul, Diff_type shape, SrcAccessor as,
+                      SeedImageIterator seedsul, SeedAccessor aseeds,
+                      DestImageIterator destul, DestAccessor ad,
+                      RegionStatisticsArray & stats, 
+                      SRGType srgType,
+                      Neighborhood n,
+                      double max_cost,
+                      std::ptrdiff_t bucket_count)
+{
+    typedef typename RegionStatisticsArray::value_type RegionStatistics;
+    typedef typename PromoteTraits<typename RegionStatistics::cost_type, double>::Promote CostType;
 
-                    Voxel * new_voxel =
-                        allocator.create(pos+Neighborhood::diff((Direction)i), nearest, cost, count++, lab);
-                    pheap.push(new_voxel);
-                }
-            }
-        }
-    }
-    
-    // free temporary memory
-    while(pheap.size() != 0)
+    if(bucket_count == 0)
     {
-        allocator.dismiss(pheap.top());
-        pheap.pop();
+        seededRegionGrowing3D(srcul, shape, as, seedsul, aseeds, 
+                              destul, ad, stats, srgType, n, max_cost);
+        return;
     }
 
-    // write result
-    transformMultiArray(ir, Diff_type(w,h,d), AccessorTraits<int>::default_accessor(), 
-                        destul, ad, detail::UnlabelWatersheds());
+    detail::SeedRgBucketCandidates<Diff_type, CostType> pqueue(bucket_count);
+    detail::seededRegionGrowing3DImpl(srcul, shape, as, seedsul, aseeds, 
+                                      destul, ad, stats, srgType, n, max_cost, pqueue);
 }
 
 template <class SrcImageIterator, class Diff_type, class SrcAccessor,
@@ -501,6 +544,24 @@ seededRegionGrowing3D(SrcImageIterator srcul, Diff_type shape, SrcAccessor as,
                            stats, CompleteGrow);
 }
 
+template <class SrcImageIterator, class Shape, class SrcAccessor,
+          class SeedImageIterator, class SeedAccessor,
+          class DestImageIterator, class DestAccessor,
+          class RegionStatisticsArray, class Neighborhood>
+inline void
+seededRegionGrowing3D(triple<SrcImageIterator, Shape, SrcAccessor> img1,
+                      pair<SeedImageIterator, SeedAccessor> img3,
+                      pair<DestImageIterator, DestAccessor> img4,
+                      RegionStatisticsArray & stats, 
+                      SRGType srgType, Neighborhood n, double max_cost,
+                      std::ptrdiff_t bucket_count)
+{
+    seededRegionGrowing3D(img1.first, img1.second, img1.third,
+                          img3.first, img3.second,
+                          img4.first, img4.second,
+                          stats, srgType, n, max_cost, bucket_count);
+}
+
 template <class SrcImageIterator, class Shape, class SrcAccessor,
           class SeedImageIterator, class SeedAccessor,
           class DestImageIterator, class DestAccessor,
@@ -42,6 +42,7 @@
 #include "numerictraits.hxx"
 #include "imageiteratoradapter.hxx"
 #include "bordertreatment.hxx"
+#include "simd_convolution.hxx"
 #include "gaussians.hxx"
 #include "array_vector.hxx"
 
@@ -747,6 +748,151 @@ void internalConvolveLineAvoid(SrcIterator is, SrcIterator iend, SrcAccessor sa,
     }
 }
 
+namespace detail {
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class KernelIterator, class KernelAccessor>
+void internalConvolveLine(SrcIterator is, SrcIterator iend, SrcAccessor sa,
+                          DestIterator id, DestAccessor da,
+                          KernelIterator ik, KernelAccessor ka,
+                          int kleft, int kright, BorderTreatmentMode border,
+                          int start, int stop)
+{
+    switch(border)
+    {
+      case BORDER_TREATMENT_WRAP:
+      {
+        internalConvolveLineWrap(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
+        break;
+      }
+      case BORDER_TREATMENT_AVOID:
+      {
+        internalConvolveLineAvoid(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
+        break;
+      }
+      case BORDER_TREATMENT_REFLECT:
+      {
+        internalConvolveLineReflect(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
+        break;
+      }
+      case BORDER_TREATMENT_REPEAT:
+      {
+        internalConvolveLineRepeat(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
+        break;
+      }
+      case BORDER_TREATMENT_CLIP:
+      {
+        // find norm of kernel
+        typedef typename KernelAccessor::value_type KT;
+        KT norm = NumericTraits<KT>::zero();
+        KernelIterator iik = ik + kleft;
+        for(int i=kleft; i<=kright; ++i, ++iik)
+            norm += ka(iik);
+
+        vigra_precondition(norm != NumericTraits<KT>::zero(),
+                     "convolveLine(): Norm of kernel must be != 0"
+                     " in mode BORDER_TREATMENT_CLIP.\n");
+
+        internalConvolveLineClip(is, iend, sa, id, da, ik, ka, kleft, kright, norm, start, stop);
+        break;
+      }
+      case BORDER_TREATMENT_ZEROPAD:
+      {
+        internalConvolveLineZeropad(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
+        break;
+      }
+      default:
+      {
+        vigra_precondition(0,
+                     "convolveLine(): Unknown border treatment mode.\n");
+      }
+    }
+}
+
+    // default: no vectorized code available for this iterator/accessor combination
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class KernelIterator, class KernelAccessor>
+inline bool 
+convolveLineInteriorSimd(SrcIterator, SrcAccessor, DestIterator, DestAccessor,
+                         KernelIterator, KernelAccessor, int, int, int, int, VigraFalseType)
+{
+    return false;
+}
+
+template <class T, class SumType,
+          class DestIterator, class DestAccessor,
+          class KernelIterator, class KernelAccessor>
+inline bool 
+convolveLineInteriorSimdImpl(T const *, SumType *, DestIterator, DestAccessor,
+                             KernelIterator, KernelAccessor, int, int, int, int, VigraFalseType)
+{
+    return false;
+}
+
+    // compute the elements [istart, istop) of a line where the kernel doesn't
+    // touch the border, and write them to the destination starting at 'id'
+template <class T, class SumType,
+          class DestIterator, class DestAccessor,
+          class KernelIterator, class KernelAccessor>
+bool 
+convolveLineInteriorSimdImpl(T const * is, SumType *, DestIterator id, DestAccessor da,
+                             KernelIterator ik, KernelAccessor ka, 
+                             int kleft, int kright, int istart, int istop, VigraTrueType)
+{
+    if(simdInstructionSet() == SIMD_NONE)
+        return false;
+        
+    // This function is called for every line, so we avoid heap allocations: 
+    // the reversed kernel and the results are kept in fixed-size buffers on the 
+    // stack, and the line is processed in chunks. Only kernels longer than
+    // the kernel buffer need heap memory, but then the allocation is negligible 
+    // compared to the convolution itself.
+    enum { BufferSize = 256 };
+    SumType kernelBuffer[BufferSize], res[BufferSize];
+    ArrayVector<SumType> longKernel;
+    
+    int kw = kright - kleft + 1;
+    SumType * kernel = kernelBuffer;
+    if(kw > BufferSize)
+    {
+        longKernel.resize(kw);
+        kernel = longKernel.begin();
+    }
+    for(int k=0; k<kw; ++k)
+        kernel[k] = ka(ik + (kright - k));
+    
+    for(int x = istart; x < istop; x += BufferSize)
+    {
+        int n = std::min<int>(BufferSize, istop - x);
+        convolveInteriorSimd(is + (x - kright), res, n, kernel, kw);
+        for(int k=0; k<n; ++k, ++id)
+            da.set(detail::RequiresExplicitCast<typename
+                          DestAccessor::value_type>::cast(res[k]), id);
+    }
+    return true;
+}
+
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor,
+          class KernelIterator, class KernelAccessor>
+inline bool 
+convolveLineInteriorSimd(SrcIterator is, SrcAccessor, DestIterator id, DestAccessor da,
+                         KernelIterator ik, KernelAccessor ka, 
+                         int kleft, int kright, int istart, int istop, VigraTrueType)
+{
+    typedef typename SimdConvolutionSource<SrcIterator, SrcAccessor>::type T;
+    typedef typename KernelAccessor::value_type KernelValue;
+    typedef typename PromoteTraits<T, KernelValue>::Promote SumType;
+    
+    return convolveLineInteriorSimdImpl(static_cast<T const *>(is), (SumType*)0, id, da, ik, ka, 
+                                        kleft, kright, istart, istop, 
+                                        typename SimdConvolutionSumType<KernelValue, SumType>::isSupported());
+}
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*         Separable convolution functions              */
@@ -900,8 +1046,6 @@ void convolveLine(SrcIterator is, SrcIterator iend, SrcAccessor sa,
                   int kleft, int kright, BorderTreatmentMode border,
                   int start = 0, int stop = 0)
 {
-    typedef typename KernelAccessor::value_type KernelValue;
-
     vigra_precondition(kleft <= 0,
                  "convolveLine(): kleft must be <= 0.\n");
     vigra_precondition(kright >= 0,
@@ -917,58 +1061,25 @@ void convolveLine(SrcIterator is, SrcIterator iend, SrcAccessor sa,
         vigra_precondition(0 <= start && start < stop && stop <= w,
                         "convolveLine(): invalid subrange (start, stop).\n");
 
-    typedef typename PromoteTraits<
-            typename SrcAccessor::value_type,
-            typename KernelAccessor::value_type>::Promote SumType;
-    ArrayVector<SumType> a(iend - is); 
-    switch(border)
+    int istart = std::max(start, kright),
+        istop  = std::min(stop == 0 ? w : stop, w + kleft);
+    if(istart < istop &&
+       detail::convolveLineInteriorSimd(is, sa, id + (istart - start), da, ik, ka, kleft, kright, istart, istop,
+                  typename detail::SimdConvolutionSource<SrcIterator, SrcAccessor>::isSupported()))
     {
-      case BORDER_TREATMENT_WRAP:
-      {
-        internalConvolveLineWrap(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
-        break;
-      }
-      case BORDER_TREATMENT_AVOID:
-      {
-        internalConvolveLineAvoid(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
-        break;
-      }
-      case BORDER_TREATMENT_REFLECT:
-      {
-        internalConvolveLineReflect(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
-        break;
-      }
-      case BORDER_TREATMENT_REPEAT:
-      {
-        internalConvolveLineRepeat(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
-        break;
-      }
-      case BORDER_TREATMENT_CLIP:
-      {
-        // find norm of kernel
-        typedef typename KernelAccessor::value_type KT;
-        KT norm = NumericTraits<KT>::zero();
-        KernelIterator iik = ik + kleft;
-        for(int i=kleft; i<=kright; ++i, ++iik)
-            norm += ka(iik);
-
-        vigra_precondition(norm != NumericTraits<KT>::zero(),
-                     "convolveLine(): Norm of kernel must be != 0"
-                     " in mode BORDER_TREATMENT_CLIP.\n");
-
-        internalConvolveLineClip(is, iend, sa, id, da, ik, ka, kleft, kright, norm, start, stop);
-        break;
-      }
-      case BORDER_TREATMENT_ZEROPAD:
-      {
-        internalConvolveLineZeropad(is, iend, sa, id, da, ik, ka, kleft, kright, start, stop);
-        break;
-      }
-      default:
-      {
-        vigra_precondition(0,
-                     "convolveLine(): Unknown border treatment mode.\n");
-      }
+        // the interior was computed by vectorized code, now do the borders
+        if(border == BORDER_TREATMENT_AVOID)
+            return;
+        if(start < istart)
+            detail::internalConvolveLine(is, iend, sa, id, da, ik, ka, kleft, kright, border, 
+                                         start, istart);
+        if(istop < (stop == 0 ? w : stop))
+            detail::internalConvolveLine(is, iend, sa, id + (istop - start), da, ik, ka, kleft, kright, border, 
+                                         istop, stop == 0 ? w : stop);
+    }
+    else
+    {
+        detail::internalConvolveLine(is, iend, sa, id, da, ik, ka, kleft, kright, border, start, stop);
     }
 }
 
@@ -1310,7 +1421,9 @@ class Kernel1D
         {}
 
         ~InitProxy() 
-#ifndef _MSC_VER
+#if defined(VIGRA_HAS_NOEXCEPT)
+             noexcept(false)
+#elif !defined(_MSC_VER)
              throw(PreconditionViolation)
 #endif
         {
@@ -0,0 +1,205 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_SIMD_HXX
+#define VIGRA_SIMD_HXX
+
+#include "config.hxx"
+
+// Runtime dispatch is supported for x86 processors with gcc, clang and MSVC.
+// Define VIGRA_NO_SIMD to disable all explicitly vectorized code.
+#if !defined(VIGRA_NO_SIMD) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+    (defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1910))
+#  define VIGRA_HAS_SIMD_DISPATCH
+#endif
+
+#ifdef VIGRA_HAS_SIMD_DISPATCH
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+// Function attributes that enable code generation for a given instruction set
+// in a single function. Multiply-add contraction is switched off, so that the
+// vectorized code performs exactly the same operations as scalar code. Since clang
+// doesn't support the 'optimize' attribute, functions using these attributes must
+// also place VIGRA_SIMD_NO_FP_CONTRACT at the beginning of their body.
+#if defined(VIGRA_HAS_SIMD_DISPATCH) && defined(__clang__)
+#  define VIGRA_TARGET_SSE2    __attribute__((target("sse2")))
+#  define VIGRA_TARGET_AVX2    __attribute__((target("avx2")))
+#  define VIGRA_TARGET_AVX512  __attribute__((target("avx512f")))
+#  define VIGRA_SIMD_NO_FP_CONTRACT _Pragma("clang fp contract(off)")
+#elif defined(VIGRA_HAS_SIMD_DISPATCH) && defined(__GNUC__)
+#  define VIGRA_TARGET_SSE2    __attribute__((target("sse2"), optimize("fp-contract=off")))
+#  define VIGRA_TARGET_AVX2    __attribute__((target("avx2"), optimize("fp-contract=off")))
+#  define VIGRA_TARGET_AVX512  __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#  define VIGRA_SIMD_NO_FP_CONTRACT
+#else
+#  define VIGRA_TARGET_SSE2
+#  define VIGRA_TARGET_AVX2
+#  define VIGRA_TARGET_AVX512
+#  define VIGRA_SIMD_NO_FP_CONTRACT
+#endif
+
+namespace vigra {
+
+/** \addtogroup SimdDispatch Runtime Selection of SIMD Instruction Sets
+
+    Some functions (e.g. \ref convolveLine()) contain code paths that are explicitly
+    vectorized for different SIMD instruction sets. The most powerful instruction set
+    supported by the CPU is determined at runtime, so that the same binary
+    runs optimally on different machines.
+
+    Runtime dispatch is available for x86 processors when compiling with gcc, clang,
+    or MSVC 2017 and later. Defining <tt>VIGRA_NO_SIMD</tt> disables all explicitly
+    vectorized code.
+*/
+//@{
+
+    /** \brief SIMD instruction sets used for runtime dispatch.
+
+        <b>\#include</b> \<vigra/simd.hxx\><br>
+        Namespace: vigra
+    */
+enum SimdInstructionSet
+{
+    SIMD_NONE = 0,   ///< scalar code only
+    SIMD_SSE2 = 1,   ///< 128-bit vectors
+    SIMD_AVX2 = 2,   ///< 256-bit vectors
+    SIMD_AVX512 = 3  ///< 512-bit vectors (AVX-512F)
+};
+
+namespace detail {
+
+inline SimdInstructionSet detectSimdInstructionSet()
+{
+#if !defined(VIGRA_HAS_SIMD_DISPATCH)
+    return SIMD_NONE;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+    return SIMD_NONE;
+#else // _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool sse2    = (info[3] & (1 << 26)) != 0,
+         osxsave = (info[2] & (1 << 27)) != 0;
+    unsigned long long xcr0 = osxsave
+                                  ? _xgetbv(0)
+                                  : 0;
+    bool os_avx    = (xcr0 & 0x06) == 0x06,  // XMM and YMM state
+         os_avx512 = (xcr0 & 0xe6) == 0xe6;  // additionally opmask and ZMM state
+    if(max_leaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        if(os_avx512 && (info[1] & (1 << 16)) != 0)
+            return SIMD_AVX512;
+        if(os_avx && (info[1] & (1 << 5)) != 0)
+            return SIMD_AVX2;
+    }
+    return sse2
+               ? SIMD_SSE2
+               : SIMD_NONE;
+#endif
+}
+
+inline SimdInstructionSet & currentSimdInstructionSet()
+{
+    static SimdInstructionSet current = detectSimdInstructionSet();
+    return current;
+}
+
+} // namespace detail
+
+    /** \brief The most powerful SIMD instruction set supported by this CPU.
+
+        Returns <tt>SIMD_NONE</tt> if runtime dispatch is not available on this
+        platform or has been disabled by <tt>VIGRA_NO_SIMD</tt>.
+
+        <b>\#include</b> \<vigra/simd.hxx\><br>
+        Namespace: vigra
+    */
+inline SimdInstructionSet supportedSimdInstructionSet()
+{
+    static SimdInstructionSet supported = detail::detectSimdInstructionSet();
+    return supported;
+}
+
+    /** \brief The SIMD instruction set currently used by vectorized functions.
+
+        Defaults to \ref supportedSimdInstructionSet().
+
+        <b>\#include</b> \<vigra/simd.hxx\><br>
+        Namespace: vigra
+    */
+inline SimdInstructionSet simdInstructionSet()
+{
+    return detail::currentSimdInstructionSet();
+}
+
+    /** \brief Restrict vectorized functions to the given SIMD instruction set.
+
+        This is useful for benchmarking and to compare results with the scalar code
+        (<tt>setSimdInstructionSet(SIMD_NONE)</tt>). If the CPU doesn't support the
+        requested instruction set, the most powerful supported one is used instead.
+        The previous setting is returned. This function is not thread-safe and
+        should be called before any vectorized function is executed.
+
+        <b>\#include</b> \<vigra/simd.hxx\><br>
+        Namespace: vigra
+    */
+inline SimdInstructionSet setSimdInstructionSet(SimdInstructionSet s)
+{
+    SimdInstructionSet old = detail::currentSimdInstructionSet();
+    detail::currentSimdInstructionSet() = s < supportedSimdInstructionSet()
+                                              ? s
+                                              : supportedSimdInstructionSet();
+    return old;
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_SIMD_HXX
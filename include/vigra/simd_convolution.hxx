@@ -0,0 +1,285 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#ifndef VIGRA_SIMD_CONVOLUTION_HXX
+#define VIGRA_SIMD_CONVOLUTION_HXX
+
+#include <cstring>
+#include "simd.hxx"
+#include "accessor.hxx"
+#include "sized_int.hxx"
+#include "metaprogramming.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+/********************************************************/
+/*                                                      */
+/*          vectorized interior of convolveLine()       */
+/*                                                      */
+/********************************************************/
+
+// The functions below compute 
+//
+//     dest[x] = sum_k kernel[k] * src[x + k],   0 <= x < n,  0 <= k < kw
+//
+// where 'kernel' holds the reversed kernel coefficients and 'src' points to 
+// the first source element needed for dest[0]. The vector lanes correspond to
+// consecutive output elements, and the sum is accumulated in the same order
+// as in the scalar code, starting from zero. Since multiply-add contraction
+// is switched off, the results are identical to the scalar code.
+
+#ifdef VIGRA_HAS_SIMD_DISPATCH
+
+    // load functions: convert 'lanes' source elements to the sum type
+
+VIGRA_TARGET_SSE2 inline __m128  simdLoadSSE2(float const * p, float)  { return _mm_loadu_ps(p); }
+VIGRA_TARGET_SSE2 inline __m128  simdLoadSSE2(UInt8 const * p, float)
+{
+    int v;
+    std::memcpy(&v, p, 4);
+    __m128i zero = _mm_setzero_si128(),
+            b = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+    return _mm_cvtepi32_ps(b);
+}
+VIGRA_TARGET_SSE2 inline __m128d simdLoadSSE2(double const * p, double) { return _mm_loadu_pd(p); }
+VIGRA_TARGET_SSE2 inline __m128d simdLoadSSE2(float const * p, double)
+{
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const *)p)));
+}
+VIGRA_TARGET_SSE2 inline __m128d simdLoadSSE2(UInt8 const * p, double)
+{
+    return _mm_cvtepi32_pd(_mm_setr_epi32(p[0], p[1], 0, 0));
+}
+
+VIGRA_TARGET_AVX2 inline __m256  simdLoadAVX2(float const * p, float)  { return _mm256_loadu_ps(p); }
+VIGRA_TARGET_AVX2 inline __m256  simdLoadAVX2(UInt8 const * p, float)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)p)));
+}
+VIGRA_TARGET_AVX2 inline __m256d simdLoadAVX2(double const * p, double) { return _mm256_loadu_pd(p); }
+VIGRA_TARGET_AVX2 inline __m256d simdLoadAVX2(float const * p, double)  { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+VIGRA_TARGET_AVX2 inline __m256d simdLoadAVX2(UInt8 const * p, double)
+{
+    int v;
+    std::memcpy(&v, p, 4);
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v)));
+}
+
+    // The zero-masking conversions are used because gcc's unmasked variants pass an 
+    // intentionally uninitialized vector to the builtins, which triggers warnings.
+VIGRA_TARGET_AVX512 inline __m512  simdLoadAVX512(float const * p, float)  { return _mm512_loadu_ps(p); }
+VIGRA_TARGET_AVX512 inline __m512  simdLoadAVX512(UInt8 const * p, float)
+{
+    return _mm512_maskz_cvtepi32_ps((__mmask16)0xFFFF, 
+               _mm512_maskz_cvtepu8_epi32((__mmask16)0xFFFF, _mm_loadu_si128((__m128i const *)p)));
+}
+VIGRA_TARGET_AVX512 inline __m512d simdLoadAVX512(double const * p, double) { return _mm512_loadu_pd(p); }
+VIGRA_TARGET_AVX512 inline __m512d simdLoadAVX512(float const * p, double)
+{
+    return _mm512_maskz_cvtps_pd((__mmask8)0xFF, _mm256_loadu_ps(p));
+}
+VIGRA_TARGET_AVX512 inline __m512d simdLoadAVX512(UInt8 const * p, double)
+{
+    return _mm512_maskz_cvtepi32_pd((__mmask8)0xFF, _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)p)));
+}
+
+    // Each kernel processes two vectors of output elements at a time to hide the 
+    // latency of the additions, then single vectors, and finally scalars.
+#define VIGRA_SIMD_CONVOLVE_INTERIOR(NAME, TARGET, S, VECTOR, LANES, SETZERO, SET1, ADD, MUL, STOREU, LOAD) \
+template <class T> \
+TARGET void NAME(T const * src, S * dest, int n, S const * kernel, int kw) \
+{ \
+    VIGRA_SIMD_NO_FP_CONTRACT \
+    int x = 0; \
+    for(; x + 2*LANES <= n; x += 2*LANES) \
+    { \
+        VECTOR s0 = SETZERO(), s1 = SETZERO(); \
+        T const * p = src + x; \
+        for(int k = 0; k < kw; ++k, ++p) \
+        { \
+            VECTOR kv = SET1(kernel[k]); \
+            s0 = ADD(s0, MUL(kv, LOAD(p, S()))); \
+            s1 = ADD(s1, MUL(kv, LOAD(p + LANES, S()))); \
+        } \
+        STOREU(dest + x, s0); \
+        STOREU(dest + x + LANES, s1); \
+    } \
+    for(; x + LANES <= n; x += LANES) \
+    { \
+        VECTOR s0 = SETZERO(); \
+        T const * p = src + x; \
+        for(int k = 0; k < kw; ++k, ++p) \
+            s0 = ADD(s0, MUL(SET1(kernel[k]), LOAD(p, S()))); \
+        STOREU(dest + x, s0); \
+    } \
+    for(; x < n; ++x) \
+    { \
+        S sum = S(); \
+        T const * p = src + x; \
+        for(int k = 0; k < kw; ++k, ++p) \
+            sum += kernel[k] * *p; \
+        dest[x] = sum; \
+    } \
+}
+
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorSSE2, VIGRA_TARGET_SSE2, float, __m128, 4,
+                             _mm_setzero_ps, _mm_set1_ps, _mm_add_ps, _mm_mul_ps, _mm_storeu_ps, simdLoadSSE2)
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorSSE2, VIGRA_TARGET_SSE2, double, __m128d, 2,
+                             _mm_setzero_pd, _mm_set1_pd, _mm_add_pd, _mm_mul_pd, _mm_storeu_pd, simdLoadSSE2)
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorAVX2, VIGRA_TARGET_AVX2, float, __m256, 8,
+                             _mm256_setzero_ps, _mm256_set1_ps, _mm256_add_ps, _mm256_mul_ps, _mm256_storeu_ps, simdLoadAVX2)
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorAVX2, VIGRA_TARGET_AVX2, double, __m256d, 4,
+                             _mm256_setzero_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_mul_pd, _mm256_storeu_pd, simdLoadAVX2)
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorAVX512, VIGRA_TARGET_AVX512, float, __m512, 16,
+                             _mm512_setzero_ps, _mm512_set1_ps, _mm512_add_ps, _mm512_mul_ps, _mm512_storeu_ps, simdLoadAVX512)
+VIGRA_SIMD_CONVOLVE_INTERIOR(convolveInteriorAVX512, VIGRA_TARGET_AVX512, double, __m512d, 8,
+                             _mm512_setzero_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_mul_pd, _mm512_storeu_pd, simdLoadAVX512)
+
+#undef VIGRA_SIMD_CONVOLVE_INTERIOR
+
+#endif // VIGRA_HAS_SIMD_DISPATCH
+
+    // Returns false if no SIMD instruction set is available (the caller must 
+    // then use the scalar code).
+template <class T, class S>
+inline bool 
+convolveInteriorSimd(T const * src, S * dest, int n, S const * kernel, int kw)
+{
+#ifdef VIGRA_HAS_SIMD_DISPATCH
+    switch(simdInstructionSet())
+    {
+      case SIMD_AVX512:
+        convolveInteriorAVX512(src, dest, n, kernel, kw);
+        return true;
+      case SIMD_AVX2:
+        convolveInteriorAVX2(src, dest, n, kernel, kw);
+        return true;
+      case SIMD_SSE2:
+        convolveInteriorSSE2(src, dest, n, kernel, kw);
+        return true;
+      default:
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+    // Determine whether an iterator/accessor pair refers to contiguous memory
+    // of a type supported by the vectorized code.
+template <class T>
+struct SimdConvolutionSourceType
+{
+    typedef VigraFalseType isSupported;
+};
+
+template <>
+struct SimdConvolutionSourceType<float>
+{
+    typedef VigraTrueType isSupported;
+    typedef float type;
+};
+
+template <>
+struct SimdConvolutionSourceType<double>
+{
+    typedef VigraTrueType isSupported;
+    typedef double type;
+};
+
+template <>
+struct SimdConvolutionSourceType<UInt8>
+{
+    typedef VigraTrueType isSupported;
+    typedef UInt8 type;
+};
+
+template <class Iterator, class Accessor>
+struct SimdConvolutionSource
+{
+    typedef VigraFalseType isSupported;
+};
+
+#define VIGRA_SIMD_CONVOLUTION_SOURCE(ITERATOR, ACCESSOR) \
+template <class T> \
+struct SimdConvolutionSource<ITERATOR, ACCESSOR<T> > \
+: public SimdConvolutionSourceType<T> \
+{};
+
+VIGRA_SIMD_CONVOLUTION_SOURCE(T *, StandardValueAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T *, StandardConstValueAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T *, StandardAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T *, StandardConstAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T const *, StandardValueAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T const *, StandardConstValueAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T const *, StandardAccessor)
+VIGRA_SIMD_CONVOLUTION_SOURCE(T const *, StandardConstAccessor)
+
+#undef VIGRA_SIMD_CONVOLUTION_SOURCE
+
+    // The sum type must be float or double, and the kernel's value type
+    // must convert exactly to the sum type.
+template <class KernelValue, class SumType>
+struct SimdConvolutionSumType
+{
+    typedef VigraFalseType isSupported;
+};
+
+template <>
+struct SimdConvolutionSumType<float, float>
+{
+    typedef VigraTrueType isSupported;
+};
+
+template <>
+struct SimdConvolutionSumType<float, double>
+{
+    typedef VigraTrueType isSupported;
+};
+
+template <>
+struct SimdConvolutionSumType<double, double>
+{
+    typedef VigraTrueType isSupported;
+};
+
+} // namespace detail
+
+} // namespace vigra
+
+#endif // VIGRA_SIMD_CONVOLUTION_HXX
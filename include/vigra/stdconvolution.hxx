@@ -43,6 +43,8 @@
 #include "separableconvolution.hxx"
 #include "utilities.hxx"
 #include "sized_int.hxx"
+#include "array_vector.hxx"
+#include "singular_value_decomposition.hxx"
 
 namespace vigra {
 
@@ -1315,8 +1317,93 @@ public:
         border_treatment_ = new_mode;
     }
 
+        /** Approximate the kernel by a sum of separable kernels.
+
+            The kernel matrix is decomposed by \ref singularValueDecomposition(), 
+            and the terms belonging to the largest singular values are returned
+            as pairs of 1D kernels, such that
+            
+            \code
+            kernel(x, y) ~ sum_k xkernels[k][x] * ykernels[k][y]
+            \endcode
+            
+            Terms are added until the relative approximation error (i.e. the Frobenius norm 
+            of the difference between the kernel and its approximation, divided by the 
+            Frobenius norm of the kernel) drops to <tt>tolerance</tt>, or the number of 
+            terms reaches <tt>maxRank</tt>. The function returns the final 
+            relative error. The 1D kernels inherit the kernel's border treatment.
+            
+            Many non-separable kernels (e.g. rotated anisotropic Gaussians) are well 
+            approximated by 2 or 3 terms, so that convolution with the 
+            approximation costs <tt>2*rank*K</tt> instead of <tt>K*K</tt> operations 
+            per pixel for a KxK kernel. See \ref convolveImage() for a function 
+            that uses the approximation automatically.
+
+            <b> Usage:</b>
+
+            \code
+            vigra::Kernel2D<double> kernel;
+            ...
+            ArrayVector<Kernel1D<double> > kx, ky;
+            double error = kernel.separableApproximation(3, 1e-4, kx, ky);
+            \endcode
+        */
+    double separableApproximation(unsigned int maxRank, double tolerance,
+                                  ArrayVector<Kernel1D<value_type> > & xkernels,
+                                  ArrayVector<Kernel1D<value_type> > & ykernels) const
+    {
+        int w = width(), h = height();
+        bool transposed = w > h;  // SVD requires rows >= columns
+        int rows = transposed ? w : h,
+            cols = transposed ? h : w;
+        
+        linalg::Matrix<double> a(rows, cols), u(rows, cols), sv(cols, 1), v(cols, cols);
+        for(int y=0; y<h; ++y)
+            for(int x=0; x<w; ++x)
+                if(transposed)
+                    a(x, y) = kernel_(x, y);
+                else
+                    a(y, x) = kernel_(x, y);
+        
+        linalg::singularValueDecomposition(a, u, sv, v);
+        
+        // remaining[k] is the squared error when k terms are used
+        ArrayVector<double> remaining(cols+1, 0.0);
+        for(int k=cols-1; k>=0; --k)
+            remaining[k] = remaining[k+1] + sq(sv(k, 0));
+        double total = remaining[0];
+        
+        xkernels.clear();
+        ykernels.clear();
+        int rank = 0;
+        for(; rank<cols && rank<(int)maxRank; ++rank)
+        {
+            if(total == 0.0 || std::sqrt(remaining[rank] / total) <= tolerance)
+                break;
+            double scale = std::sqrt(sv(rank, 0));
+            Kernel1D<value_type> kx, ky;
+            initSeparableTerm(kx, left_.x, right_.x, transposed ? u : v, rank, scale);
+            initSeparableTerm(ky, left_.y, right_.y, transposed ? v : u, rank, scale);
+            xkernels.push_back(kx);
+            ykernels.push_back(ky);
+        }
+        return total > 0.0
+                  ? std::sqrt(remaining[rank] / total)
+                  : 0.0;
+    }
 
 private:
+    void initSeparableTerm(Kernel1D<value_type> & k, int left, int right,
+                           linalg::Matrix<double> const & m, int column, double scale) const
+    {
+        // use the init list proxy, so that the norm is computed as well
+        typename Kernel1D<value_type>::InitProxy init = 
+            (k.initExplicitly(left, right) = NumericTraits<value_type>::fromRealPromote(scale*m(0, column)));
+        for(int i=1; i<=right-left; ++i)
+            init, NumericTraits<value_type>::fromRealPromote(scale*m(i, column));
+        k.setBorderTreatment(border_treatment_);
+    }
+
     BasicImage<value_type> kernel_;
     Point2D left_, right_;
     value_type norm_;
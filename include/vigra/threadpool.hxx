@@ -0,0 +1,616 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2014 by Ullrich Koethe                       */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_THREADPOOL_HXX
+#define VIGRA_THREADPOOL_HXX
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "config.hxx"
+#include "error.hxx"
+
+#ifdef VIGRA_HAS_STD_THREAD
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <map>
+#endif
+
+namespace vigra {
+
+/** \addtogroup ParallelProcessing Parallel Processing
+
+    Thread pool with work stealing and parallel loops over index and iterator ranges.
+    The number of threads used by default can be set globally by
+    \ref setDefaultConcurrency().
+
+    These facilities require a compiler with C++11 thread support
+    (the macro <tt>VIGRA_HAS_STD_THREAD</tt> is then defined in vigra/config.hxx).
+    Otherwise, or when <tt>VIGRA_NO_THREADS</tt> is defined,
+    \ref parallel_foreach() silently falls back to sequential execution.
+    Programs using threads must usually be linked with the platform's
+    thread library (e.g. <tt>-pthread</tt> on Linux).
+*/
+//@{
+
+    /** \brief Number of threads that can run concurrently on this machine.
+
+        Returns 1 if this cannot be determined or threads are not supported.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+inline int hardwareConcurrency()
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0
+               ? n
+               : 1;
+#else
+    return 1;
+#endif
+}
+
+namespace detail {
+
+inline int & defaultConcurrencySetting()
+{
+    static int n = 0;
+    return n;
+}
+
+} // namespace detail
+
+    /** \brief Number of threads used when a function is asked to choose automatically.
+
+        All functions and classes that accept a thread count interpret
+        <tt>n <= 0</tt> as "use the default", which is the value returned here.
+        It equals \ref hardwareConcurrency() unless it was changed by
+        \ref setDefaultConcurrency().
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+inline int defaultConcurrency()
+{
+    int n = detail::defaultConcurrencySetting();
+    return n > 0
+               ? n
+               : hardwareConcurrency();
+}
+
+    /** \brief Change the number of threads returned by \ref defaultConcurrency().
+
+        If <tt>n <= 0</tt>, the default is reset to \ref hardwareConcurrency().
+        This is useful to restrict a whole program to fewer threads (e.g. when it
+        shares the machine with other jobs), or to run it sequentially with
+        <tt>setDefaultConcurrency(1)</tt>. The previous setting is returned.
+        This function is not thread-safe and should be called before any
+        parallel function is executed.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+inline int setDefaultConcurrency(int n)
+{
+    int old = defaultConcurrency();
+    detail::defaultConcurrencySetting() = n > 0
+                                              ? n
+                                              : 0;
+    return old;
+}
+
+    /** \brief Options for parallel algorithms.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+class ParallelOptions
+{
+  public:
+
+    int n_threads;
+
+    ParallelOptions()
+    : n_threads(0)
+    {}
+
+        /** Number of threads.
+
+            If <tt>n <= 0</tt>, \ref defaultConcurrency() threads are used.
+
+            Default: 0
+        */
+    ParallelOptions & numThreads(int n)
+    {
+        n_threads = n;
+        return *this;
+    }
+
+        /** The number of threads that will actually be used.
+        */
+    int actualNumThreads() const
+    {
+        return n_threads > 0
+                   ? n_threads
+                   : defaultConcurrency();
+    }
+};
+
+#ifdef VIGRA_HAS_STD_THREAD
+
+    /** \brief Pool of worker threads executing tasks with work stealing.
+
+        Tasks are arbitrary functors that are called with the index of the
+        executing thread (in the range <tt>[0, numThreads())</tt>) as their only
+        argument, so that a task can select per-thread scratch memory.
+        \ref enqueue() returns a <tt>std::future</tt> whose <tt>get()</tt> rethrows
+        any exception raised by the task.
+
+        Every worker owns a task queue, and new tasks are distributed over these
+        queues in round-robin order. A worker executes the tasks of its own queue
+        in the order they were enqueued. When its queue is empty, it steals
+        the most recently enqueued task from another worker's queue. Thus, all
+        workers stay busy as long as there is work, even if the tasks have very
+        different running times, while workers rarely compete for the same queue.
+        Tasks must not wait for other tasks of the same pool, since this may
+        deadlock when all workers are waiting.
+
+        \code
+        ThreadPool pool(4);
+        std::vector<std::future<void> > results;
+        for(int k=0; k<100; ++k)
+            results.push_back(pool.enqueue(MyTask(k)));  // calls MyTask(k)(threadId)
+        for(int k=0; k<100; ++k)
+            results[k].get();
+        \endcode
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+class ThreadPool
+{
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void(int)> > tasks;
+    };
+
+  public:
+
+        /** Create a pool with \a n worker threads. If <tt>n <= 0</tt>,
+            \ref defaultConcurrency() threads are started.
+        */
+    explicit ThreadPool(int n = 0)
+    : next_queue_(0),
+      pending_(0),
+      busy_(0),
+      stop_(false)
+    {
+        if(n <= 0)
+            n = defaultConcurrency();
+        for(int k=0; k<n; ++k)
+            queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+        for(int k=0; k<n; ++k)
+            workers_.push_back(std::thread(&ThreadPool::work, this, k));
+    }
+
+        /** Finish all pending tasks and join the worker threads.
+        */
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        worker_condition_.notify_all();
+        for(std::size_t k=0; k<workers_.size(); ++k)
+            workers_[k].join();
+    }
+
+        /** Add a task to the pool. The task will be called as <tt>f(threadId)</tt>.
+        */
+    template <class F>
+    std::future<void> enqueue(F f)
+    {
+        std::shared_ptr<std::packaged_task<void(int)> >
+            task(new std::packaged_task<void(int)>(f));
+        std::future<void> res = task->get_future();
+        std::size_t q;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            vigra_precondition(!stop_,
+                "ThreadPool::enqueue(): pool is being destroyed.");
+            q = next_queue_;
+            next_queue_ = (next_queue_ + 1) % queues_.size();
+        }
+        {
+            std::unique_lock<std::mutex> lock(queues_[q]->mutex);
+            queues_[q]->tasks.push_back([task](int id) { (*task)(id); });
+        }
+        {
+            // count the task only after it has been pushed, so that a
+            // worker who reserved it is guaranteed to find it
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++pending_;
+        }
+        worker_condition_.notify_one();
+        return res;
+    }
+
+        /** Block until all tasks are finished and all workers are idle.
+        */
+    void waitFinished()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        finish_condition_.wait(lock, [this]() { return pending_ == 0 && busy_ == 0; });
+    }
+
+        /** Number of worker threads.
+        */
+    std::size_t numThreads() const
+    {
+        return workers_.size();
+    }
+
+        /** True if the calling thread is one of the pool's workers.
+        */
+    bool isWorkerThread() const
+    {
+        std::thread::id id = std::this_thread::get_id();
+        for(std::size_t k=0; k<workers_.size(); ++k)
+            if(workers_[k].get_id() == id)
+                return true;
+        return false;
+    }
+
+  private:
+    ThreadPool(ThreadPool const &);             // not copyable
+    ThreadPool & operator=(ThreadPool const &); // not assignable
+
+        // Take a task, preferably the oldest one from the worker's own queue,
+        // otherwise the newest one from another queue. The caller has reserved
+        // a task by decrementing pending_, so some queue must contain one.
+    std::function<void(int)> take(int threadId)
+    {
+        std::size_t n = queues_.size();
+        for(;;)
+        {
+            for(std::size_t k=0; k<n; ++k)
+            {
+                WorkQueue & queue = *queues_[(threadId + k) % n];
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                if(queue.tasks.empty())
+                    continue;
+                std::function<void(int)> task;
+                if(k == 0)
+                {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                else
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                }
+                return task;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void work(int threadId)
+    {
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                worker_condition_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+                if(pending_ == 0)
+                    return; // stop_ is set
+                --pending_;
+                ++busy_;
+            }
+            take(threadId)(threadId);
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                --busy_;
+            }
+            finish_condition_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkQueue> > queues_;
+    std::mutex mutex_;
+    std::condition_variable worker_condition_, finish_condition_;
+    std::size_t next_queue_, pending_, busy_;
+    bool stop_;
+};
+
+namespace detail {
+
+    // The pools behind sharedThreadPool(), one per thread count. They are 
+    // allocated on the heap and never destroyed, so that parallel functions 
+    // may still be called during static destruction.
+class SharedThreadPools
+{
+  public:
+    ThreadPool & get(int n)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ThreadPool * & pool = pools_[n];
+        if(pool == 0)
+            pool = new ThreadPool(n);
+        return *pool;
+    }
+    
+    bool isWorkerThread()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::map<int, ThreadPool *>::const_iterator i = pools_.begin(); i != pools_.end(); ++i)
+            if(i->second->isWorkerThread())
+                return true;
+        return false;
+    }
+    
+  private:
+    std::mutex mutex_;
+    std::map<int, ThreadPool *> pools_;
+};
+
+inline SharedThreadPools & sharedThreadPools()
+{
+    static SharedThreadPools * pools = new SharedThreadPools();
+    return *pools;
+}
+
+} // namespace detail
+
+    /** \brief Process-wide thread pool with \a n threads.
+
+        If <tt>n <= 0</tt>, a pool with \ref defaultConcurrency() threads is returned.
+        The pool is created on first use and reused by all later calls with the 
+        same number of threads, so that repeated parallel calls don't pay for 
+        starting and joining threads. It is used by the variants of 
+        \ref parallel_foreach() that take a thread count. Several threads may 
+        submit work to a shared pool concurrently. The pools are never destroyed.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+inline ThreadPool & sharedThreadPool(int n = 0)
+{
+    return detail::sharedThreadPools().get(n > 0 
+                                               ? n 
+                                               : defaultConcurrency());
+}
+
+namespace detail {
+
+    // Split [0, count) into contiguous ranges and call f(threadId, begin, end)
+    // for each range in the threads of 'pool'.
+template <class F>
+void parallelForeachRanges(ThreadPool & pool, std::ptrdiff_t count, F const & f)
+{
+    if(count <= 0)
+        return;
+    std::ptrdiff_t chunks = std::min<std::ptrdiff_t>(count, 4*(std::ptrdiff_t)pool.numThreads());
+    std::vector<std::future<void> > results;
+    results.reserve(chunks);
+    for(std::ptrdiff_t c=0; c<chunks; ++c)
+    {
+        std::ptrdiff_t begin = c*count / chunks,
+                       end   = (c+1)*count / chunks;
+        results.push_back(pool.enqueue(
+            [&f, begin, end](int threadId)
+            {
+                f(threadId, begin, end);
+            }));
+    }
+    // make sure that no task refers to 'f' anymore before an exception propagates
+    for(std::size_t k=0; k<results.size(); ++k)
+        results[k].wait();
+    for(std::size_t k=0; k<results.size(); ++k)
+        results[k].get();
+}
+
+} // namespace detail
+
+    /** \brief Call <tt>f(threadId, i)</tt> for every <tt>i</tt> in <tt>[0, count)</tt>,
+        using the threads of \a pool.
+
+        The index range is split into contiguous ranges of roughly equal size,
+        a few per thread, which are balanced between the threads by work stealing.
+        Since \a f is called concurrently, its call operator must be thread-safe.
+        The function returns when all calls have finished. If any call throws,
+        the exception is rethrown in the calling thread. It must not be called
+        from a task running in the same \a pool.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+template <class F>
+void parallel_foreach(ThreadPool & pool, std::ptrdiff_t count, F const & f)
+{
+    detail::parallelForeachRanges(pool, count,
+        [&f](int threadId, std::ptrdiff_t begin, std::ptrdiff_t end)
+        {
+            for(std::ptrdiff_t i=begin; i<end; ++i)
+                f(threadId, i);
+        });
+}
+
+    /** \brief Call <tt>f(threadId, *iter)</tt> for every iterator in <tt>[begin, end)</tt>,
+        using the threads of \a pool.
+
+        \a Iterator must be a random access iterator, for example
+        \ref vigra::StridedScanOrderIterator (as returned by
+        <tt>MultiArrayView::begin()</tt>) or \ref vigra::CoupledScanOrderIterator.
+        Each thread receives contiguous subranges and advances the iterator
+        incrementally within them. Otherwise, the semantics are the same as for
+        the index range version.
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+template <class Iterator, class F>
+void parallel_foreach(ThreadPool & pool, Iterator begin, Iterator end, F const & f)
+{
+    detail::parallelForeachRanges(pool, end - begin,
+        [&f, &begin](int threadId, std::ptrdiff_t rangeBegin, std::ptrdiff_t rangeEnd)
+        {
+            Iterator iter = begin + rangeBegin;
+            for(std::ptrdiff_t i=rangeBegin; i<rangeEnd; ++i, ++iter)
+                f(threadId, *iter);
+        });
+}
+
+#endif // VIGRA_HAS_STD_THREAD
+
+    /** \brief Call <tt>f(threadId, i)</tt> for every <tt>i</tt> in <tt>[0, count)</tt>,
+        using up to \a nThreads threads.
+
+        If <tt>nThreads <= 0</tt>, \ref defaultConcurrency() threads are used.
+        The thread index passed to \a f is in the range <tt>[0, nThreads)</tt>
+        and can be used to select per-thread scratch memory. The calls are 
+        executed by \ref sharedThreadPool()<tt>(nThreads)</tt>. When
+        <tt>nThreads == 1</tt>, threads are not supported, or the function is 
+        called from within another parallel_foreach() running on a shared pool,
+        all calls are executed sequentially in the calling thread with 
+        <tt>threadId == 0</tt>. Thus, nested parallel loops neither deadlock
+        nor oversubscribe the machine.
+
+        Which thread handles a particular index is unpredictable. To get the
+        same results regardless of the number of threads, the effect of
+        <tt>f(threadId, i)</tt> must only depend on <tt>i</tt> (per-thread scratch
+        memory is fine). In particular, random numbers should be drawn from
+        a generator belonging to the index, not to the thread
+        (see \ref randomStream()).
+
+        \code
+        struct SquareRoot
+        {
+            MultiArrayView<1, double> & a;
+
+            void operator()(int threadId, std::ptrdiff_t i) const
+            {
+                a(i) = std::sqrt(a(i));
+            }
+        };
+
+        MultiArray<1, double> a(Shape1(1000000));
+        ...
+        SquareRoot f = { a };
+        parallel_foreach(4, a.size(), f);
+        \endcode
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+template <class F>
+void parallel_foreach(int nThreads, std::ptrdiff_t count, F const & f)
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+    if(nThreads > 1 && count > 1 && !detail::sharedThreadPools().isWorkerThread())
+    {
+        parallel_foreach(sharedThreadPool(nThreads), count, f);
+        return;
+    }
+#else
+    (void)nThreads;
+#endif
+    for(std::ptrdiff_t i=0; i<count; ++i)
+        f(0, i);
+}
+
+    /** \brief Call <tt>f(threadId, *iter)</tt> for every iterator in <tt>[begin, end)</tt>,
+        using up to \a nThreads threads.
+
+        \a Iterator must be a random access iterator, for example a
+        \ref vigra::StridedScanOrderIterator or \ref vigra::CoupledScanOrderIterator.
+        Otherwise, the semantics are the same as for the index range version.
+
+        \code
+        MultiArray<3, float> a(Shape3(200, 200, 200));
+        MultiArray<3, UInt8> mask(a.shape());
+        ...
+        // set masked elements to zero
+        typedef CoupledIteratorType<3, float, UInt8>::type Iterator;
+        Iterator begin = createCoupledIterator(a, mask),
+                 end   = begin.getEndIterator();
+        parallel_foreach(0, begin, end,
+            [](int threadId, Iterator::reference h)
+            {
+                if(get<2>(h) != 0)
+                    get<1>(h) = 0.0f;
+            });
+        \endcode
+
+        <b>\#include</b> \<vigra/threadpool.hxx\><br>
+        Namespace: vigra
+    */
+template <class Iterator, class F>
+void parallel_foreach(int nThreads, Iterator begin, Iterator end, F const & f)
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    if(nThreads <= 0)
+        nThreads = defaultConcurrency();
+    std::ptrdiff_t count = end - begin;
+    if(nThreads > 1 && count > 1 && !detail::sharedThreadPools().isWorkerThread())
+    {
+        parallel_foreach(sharedThreadPool(nThreads), begin, end, f);
+        return;
+    }
+#else
+    (void)nThreads;
+#endif
+    for(; begin != end; ++begin)
+        f(0, *begin);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_THREADPOOL_HXX
@@ -37,10 +37,16 @@
 #ifndef VIGRA_UNION_FIND_HXX
 #define VIGRA_UNION_FIND_HXX
 
+#include <vector>
+#include <algorithm>
 #include "config.hxx"
 #include "error.hxx"
 #include "array_vector.hxx"
 
+#ifdef VIGRA_HAS_STD_THREAD
+#include <atomic>
+#endif
+
 namespace vigra {
 
 namespace detail {
@@ -145,6 +151,107 @@ class UnionFindArray
     }
 };
 
+    // Union-find array that may be modified by several threads simultaneously.
+    // Like UnionFindArray, the root of every tree is its smallest label: makeUnion()
+    // links the larger root to the smaller one by an atomic compare-and-swap, and
+    // starts over if another thread has modified that root in the meantime. find()
+    // shortens the paths it follows (path halving) without locking, since this only 
+    // replaces a parent by one of its ancestors. makeContiguous() and operator[]
+    // must only be called when all threads have finished. Without thread support,
+    // plain integers are used.
+template <class T>
+class ConcurrentUnionFindArray
+{
+#ifdef VIGRA_HAS_STD_THREAD
+    typedef std::atomic<T> Entry;
+#else
+    typedef T Entry;
+#endif
+    typedef typename std::vector<Entry>::difference_type IndexType;
+    mutable std::vector<Entry> labels_;
+    
+    static T load(Entry const & e)
+    {
+        return e;
+    }
+    
+    static bool compareExchange(Entry & e, T expected, T desired)
+    {
+#ifdef VIGRA_HAS_STD_THREAD
+        return e.compare_exchange_strong(expected, desired);
+#else
+        if(e != expected)
+            return false;
+        e = desired;
+        return true;
+#endif
+    }
+    
+  public:
+        // create the labels 0, ..., size-1, each of which is a separate tree
+    ConcurrentUnionFindArray(T size = 1)
+    : labels_((IndexType)size)
+    {
+        for(T k=0; k < size; ++k)
+            labels_[(IndexType)k] = k;
+    }
+    
+    T size() const
+    {
+        return (T)labels_.size();
+    }
+    
+    T find(T label) const
+    {
+        for(;;)
+        {
+            T parent = load(labels_[(IndexType)label]);
+            if(parent == label)
+                return label;
+            T grandparent = load(labels_[(IndexType)parent]);
+            if(grandparent != parent)
+                compareExchange(labels_[(IndexType)label], parent, grandparent);
+            label = grandparent;
+        }
+    }
+    
+    T makeUnion(T l1, T l2)
+    {
+        for(;;)
+        {
+            l1 = find(l1);
+            l2 = find(l2);
+            if(l1 == l2)
+                return l1;
+            if(l2 < l1)
+                std::swap(l1, l2);
+            if(compareExchange(labels_[(IndexType)l2], l2, l1))
+                return l1;
+        }
+    }
+    
+        // replace each label by the index of its root in the sequence of roots
+        // (which starts with 0) and return the largest index
+    T makeContiguous()
+    {
+        T count = 0; 
+        for(IndexType i=0; i<(IndexType)labels_.size(); ++i)
+        {
+            T parent = load(labels_[i]);
+            if(parent == (T)i)
+                labels_[i] = count++;
+            else
+                labels_[i] = load(labels_[(IndexType)parent]); // parent < i is already final
+        }
+        return count-1;   
+    }
+    
+    T operator[](T label) const
+    {
+        return load(labels_[(IndexType)label]);
+    }
+};
+
 } // namespace detail
 
 } // namespace vigra
@@ -738,7 +738,8 @@ class WatershedOptions
     
         /** \brief Keep one-pixel wide contour between regions.
         
-            Note that this option is unsupported by the turbo algorithm.
+            In combination with the turbo algorithm, the bucket queue variant 
+            of \ref seededRegionGrowing() is used.
 
             Default: false
         */
@@ -1008,9 +1009,9 @@ class BiasedWatershedStatistics
          is faster because it orders pixels by means of a \ref BucketQueue (therefore,
          the boundary indicator must contain integers in the range 
          <tt>[0, ..., bucket_count-1]</tt>, where <tt>bucket_count</tt> is specified in
-         the options object), it only supports complete growing (no contour between regions
-         is possible), and it handles plateaus in a simplistic way. It also saves some
-         memory because it allocates less temporary storage.
+         the options object), and it handles plateaus in a simplistic way. It also saves some
+         memory because it allocates less temporary storage. When a contour between regions 
+         is requested, the bucket queue variant of \ref seededRegionGrowing() is used instead.
     <li> Whether one region (label) is to be preferred or discouraged by biasing its cost 
          with a given factor (smaller than 1 for preference, larger than 1 for discouragement).
     </ul>
@@ -1185,6 +1186,17 @@ watershedsRegionGrowing(SrcIterator upperlefts, SrcIterator lowerrights, SrcAcce
                                 destIter(upperleftd, da), 
                                 regionstats, options.terminate, neighborhood, options.max_cost);
         }
+        else if((options.terminate & KeepContours) != 0)
+        {
+            // fastSeededRegionGrowing() can't keep contours, use the bucket queue 
+            // variant of seededRegionGrowing() instead
+            max_region_label = 
+            seededRegionGrowing(srcIterRange(upperlefts, lowerrights, sa),
+                                srcIter(upperleftd, da),
+                                destIter(upperleftd, da), 
+                                regionstats, options.terminate, neighborhood, 
+                                options.max_cost, options.bucket_count);
+        }
         else
         {
             max_region_label = 
@@ -1208,6 +1220,17 @@ watershedsRegionGrowing(SrcIterator upperlefts, SrcIterator lowerrights, SrcAcce
                                 destIter(upperleftd, da), 
                                 regionstats, options.terminate, neighborhood, options.max_cost);
         }
+        else if((options.terminate & KeepContours) != 0)
+        {
+            // fastSeededRegionGrowing() can't keep contours, use the bucket queue 
+            // variant of seededRegionGrowing() instead
+            max_region_label = 
+            seededRegionGrowing(srcIterRange(upperlefts, lowerrights, sa),
+                                srcIter(upperleftd, da),
+                                destIter(upperleftd, da), 
+                                regionstats, options.terminate, neighborhood, 
+                                options.max_cost, options.bucket_count);
+        }
         else
         {
             max_region_label = 
@@ -452,6 +452,10 @@ generateWatershedSeeds(triple<SrcIterator, SrcIterator, SrcAccessor> src,
     are compared. The voxel type of the input volume must be <tt>LessThanComparable</tt>.
     The function uses accessors. 
     
+    For volumes that don't fit into memory (e.g. \ref vigra::ChunkedArrayHDF5), 
+    a blockwise and parallel version with identical results is provided in 
+    \<vigra/blockwise_watersheds.hxx\>.
+    
     ...probably soon in VIGRA:
     Note that VIGRA provides an alternative implementation of the watershed transform via
     \ref seededRegionGrowing3D(). It is slower, but handles plateaus better 
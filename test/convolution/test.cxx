@@ -1415,6 +1415,152 @@ struct ConvolutionTest
         }
     }
     
+    void separableApproximationTest()
+    {
+        // separable kernels have rank 1
+        vigra::Kernel1D<double> gauss1, grad1;
+        gauss1.initGaussian(1.5);
+        grad1.initGaussianDerivative(1.0, 1);
+        vigra::Kernel2D<double> sep;
+        sep.initSeparable(grad1, gauss1);
+
+        vigra::ArrayVector<vigra::Kernel1D<double> > kx, ky;
+        double error = sep.separableApproximation(3, 1e-10, kx, ky);
+        should(error < 1e-10);
+        shouldEqual(kx.size(), 1u);
+        shouldEqual(ky.size(), 1u);
+        shouldEqual(kx[0].left(), grad1.left());
+        shouldEqual(kx[0].right(), grad1.right());
+        shouldEqual(ky[0].left(), gauss1.left());
+        shouldEqual(ky[0].right(), gauss1.right());
+        for(int y=sep.upperLeft().y; y<=sep.lowerRight().y; ++y)
+            for(int x=sep.upperLeft().x; x<=sep.lowerRight().x; ++x)
+                should(VIGRA_CSTD::fabs(kx[0][x]*ky[0][y] - sep(x, y)) < 1e-12);
+
+        // rotated anisotropic Gaussian (non-separable)
+        vigra::Kernel2D<double> aniso;
+        aniso.initExplicitly(Diff2D(-6,-4), Diff2D(6,4));
+        double c = VIGRA_CSTD::cos(M_PI / 6.0), s = VIGRA_CSTD::sin(M_PI / 6.0);
+        for(int y=-4; y<=4; ++y)
+        {
+            for(int x=-6; x<=6; ++x)
+            {
+                double u = c*x + s*y, v = -s*x + c*y;
+                aniso(x, y) = VIGRA_CSTD::exp(-u*u / 8.0 - v*v / 2.0);
+            }
+        }
+        aniso.normalize();
+        
+        double error1 = aniso.separableApproximation(1, 0.0, kx, ky);
+        shouldEqual(kx.size(), 1u);
+        double error3 = aniso.separableApproximation(3, 0.0, kx, ky);
+        shouldEqual(kx.size(), 3u);
+        should(error3 < error1);
+        should(error3 < 0.03);
+        
+        // the approximation stops as soon as the tolerance is reached
+        error = aniso.separableApproximation(9, error3, kx, ky);
+        should(kx.size() <= 3u);
+        should(error <= error3);
+        
+        // check the error of the approximation
+        double diff = 0.0, norm = 0.0;
+        for(int y=-4; y<=4; ++y)
+        {
+            for(int x=-6; x<=6; ++x)
+            {
+                double approx = 0.0;
+                for(unsigned int k=0; k<kx.size(); ++k)
+                    approx += kx[k][x]*ky[k][y];
+                diff += sq(approx - aniso(x, y));
+                norm += sq(aniso(x, y));
+            }
+        }
+        shouldEqualTolerance(VIGRA_CSTD::sqrt(diff / norm), error, 1e-6);
+        
+        // full rank reproduces the kernel
+        error = aniso.separableApproximation(9, 0.0, kx, ky);
+        should(error < 1e-12);
+    }
+    
+    void separableApproximationConvolutionTest()
+    {
+        vigra::Kernel2D<double> aniso;
+        aniso.initExplicitly(Diff2D(-6,-4), Diff2D(6,4));
+        double c = VIGRA_CSTD::cos(M_PI / 6.0), s = VIGRA_CSTD::sin(M_PI / 6.0);
+        for(int y=-4; y<=4; ++y)
+        {
+            for(int x=-6; x<=6; ++x)
+            {
+                double u = c*x + s*y, v = -s*x + c*y;
+                aniso(x, y) = VIGRA_CSTD::exp(-u*u / 8.0 - v*v / 2.0);
+            }
+        }
+        aniso.normalize();
+        
+        double norm = 0.0;
+        for(int y=-4; y<=4; ++y)
+            for(int x=-6; x<=6; ++x)
+                norm += sq(aniso(x, y));
+        double bound = 0.03 * VIGRA_CSTD::sqrt(norm * aniso.width() * aniso.height()) * 255.0;
+
+        vigra::BorderTreatmentMode modes[] = { vigra::BORDER_TREATMENT_AVOID, vigra::BORDER_TREATMENT_REFLECT,
+                                               vigra::BORDER_TREATMENT_REPEAT, vigra::BORDER_TREATMENT_WRAP,
+                                               vigra::BORDER_TREATMENT_CLIP };
+        for(int m=0; m<5; ++m)
+        {
+            aniso.setBorderTreatment(modes[m]);
+            Image ref(lenna.size(), -1.0), res(lenna.size(), -1.0), exact(lenna.size(), -1.0);
+            convolveImage(srcImageRange(lenna), destImage(ref), kernel2d(aniso));
+            
+            // approximation
+            convolveImage(srcImageRange(lenna), destImage(res), aniso, 0.03);
+            double maxDiff = 0.0;
+            for(int k=0; k<res.width()*res.height(); ++k)
+                maxDiff = std::max(maxDiff, VIGRA_CSTD::fabs(res.data()[k] - ref.data()[k]));
+            should(maxDiff <= bound);
+            if(modes[m] == vigra::BORDER_TREATMENT_CLIP)
+                should(maxDiff == 0.0);  // always convolved directly
+            else
+                should(maxDiff > 0.0);   // separable approximation was used
+            
+            // tolerance 0 requires full rank, so that direct convolution is used
+            convolveImage(srcImageRange(lenna), destImage(exact), aniso, 0.0);
+            shouldEqualSequence(exact.begin(), exact.end(), ref.begin());
+            
+            // full rank separable sum reproduces the kernel
+            convolveImage(srcImageRange(lenna), destImage(exact), aniso, 1e-12, 9);
+            if(modes[m] == vigra::BORDER_TREATMENT_CLIP)
+                shouldEqualSequence(exact.begin(), exact.end(), ref.begin());
+            else
+                shouldEqualSequenceTolerance(exact.begin(), exact.end(), ref.begin(), 1e-10);
+        }
+        
+        // a kernel of rank 2 is cheaper to apply as two separable terms, and the 
+        // result must agree with direct convolution up to rounding errors
+        vigra::Kernel2D<double> lowRank;
+        lowRank.initExplicitly(Diff2D(-7,-5), Diff2D(7,5));
+        for(int y=-5; y<=5; ++y)
+            for(int x=-7; x<=7; ++x)
+                lowRank(x, y) = VIGRA_CSTD::exp(-x*x / 8.0 - y*y / 2.0) + 
+                                0.5*x*y*VIGRA_CSTD::exp(-x*x / 4.5 - y*y / 4.5);
+        lowRank.normalize();
+        
+        vigra::ArrayVector<vigra::Kernel1D<double> > kx, ky;
+        should(lowRank.separableApproximation(3, 1e-10, kx, ky) < 1e-10);
+        shouldEqual(kx.size(), 2u);
+        should(2*(lowRank.width() + lowRank.height()) < lowRank.width()*lowRank.height());
+        
+        for(int m=0; m<4; ++m)
+        {
+            lowRank.setBorderTreatment(modes[m]);
+            Image ref(lenna.size(), -1.0), res(lenna.size(), -1.0);
+            convolveImage(srcImageRange(lenna), destImage(ref), kernel2d(lowRank));
+            convolveImage(srcImageRange(lenna), destImage(res), lowRank, 1e-10);
+            shouldEqualSequenceTolerance(res.begin(), res.end(), ref.begin(), 1e-8);
+        }
+    }
+    
     void recursiveFilterTestWithAvoid()
     {
         Image src_const(25, 25);
@@ -2069,8 +2215,93 @@ struct ConvolutionTest
         {
             shouldEqualTolerance((*i1), (*i2), 1e-7);
         }
+        
+        // the same with temporary images from an arena
+        vigra::ScratchArena arena;
+        for(int k=0; k<2; ++k)
+        {
+            Image res2(lenna.size());
+            arena.resetStatistics();
+            nonlinearDiffusion(srcImageRange(lenna), destImage(res2),
+                               vigra::DiffusivityFunctor<double>(4.0), 4.0, arena);
+            shouldEqualSequence(res2.begin(), res2.end(), res.begin());
+            shouldEqual(arena.bytesInUse(), 0u);
+            if(k > 0)
+                shouldEqual(arena.systemAllocations(), 0u);
+        }
+    }
+    
+    template <class T, class K>
+    void simdConvolveLineTest(int w = 101, double std_dev = 2.5)
+    {
+        typedef typename vigra::PromoteTraits<T, K>::Promote SumType;
+        typedef vigra::StandardConstValueAccessor<T> SrcAccessor;
+        typedef vigra::StandardValueAccessor<SumType> DestAccessor;
+        vigra::ArrayVector<T> src(w);
+        for(int k=0; k<w; ++k)
+            src[k] = (T)((k*37) % 251 + 0.3*(k % 7));
+            
+        vigra::BorderTreatmentMode modes[] = { vigra::BORDER_TREATMENT_AVOID, vigra::BORDER_TREATMENT_CLIP,
+                                               vigra::BORDER_TREATMENT_REPEAT, vigra::BORDER_TREATMENT_REFLECT, 
+                                               vigra::BORDER_TREATMENT_WRAP, vigra::BORDER_TREATMENT_ZEROPAD };
+        vigra::SimdInstructionSet levels[] = { vigra::SIMD_SSE2, vigra::SIMD_AVX2, vigra::SIMD_AVX512 };
+        
+        vigra::SimdInstructionSet old = vigra::simdInstructionSet();
+        for(int m=0; m<6; ++m)
+        {
+            for(int order=0; order<2; ++order)
+            {
+                vigra::Kernel1D<K> kernel;
+                kernel.initGaussianDerivative(std_dev, order);
+                kernel.setBorderTreatment(modes[m]);
+                
+                int ranges[][2] = { {0, 0}, {3, 50}, {20, 101}, {9, 11} };
+                for(int r=0; r<4; ++r)
+                {
+                    int start = ranges[r][0], stop = ranges[r][1];
+                    vigra::ArrayVector<SumType> ref(w, SumType(-1.0)), res(w, SumType(-1.0));
+                    
+                    vigra::setSimdInstructionSet(vigra::SIMD_NONE);
+                    convolveLine(vigra::make_triple(src.begin(), src.end(), SrcAccessor()),
+                                 std::make_pair(ref.begin(), DestAccessor()),
+                                 kernel1d(kernel), start, stop);
+                                 
+                    for(int l=0; l<3; ++l)
+                    {
+                        if(levels[l] > vigra::supportedSimdInstructionSet())
+                            break;
+                        vigra::setSimdInstructionSet(levels[l]);
+                        convolveLine(vigra::make_triple(src.begin(), src.end(), SrcAccessor()),
+                                     std::make_pair(res.begin(), DestAccessor()),
+                                     kernel1d(kernel), start, stop);
+                        shouldEqualSequence(res.begin(), res.end(), ref.begin());
+                    }
+                }
+            }
+        }
+        vigra::setSimdInstructionSet(old);
     }
     
+    void simdConvolutionTest()
+    {
+        simdConvolveLineTest<float, float>();
+        simdConvolveLineTest<float, double>();
+        simdConvolveLineTest<double, double>();
+        simdConvolveLineTest<double, float>();
+        simdConvolveLineTest<vigra::UInt8, float>();
+        simdConvolveLineTest<vigra::UInt8, double>();
+        // lines longer than the internal chunk size and kernels longer than the kernel buffer
+        simdConvolveLineTest<float, float>(1000, 10.0);
+        simdConvolveLineTest<double, double>(1000, 50.0);
+        
+        // the SIMD instruction set can only be restricted, not extended
+        vigra::SimdInstructionSet old = vigra::setSimdInstructionSet(vigra::SIMD_AVX512);
+        shouldEqual(vigra::simdInstructionSet(), vigra::supportedSimdInstructionSet());
+        vigra::setSimdInstructionSet(vigra::SIMD_NONE);
+        shouldEqual(vigra::simdInstructionSet(), vigra::SIMD_NONE);
+        vigra::setSimdInstructionSet(old);
+    }
+
     Image constimg, lenna, rampimg, sym_image, unsym_image;
     vigra::Kernel2D<double> sym_kernel, unsym_kernel, line_kernel;
     
@@ -2388,6 +2619,7 @@ struct ConvolutionTestSuite
         add( testCase( &ConvolutionTest::stdConvolutionTestFromWrapWithReflect));
         add( testCase( &ConvolutionTest::stdConvolutionTestFromRepeatWithAvoid));
         add( testCase( &ConvolutionTest::stdConvolutionTestOfAllTreatmentsRelatively));
+        add( testCase( &ConvolutionTest::simdConvolutionTest));
 
         add( testCase( &ConvolutionTest::separableConvolutionTest));
         add( testCase( &ConvolutionTest::separableDerivativeRepeatTest));
@@ -2411,6 +2643,8 @@ struct ConvolutionTestSuite
         add( testCase( &ConvolutionTest::structureTensorRGBTest));
         add( testCase( &ConvolutionTest::stdConvolutionTest));
         add( testCase( &ConvolutionTest::stdVersusSeparableConvolutionTest));
+        add( testCase( &ConvolutionTest::separableApproximationTest));
+        add( testCase( &ConvolutionTest::separableApproximationConvolutionTest));
         add( testCase( &ConvolutionTest::recursiveFilterTestWithAvoid));
         add( testCase( &ConvolutionTest::recursiveFilterTestWithClipOnConstImage));
         add( testCase( &ConvolutionTest::recursiveFilterTestWithClipOnNonConstImage));
@@ -0,0 +1,161 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2014 by Ullrich Koethe                     */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+// Measures direct and FFT-based convolution for increasing kernel sizes,
+// reports the crossover points, and compares them with the predictions 
+// of the cost model in fftConvolutionIsFaster().
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include "unittest.hxx"
+#include "vigra/multi_fft.hxx"
+#include "vigra/timing.hxx"
+
+using namespace vigra;
+
+struct FFTConvolutionSpeedTest
+{
+    typedef MultiArrayShape<2>::type Shape2;
+    typedef MultiArrayShape<3>::type Shape3;
+
+    int repetitions;
+
+    FFTConvolutionSpeedTest()
+    : repetitions(3)
+    {}
+
+    void testImage()
+    {
+        Shape2 shape(512, 512);
+        MultiArray<2, float> src(shape), dest(shape);
+        for(int k=0; k<src.size(); ++k)
+            src[k] = std::rand() / (float)RAND_MAX;
+
+        std::cout << "    2D convolution of a " << shape << " image (msec):\n"
+                  << "    kernel     direct        FFT   predicted\n";
+        int measured = 0, predicted = 0;
+        for(int radius = 1; radius <= 15; ++radius)
+        {
+            Kernel2D<double> kernel;
+            kernel.initExplicitly(Diff2D(-radius, -radius), Diff2D(radius, radius));
+            for(int y=-radius; y<=radius; ++y)
+                for(int x=-radius; x<=radius; ++x)
+                    kernel(x, y) = std::rand() / (double)RAND_MAX;
+            kernel.setBorderTreatment(BORDER_TREATMENT_REFLECT);
+
+            double t[2];
+            ConvolutionMethod methods[2] = { CONVOLUTION_DIRECT, CONVOLUTION_FFT };
+            for(int m=0; m<2; ++m)
+            {
+                convolveImage(srcImageRange(src), destImage(dest), kernel, methods[m]); // warm up
+                USETICTOC;
+                TIC;
+                for(int k=0; k<repetitions; ++k)
+                    convolveImage(srcImageRange(src), destImage(dest), kernel, methods[m]);
+                t[m] = TOCN / repetitions;
+            }
+            bool fft = fftConvolutionIsFaster(shape, Shape2(2*radius+1));
+            if(measured == 0 && t[1] < t[0])
+                measured = 2*radius+1;
+            if(predicted == 0 && fft)
+                predicted = 2*radius+1;
+            std::cout << "    " << std::setw(3) << 2*radius+1 << "x" << std::setw(2) << std::left << 2*radius+1 << std::right
+                      << std::setw(11) << t[0] << std::setw(11) << t[1] 
+                      << (fft ? "         FFT\n" : "      direct\n");
+        }
+        std::cout << "    crossover: measured " << measured << ", predicted " << predicted << std::endl;
+    }
+
+    void testLines()
+    {
+        Shape3 shape(256, 256, 16);
+        MultiArray<3, float> src(shape), dest(shape);
+        for(int k=0; k<src.size(); ++k)
+            src[k] = std::rand() / (float)RAND_MAX;
+
+        std::cout << "    convolution of a " << shape << " volume along axis 1 (msec):\n"
+                  << "    kernel     direct        FFT   predicted\n";
+        int measured = 0, predicted = 0;
+        for(int radius = 8; radius <= 128; radius *= 2)
+        {
+            Kernel1D<double> kernel;
+            kernel.initGaussian(radius / 3.0, 1.0, 3.0);  // 2*radius+1 coefficients
+            
+            double t[2];
+            ConvolutionMethod methods[2] = { CONVOLUTION_DIRECT, CONVOLUTION_FFT };
+            for(int m=0; m<2; ++m)
+            {
+                USETICTOC;
+                TIC;
+                for(int k=0; k<repetitions; ++k)
+                    convolveMultiArrayOneDimension(srcMultiArrayRange(src), destMultiArray(dest), 1, kernel,
+                                                   ConvolutionOptions<3>(), methods[m]);
+                t[m] = TOCN / repetitions;
+            }
+            MultiArrayShape<1>::type line(shape[1]), klen(kernel.size());
+            bool fft = detail::fftConvolutionCost(line, klen, 2) < 
+                       detail::directConvolutionCost(line, klen, true);
+            if(measured == 0 && t[1] < t[0])
+                measured = kernel.size();
+            if(predicted == 0 && fft)
+                predicted = kernel.size();
+            std::cout << "    " << std::setw(6) << std::left << kernel.size() << std::right
+                      << std::setw(11) << t[0] << std::setw(11) << t[1] 
+                      << (fft ? "         FFT\n" : "      direct\n");
+        }
+        std::cout << "    crossover: measured " << measured << ", predicted " << predicted << std::endl;
+    }
+};
+
+struct FFTConvolutionSpeedTestSuite
+: public vigra::test_suite
+{
+    FFTConvolutionSpeedTestSuite()
+    : vigra::test_suite("FFTConvolutionSpeedTestSuite")
+    {
+        add( testCase( &FFTConvolutionSpeedTest::testImage ) );
+        add( testCase( &FFTConvolutionSpeedTest::testLines ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    FFTConvolutionSpeedTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
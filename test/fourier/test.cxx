@@ -35,6 +35,7 @@
 
 #include "unittest.hxx"
 #include <stdlib.h>
+#include <cstdio>
 #include <algorithm>
 #include <functional>
 #include <vigra/stdimage.hxx>
@@ -692,6 +693,244 @@ struct MultiFFTTest
         shouldEqualSequenceTolerance(out2.data(), out2.data()+out2.size(),
                                      out4.data(), 1e-15);
     }
+
+    void testConvolveAuto()
+    {
+        typedef MultiArrayView<2, double> MV;
+        Shape2 s(47, 38);
+        MultiArray<2, double> in(s), out(s), ref(s);
+        for(int k=0; k<in.size(); ++k)
+            in[k] = std::rand() / (double)RAND_MAX;
+
+        // asymmetric kernel with random coefficients
+        Kernel2D<double> kernel;
+        kernel.initExplicitly(Diff2D(-5, -3), Diff2D(4, 6));
+        for(int y=-3; y<=6; ++y)
+            for(int x=-5; x<=4; ++x)
+                kernel(x, y) = std::rand() / (double)RAND_MAX - 0.3;
+
+        BorderTreatmentMode modes[] = { BORDER_TREATMENT_AVOID, BORDER_TREATMENT_REFLECT, 
+                                        BORDER_TREATMENT_REPEAT, BORDER_TREATMENT_WRAP };
+        for(int m=0; m<4; ++m)
+        {
+            kernel.setBorderTreatment(modes[m]);
+            out.init(-1.0);
+            ref.init(-1.0);
+            convolveImage(srcImageRange(in), destImage(ref), kernel, CONVOLUTION_DIRECT);
+            convolveImage(srcImageRange(in), destImage(out), kernel, CONVOLUTION_FFT);
+            for(int k=0; k<out.size(); ++k)
+                should(std::abs(out[k] - ref[k]) < 1e-12);
+        }
+
+        // the plans for a given shape are created only once
+        std::size_t plans = fftwPlanCacheSize();
+        convolveImage(srcImageRange(in), destImage(out), kernel, CONVOLUTION_FFT);
+        shouldEqual(fftwPlanCacheSize(), plans);
+
+        kernel.setBorderTreatment(BORDER_TREATMENT_CLIP);
+        try
+        {
+            convolveImage(srcImageRange(in), destImage(out), kernel, CONVOLUTION_FFT);
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nFFT convolution: border treatment must be");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+        // CLIP always uses the direct method in automatic mode
+        convolveImage(srcImageRange(in), destImage(ref), kernel, CONVOLUTION_DIRECT);
+        convolveImage(srcImageRange(in), destImage(out), kernel);
+        shouldEqualSequence(out.data(), out.data()+out.size(), ref.data());
+
+        // cost model
+        should(!fftConvolutionIsFaster(Shape2(512, 512), Shape2(3, 3)));
+        should(fftConvolutionIsFaster(Shape2(512, 512), Shape2(31, 31)));
+
+        Kernel2D<double> gauss;
+        gauss.initGaussian(6.0);
+        ImageImportInfo info("ghouse.gif");
+        Shape2 is(info.width(), info.height());
+        MultiArray<2, double> image(is), res(is), res_auto(is);
+        importImage(info, destImage(image));
+        should(fftConvolutionIsFaster(is, Shape2(gauss.width(), gauss.height())));
+        convolveImage(srcImageRange(image), destImage(res), gauss, CONVOLUTION_DIRECT);
+        convolveImage(srcImageRange(image), destImage(res_auto), gauss);
+        for(int k=0; k<res.size(); ++k)
+            should(std::abs(res[k] - res_auto[k]) < 1e-10);
+    }
+
+    void testConvolveOneDimensionAuto()
+    {
+        typedef MultiArrayShape<3>::type Shape3;
+        Shape3 s(40, 33, 29);
+        MultiArray<3, float> in(s), out(s), ref(s);
+        for(int k=0; k<in.size(); ++k)
+            in[k] = std::rand() / (float)RAND_MAX;
+
+        Kernel1D<double> kernel;
+        kernel.initGaussianDerivative(3.0, 1);
+
+        BorderTreatmentMode modes[] = { BORDER_TREATMENT_AVOID, BORDER_TREATMENT_REFLECT, 
+                                        BORDER_TREATMENT_REPEAT, BORDER_TREATMENT_WRAP, 
+                                        BORDER_TREATMENT_ZEROPAD };
+        for(int m=0; m<5; ++m)
+        {
+            kernel.setBorderTreatment(modes[m]);
+            for(unsigned int d=0; d<3; ++d)
+            {
+                out.init(-1.0f);
+                ref.init(-1.0f);
+                convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(ref), d, kernel,
+                                               ConvolutionOptions<3>(), CONVOLUTION_DIRECT);
+                convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(out), d, kernel,
+                                               ConvolutionOptions<3>().numThreads(2), CONVOLUTION_FFT);
+                for(int k=0; k<out.size(); ++k)
+                    should(std::abs(out[k] - ref[k]) < 1e-5);
+            }
+        }
+
+        // subarray
+        Shape3 start(3, 4, 5), stop(30, 25, 20);
+        MultiArray<3, float> sout(stop - start), sref(stop - start);
+        kernel.setBorderTreatment(BORDER_TREATMENT_REFLECT);
+        for(unsigned int d=0; d<3; ++d)
+        {
+            convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(sref), d, kernel,
+                                           ConvolutionOptions<3>().subarray(start, stop), CONVOLUTION_DIRECT);
+            convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(sout), d, kernel,
+                                           ConvolutionOptions<3>().subarray(start, stop), CONVOLUTION_FFT);
+            for(int k=0; k<sout.size(); ++k)
+                should(std::abs(sout[k] - sref[k]) < 1e-5);
+        }
+
+        // short kernels are always convolved directly
+        kernel.initGaussian(1.0);
+        convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(ref), 1, kernel);
+        convolveMultiArrayOneDimension(srcMultiArrayRange(in), destMultiArray(out), 1, kernel,
+                                       ConvolutionOptions<3>(), CONVOLUTION_AUTO);
+        shouldEqualSequence(out.data(), out.data()+out.size(), ref.data());
+    }
+
+    void testPlanCache()
+    {
+        typedef MultiArrayShape<2>::type Shape2;
+        Shape2 s(20, 15);
+        MultiArray<2, double> in(s), out(s);
+        MultiArray<2, FFTWComplex<double> > fourier(fftwCorrespondingShapeR2C(s)), 
+                                            fourier2(fftwCorrespondingShapeR2C(s));
+        for(int k=0; k<in.size(); ++k)
+            in[k] = std::rand() / (double)RAND_MAX;
+
+        fftwClearPlanCache();
+        std::size_t plans = fftwPlanCacheSize();
+        {
+            FFTWPlan<2, double> forward(in, fourier), backward(fourier, out);
+            shouldEqual(fftwPlanCacheSize(), plans + 2);
+            
+            // plans for the same shapes are reused
+            FFTWPlan<2, double> forward2(in, fourier2);
+            shouldEqual(fftwPlanCacheSize(), plans + 2);
+            
+            forward.execute(in, fourier);
+            forward2.execute(in, fourier2);
+            shouldEqualSequence(fourier.begin(), fourier.end(), fourier2.begin());
+            backward.execute(fourier, out);
+            for(int k=0; k<out.size(); ++k)
+                shouldEqualTolerance(out[k], in[k], 1e-12);
+            
+            // plans in use are not destroyed
+            shouldEqual(fftwClearPlanCache(), 0u);
+            shouldEqual(fftwPlanCacheSize(), plans + 2);
+
+            // the number of threads is part of the cache key (it is ignored 
+            // without threaded FFTW)
+            FFTWPlan<2, double> forward3(in, fourier2, FFTW_ESTIMATE, 2);
+#ifdef VIGRA_FFTW_THREADS
+            shouldEqual(fftwPlanCacheSize(), plans + 3);
+#else
+            shouldEqual(fftwPlanCacheSize(), plans + 2);
+#endif
+            forward3.execute(in, fourier2);
+            shouldEqualSequence(fourier.begin(), fourier.end(), fourier2.begin());
+            
+            FFTWPlan<2, double> forward4(in, fourier2, FFTW_ESTIMATE, 0);
+            forward4.execute(in, fourier2);
+            shouldEqualSequence(fourier.begin(), fourier.end(), fourier2.begin());
+        }
+        
+        // unused plans stay in the cache until it is cleared
+        std::size_t cached = fftwPlanCacheSize() - plans;
+#ifdef VIGRA_FFTW_THREADS
+        shouldEqual(cached, 3u);
+#else
+        shouldEqual(cached, 2u);
+#endif
+        shouldEqual(fftwClearPlanCache(), cached);
+        shouldEqual(fftwPlanCacheSize(), plans);
+    }
+
+    void testPlanCacheLimit()
+    {
+        std::size_t limit = fftwPlanCacheLimit();
+        shouldEqual(limit, 64u);
+        
+        fftwClearPlanCache();
+        std::size_t plans = fftwPlanCacheSize();
+        
+        // only the two most recently released plans are kept
+        fftwSetPlanCacheLimit(2);
+        for(int k=0; k<5; ++k)
+        {
+            MultiArray<1, double> in(MultiArrayShape<1>::type(16+k));
+            MultiArray<1, FFTWComplex<double> > fourier(fftwCorrespondingShapeR2C(in.shape()));
+            FFTWPlan<1, double> plan(in, fourier);
+            plan.execute(in, fourier);
+            shouldEqual(fftwPlanCacheSize(), plans + std::min(k, 2) + 1);
+        }
+        shouldEqual(fftwPlanCacheSize(), plans + 2);
+        
+        {
+            // reusing a plan makes it the most recently used one
+            MultiArray<1, double> in(MultiArrayShape<1>::type(19));
+            MultiArray<1, FFTWComplex<double> > fourier(fftwCorrespondingShapeR2C(in.shape()));
+            FFTWPlan<1, double> reused(in, fourier);
+            shouldEqual(fftwPlanCacheSize(), plans + 2);
+            
+            // plans in use don't count against the limit
+            MultiArray<1, double> in2(MultiArrayShape<1>::type(32));
+            MultiArray<1, FFTWComplex<double> > fourier2(fftwCorrespondingShapeR2C(in2.shape()));
+            FFTWPlan<1, double> fresh(in2, fourier2);
+            shouldEqual(fftwPlanCacheSize(), plans + 3);
+        }
+        // the plan of size 20 was evicted, size 19 and 32 remain
+        shouldEqual(fftwPlanCacheSize(), plans + 2);
+        
+        // a lower limit destroys surplus plans immediately
+        fftwSetPlanCacheLimit(0);
+        shouldEqual(fftwPlanCacheSize(), plans);
+        
+        fftwSetPlanCacheLimit(limit);
+        shouldEqual(fftwPlanCacheLimit(), limit);
+    }
+
+    void testWisdom()
+    {
+        typedef MultiArrayShape<2>::type Shape2;
+        MultiArray<2, double> in(Shape2(32, 32));
+        MultiArray<2, FFTWComplex<double> > fourier(fftwCorrespondingShapeR2C(in.shape()));
+        FFTWPlan<2, double> plan(in, fourier, FFTW_MEASURE);
+
+        std::string wisdom = FFTWWisdom<double>::exportToString();
+        should(wisdom.size() > 0);
+        FFTWWisdom<double>::forget();
+        should(FFTWWisdom<double>::importFromString(wisdom));
+        
+        should(FFTWWisdom<double>::exportToFile("fftw_wisdom.dat"));
+        should(FFTWWisdom<double>::importFromFile("fftw_wisdom.dat"));
+        std::remove("fftw_wisdom.dat");
+    }
 };
 
 struct FFTWTestSuite
@@ -716,6 +955,11 @@ struct FFTWTestSuite
         add( testCase(&MultiFFTTest::testConvolveFFT));
         add( testCase(&MultiFFTTest::testConvolveFFTComplex));
         add( testCase(&MultiFFTTest::testConvolveFourierKernel));
+        add( testCase(&MultiFFTTest::testConvolveAuto));
+        add( testCase(&MultiFFTTest::testConvolveOneDimensionAuto));
+        add( testCase(&MultiFFTTest::testPlanCache));
+        add( testCase(&MultiFFTTest::testPlanCacheLimit));
+        add( testCase(&MultiFFTTest::testWisdom));
     }
 };
 
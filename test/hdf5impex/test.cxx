@@ -41,6 +41,8 @@
 #include "unittest.hxx"
 #include "vigra/hdf5impex.hxx"
 #include "vigra/multi_array.hxx"
+#include "vigra/multi_array_chunked_hdf5.hxx"
+#include "vigra/multi_array_mapped_hdf5.hxx"
 
 using namespace vigra;
 
@@ -1175,6 +1177,97 @@ public:
         file_open.readAttribute("/group2/float_array","float_array_attribute",read_attr);
     }
 
+    void testChunkedArrayHDF5()
+    {
+        typedef MultiArrayShape<3>::type Shape;
+        Shape shape(20, 21, 22), chunk_shape(8, 8, 8);
+        MultiArray<3, float> ref(shape);
+        for(int k=0; k<ref.size(); ++k)
+            ref[k] = (float)k;
+
+        std::string file_name("testfile_chunked.h5");
+        {
+            HDF5File file(file_name, HDF5File::New);
+            // a small cache forces chunks to be written to the file during the commit
+            ChunkedArrayHDF5<3, float> array(file, "chunked", shape, chunk_shape,
+                                             ChunkedArrayOptions().cacheMax(4).compression(3));
+            shouldEqual(array.backend(), "ChunkedArrayHDF5");
+            shouldEqual(array.getItem(Shape(1,2,3)), 0.0f);
+
+            array.commitSubarray(Shape(), ref);
+            should(array.cacheSize() <= 4);
+            should(array.subarray(Shape(), shape) == ref);
+
+            Shape start(3, 5, 7), stop(17, 20, 15);
+            should(array.subarray(start, stop) == ref.subarray(start, stop));
+        }
+        {
+            HDF5File file(file_name, HDF5File::Open);
+            MultiArray<3, float> data;
+            file.readAndResize("chunked", data);
+            should(data == ref);
+        }
+        {
+            HDF5File file(file_name, HDF5File::OpenReadOnly);
+            should(file.isReadOnly());
+            ChunkedArrayHDF5<3, float> array(file, "chunked");
+            shouldEqual(array.shape(), shape);
+            should(array.subarray(Shape(), shape) == ref);
+        }
+    }
+
+    void testMappedHDF5Dataset()
+    {
+        typedef MultiArrayShape<3>::type Shape;
+        Shape shape(20, 21, 22);
+        MultiArray<3, float> ref(shape);
+        MultiArray<2, TinyVector<int, 3> > vref(Shape2(7, 5));
+        for(int k=0; k<ref.size(); ++k)
+            ref[k] = (float)k;
+        for(int k=0; k<vref.size(); ++k)
+            vref[k] = TinyVector<int, 3>(k, 2*k, 3*k);
+
+        std::string file_name("testfile_mapped.h5");
+        {
+            HDF5File file(file_name, HDF5File::New);
+            file.write("contiguous", ref);
+            file.write("vector", vref);
+            file.write("chunked", ref, Shape(8, 8, 8));
+        }
+
+        HDF5File file(file_name, HDF5File::OpenReadOnly);
+        MappedMultiArray<3, float> mapped;
+        mapHDF5Dataset(file, "contiguous", mapped);
+        shouldEqual(mapped.shape(), shape);
+        should(mapped == ref);
+
+        MappedMultiArray<2, TinyVector<int, 3> > vmapped;
+        mapHDF5Dataset(file, "vector", vmapped);
+        shouldEqual(vmapped.shape(), vref.shape());
+        should(vmapped == vref);
+
+        try
+        {
+            mapHDF5Dataset(file, "chunked", mapped);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation & e)
+        {
+            std::string expected("\nPrecondition violation!\nmapHDF5Dataset(): dataset must be stored contiguously");
+            std::string message(e.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+
+        MappedMultiArray<3, int> wrong_type;
+        try
+        {
+            mapHDF5Dataset(file, "contiguous", wrong_type);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+
     struct HDF5File_close_test : public HDF5File
     {
         HDF5File_close_test(const std::string & name, HDF5File::OpenMode mode = HDF5File::New)
@@ -1304,6 +1397,8 @@ struct HDF5ImportExportTestSuite : public vigra::test_suite
         add(testCase(&HDF5ExportImportTest::testHDF5FileAttributes));
         add(testCase(&HDF5ExportImportTest::testHDF5FileTutorial));
         add(testCase(&HDF5ExportImportTest::test_file_closing));
+        add(testCase(&HDF5ExportImportTest::testChunkedArrayHDF5));
+        add(testCase(&HDF5ExportImportTest::testMappedHDF5Dataset));
     }
 };
 
@@ -353,6 +353,37 @@ struct BasicImageTest
         shouldEqual(other.height(), 3);
         shouldEqual(other(2,2), this->data[8]);
     }
+
+    void moveImage()
+    {
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        IMAGE copy(this->img);
+        typename IMAGE::const_pointer p = copy.data();
+        IMAGE other(std::move(copy));
+        should(other.data() == p);
+        shouldEqual(copy.width(), 0);
+        shouldEqual(copy.height(), 0);
+        shouldEqual(other(2,2), this->data[8]);
+        
+        // different size => the data are taken over
+        IMAGE small(1,1);
+        small = std::move(other);
+        should(small.data() == p);
+        shouldEqual(small.width(), 3);
+        shouldEqual(other.width(), 0);
+
+        // same size => the data are taken over as well
+        IMAGE same(3,3);
+        same = std::move(small);
+        should(same.data() == p);
+        shouldEqual(small.width(), 0);
+        shouldEqual(same(2,2), this->data[8]);
+        
+        std::swap(same, other);
+        should(other.data() == p);
+        shouldEqual(same.width(), 0);
+#endif
+    }
 };
 
 template <class IMAGE>
@@ -457,21 +488,25 @@ struct ImageTestSuite
         add( testCase( &BasicImageTest<BasicImage<unsigned char> >::testConstructor));
         add( testCase( &BasicImageTest<BasicImage<unsigned char> >::copyImage));
         add( testCase( &BasicImageTest<BasicImage<unsigned char> >::swapImage));
+        add( testCase( &BasicImageTest<BasicImage<unsigned char> >::moveImage));
         add( testCase( &BasicImageTest<BasicImage<double> >::testIterator));
         add( testCase( &BasicImageTest<BasicImage<double> >::testIndex));
         add( testCase( &BasicImageTest<BasicImage<double> >::testConstructor));
         add( testCase( &BasicImageTest<BasicImage<double> >::copyImage));
         add( testCase( &BasicImageTest<BasicImage<double> >::swapImage));
+        add( testCase( &BasicImageTest<BasicImage<double> >::moveImage));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::testIterator));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::testIndex));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::testConstructor));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::copyImage));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::swapImage));
+        add( testCase( &BasicImageTest<BasicImage<RGBValue<unsigned char> > >::moveImage));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::testIterator));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::testIndex));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::testConstructor));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::copyImage));
         add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::swapImage));
+        add( testCase( &BasicImageTest<BasicImage<RGBValue<float> > >::moveImage));
         add( testCase( &BasicImageViewTest<BasicImageView<unsigned char> >::testIterator));
         add( testCase( &BasicImageViewTest<BasicImageView<unsigned char> >::testIndex));
         add( testCase( &BasicImageViewTest<BasicImageView<unsigned char> >::copyImage));
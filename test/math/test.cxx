@@ -2314,6 +2314,34 @@ struct LinalgTest
         }
     }
 
+    void testMoveAndTemporaries()
+    {
+        double epsilon = 1e-11;
+        Matrix a = random_matrix (size, size), b = random_matrix (size, size);
+
+        // square temporaries are transposed in-place
+        Matrix at = transpose(a), bt = transpose(b);
+        Matrix t = transpose(a * b), r = bt * at;
+        shouldEqualSequenceTolerance(t.data(), t.data()+size*size, r.data(), epsilon);
+        Matrix c = random_matrix (size, 3);
+        Matrix tc = transpose(c * 2.0);
+        shouldEqual(tc.shape(), Shape(3, size));
+        for(unsigned int i = 0; i < size; ++i)
+            for(unsigned int j = 0; j < 3; ++j)
+                shouldEqual(tc(j, i), 2.0 * c(i, j));
+
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        double * p = a.data();
+        Matrix m(std::move(a));
+        should(m.data() == p);
+        should(!a.hasData());
+        Matrix n(2, 2);
+        n = std::move(m);
+        should(n.data() == p);
+        should(!m.hasData());
+#endif
+    }
+
     void testInverse()
     {
         double epsilon = 1e-11;
@@ -2858,6 +2886,7 @@ struct MathTestSuite
         add( testCase(&LinalgTest::testOverdetermined));
         add( testCase(&LinalgTest::testIncrementalLinearSolve));
         add( testCase(&LinalgTest::testInverse));
+        add( testCase(&LinalgTest::testMoveAndTemporaries));
         add( testCase(&LinalgTest::testSymmetricEigensystem));
         add( testCase(&LinalgTest::testNonsymmetricEigensystem));
         add( testCase(&LinalgTest::testSymmetricEigensystemAnalytic));
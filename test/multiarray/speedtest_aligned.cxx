@@ -0,0 +1,136 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2014 by Ullrich Koethe                     */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+// Compares a per-pixel pipeline on packed arrays with unaligned lines
+// and on padded arrays whose lines are aligned to the vector width.
+
+#include <iostream>
+#include "unittest.hxx"
+#include "vigra/multi_array.hxx"
+#include "vigra/timing.hxx"
+
+using namespace vigra;
+
+#if defined(__GNUC__)
+  #define ASSUME_ALIGNED(p, a) static_cast<float *>(__builtin_assume_aligned(p, a))
+#else
+  #define ASSUME_ALIGNED(p, a) (p)
+#endif
+
+    // d = s*a + b for every line along the first axis. When all lines are
+    // aligned, the compiler is told so and can omit the scalar prologue.
+template <class Array>
+void axpb(Array & src, Array & dest, float a, float b)
+{
+    bool aligned = src.isAligned(32) && dest.isAligned(32);
+    MultiArrayIndex width = src.shape(0);
+    for(MultiArrayIndex z=0; z<src.shape(2); ++z)
+    {
+        for(MultiArrayIndex y=0; y<src.shape(1); ++y)
+        {
+            float * s = &src(0, y, z), * d = &dest(0, y, z);
+            if(aligned)
+            {
+                s = ASSUME_ALIGNED(s, 32);
+                d = ASSUME_ALIGNED(d, 32);
+            }
+            for(MultiArrayIndex x=0; x<width; ++x)
+                d[x] = s[x]*a + b;
+        }
+    }
+}
+
+struct AlignedSpeedTest
+{
+    typedef MultiArrayShape<3>::type Shape;
+
+    Shape shape;
+    int repetitions;
+
+    AlignedSpeedTest()
+    : shape(251, 200, 40),
+      repetitions(20)
+    {}
+
+    template <class Array>
+    double run(Array & src, Array & dest)
+    {
+        USETICTOC;
+        TIC;
+        for(int k=0; k<repetitions; ++k)
+            axpb(src, dest, 1.5f, 0.5f);
+        return TOCN;
+    }
+
+    void testSpeed()
+    {
+        // packed layout, lines start at arbitrary addresses
+        MultiArray<3, float> packed_src(shape + Shape(1, 0, 0)), packed_dest(shape + Shape(1, 0, 0));
+        MultiArrayView<3, float> src = packed_src.subarray(Shape(1, 0, 0), packed_src.shape()),
+                                 dest = packed_dest.subarray(Shape(1, 0, 0), packed_dest.shape());
+        linearSequence(src.begin(), src.end());
+
+        // padded layout, all lines are aligned
+        PaddedMultiArray<3, float> padded_src(src), padded_dest(shape);
+        should(padded_src.isAligned(32) && !src.isAligned(32));
+
+        double t_packed = run(src, dest),
+               t_padded = run(padded_src, padded_dest);
+
+        should(dest == padded_dest);
+        std::cout << "    unaligned lines: " << t_packed << " msec\n"
+                  << "    aligned lines:   " << t_padded << " msec\n"
+                  << "    speed-up:        " << t_packed / t_padded << std::endl;
+    }
+};
+
+struct AlignedSpeedTestSuite
+: public vigra::test_suite
+{
+    AlignedSpeedTestSuite()
+    : vigra::test_suite("AlignedSpeedTestSuite")
+    {
+        add( testCase( &AlignedSpeedTest::testSpeed ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    AlignedSpeedTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
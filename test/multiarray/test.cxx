@@ -38,6 +38,7 @@
 #include "vigra/multi_iterator_coupled.hxx"
 #include "vigra/multi_impex.hxx"
 #include "vigra/basicimageview.hxx"
+#include "vigra/basicimage.hxx"
 #include "vigra/navigator.hxx"
 #include "vigra/multi_pointoperators.hxx"
 #include "vigra/tensorutilities.hxx"
@@ -494,6 +495,40 @@ public:
         shouldEqual (b.shape (0), 2);
     }
 
+    void test_move ()
+    {
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        array3_t a (a3);
+        scalar_type * p = a.data();
+        array3_t b (std::move(a));
+        should (b.data() == p);
+        should (!a.hasData());
+        should (b == a3);
+
+        // different shape => the memory is taken over
+        array3_t c (shape3_t(1, 2, 3));
+        c = std::move(b);
+        should (c.data() == p);
+        should (!b.hasData());
+        should (c == a3);
+
+        // same shape => the memory is taken over as well
+        array3_t d (s, scalar_type(0));
+        d = std::move(c);
+        should (d.data() == p);
+        should (!c.hasData());
+        should (d == a3);
+
+        std::swap(c, d);
+        should (c.data() == p);
+        should (!d.hasData());
+        using std::swap;
+        swap(c, d);
+        should (d.data() == p);
+        should (!c.hasData());
+#endif
+    }
+
     void testShape()
     {
         shouldEqual(a3.shape(0), 2);
@@ -1252,6 +1287,86 @@ public:
     }
 };
 
+class AlignedMultiArrayTest
+{
+public:
+    typedef MultiArrayShape<3>::type Shape;
+
+    void testAlignedAllocator()
+    {
+        for(int k=1; k<20; ++k)
+        {
+            MultiArray<3, float, AlignedAllocator<float> > a(Shape(k, 3, 2), 1.0f);
+            should(reinterpret_cast<std::size_t>(a.data()) % 64 == 0);
+            should(a.isAligned(64) == (k*sizeof(float) % 64 == 0));
+
+            ArrayVector<double, AlignedAllocator<double, 32> > v(k, 2.0);
+            should(reinterpret_cast<std::size_t>(v.data()) % 32 == 0);
+            shouldEqual(v[k-1], 2.0);
+
+            BasicImage<UInt8, AlignedAllocator<UInt8> > i(k, 5, 3);
+            should(reinterpret_cast<std::size_t>(i.data()) % 64 == 0);
+            shouldEqual(i(k-1, 4), 3);
+        }
+
+        MultiArray<2, float, AlignedAllocator<float, 32> > b(Shape2(16, 5));
+        should(b.isAligned(32));
+        should(!b.subarray(Shape2(1, 0), Shape2(16, 5)).isAligned(32));
+        should(!b.transpose().isAligned(32));
+        shouldEqual((MultiArray<2, float>().alignment()), 0u);
+    }
+
+    void testPaddedArray()
+    {
+        Shape shape(21, 5, 3);
+        PaddedMultiArray<3, float> a(shape, 2.0f);
+        shouldEqual(a.shape(), shape);
+        shouldEqual(a.stride(), Shape(1, 32, 160));
+        should(a.isAligned(64));
+        should(!a.isUnstrided());
+        should(a.isUnstrided(0));
+        // the padded layout must not bind to functions requiring contiguous memory
+        should((IsSameType<PaddedMultiArray<3, float>::view_type, 
+                           MultiArrayView<3, float, StridedArrayTag> >::value));
+        should(!(IsConvertibleTo<PaddedMultiArray<3, float>, MultiArrayView<3, float> >::value));
+
+        MultiArray<3, float> ref(shape);
+        linearSequence(ref.begin(), ref.end());
+        a = ref;
+        should(a == ref);
+        should(a.isAligned(64));
+
+        // algorithms work on the padded layout
+        MultiArray<3, float> expected(ref);
+        a += ref;
+        expected *= 2.0f;
+        should(a == expected);
+        transformMultiArray(srcMultiArrayRange(ref), destMultiArray(a), Arg1() + Param(1.0f));
+        expected = ref;
+        expected += 1.0f;
+        should(a == expected);
+
+        PaddedMultiArray<3, float> b(a), c;
+        should(b == a);
+        should(b.data() != a.data());
+        should(!c.hasData());
+        c.swap(b);
+        should(c == a);
+        should(!b.hasData());
+
+        PaddedMultiArray<3, float, 32> d(ref.subarray(Shape(1,1,1), shape));
+        shouldEqual(d.stride(), Shape(1, 24, 96));
+        should(d.isAligned(32));
+        should(d == ref.subarray(Shape(1,1,1), shape));
+        d.reshape(Shape(7, 2, 2), 5.0f);
+        shouldEqual(d.stride(), Shape(1, 8, 16));
+        should((d == MultiArray<3, float>(Shape(7, 2, 2), 5.0f)));
+
+        // 3-byte elements: each line is padded to a multiple of 64 elements
+        shouldEqual((PaddedMultiArray<2, RGBValue<UInt8> >::paddedStrides(Shape2(10, 4))), Shape2(1, 64));
+    }
+};
+
 class MultiArrayNavigatorTest
 {
 public:
@@ -1985,6 +2100,138 @@ struct MultiArrayPointoperatorsTest
                     shouldEqual(res(x,y,z), 3.0*img(x,y,z));
     }
     
+    void testMultiArrayViewPointoperators()
+    {
+        using namespace vigra::functor;
+
+        MultiArray<3, float> a(Shape3(60, 40, 30)), b(a.shape());
+        for(int k=0; k<a.size(); ++k)
+        {
+            a[k] = (float)(k % 97);
+            b[k] = (float)(k % 13) + 1.0f;
+        }
+        // strided views, whose first two dimensions can't be merged
+        MultiArrayView<3, float, StridedArrayTag> sa = a.subarray(Shape3(1,2,3), Shape3(51,38,29)),
+                                                  sb = b.subarray(Shape3(5,0,1), Shape3(55,36,27)).transpose(),
+                                                  sbt = sb.transpose();
+
+        for(int threads=0; threads<5; threads+=2)
+        {
+            ParallelOptions opt = ParallelOptions().numThreads(threads);
+
+            MultiArray<3, float> ref(a.shape()), res(a.shape());
+            initMultiArray(destMultiArrayRange(ref), 2.5);
+            initMultiArray(res, 2.5, opt);
+            should(ref == res);
+            initMultiArray(res.subarray(Shape3(3), Shape3(10)), 1.0, opt);
+            initMultiArray(ref.subarray(Shape3(3), Shape3(10)), 1.0);
+            should(ref == res);
+            shouldEqual(res(5,5,5), 1.0f);
+            shouldEqual(res(5,5,11), 2.5f);
+
+            transformMultiArray(srcMultiArrayRange(a), destMultiArray(ref), sqrt(Arg1()));
+            transformMultiArray(a, res, sqrt(Arg1()), opt);
+            should(ref == res);
+            res.init(0.0f);
+            transformMultiArray(a, res, sqrt(Arg1()));
+            should(ref == res);
+
+            MultiArray<3, int> iref(sa.shape()), ires(sa.shape());
+            transformMultiArray(srcMultiArrayRange(sa), destMultiArray(iref), Arg1()*Param(2.4));
+            transformMultiArray(sa, ires, Arg1()*Param(2.4), opt);
+            should(iref == ires);
+
+            MultiArray<3, float> sref(sa.shape()), sres(sa.shape());
+            combineTwoMultiArrays(srcMultiArrayRange(sa), srcMultiArray(sbt), destMultiArray(sref),
+                                  Arg1() + Arg2());
+            combineTwoMultiArrays(sa, sbt, sres, Arg1() + Arg2(), opt);
+            should(sref == sres);
+
+            MultiArray<3, float> tref(sb.shape()), tres(sb.shape());
+            combineThreeMultiArrays(srcMultiArrayRange(sa.transpose()), srcMultiArray(sb),
+                                    srcMultiArray(sb), destMultiArray(tref),
+                                    Arg1() + Arg2()*Arg3());
+            combineThreeMultiArrays(sa.transpose(), sb, sb, tres, Arg1() + Arg2()*Arg3(), opt);
+            should(tref == tres);
+            tres.init(0.0f);
+            combineThreeMultiArrays(sa.transpose(), sb, sb, tres, Arg1() + Arg2()*Arg3());
+            should(tref == tres);
+        }
+
+        // expand mode is delegated to the iterator-based implementation
+        MultiArray<3, float> res(a.shape());
+        transformMultiArray(a.subarray(Shape3(), Shape3(60, 1, 1)), res, Arg1() + Param(1.0f),
+                            ParallelOptions().numThreads(4));
+        for(int z=0; z<30; ++z)
+            for(int y=0; y<40; ++y)
+                for(int x=0; x<60; ++x)
+                    shouldEqual(res(x,y,z), a(x,0,0) + 1.0f);
+        combineTwoMultiArrays(a, a.subarray(Shape3(), Shape3(1, 40, 30)), res, Arg1() - Arg2());
+        for(int z=0; z<30; ++z)
+            for(int y=0; y<40; ++y)
+                for(int x=0; x<60; ++x)
+                    shouldEqual(res(x,y,z), a(x,y,z) - a(0,y,z));
+
+        try
+        {
+            combineThreeMultiArrays(a, b, sa, res, Arg1() + Arg2() + Arg3());
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\ncombineThreeMultiArrays(): shape mismatch between inputs and/or output.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testParallelInspect()
+    {
+        MultiArray<3, double> a(Shape3(70, 50, 40));
+        RandomMT19937 random(11);
+        for(int k=0; k<a.size(); ++k)
+            a[k] = random.uniform(-10.0, 100.0);
+        MultiArrayView<3, double, StridedArrayTag> sa = a.subarray(Shape3(3, 0, 1), Shape3(67, 49, 40)).transpose();
+
+        FindMinMax<double> minmaxRef, minmax;
+        FindAverage<double> averageRef;
+        inspectMultiArray(srcMultiArrayRange(sa), minmaxRef);
+        inspectMultiArray(srcMultiArrayRange(sa), averageRef);
+
+        inspectMultiArray(sa, minmax);
+        shouldEqual(minmax.min, minmaxRef.min);
+        shouldEqual(minmax.max, minmaxRef.max);
+        shouldEqual(minmax.count, minmaxRef.count);
+
+        FindAverage<double> average1, average;
+        inspectMultiArray(sa, average1, ParallelOptions().numThreads(1));
+        shouldEqual(average1.count(), averageRef.count());
+        shouldEqualTolerance(average1.average(), averageRef.average(), 1e-12);
+
+        for(int threads=0; threads<9; threads+=4)
+        {
+            FindMinMax<double> minmax;
+            inspectMultiArray(sa, minmax, ParallelOptions().numThreads(threads));
+            shouldEqual(minmax.min, minmaxRef.min);
+            shouldEqual(minmax.max, minmaxRef.max);
+            shouldEqual(minmax.count, minmaxRef.count);
+
+            // the result doesn't depend on the number of threads
+            FindAverage<double> average;
+            inspectMultiArray(sa, average, ParallelOptions().numThreads(threads));
+            shouldEqual(average.count(), average1.count());
+            shouldEqual(average.average(), average1.average());
+        }
+
+        // the functor's previous state is kept
+        FindMinMax<double> minmax2;
+        minmax2(-20.0);
+        inspectMultiArray(sa, minmax2, ParallelOptions().numThreads(4));
+        shouldEqual(minmax2.min, -20.0);
+        shouldEqual(minmax2.max, minmaxRef.max);
+        shouldEqual(minmax2.count, minmaxRef.count + 1);
+    }
+
     void testInitMultiArrayBorder(){
         typedef vigra::MultiArray<1,int> IntLine;
         typedef vigra::MultiArray<2,int> IntImage;
@@ -2211,6 +2458,38 @@ public:
                     w(x,y,z) = u(x,y,z) * v(x,y,z);
         t = TOCS;
         std::cerr << "    explicit loops: " << t << "\n";
+        TIC;
+        {
+            double const * pu = u.data(), * pv = v.data();
+            double * pw = w.data();
+            for(MultiArrayIndex k=0; k<w.size(); ++k)
+                pw[k] = pu[k] * pv[k];
+        }
+        t = TOCS;
+        std::cerr << "    hand-written pointer loop: " << t << "\n";
+        {
+            int oldThreads = setMultiMathThreads(4);
+            TIC;
+            w = u*v;
+            t = TOCS;
+            setMultiMathThreads(oldThreads);
+            std::cerr << "    multi_math expression (4 threads): " << t << "\n";
+        }
+        double s1 = 0.0, s2 = 0.0;
+        TIC;
+        s1 = sum<double>(sq(u-v));
+        t = TOCS;
+        std::cerr << "    fused multi_math reduction: " << t << "\n";
+        TIC;
+        {
+            double const * pu = u.data(), * pv = v.data();
+            for(MultiArrayIndex k=0; k<u.size(); ++k)
+                s2 += sq(pu[k] - pv[k]);
+        }
+        t = TOCS;
+        std::cerr << "    hand-written reduction loop: " << t << "\n";
+        // the summation order may differ
+        shouldEqualTolerance(s1, s2, 1e-12);
     }
 
     void testBasicArithmetic()
@@ -2606,6 +2885,132 @@ public:
                     shouldEqual(d(x,y,z)+ss(y), r1(x,y,z));
     }
 
+    struct NestedExpression
+    {
+        MultiArray<3, int> const & u, & v;
+        MultiArray<4, int> & res;
+        
+        void operator()(int, std::ptrdiff_t k) const
+        {
+            using namespace vigra::multi_math;
+            res.bindOuter(k) = u*v + 2;
+        }
+    };
+
+    void testParallelEvaluation()
+    {
+        using namespace vigra::multi_math;
+
+        // large enough for multi-threaded evaluation
+        Shape3 s(70, 60, 80);
+        should(prod(s) >= VIGRA_MULTI_MATH_PARALLEL_THRESHOLD);
+
+        MultiArray<3, int> u(s), v(s), ref(s);
+        for(int k=0; k<u.size(); ++k)
+        {
+            u[k] = k % 97;
+            v[k] = (3*k) % 101 - 50;
+        }
+        MultiArrayView<3, int, StridedArrayTag> vt = v.transpose();
+        MultiArray<3, int> vc(vt);
+        MultiArray<3, int> uline(Shape3(70, 1, 1));
+        for(int k=0; k<70; ++k)
+            uline[k] = k - 35;
+
+        // explicit loops for reference
+        MultiArray<3, int> r1(s), r2(s), r3(s), r4(s);
+        MultiArray<3, int> r5(Shape3(80, 60, 70));
+        MultiArray<3, int> b(Shape3(140, 60, 80));
+        for(int z=0; z<80; ++z)
+            for(int y=0; y<60; ++y)
+                for(int x=0; x<70; ++x)
+                {
+                    r1(x,y,z) = u(x,y,z)*v(x,y,z) + 2;
+                    r2(x,y,z) = u(x,y,z) - vc(z,y,x);
+                    r3(x,y,z) = uline(x,0,0)*v(x,y,z);
+                }
+        
+        long long ssd = 0, st = 0;
+        for(int k=0; k<u.size(); ++k)
+        {
+            ssd += sq(u[k] - v[k]);
+            st += u[k]*v[k];
+        }
+
+        // multi-threaded evaluation must be enabled explicitly
+        shouldEqual(multiMathThreads(), 1);
+        
+        int threads[] = { 1, 4 };
+        for(int t=0; t<2; ++t)
+        {
+            int oldThreads = setMultiMathThreads(threads[t]);
+            shouldEqual(multiMathThreads(), threads[t]);
+
+            // unstrided arrays
+            ref = u*v + 2;
+            shouldEqualSequence(ref.begin(), ref.end(), r1.begin());
+
+            // transposed and strided operands
+            ref = u - vc.transpose();
+            shouldEqualSequence(ref.begin(), ref.end(), r2.begin());
+            r4.transpose() = u.transpose() - vt.transpose().transpose();
+            shouldEqualSequence(r4.begin(), r4.end(), r2.begin());
+            r5 = u.transpose() - vc;
+            shouldEqualSequence(r5.transpose().begin(), r5.transpose().end(), r2.begin());
+
+            MultiArrayView<3, int, StridedArrayTag> bs = b.stridearray(Shape3(2,1,1));
+            bs = u*v;
+            bs += 2;
+            shouldEqualSequence(bs.begin(), bs.end(), r1.begin());
+
+            // expansion of singleton axes
+            ref = uline*v;
+            shouldEqualSequence(ref.begin(), ref.end(), r3.begin());
+
+            // reductions in the same pass
+            shouldEqual(sum<long long>(sq(u-v)), ssd);
+            shouldEqual(sum<long long>(u*vc.transpose()), st);
+            shouldEqual(sum<long long>(u*vc.transpose(), 7LL), st + 7);
+            should(all(u >= 0));
+            should(!all(u > 0));
+            should(any(u == 96));
+            should(!any(u > 96));
+            shouldEqual(product<double>(u*0 + 1), 1.0);
+
+            // long 1D arrays are split into segments
+            MultiArray<1, double> l(Shape1(300000)), lr(Shape1(300000));
+            for(int k=0; k<l.size(); ++k)
+                l[k] = k;
+            lr = 2.0*l;
+            for(int k=0; k<l.size(); ++k)
+                shouldEqual(lr[k], 2.0*k);
+            shouldEqual(sum<double>(l + 1.0), 300000.0*300001.0 / 2.0);
+
+            setMultiMathThreads(oldThreads);
+        }
+        
+        // expressions within a parallel loop are evaluated sequentially
+        {
+            int oldThreads = setMultiMathThreads(4);
+            MultiArray<4, int> rows(Shape4(70, 60, 80, 3));
+            NestedExpression f = { u, v, rows };
+            parallel_foreach(3, 3, f);
+            for(int k=0; k<3; ++k)
+                shouldEqualSequence(rows.bindOuter(k).begin(), rows.bindOuter(k).end(), r1.begin());
+            setMultiMathThreads(oldThreads);
+        }
+
+        // floating point reductions don't depend on the number of threads
+        MultiArray<3, double> f(s);
+        for(int k=0; k<f.size(); ++k)
+            f[k] = std::exp(-0.001*(k % 1000));
+        double s1 = sum<double>(sq(f) - f.transpose().transpose());
+        int oldThreads = setMultiMathThreads(3);
+        double s3 = sum<double>(sq(f) - f.transpose().transpose());
+        setMultiMathThreads(oldThreads);
+        shouldEqual(s1, s3);
+    }
+
     void testComplex()
     {
         using namespace vigra::multi_math;
@@ -2684,6 +3089,7 @@ struct MultiArrayTestSuite
         add( testCase( &MultiArrayTest::test_second_ctor ) );
         add( testCase( &MultiArrayTest::test_assignment ) );
         add( testCase( &MultiArrayTest::test_copy_construction ) );
+        add( testCase( &MultiArrayTest::test_move ) );
         add( testCase( &MultiArrayTest::testShape ) );
         add( testCase( &MultiArrayTest::test_iterator ) );
         add( testCase( &MultiArrayTest::test_const_iterator ) );
@@ -2728,6 +3134,8 @@ struct MultiArrayDataTestSuite
         add( testCase( &MultiArrayDataTest::testAssignmentAndReset ) );
         add( testCase( &MultiArrayNavigatorTest::testNavigator ) );
         add( testCase( &MultiArrayNavigatorTest::testCoordinateNavigator ) );
+        add( testCase( &AlignedMultiArrayTest::testAlignedAllocator ) );
+        add( testCase( &AlignedMultiArrayTest::testPaddedArray ) );
     }
 };
 
@@ -2752,6 +3160,8 @@ struct MultiArrayPointOperatorsTestSuite
         add( testCase( &MultiArrayPointoperatorsTest::testCombine2OuterReduce ) );
         add( testCase( &MultiArrayPointoperatorsTest::testCombine2InnerReduce ) );
         add( testCase( &MultiArrayPointoperatorsTest::testCombine3 ) );
+        add( testCase( &MultiArrayPointoperatorsTest::testMultiArrayViewPointoperators ) );
+        add( testCase( &MultiArrayPointoperatorsTest::testParallelInspect ) );
         add( testCase( &MultiArrayPointoperatorsTest::testInitMultiArrayBorder ) );
         add( testCase( &MultiArrayPointoperatorsTest::testTensorUtilities ) );
 
@@ -2763,6 +3173,7 @@ struct MultiArrayPointOperatorsTestSuite
         add( testCase( &MultiMathTest::testNonscalarValues ) );
         add( testCase( &MultiMathTest::testMixedExpressions ) );
         add( testCase( &MultiMathTest::testComplex ) );
+        add( testCase( &MultiMathTest::testParallelEvaluation ) );
     }
 }; // struct MultiArrayPointOperatorsTestSuite
 
@@ -0,0 +1,357 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2012-2014 by Ullrich Koethe                */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */                
+/*                                                                      */
+/************************************************************************/
+
+
+#include <cstdio>
+#include "unittest.hxx"
+#include "vigra/multi_array_chunked.hxx"
+#include "vigra/functorexpression.hxx"
+
+using namespace vigra;
+using namespace vigra::functor;
+
+template <class Array>
+class ChunkedMultiArrayTest
+{
+public:
+
+    typedef Array                                  ChunkedArrayType;
+    typedef typename Array::value_type             T;
+    typedef MultiArray<3, T>                       PlainArray;
+    typedef typename MultiArrayShape<3>::type      Shape;
+
+    Shape shape, chunk_shape;
+    PlainArray ref;
+
+    ChunkedMultiArrayTest()
+    : shape(20, 21, 22),
+      chunk_shape(8, 8, 8),
+      ref(shape)
+    {
+        for(int k=0; k<ref.size(); ++k)
+            ref[k] = T(k);
+    }
+
+    static ChunkedArrayType * createArray(Shape const & shape, Shape const & chunk_shape,
+                                          ChunkedArrayOptions const & options = ChunkedArrayOptions())
+    {
+        return new ChunkedArrayType(shape, chunk_shape, options);
+    }
+
+    void fill(ChunkedArrayType & a)
+    {
+        a.commitSubarray(Shape(), ref);
+    }
+
+    void testConstruction()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape,
+                                                         ChunkedArrayOptions().fillValue(3)));
+
+        shouldEqual(a->shape(), shape);
+        shouldEqual(a->size(), prod(shape));
+        shouldEqual(a->chunkShape(), chunk_shape);
+        shouldEqual(a->chunkArrayShape(), Shape(3, 3, 3));
+        shouldEqual(a->chunkShape(Shape(2, 2, 2)), Shape(4, 5, 6));
+        shouldEqual(a->cacheSize(), 0u);
+
+        // untouched elements read as the fill value
+        shouldEqual(a->getItem(Shape(1, 2, 3)), T(3));
+        shouldEqual(a->getItem(shape - Shape(1)), T(3));
+
+        // writing allocates exactly one chunk
+        a->setItem(Shape(9, 9, 9), T(42));
+        shouldEqual(a->getItem(Shape(9, 9, 9)), T(42));
+        shouldEqual(a->getItem(Shape(9, 9, 10)), T(3));
+
+        try
+        {
+            a->getItem(shape);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+
+    void testCheckoutCommit()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape));
+        fill(*a);
+
+        // the whole array
+        PlainArray all(shape);
+        a->checkoutSubarray(Shape(), all);
+        should(all == ref);
+
+        // blocks that cross chunk boundaries
+        Shape start(3, 5, 7), stop(17, 20, 15);
+        PlainArray block = a->subarray(start, stop);
+        shouldEqual(block.shape(), stop - start);
+        should(block == ref.subarray(start, stop));
+
+        // checkout into a strided view of a differently typed array
+        typedef typename NumericTraits<T>::RealPromote DType;
+        MultiArray<3, DType> dblock(Shape(2*(stop-start)[0], (stop-start)[1], (stop-start)[2]));
+        a->checkoutSubarray(start, dblock.stridearray(Shape(2, 1, 1)));
+        for(int z=0; z<stop[2]-start[2]; ++z)
+            for(int y=0; y<stop[1]-start[1]; ++y)
+                for(int x=0; x<stop[0]-start[0]; ++x)
+                    shouldEqual(dblock(2*x, y, z), (DType)ref(x+start[0], y+start[1], z+start[2]));
+
+        // modify a block and write it back
+        block += T(1);
+        a->commitSubarray(start, block);
+        ref.subarray(start, stop) += T(1);
+        a->checkoutSubarray(Shape(), all);
+        should(all == ref);
+    }
+
+    void testIterators()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape));
+        fill(*a);
+
+        ChunkedArrayType const & ca = *a;
+        typename ChunkedArrayType::const_iterator i = ca.begin(), end = ca.end();
+        typename PlainArray::iterator r = ref.begin();
+        int count = 0;
+        for(; i != end; ++i, ++r, ++count)
+        {
+            shouldEqual(*i, *r);
+        }
+        shouldEqual(count, prod(shape));
+
+        // write through iterators
+        typename ChunkedArrayType::iterator j = a->begin();
+        for(; j != a->end(); ++j)
+            *j = *j + T(2);
+        ref += T(2);
+        should(a->subarray(Shape(), shape) == ref);
+
+        // copies of iterators are independent
+        typename ChunkedArrayType::iterator k = a->begin(), l = k;
+        ++k;
+        shouldEqual(*l, ref[0]);
+        shouldEqual(*k, ref[1]);
+        shouldEqual(k.point(), Shape(1, 0, 0));
+
+        // chunk iteration over a ROI
+        Shape start(3, 5, 7), stop(17, 20, 15);
+        typename ChunkedArrayType::chunk_iterator c    = a->chunk_begin(start, stop),
+                                                  cend = a->chunk_end(start, stop);
+        int chunkCount = 0;
+        MultiArrayIndex elements = 0;
+        for(; c != cend; ++c, ++chunkCount)
+        {
+            should(c->shape() == c.chunkStop() - c.chunkStart());
+            should(*c == ref.subarray(c.chunkStart(), c.chunkStop()));
+            elements += c->size();
+            *c = T(0);
+        }
+        shouldEqual(chunkCount, 3*3*2);
+        shouldEqual(elements, prod(stop - start));
+        ref.subarray(start, stop) = T(0);
+        should(a->subarray(Shape(), shape) == ref);
+    }
+
+    void testPointOperators()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape));
+        fill(*a);
+
+        // different chunk shape for the destination
+        ChunkedArrayLazy<3, T> b(shape, Shape(16, 4, 32));
+        transformMultiArray(*a, b, Arg1()*Param(T(2)));
+
+        PlainArray res(shape);
+        b.checkoutSubarray(Shape(), res);
+        ref *= T(2);
+        should(res == ref);
+    }
+
+    void testCache()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape,
+                                                         ChunkedArrayOptions().cacheMax(4)));
+        fill(*a);
+        if(a->backend() != "ChunkedArrayLazy")
+            should(a->cacheSize() <= 4u);
+
+        // chunks that were evicted must be reloaded correctly
+        should(a->subarray(Shape(), shape) == ref);
+
+        for(int k=0; k<prod(shape); k += 97)
+            shouldEqual(a->getItem(ref.scanOrderIndexToCoordinate(k)), ref[k]);
+
+        a->setCacheMaxSize(0);
+        if(a->backend() != "ChunkedArrayLazy")
+            shouldEqual(a->cacheSize(), 0u);
+        should(a->subarray(Shape(), shape) == ref);
+    }
+
+    void testReleaseChunks()
+    {
+        VIGRA_UNIQUE_PTR<ChunkedArrayType> a(createArray(shape, chunk_shape,
+                                                         ChunkedArrayOptions().fillValue(1)));
+        fill(*a);
+        if(a->backend() == "ChunkedArrayLazy")
+            shouldEqual(a->cacheSize(), 27u);
+
+        // keep the data
+        a->releaseChunks(Shape(), shape);
+        should(a->subarray(Shape(), shape) == ref);
+
+        // only chunk (0,0,0) is completely inside the ROI
+        a->releaseChunks(Shape(), Shape(10), true);
+        PlainArray res = a->subarray(Shape(), shape);
+        if(a->backend() == "ChunkedArrayLazy")
+            ref.subarray(Shape(), chunk_shape) = T(1);
+        should(res == ref);
+    }
+};
+
+template <unsigned int N, class T>
+class ChunkedArrayDirectoryTestHelper
+: public ChunkedArrayDirectory<N, T>
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    ChunkedArrayDirectoryTestHelper(Shape const & shape, Shape const & chunk_shape,
+                                    ChunkedArrayOptions const & options)
+    : ChunkedArrayDirectory<N, T>(".", shape, chunk_shape, options)
+    {
+        removeFiles();
+    }
+
+    ~ChunkedArrayDirectoryTestHelper()
+    {
+        this->flush();
+        this->unloadAll(true);
+        removeFiles();
+    }
+
+    void removeFiles()
+    {
+        Shape chunkIndex, chunkEnd = this->chunkArrayShape();
+        do
+        {
+            std::remove(this->chunkFileName(chunkIndex).c_str());
+        }
+        while(detail::incrementCoordinate(chunkIndex, Shape(), chunkEnd));
+    }
+};
+
+class ChunkedArrayDirectoryTest
+{
+public:
+    typedef MultiArrayShape<3>::type Shape;
+
+    void testPersistence()
+    {
+        Shape shape(20, 21, 22), chunk_shape(8, 8, 8);
+        MultiArray<3, int> ref(shape);
+        linearSequence(ref.begin(), ref.end());
+        {
+            ChunkedArrayDirectory<3, int> a(".", shape, chunk_shape);
+            a.commitSubarray(Shape(), ref);
+        }
+        {
+            // reopen: data are read from the chunk files
+            ChunkedArrayDirectory<3, int> a(".", shape, chunk_shape, ChunkedArrayOptions().cacheMax(2));
+            should(a.subarray(Shape(), shape) == ref);
+
+            Shape chunkIndex, chunkEnd = a.chunkArrayShape();
+            do
+            {
+                std::remove(a.chunkFileName(chunkIndex).c_str());
+            }
+            while(detail::incrementCoordinate(chunkIndex, Shape(), chunkEnd));
+        }
+    }
+
+    void testWriteErrors()
+    {
+        Shape shape(20, 21, 22), chunk_shape(8, 8, 8);
+        MultiArray<3, int> ref(shape, 1);
+        // keep all chunks in the cache, so that nothing is written before flush()
+        ChunkedArrayDirectory<3, int> a("./does_not_exist", shape, chunk_shape,
+                                        ChunkedArrayOptions().cacheMax(27));
+        a.commitSubarray(Shape(), ref);
+        try
+        {
+            a.flush();
+            failTest("no exception thrown");
+        }
+        catch(PostconditionViolation &)
+        {}
+        // the destructor must swallow the same error instead of terminating
+    }
+};
+
+struct ChunkedMultiArrayTestSuite
+: public vigra::test_suite
+{
+    template <class Array>
+    void testChunkedArrayType()
+    {
+        add( testCase( &ChunkedMultiArrayTest<Array>::testConstruction ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testCheckoutCommit ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testIterators ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testPointOperators ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testCache ) );
+        add( testCase( &ChunkedMultiArrayTest<Array>::testReleaseChunks ) );
+    }
+
+    ChunkedMultiArrayTestSuite()
+    : vigra::test_suite("ChunkedMultiArrayTestSuite")
+    {
+        testChunkedArrayType<ChunkedArrayLazy<3, float> >();
+        testChunkedArrayType<ChunkedArrayLazy<3, TinyVector<int, 2> > >();
+        testChunkedArrayType<ChunkedArrayDirectoryTestHelper<3, float> >();
+
+        add( testCase( &ChunkedArrayDirectoryTest::testPersistence ) );
+        add( testCase( &ChunkedArrayDirectoryTest::testWriteErrors ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    ChunkedMultiArrayTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
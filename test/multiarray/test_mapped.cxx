@@ -0,0 +1,232 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2012-2014 by Ullrich Koethe                */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */                
+/*                                                                      */
+/************************************************************************/
+
+
+#include <cstdio>
+#include <fstream>
+#include "unittest.hxx"
+#include "vigra/multi_array_mapped.hxx"
+#include "vigra/stdimage.hxx"
+#include "vigra/impex.hxx"
+
+using namespace vigra;
+
+class MappedMultiArrayTest
+{
+public:
+    typedef MultiArrayShape<3>::type Shape;
+
+    Shape shape;
+    MultiArray<3, float> ref;
+    std::string filename;
+    MultiArrayIndex offset;
+
+    MappedMultiArrayTest()
+    : shape(20, 21, 22),
+      ref(shape),
+      filename("mapped_test.raw"),
+      offset(100)
+    {
+        for(int k=0; k<ref.size(); ++k)
+            ref[k] = (float)k;
+
+        // write a header of 'offset' bytes, followed by the data
+        std::ofstream f(filename.c_str(), std::ios::binary);
+        std::string header(offset, 'x');
+        f.write(header.c_str(), offset);
+        f.write(reinterpret_cast<char const *>(ref.data()), ref.size()*sizeof(float));
+    }
+
+    ~MappedMultiArrayTest()
+    {
+        std::remove(filename.c_str());
+        std::remove("mapped_test.pgm");
+        std::remove("mapped_test.ppm");
+        std::remove("mapped_test.xv");
+    }
+
+    MultiArray<3, float> readFile()
+    {
+        MultiArray<3, float> res(shape);
+        std::ifstream f(filename.c_str(), std::ios::binary);
+        f.seekg(offset);
+        f.read(reinterpret_cast<char *>(res.data()), res.size()*sizeof(float));
+        return res;
+    }
+
+    void testReadOnly()
+    {
+        MappedMultiArray<3, float> a;
+        should(!a.isMapped());
+
+        a.map(filename, shape, offset, MappedArrayOptions().sequential().willNeed());
+        should(a.isMapped());
+        shouldEqual(a.accessMode(), MappedArrayOptions::ReadOnly);
+        shouldEqual(a.shape(), shape);
+        should(a == ref);
+
+        // mapped arrays work with all algorithms accepting views
+        MultiArrayView<3, float, StridedArrayTag> t = a.transpose();
+        shouldEqual(t(3, 2, 1), ref(1, 2, 3));
+
+        a.unmap();
+        should(!a.isMapped());
+        shouldEqual(a.shape(), Shape());
+
+        try
+        {
+            MappedMultiArray<3, float> b(filename, shape + Shape(1), offset);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation & e)
+        {
+            std::string expected("\nPrecondition violation!\nMemoryMappedFile::map(): requested region exceeds the size of file");
+            std::string message(e.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testCopyOnWrite()
+    {
+        {
+            MappedMultiArray<3, float> a(filename, shape, offset,
+                                         MappedArrayOptions().copyOnWrite().randomAccess().hugePages());
+            a.init(1.0f);
+            a.flush();
+            should((a == MultiArray<3, float>(shape, 1.0f)));
+        }
+        should(readFile() == ref);
+    }
+
+    void testReadWrite()
+    {
+        {
+            MappedMultiArray<3, float> a(filename, shape, offset, MappedArrayOptions().readWrite());
+            a.bindOuter(0) = -1.0f;
+            a.flush();
+        }
+        ref.bindOuter(0) = -1.0f;
+        should(readFile() == ref);
+    }
+
+    void testPNM()
+    {
+        BImage gray(11, 7);
+        BRGBImage color(11, 7);
+        for(int y=0; y<7; ++y)
+        {
+            for(int x=0; x<11; ++x)
+            {
+                gray(x, y) = x + 11*y;
+                color(x, y) = RGBValue<UInt8>(x, y, x+y);
+            }
+        }
+        exportImage(srcImageRange(gray), ImageExportInfo("mapped_test.pgm").setCompression("RAW"));
+        exportImage(srcImageRange(color), ImageExportInfo("mapped_test.ppm").setCompression("RAW"));
+
+        MappedMultiArray<2, UInt8> mgray;
+        mapPNM("mapped_test.pgm", mgray);
+        shouldEqual(mgray.shape(), Shape2(11, 7));
+        MappedMultiArray<2, RGBValue<UInt8> > mcolor;
+        mapPNM("mapped_test.ppm", mcolor);
+        shouldEqual(mcolor.shape(), Shape2(11, 7));
+        for(int y=0; y<7; ++y)
+        {
+            for(int x=0; x<11; ++x)
+            {
+                shouldEqual(mgray(x, y), gray(x, y));
+                shouldEqual(mcolor(x, y), color(x, y));
+            }
+        }
+
+        MappedMultiArray<2, float> wrong;
+        try
+        {
+            mapPNM("mapped_test.pgm", wrong);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+
+    void testVIFF()
+    {
+        FVector3Image image(11, 7);
+        for(int y=0; y<7; ++y)
+            for(int x=0; x<11; ++x)
+                image(x, y) = FVector3Image::value_type(x, y, x*y);
+        exportImage(srcImageRange(image), ImageExportInfo("mapped_test.xv"));
+
+        MappedMultiArray<3, float> bands;
+        mapVIFF("mapped_test.xv", bands);
+        shouldEqual(bands.shape(), Shape(11, 7, 3));
+        for(int y=0; y<7; ++y)
+            for(int x=0; x<11; ++x)
+                for(int b=0; b<3; ++b)
+                    shouldEqual(bands(x, y, b), image(x, y)[b]);
+
+        MappedMultiArray<2, float> single;
+        try
+        {
+            mapVIFF("mapped_test.xv", single);
+            failTest("no exception thrown");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+};
+
+struct MappedMultiArrayTestSuite
+: public vigra::test_suite
+{
+    MappedMultiArrayTestSuite()
+    : vigra::test_suite("MappedMultiArrayTestSuite")
+    {
+        add( testCase( &MappedMultiArrayTest::testReadOnly ) );
+        add( testCase( &MappedMultiArrayTest::testCopyOnWrite ) );
+        add( testCase( &MappedMultiArrayTest::testReadWrite ) );
+        add( testCase( &MappedMultiArrayTest::testPNM ) );
+        add( testCase( &MappedMultiArrayTest::testVIFF ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    MappedMultiArrayTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
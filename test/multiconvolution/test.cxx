@@ -47,6 +47,8 @@
 #include "unittest.hxx"
 #include "vigra/multi_array.hxx"
 #include "vigra/multi_convolution.hxx"
+#include "vigra/multi_features.hxx"
+#include "vigra/multi_tensorutilities.hxx"
 #include "vigra/basicimageview.hxx"
 #include "vigra/convolution.hxx" 
 #include "vigra/navigator.hxx"
@@ -470,6 +472,268 @@ struct MultiArraySeparableConvolutionTest
         shouldEqualSequenceTolerance(st.data(), st.data()+size, rst.data(), epsilon);
     }
 
+    void test_parallel()
+    {
+        Size3 shape(40, 30, 20);
+        Image3D src(shape), seq(shape), par(shape);
+        makeRandom(src);
+        
+        ConvolutionOptions<3> opt;
+        opt.numThreads(4);
+        
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(seq), 2.0);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(par), 2.0, opt);
+        shouldEqualSequence(par.begin(), par.end(), seq.begin());
+        
+        // in-place operation
+        par = src;
+        gaussianSmoothMultiArray(srcMultiArrayRange(par), destMultiArray(par), 2.0, opt);
+        shouldEqualSequence(par.begin(), par.end(), seq.begin());
+
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(seq), 1.5);
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(par), 1.5, opt);
+        shouldEqualSequence(par.begin(), par.end(), seq.begin());
+        
+        // automatic choice of the number of threads
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(seq), 1.0);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(par), 1.0, 
+                                 ConvolutionOptions<3>().numThreads(0));
+        shouldEqualSequence(par.begin(), par.end(), seq.begin());
+        
+        Image3x3 vseq(shape), vpar(shape);
+        
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vseq), 1.5);
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vpar), 1.5, opt);
+        shouldEqualSequence(vpar.begin(), vpar.end(), vseq.begin());
+
+        symmetricGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vseq));
+        symmetricGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vpar), opt);
+        shouldEqualSequence(vpar.begin(), vpar.end(), vseq.begin());
+        
+        typedef TinyVector<PixelType, 6> TensorType;
+        MultiArray<3, TensorType> tseq(shape), tpar(shape);
+
+        hessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(tseq), 1.5);
+        hessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(tpar), 1.5, opt);
+        shouldEqualSequence(tpar.begin(), tpar.end(), tseq.begin());
+
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tseq), 1.0, 2.0);
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tpar), 1.0, 2.0, opt);
+        shouldEqualSequence(tpar.begin(), tpar.end(), tseq.begin());
+        
+        // subarray
+        Size3 start(5, 3, 2), stop(35, 25, 15);
+        Image3D sseq(stop-start), spar(stop-start);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(sseq), 2.0,
+                                 ConvolutionOptions<3>().subarray(start, stop));
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(spar), 2.0,
+                                 ConvolutionOptions<3>().subarray(start, stop).numThreads(3));
+        shouldEqualSequence(spar.begin(), spar.end(), sseq.begin());
+        
+        Kernel1D<float> gauss;
+        gauss.initGaussian(1.5);
+        convolveMultiArrayOneDimension(srcMultiArrayRange(src), destMultiArray(sseq), 1, gauss, start, stop);
+        convolveMultiArrayOneDimension(srcMultiArrayRange(src), destMultiArray(spar), 1, gauss, 
+                                       ConvolutionOptions<3>().subarray(start, stop).numThreads(3));
+        shouldEqualSequence(spar.begin(), spar.end(), sseq.begin());
+        
+        // the results are independent of the number of threads
+        separableConvolveMultiArray(srcMultiArrayRange(src), destMultiArray(seq), gauss);
+        for(int n=2; n<=7; ++n)
+        {
+            separableConvolveMultiArray(srcMultiArrayRange(src), destMultiArray(par), gauss,
+                                        ConvolutionOptions<3>().numThreads(n));
+            shouldEqualSequence(par.begin(), par.end(), seq.begin());
+        }
+    }
+
+    void test_scratchArena()
+    {
+        Size3 shape(40, 30, 20);
+        Image3D src(shape), ref(shape), res(shape);
+        makeRandom(src);
+        
+        typedef TinyVector<PixelType, 6> TensorType;
+        MultiArray<3, TensorType> tref(shape), tres(shape);
+        
+        ScratchArena arena;
+        ConvolutionOptions<3> opt;
+        opt.scratchArena(arena);
+        
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tref), 1.0, 2.0);
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 1.5);
+        
+        for(int k=0; k<3; ++k)
+        {
+            arena.resetStatistics();
+            
+            structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tres), 1.0, 2.0, opt);
+            shouldEqualSequence(tres.begin(), tres.end(), tref.begin());
+            
+            laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(res), 1.5, opt);
+            shouldEqualSequence(res.begin(), res.end(), ref.begin());
+            
+            shouldEqual(arena.bytesInUse(), 0u);
+            // gradient and tensor array of the structure tensor
+            should(arena.highWaterMark() >= shape[0]*shape[1]*shape[2]*(3+6)*sizeof(PixelType));
+            // memory is only allocated in the first iteration
+            if(k > 0)
+                shouldEqual(arena.systemAllocations(), 0u);
+        }
+        
+        // subarray and integer destination: temporary arrays in separableConvolveMultiArray()
+        Size3 start(5, 3, 2), stop(35, 25, 15);
+        MultiArray<3, int> iref(stop-start), ires(stop-start);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(iref), 2.0,
+                                 ConvolutionOptions<3>().subarray(start, stop));
+        for(int k=0; k<2; ++k)
+        {
+            arena.resetStatistics();
+            gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ires), 2.0,
+                                     ConvolutionOptions<3>().subarray(start, stop).scratchArena(arena));
+            shouldEqualSequence(ires.begin(), ires.end(), iref.begin());
+            shouldEqual(arena.bytesInUse(), 0u);
+            shouldEqual(arena.systemAllocations(), 0u);
+        }
+    }
+
+    void test_tiles()
+    {
+        // convolution along the strided axes processes tiles of lines,
+        // compare with line-by-line convolution of the transposed array
+        Size3 shape(37, 23, 19);
+        Image3D src(shape), res(shape), ref(shape);
+        makeRandom(src);
+        
+        MultiArrayView<3, PixelType, StridedArrayTag> srct = src.transpose(), 
+                                                      reft = ref.transpose();
+        MultiArrayView<2, PixelType, StridedArrayTag> src2 = src.bindOuter(5), 
+                                                      res2 = res.bindOuter(5),
+                                                      src2t = src2.transpose(),
+                                                      ref2t = ref.bindOuter(5).transpose();
+        
+        BorderTreatmentMode modes[] = { BORDER_TREATMENT_REFLECT, BORDER_TREATMENT_REPEAT,
+                                        BORDER_TREATMENT_WRAP, BORDER_TREATMENT_ZEROPAD,
+                                        BORDER_TREATMENT_CLIP, BORDER_TREATMENT_AVOID };
+        for(int m=0; m<6; ++m)
+        {
+            Kernel1D<double> kernel;
+            kernel.initGaussianDerivative(2.0, 1);
+            kernel.setBorderTreatment(modes[m]);
+            
+            res.init(0.0f);
+            ref.init(0.0f);
+            convolveMultiArrayOneDimension(srcMultiArrayRange(src), destMultiArray(res), 2, kernel);
+            convolveMultiArrayOneDimension(srcMultiArrayRange(srct), destMultiArray(reft), 0, kernel);
+            shouldEqualSequence(res.begin(), res.end(), ref.begin());
+            
+            // tiles must also work when the array is split into slices along axis 0
+            res.init(0.0f);
+            ref.init(0.0f);
+            convolveMultiArrayOneDimension(srcMultiArrayRange(src2), destMultiArray(res2), 1, kernel,
+                                           ConvolutionOptions<2>().numThreads(3));
+            convolveMultiArrayOneDimension(srcMultiArrayRange(src2t), destMultiArray(ref2t), 0, kernel);
+            shouldEqualSequence(res.begin(), res.end(), ref.begin());
+        }
+        
+        // subarray
+        Kernel1D<double> kernel;
+        kernel.initGaussian(1.5);
+        Size3 start(3, 4, 5), stop(30, 20, 15);
+        Image3D sres(stop-start), sref(stop-start);
+        MultiArrayView<3, PixelType, StridedArrayTag> sreft = sref.transpose();
+        convolveMultiArrayOneDimension(srcMultiArrayRange(src), destMultiArray(sres), 
+                                       1, kernel, start, stop);
+        convolveMultiArrayOneDimension(srcMultiArrayRange(srct), destMultiArray(sreft), 
+                                       1, kernel, Size3(start[2], start[1], start[0]), Size3(stop[2], stop[1], stop[0]));
+        shouldEqualSequence(sres.begin(), sres.end(), sref.begin());
+        
+        // full separable filter
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(res), 2.0);
+        gaussianSmoothMultiArray(srcMultiArrayRange(srct), destMultiArray(reft), 2.0);
+        shouldEqualSequenceTolerance(res.begin(), res.end(), ref.begin(), 1e-6f);
+    }
+
+    void test_recursive()
+    {
+        // compare with the analytic response to a plane wave (away from the borders)
+        typedef MultiArray<3, double> DImage;
+        Size3 shape(60, 50, 40);
+        TinyVector<double, 3> w(0.11, -0.07, 0.05);
+        double sigma = 4.0;
+        DImage src(shape), res(shape);
+        for(int z=0; z<shape[2]; ++z)
+            for(int y=0; y<shape[1]; ++y)
+                for(int x=0; x<shape[0]; ++x)
+                    src(x, y, z) = std::sin(w[0]*x + w[1]*y + w[2]*z);
+        double amplitude = std::exp(-0.5*sq(sigma)*squaredNorm(w));
+        Size3 istart(18, 18, 18), istop(42, 32, 22);
+        
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(res), sigma);
+        for(int z=istart[2]; z<istop[2]; ++z)
+            for(int y=istart[1]; y<istop[1]; ++y)
+                for(int x=istart[0]; x<istop[0]; ++x)
+                    should(std::abs(res(x, y, z) - amplitude*src(x, y, z)) < 5e-4);
+        
+        MultiArray<3, TinyVector<double, 3> > grad(shape);
+        recursiveGaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(grad), sigma);
+        for(int z=istart[2]; z<istop[2]; ++z)
+            for(int y=istart[1]; y<istop[1]; ++y)
+                for(int x=istart[0]; x<istop[0]; ++x)
+                    for(int k=0; k<3; ++k)
+                        should(std::abs(grad(x, y, z)[k] - 
+                                        amplitude*w[k]*std::cos(w[0]*x + w[1]*y + w[2]*z)) < 3e-4);
+                                 
+        MultiArray<3, TinyVector<double, 6> > hessian(shape);
+        recursiveHessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(hessian), sigma);
+        for(int z=istart[2]; z<istop[2]; ++z)
+            for(int y=istart[1]; y<istop[1]; ++y)
+                for(int x=istart[0]; x<istop[0]; ++x)
+                    for(int i=0, b=0; i<3; ++i)
+                        for(int j=i; j<3; ++j, ++b)
+                            should(std::abs(hessian(x, y, z)[b] + amplitude*w[i]*w[j]*src(x, y, z)) < 3e-5);
+                            
+        // the results near the borders are close to those of the explicit filters
+        Image3D fsrc(shape), fres(shape), fir(shape), iir(shape);
+        makeRandom(fsrc);
+        gaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(fir), sigma);
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(iir), sigma);
+        shouldEqualSequenceTolerance(iir.begin(), iir.end(), fir.begin(), 5e-3f);
+        
+        // automatic selection of the recursive filter
+        gaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(fres), sigma, 
+                                 ConvolutionOptions<3>().recursiveFilterThreshold(sigma + 0.1));
+        gaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(iir), sigma, 
+                                 ConvolutionOptions<3>().recursiveFilterThreshold(sigma));
+        shouldEqualSequence(fres.begin(), fres.end(), fir.begin());
+        fres = iir;
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(iir), sigma);
+        shouldEqualSequence(fres.begin(), fres.end(), iir.begin());
+        
+        // mixed explicit and recursive filters for anisotropic data
+        gaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(iir), sigma, 
+                                 ConvolutionOptions<3>().stepSize(1.0, 1.0, 2.0).recursiveFilterThreshold(3.0));
+        gaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(fir), sigma, 
+                                 ConvolutionOptions<3>().stepSize(1.0, 1.0, 2.0));
+        shouldEqualSequenceTolerance(iir.begin(), iir.end(), fir.begin(), 5e-3f);
+        
+        // multi-threading, in-place operation, and subarrays
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(fres), sigma);
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(iir), sigma, 
+                                          ConvolutionOptions<3>().numThreads(4));
+        shouldEqualSequence(iir.begin(), iir.end(), fres.begin());
+        iir = fsrc;
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(iir), destMultiArray(iir), sigma);
+        shouldEqualSequence(iir.begin(), iir.end(), fres.begin());
+
+        Size3 start(3, 20, 10), stop(50, 30, 25);
+        Image3D sub(stop-start);
+        recursiveGaussianSmoothMultiArray(srcMultiArrayRange(fsrc), destMultiArray(sub), sigma, 
+                                          ConvolutionOptions<3>().subarray(start, stop));
+        MultiArrayView<3, PixelType> ref = fres.subarray(start, stop);
+        shouldEqualSequenceTolerance(sub.begin(), sub.end(), ref.begin(), 1e-3f);
+    }
+
     //--------------------------------------------
 
     const Size3 shape;
@@ -516,6 +780,143 @@ struct MultiArraySeparableConvolutionTest
         test_gradient1( srcImage, false );
         test_gradient1( srcImage, true );
     }
+
+    template <class View1, class View2>
+    static double maxDifference(View1 const & a, View2 const & b)
+    {
+        typename View1::const_iterator i = a.begin();
+        typename View2::const_iterator j = b.begin();
+        double res = 0.0;
+        for(; i != a.end(); ++i, ++j)
+            res = std::max(res, (double)std::abs(*i - *j));
+        return res;
+    }
+
+    void test_featureBank()
+    {
+        typedef MultiArrayShape<4>::type Shape4;
+        typedef TinyVector<PixelType, 6> TensorType;
+        Size3 shape(30, 25, 20);
+        Image3D src(shape), ref(shape);
+        makeRandom(src);
+
+        PixelFeatureBank<3> bank;
+        bank.add(FEATURE_GAUSSIAN_SMOOTHING, 1.0)
+            .add(FEATURE_GRADIENT_MAGNITUDE, 1.0)
+            .add(FEATURE_HESSIAN_OF_GAUSSIAN_EIGENVALUES, 1.0)
+            .add(FEATURE_LAPLACIAN_OF_GAUSSIAN, 1.0)
+            .add(FEATURE_STRUCTURE_TENSOR_EIGENVALUES, 1.0, 2.0)
+            .add(FEATURE_GAUSSIAN_SMOOTHING, 2.5)
+            .add(FEATURE_GRADIENT_MAGNITUDE, 2.5)
+            .add(FEATURE_STRUCTURE_TENSOR_EIGENVALUES, 2.5);
+        shouldEqual(bank.size(), 8u);
+        shouldEqual(bank.numberOfChannels(), 14u);
+        shouldEqual(bank.channelOffset(4), 6u);
+        shouldEqual(bank.channelCount(4), 3u);
+        shouldEqual(bank.outerScale(4), 2.0);
+        shouldEqual(bank.outerScale(7), 1.25);
+        shouldEqual(bank.outerScale(6), 0.0);
+
+        // the separate functions need 3+9+18+9+12+3+9+12 = 75 passes,
+        // scale 1.0 needs 3+6+10, scale 2.5 2+3+4 passes, plus 2*3 for the tensor smoothing
+        shouldEqual(bank.numberOfFilterPasses(), 34u);
+
+        // the residual scale 2.29 is too small for incremental smoothing 
+        // from 1.0 at these step sizes
+        ConvolutionOptions<3> opt;
+        opt.stepSize(1.0, 1.5, 2.0).numThreads(3);
+        bank.minimumIncrementalScale(1.2);
+
+        MultiArray<4, PixelType> features(Shape4(bank.numberOfChannels(), shape[0], shape[1], shape[2]));
+        bank.compute(src, features, opt);
+
+        double epsilon = 1e-5;
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 1.0, opt);
+        should(maxDifference(features.bindInner(0), ref) < epsilon);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 2.5, opt);
+        should(maxDifference(features.bindInner(9), ref) < epsilon);
+
+        Image3x3 grad(shape);
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(grad), 1.0, opt);
+        transformMultiArray(srcMultiArrayRange(grad), destMultiArray(ref), norm(Arg1()));
+        should(maxDifference(features.bindInner(1), ref) < epsilon);
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(grad), 2.5, opt);
+        transformMultiArray(srcMultiArrayRange(grad), destMultiArray(ref), norm(Arg1()));
+        should(maxDifference(features.bindInner(10), ref) < epsilon);
+
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 1.0, opt);
+        should(maxDifference(features.bindInner(5), ref) < epsilon);
+
+        MultiArray<3, TensorType> tensor(shape);
+        Image3x3 ev(shape);
+        hessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(tensor), 1.0, opt);
+        tensorEigenvaluesMultiArray(srcMultiArrayRange(tensor), destMultiArray(ev));
+        should(maxDifference(features.subarray(Shape4(2,0,0,0), Shape4(5, shape[0], shape[1], shape[2])), ev.expandElements(0)) < epsilon);
+
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tensor), 1.0, 2.0, opt);
+        tensorEigenvaluesMultiArray(srcMultiArrayRange(tensor), destMultiArray(ev));
+        should(maxDifference(features.subarray(Shape4(6,0,0,0), Shape4(9, shape[0], shape[1], shape[2])), ev.expandElements(0)) < epsilon);
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tensor), 2.5, 1.25, opt);
+        tensorEigenvaluesMultiArray(srcMultiArrayRange(tensor), destMultiArray(ev));
+        should(maxDifference(features.subarray(Shape4(11,0,0,0), Shape4(14, shape[0], shape[1], shape[2])), ev.expandElements(0)) < epsilon);
+
+        // wrong number of channels
+        try
+        {
+            MultiArray<4, PixelType> wrong(Shape4(13, shape[0], shape[1], shape[2]));
+            bank.compute(src, wrong, opt);
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nPixelFeatureBank::compute(): feature array has wrong number of channels.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void test_featureBankIncremental()
+    {
+        typedef MultiArrayShape<3>::type Shape3;
+        MultiArrayShape<2>::type shape(60, 50);
+        MultiArray<2, PixelType> src(shape), ref(shape);
+        makeRandom(src);
+
+        PixelFeatureBank<2> bank;
+        double scales[] = { 0.7, 1.0, 2.0, 4.0 };
+        for(int k=0; k<4; ++k)
+            bank.add(FEATURE_GAUSSIAN_SMOOTHING, scales[k])
+                .add(FEATURE_LAPLACIAN_OF_GAUSSIAN, scales[k]);
+
+        // scale 2.0 is derived from 1.0, and 4.0 from 2.0 (the residual 
+        // between 0.7 and 1.0 is too small)
+        shouldEqual(bank.incrementalBaseScale(0.7), 0.0);
+        shouldEqual(bank.incrementalBaseScale(1.0), 0.0);
+        shouldEqual(bank.incrementalBaseScale(2.0), 1.0);
+        shouldEqual(bank.incrementalBaseScale(4.0), 2.0);
+        // with step size 2, the residual scale between 1.0 and 2.0 is only 0.87 pixels
+        shouldEqual(bank.incrementalBaseScale(2.0, ConvolutionOptions<2>().stepSize(1.0, 2.0)), 0.0);
+        
+        MultiArray<3, PixelType> features(Shape3(8, shape[0], shape[1])),
+                                 direct(Shape3(8, shape[0], shape[1]));
+        bank.compute(src, features);
+        bank.minimumIncrementalScale(NumericTraits<double>::max());
+        for(int k=0; k<4; ++k)
+            shouldEqual(bank.incrementalBaseScale(scales[k]), 0.0);
+        bank.compute(src, direct);
+        shouldEqual(bank.numberOfFilterPasses(), 20u);
+
+        for(int k=0; k<4; ++k)
+        {
+            gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), scales[k]);
+            should(maxDifference(direct.bindInner(2*k), ref) < 1e-5);
+            laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(ref), scales[k]);
+            should(maxDifference(direct.bindInner(2*k+1), ref) < 1e-5);
+        }
+        for(int k=0; k<4; ++k)
+            shouldEqualSequence(features.bindInner(k).begin(), features.bindInner(k).end(), direct.bindInner(k).begin());
+        should(maxDifference(features, direct) < 2e-3);
+    }
 };                //-- struct MultiArraySeparableConvolutionTest
 
 //--------------------------------------------------------
@@ -537,6 +938,12 @@ struct MultiArraySeparableConvolutionTestSuite
                 add( testCase( &MultiArraySeparableConvolutionTest::test_hessian ) );
                 add( testCase( &MultiArraySeparableConvolutionTest::test_structureTensor ) );
                 add( testCase( &MultiArraySeparableConvolutionTest::test_gradient_magnitude ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_parallel ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_scratchArena ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_tiles ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_recursive ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_featureBank ) );
+                add( testCase( &MultiArraySeparableConvolutionTest::test_featureBankIncremental ) );
     }
 }; // struct MultiArraySeparableConvolutionTestSuite
 
@@ -0,0 +1,303 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2012-2014 by Ullrich Koethe                */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+#include <iostream>
+#include <cstdio>
+#ifdef _WIN32
+  #include <direct.h>
+#else
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+#include "unittest.hxx"
+#include "vigra/multi_blockwise.hxx"
+#include "vigra/random.hxx"
+
+using namespace vigra;
+
+    // Copy the core and check the halo. The source's elements contain
+    // their scan-order index, so that the block's position can be determined.
+struct HaloCheckFunctor
+{
+    typedef MultiArrayShape<3>::type Shape;
+
+    Shape shape, halo;
+
+    void operator()(MultiArrayView<3, int, StridedArrayTag> const & src,
+                    MultiArrayView<3, int, StridedArrayTag> dest,
+                    Shape const & start, Shape const & stop) const
+    {
+        int i = src(0, 0, 0);
+        Shape outerStart(i % shape[0], (i / shape[0]) % shape[1], i / (shape[0]*shape[1])),
+              globalStart = outerStart + start,
+              globalStop  = outerStart + stop;
+        vigra_postcondition(dest.shape() == stop - start,
+            "HaloCheckFunctor: shape mismatch.");
+        for(int k=0; k<3; ++k)
+        {
+            // the halo is only clipped at the array border
+            vigra_postcondition(start[k] == std::min(halo[k], globalStart[k]) &&
+                                src.shape(k) - stop[k] == std::min(halo[k], shape[k] - globalStop[k]),
+                "HaloCheckFunctor: wrong halo.");
+        }
+        dest = src.subarray(start, stop);
+    }
+};
+
+struct BlockwiseTest
+{
+    typedef float PixelType;
+    typedef MultiArrayShape<3>::type Shape;
+    typedef MultiArray<3, PixelType> Array;
+    typedef TinyVector<PixelType, 3> VectorType;
+    typedef TinyVector<PixelType, 6> TensorType;
+
+    Shape shape;
+    Array src;
+    BlockwiseOptions<3> bopt;
+    ConvolutionOptions<3> opt;
+
+    BlockwiseTest()
+    : shape(45, 37, 30),
+      src(shape)
+    {
+        RandomMT19937 random(42);
+        for(int k=0; k<src.size(); ++k)
+            src[k] = (PixelType)random.uniform();
+        bopt.blockShape(Shape(16, 12, 20)).numThreads(4);
+        opt.stepSize(1.0, 1.5, 2.0);
+    }
+
+    template <class View1, class View2>
+    static double maxDifference(View1 const & a, View2 const & b)
+    {
+        typename View1::const_iterator i = a.begin();
+        typename View2::const_iterator j = b.begin();
+        double res = 0.0;
+        for(; i != a.end(); ++i, ++j)
+            res = std::max(res, (double)norm(*i - *j));
+        return res;
+    }
+
+    void testBlockwiseCaller()
+    {
+        MultiArray<3, int> in(shape), out(shape);
+        for(int k=0; k<in.size(); ++k)
+            in[k] = k;
+
+        HaloCheckFunctor f;
+        f.shape = shape;
+        f.halo = Shape(3, 0, 5);
+        blockwiseCaller(in, out, f, f.halo, bopt);
+        should(in == out);
+
+        // default block shape and number of threads
+        out.init(0);
+        blockwiseCaller(in, out, f, f.halo);
+        should(in == out);
+
+        try
+        {
+            MultiArray<3, int> wrong(Shape(45, 37, 31));
+            blockwiseCaller(in, wrong, f, f.halo);
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nblockwiseCaller(): shape mismatch between input and output.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+
+        try
+        {
+            blockwiseCaller(in, in, f, f.halo);
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nblockwiseCaller(): source and destination must not overlap.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testGaussianFilters()
+    {
+        double epsilon = 1e-6;
+        Array ref(shape), res(shape);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 2.0, opt);
+        gaussianSmoothMultiArray(src, res, 2.0, bopt, opt);
+        should(maxDifference(ref, res) < epsilon);
+
+        laplacianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 1.5, opt);
+        laplacianOfGaussianMultiArray(src, res, 1.5, bopt, opt);
+        should(maxDifference(ref, res) < epsilon);
+
+        MultiArray<3, VectorType> vref(shape), vres(shape);
+        gaussianGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vref), 1.5, opt);
+        gaussianGradientMultiArray(src, vres, 1.5, bopt, opt);
+        should(maxDifference(vref, vres) < epsilon);
+
+        symmetricGradientMultiArray(srcMultiArrayRange(src), destMultiArray(vref), opt);
+        symmetricGradientMultiArray(src, vres, bopt, opt);
+        should(maxDifference(vref, vres) < epsilon);
+
+        MultiArray<3, TensorType> tref(shape), tres(shape);
+        hessianOfGaussianMultiArray(srcMultiArrayRange(src), destMultiArray(tref), 1.5, opt);
+        hessianOfGaussianMultiArray(src, tres, 1.5, bopt, opt);
+        should(maxDifference(tref, tres) < epsilon);
+
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tref), 1.0, 2.5, opt);
+        structureTensorMultiArray(src, tres, 1.0, 2.5, bopt, opt);
+        should(maxDifference(tref, tres) < epsilon);
+
+        tensorEigenvaluesMultiArray(srcMultiArrayRange(tref), destMultiArray(vref));
+        tensorEigenvaluesMultiArray(tref, vres, bopt);
+        should(vref == vres);
+
+        tensorTraceMultiArray(srcMultiArrayRange(tref), destMultiArray(ref));
+        tensorTraceMultiArray(tref, res, bopt);
+        should(ref == res);
+
+        tensorDeterminantMultiArray(srcMultiArrayRange(tref), destMultiArray(ref));
+        tensorDeterminantMultiArray(tref, res, bopt);
+        should(ref == res);
+
+        // destination is a view
+        MultiArray<4, PixelType> channels(Shape4(2, shape[0], shape[1], shape[2]));
+        MultiArrayView<3, PixelType, StridedArrayTag> channel = channels.bindInner(1);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 2.0, opt);
+        gaussianSmoothMultiArray(src, channel, 2.0, bopt, opt);
+        should(maxDifference(ref, channel) < epsilon);
+
+        // recursive filters are approximated by a halo of 4*sigma
+        ConvolutionOptions<3> ropt(opt);
+        ropt.recursiveFilterThreshold(2.0);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 4.0, ropt);
+        gaussianSmoothMultiArray(src, res, 4.0, bopt, ropt);
+        should(maxDifference(ref, res) < 1e-4);
+    }
+
+    void testScratchArena()
+    {
+        double epsilon = 1e-6;
+        MultiArray<3, TensorType> tref(shape), tres(shape);
+        structureTensorMultiArray(srcMultiArrayRange(src), destMultiArray(tref), 1.0, 2.5, opt);
+
+        // concurrent blocks must not share the caller's arena
+        ScratchArena arena;
+        ConvolutionOptions<3> aopt(opt);
+        aopt.scratchArena(arena);
+        for(int k=0; k<3; ++k)
+        {
+            structureTensorMultiArray(src, tres, 1.0, 2.5, bopt, aopt);
+            should(maxDifference(tref, tres) < epsilon);
+        }
+        shouldEqual(arena.capacity(), 0u);
+        shouldEqual(arena.systemAllocations(), 0u);
+    }
+
+    void testChunkedArrays()
+    {
+        double epsilon = 1e-6;
+        Array ref(shape), res(shape);
+        gaussianSmoothMultiArray(srcMultiArrayRange(src), destMultiArray(ref), 2.0, opt);
+
+        ChunkedArrayLazy<3, PixelType> csrc(shape, Shape(8)), cres(shape, Shape(16));
+        csrc.commitSubarray(Shape(), src);
+
+        // chunked source
+        gaussianSmoothMultiArray(csrc, res, 2.0, bopt, opt);
+        should(maxDifference(ref, res) < epsilon);
+
+        // chunked destination, blocks default to the chunks
+        gaussianSmoothMultiArray(src, cres, 2.0, BlockwiseOptions<3>().numThreads(4), opt);
+        should(maxDifference(ref, cres.subarray(Shape(), shape)) < epsilon);
+
+        // chunks are loaded and evicted concurrently
+        std::string tmpdir("test_blockwise_chunks");
+#ifdef _WIN32
+        _mkdir(tmpdir.c_str());
+#else
+        mkdir(tmpdir.c_str(), 0777);
+#endif
+        {
+            ChunkedArrayDirectory<3, PixelType> dsrc(tmpdir, shape, Shape(8), ChunkedArrayOptions().cacheMax(4));
+            dsrc.commitSubarray(Shape(), src);
+            ChunkedArrayLazy<3, PixelType> dres(shape, Shape(8));
+            gaussianSmoothMultiArray(dsrc, dres, 2.0, bopt, opt);
+            should(maxDifference(ref, dres.subarray(Shape(), shape)) < epsilon);
+            should(dsrc.cacheSize() <= 4);
+
+            Shape chunkIndex, chunkEnd = dsrc.chunkArrayShape();
+            dsrc.releaseChunks(Shape(), shape, true);
+            do
+            {
+                std::remove(dsrc.chunkFileName(chunkIndex).c_str());
+            }
+            while(detail::incrementCoordinate(chunkIndex, Shape(), chunkEnd));
+        }
+#ifdef _WIN32
+        should(_rmdir(tmpdir.c_str()) == 0);
+#else
+        should(rmdir(tmpdir.c_str()) == 0);
+#endif
+    }
+};
+
+struct BlockwiseTestSuite
+: public vigra::test_suite
+{
+    BlockwiseTestSuite()
+    : vigra::test_suite("BlockwiseTestSuite")
+    {
+        add( testCase( &BlockwiseTest::testBlockwiseCaller ) );
+        add( testCase( &BlockwiseTest::testGaussianFilters ) );
+        add( testCase( &BlockwiseTest::testScratchArena ) );
+        add( testCase( &BlockwiseTest::testChunkedArrays ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    BlockwiseTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
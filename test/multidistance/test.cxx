@@ -41,6 +41,7 @@
 
 #include "vigra/multi_distance.hxx"
 #include "vigra/distancetransform.hxx"
+#include "vigra/random.hxx"
 
 using namespace vigra;
 
@@ -1151,6 +1152,79 @@ struct MultiDistanceTest
         separableMultiDistance(srcMultiArrayRange(img2), destMultiArray(res), true);
         shouldEqualSequence(res.begin(), res.end(), desired);
     }
+
+    void testFeatureTransform()
+    {
+        typedef TinyVector<MultiArrayIndex, 3> Feature;
+        typedef MultiArray<3, Feature> FeatureVolume;
+        
+        TinyVector<double, 3> pixelPitch(1.2, 1.0, 2.4);
+        MultiArrayShape<3>::type shape(WIDTH, HEIGHT, DEPTH);
+        
+        IntVolume labels(shape);
+        MersenneTwister random;
+        for(int k=1; k<=12; ++k)
+            labels[Feature(random.uniformInt(WIDTH), random.uniformInt(HEIGHT), random.uniformInt(DEPTH))] = k;
+        
+        DoubleVolume distSquared(shape);
+        separableMultiDistSquared(srcMultiArrayRange(labels), destMultiArray(distSquared),
+                                  true, pixelPitch);
+        
+        FeatureVolume features(shape), features4(shape), offsets(shape);
+        separableMultiFeatureTransform(labels, features, true, pixelPitch);
+        separableMultiFeatureTransform(labels, features4, true, pixelPitch, 4);
+        separableMultiVectorDistance(labels, offsets, true, pixelPitch, 3);
+        
+        should(features == features4);
+        
+        for(int z=0; z<DEPTH; ++z)
+            for(int y=0; y<HEIGHT; ++y)
+                for(int x=0; x<WIDTH; ++x)
+                {
+                    Feature p(x, y, z), q = features(x, y, z);
+                    
+                    // the nearest point must be an object point ...
+                    should(labels[q] != 0);
+                    if(labels(x, y, z) != 0)
+                        shouldEqual(q, p);
+                    
+                    // ... at minimal distance
+                    double desired = NumericTraits<double>::max();
+                    for(MultiArrayIndex k=0; k<labels.size(); ++k)
+                    {
+                        if(labels[k] == 0)
+                            continue;
+                        Feature o = labels.scanOrderIndexToCoordinate(k);
+                        desired = std::min(desired, (pixelPitch*(o - p)).squaredMagnitude());
+                    }
+                    shouldEqualTolerance((pixelPitch*(q - p)).squaredMagnitude(), desired, 1e-10);
+                    shouldEqualTolerance(distSquared(x, y, z), desired, 1e-10);
+                    
+                    shouldEqual(offsets(x, y, z), q - p);
+                }
+        
+        // background == false: the zero elements are the object points
+        MultiArray<2, TinyVector<MultiArrayIndex, 2> > features2D(img2.shape());
+        Double2DArray inverted(img2.shape());
+        for(MultiArrayIndex k=0; k<img2.size(); ++k)
+            inverted[k] = img2[k] == 0.0 ? 1.0 : 0.0;
+        separableMultiVectorDistance(inverted, features2D, false);
+        for(int x=0; x<7; ++x)
+            shouldEqual(features2D(x, 0), (TinyVector<MultiArrayIndex, 2>(3 - x, 0)));
+        
+        try
+        {
+            IntVolume empty(shape);
+            separableMultiFeatureTransform(empty, features, true);
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nseparableMultiFeatureTransform(): the array contains no object points.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
 };
 
 
@@ -1166,6 +1240,7 @@ struct SimpleAnalysisTestSuite
         add( testCase( &MultiDistanceTest::testDistanceVolumesAnisoptopic));
         add( testCase( &MultiDistanceTest::distanceTransform2DCompare));
         add( testCase( &MultiDistanceTest::distanceTest1D));
+        add( testCase( &MultiDistanceTest::testFeatureTransform));
     }
 };
 
@@ -37,6 +37,7 @@
 #include "unittest.hxx"
 #include "vigra/stdimage.hxx"
 #include "vigra/multi_morphology.hxx"
+#include "vigra/random.hxx"
 #include "vigra/linear_algebra.hxx"
 #include "vigra/matrix.hxx"
 
@@ -283,6 +284,95 @@ struct MultiMorphologyTest
         multiGrayscaleDilation(srcMultiArrayRange(tmp), destMultiArray(res),2);
     }
     
+    template <class Array>
+    static void boxMorphologyBruteForce(Array const & in, Array & out, 
+                                        typename Array::difference_type const & radius, bool dilation)
+    {
+        typedef typename Array::difference_type Shape;
+        typedef typename Array::value_type Value;
+        for(MultiArrayIndex k=0; k<in.size(); ++k)
+        {
+            Shape p = in.scanOrderIndexToCoordinate(k);
+            Value v = in[p];
+            for(MultiArrayIndex l=0; l<in.size(); ++l)
+            {
+                Shape q = in.scanOrderIndexToCoordinate(l);
+                bool inside = true;
+                for(int d=0; d<(int)Shape::static_size; ++d)
+                    if(std::abs(q[d] - p[d]) > radius[d])
+                        inside = false;
+                if(inside)
+                    v = dilation
+                           ? std::max(v, in[q])
+                           : std::min(v, in[q]);
+            }
+            out[p] = v;
+        }
+    }
+
+    void boxMorphologyTest()
+    {
+        typedef vigra::MultiArray<3, UInt8> UInt8Volume;
+        typedef UInt8Volume::difference_type Shape;
+        
+        UInt8Volume in(Shape(23, 17, 11));
+        MersenneTwister random;
+        for(MultiArrayIndex k=0; k<in.size(); ++k)
+            in[k] = random.uniformInt(256);
+            
+        Shape radii[] = { Shape(2, 0, 1), Shape(0, 3, 0), Shape(4, 3, 6), Shape(30, 1, 20), Shape(0, 0, 0) };
+        for(int r=0; r<5; ++r)
+        {
+            UInt8Volume erosion(in.shape()), dilation(in.shape()), 
+                        res(in.shape()), res3(in.shape()), tmp(in.shape());
+            boxMorphologyBruteForce(in, erosion, radii[r], false);
+            boxMorphologyBruteForce(in, dilation, radii[r], true);
+            
+            multiBoxErosion(in, res, radii[r]);
+            multiBoxErosion(in, res3, radii[r], 3);
+            should(res == erosion);
+            should(res3 == erosion);
+            
+            multiBoxDilation(in, res, radii[r]);
+            multiBoxDilation(in, res3, radii[r], 3);
+            should(res == dilation);
+            should(res3 == dilation);
+            
+            boxMorphologyBruteForce(erosion, tmp, radii[r], true);
+            multiBoxOpening(in, res, radii[r], 2);
+            should(res == tmp);
+            
+            boxMorphologyBruteForce(dilation, tmp, radii[r], false);
+            multiBoxClosing(in, res, radii[r], 2);
+            should(res == tmp);
+        }
+        
+        // in-place operation and scalar radius
+        UInt8Volume erosion(in.shape()), res(in);
+        boxMorphologyBruteForce(in, erosion, Shape(2), false);
+        multiBoxErosion(res, res, 2, 4);
+        should(res == erosion);
+        
+        // huge radii are clamped to the line length (no huge line buffers)
+        Shape huge(1000000000, 2, 1000000000);
+        boxMorphologyBruteForce(in, erosion, huge, false);
+        multiBoxErosion(in, res, huge, 2);
+        should(res == erosion);
+        
+        // type conversion and negative values
+        vigra::MultiArray<2, float> fimg(img2), fres(img2.shape()), fdesired(img2.shape());
+        fimg *= -0.5f;
+        multiBoxDilation(img2, fres, IntImage::difference_type(1, 2));
+        fres *= -0.5f;
+        boxMorphologyBruteForce(fimg, fdesired, IntImage::difference_type(1, 2), false);
+        shouldEqualSequence(fres.begin(), fres.end(), fdesired.begin());
+        
+        static const int desired1D[] = {0, 0, 1, 1, 1, 0, 0};
+        IntImage lres(lin.shape());
+        multiBoxErosion(lin, lres, IntImage::difference_type(1, 0));
+        shouldEqualSequence(lres.begin(), lres.end(), desired1D);
+    }
+    
     IntImage img, img2, lin;
     IntVolume vol;
 };
@@ -302,6 +392,7 @@ struct MorphologyTestSuite
         add( testCase( &MultiMorphologyTest::grayDilationTest2D));
         add( testCase( &MultiMorphologyTest::grayErosionAndDilationTest2D));
         add( testCase( &MultiMorphologyTest::grayClosingTest2D));
+        add( testCase( &MultiMorphologyTest::boxMorphologyTest));
     }
 };
 
@@ -63,6 +63,7 @@
 //#include <vigra/random.hxx>
 //#include <vigra/convolution.hxx>
 #include <vigra/accumulator.hxx>
+#include <vigra/region_adjacency_graph.hxx>
 
 namespace std {
 
@@ -1413,6 +1414,171 @@ struct AccumulatorTest
     }
 };
 
+struct RegionAdjacencyGraphTest
+{
+    void testGraph()
+    {
+        using namespace vigra::acc;
+
+        int labelData[] = { 1, 1, 2, 2,
+                            1, 3, 3, 2,
+                            4, 4, 3, 2 };
+        MultiArrayView<2, int> labels(Shape2(4, 3), labelData);
+        MultiArray<2, double> data(labels.shape());
+        for(int y=0; y<3; ++y)
+            for(int x=0; x<4; ++x)
+                data(x, y) = x + 10*y;
+
+        RegionAdjacencyGraph<int> rag(labels);
+
+        shouldEqual(rag.nodeCount(), 5);
+        shouldEqual(rag.edgeCount(), 5);
+        int edgeData[] = { 1, 2,  1, 3,  1, 4,  2, 3,  3, 4 };
+        for(int e=0; e<5; ++e)
+        {
+            shouldEqual(rag.u(e), edgeData[2*e]);
+            shouldEqual(rag.v(e), edgeData[2*e+1]);
+            shouldEqual(rag.findEdge(rag.u(e), rag.v(e)), e);
+            shouldEqual(rag.findEdge(rag.v(e), rag.u(e)), e);
+        }
+        shouldEqual(rag.findEdge(2, 4), -1);
+        shouldEqual(rag.findEdge(0, 1), -1);
+        shouldEqual(rag.degree(0), 0);
+        shouldEqual(rag.degree(3), 3);
+        int neighbors3[] = { 1, 2, 4 }, edges3[] = { 1, 3, 4 };
+        shouldEqualSequence(rag.neighborsBegin(3), rag.neighborsEnd(3), neighbors3);
+        shouldEqualSequence(rag.edgesBegin(3), rag.edgesEnd(3), edges3);
+        for(int k=0; k<3; ++k)
+        {
+            shouldEqual(rag.neighbor(3, k), neighbors3[k]);
+            shouldEqual(rag.incidentEdge(3, k), edges3[k]);
+        }
+
+        typedef AccumulatorChain<double, Select<Count, Mean, Minimum, Maximum> > A;
+        ArrayVector<A> nodes, edges;
+        extractRegionAdjacencyFeatures(rag, labels, data, nodes, edges);
+
+        shouldEqual(nodes.size(), 5u);
+        shouldEqual(edges.size(), 5u);
+        shouldEqual(get<Count>(nodes[0]), 0.0);
+        shouldEqual(get<Count>(nodes[3]), 3.0);
+        shouldEqual(get<Mean>(nodes[3]), 15.0);
+        // edge 1-4: face (0,1)-(0,2)
+        shouldEqual(get<Count>(edges[2]), 2.0);
+        shouldEqual(get<Mean>(edges[2]), 15.0);
+        // edge 2-3: faces (2,1)-(3,1), (2,2)-(3,2), (2,0)-(2,1)
+        shouldEqual(get<Count>(edges[3]), 6.0);
+        shouldEqual(get<Minimum>(edges[3]), 2.0);
+        shouldEqual(get<Maximum>(edges[3]), 23.0);
+
+        try
+        {
+            ArrayVector<A> wrongSize(3);
+            extractRegionAdjacencyFeatures(rag, labels, data, wrongSize, edges);
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nextractRegionAdjacencyFeatures(): feature arrays must have the size of the graph.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testParallel()
+    {
+        using namespace vigra::acc;
+
+        // random blobs with values in [0, 1]
+        Shape3 shape(23, 19, 17);
+        MultiArray<3, UInt32> labels(shape);
+        MultiArray<3, float> data(shape);
+        srand(7);
+        for(int z=0; z<shape[2]; ++z)
+            for(int y=0; y<shape[1]; ++y)
+                for(int x=0; x<shape[0]; ++x)
+                {
+                    labels(x,y,z) = (x / 5) + 5*(y / 6) + 20*(z / 7) + (rand() % 10 == 0 ? 1 : 0);
+                    data(x,y,z) = (rand() % 101) / 100.0f;
+                }
+
+        UInt32 minLabel, maxLabel;
+        labels.minmax(&minLabel, &maxLabel);
+
+        // brute force reference
+        typedef std::pair<UInt32, UInt32> Edge;
+        std::map<Edge, ArrayVector<float> > reference;
+        for(int z=0; z<shape[2]; ++z)
+            for(int y=0; y<shape[1]; ++y)
+                for(int x=0; x<shape[0]; ++x)
+                    for(int k=0; k<3; ++k)
+                    {
+                        Shape3 p(x,y,z), q(p);
+                        ++q[k];
+                        if(q[k] == shape[k] || labels[p] == labels[q])
+                            continue;
+                        ArrayVector<float> & values = reference[Edge(std::min(labels[p], labels[q]), 
+                                                                     std::max(labels[p], labels[q]))];
+                        values.push_back(data[p]);
+                        values.push_back(data[q]);
+                    }
+
+        typedef AccumulatorChain<float, Select<Count, Mean, Minimum, Maximum, 
+                                               StandardQuantiles<UserRangeHistogram<100> > > > A;
+        typedef AccumulatorChain<float, Select<Count, Mean, Central<PowerSum<3> > > > B;
+        typedef AccumulatorChain<float, Select<Count, Mean> > C;
+
+        for(int threads=1; threads<=4; threads+=3)
+        {
+            RegionAdjacencyGraph<UInt32> rag(labels, ParallelOptions().numThreads(threads));
+            shouldEqual(rag.nodeCount(), (std::ptrdiff_t)maxLabel + 1);
+            shouldEqual(rag.edgeCount(), (std::ptrdiff_t)reference.size());
+
+            ArrayVector<C> nodes;
+            ArrayVector<A> edges(rag.edgeCount());
+            for(int e=0; e<rag.edgeCount(); ++e)
+                edges[e].setHistogramOptions(HistogramOptions().setMinMax(0.0, 1.0));
+            ArrayVector<B> multipassNodes, multipassEdges;
+            shouldEqual(B().passesRequired(), 2u);
+            extractRegionAdjacencyFeatures(rag, labels, data, nodes, edges, 
+                                           ParallelOptions().numThreads(threads));
+            extractRegionAdjacencyFeatures(rag, labels, data, multipassNodes, multipassEdges, 
+                                           ParallelOptions().numThreads(threads));
+
+            std::map<Edge, ArrayVector<float> >::iterator r = reference.begin();
+            for(int e=0; e<rag.edgeCount(); ++e, ++r)
+            {
+                shouldEqual(rag.u(e), r->first.first);
+                shouldEqual(rag.v(e), r->first.second);
+                ArrayVector<float> & values = r->second;
+                std::sort(values.begin(), values.end());
+                shouldEqual(get<Count>(edges[e]), (double)values.size());
+                shouldEqual(get<Minimum>(edges[e]), values.front());
+                shouldEqual(get<Maximum>(edges[e]), values.back());
+                shouldEqual(get<StandardQuantiles<UserRangeHistogram<100> > >(edges[e])[0], values.front());
+                shouldEqual(get<StandardQuantiles<UserRangeHistogram<100> > >(edges[e])[6], values.back());
+                shouldEqual(get<Count>(multipassEdges[e]), (double)values.size());
+                double sum = 0.0, sum3 = 0.0;
+                for(unsigned int k=0; k<values.size(); ++k)
+                    sum += values[k];
+                double mean = sum / values.size();
+                for(unsigned int k=0; k<values.size(); ++k)
+                    sum3 += std::pow(values[k] - mean, 3);
+                shouldEqualTolerance(get<Mean>(edges[e]), mean, 1e-6);
+                shouldEqualTolerance(get<Central<PowerSum<3> > >(multipassEdges[e]), sum3, 1e-5);
+            }
+
+            double totalCount = 0.0;
+            for(int n=0; n<rag.nodeCount(); ++n)
+            {
+                totalCount += get<Count>(nodes[n]);
+                shouldEqual(get<Count>(nodes[n]), get<Count>(multipassNodes[n]));
+            }
+            shouldEqual(totalCount, (double)labels.size());
+        }
+    }
+};
+
 struct FeaturesTestSuite : public vigra::test_suite
 {
     FeaturesTestSuite()
@@ -1427,6 +1593,8 @@ struct FeaturesTestSuite : public vigra::test_suite
         add(testCase(&AccumulatorTest::testHistogram));
         add(testCase(&AccumulatorTest::testLabelDispatch));
         add(testCase(&AccumulatorTest::testIndexSpecifiers));
+        add(testCase(&RegionAdjacencyGraphTest::testGraph));
+        add(testCase(&RegionAdjacencyGraphTest::testParallel));
     }
 };
 
@@ -277,6 +277,105 @@ struct SeededRegionGrowing3DTest
 
     }
 
+    void voronoiBucketQueueTest()
+    {
+        // distvol1 and distvol2 contain squared distances, i.e. integer costs
+        DoubleVolume res(vol2);
+
+        vigra::ArrayOfRegionStatistics<DirectCostFunctor> cost(2);
+        seededRegionGrowing3D(srcMultiArrayRange(distvol2), srcMultiArray(vol2),
+                              destMultiArray(res), cost, CompleteGrow, 
+                              NeighborCode3DSix(), NumericTraits<double>::max(), 16);
+
+        // The cost of a candidate is its own distvol2 value, whichever region it
+        // is adjacent to, so ties are decided by the order of insertion into the 
+        // queue, not by the distance to the seeds as in the heap-based algorithm.
+        // The front of region 2 reaches (2,2,1) first, and the front of region 1 
+        // reaches (1,1,2) first, although the other seed is nearer in both cases 
+        // (the heap assigns them to region 1 and 2 respectively).
+        static const double reference[] = { 1.0, 1.0, 1.0, 1.0, 
+                                            1.0, 1.0, 1.0, 1.0, 
+                                            1.0, 1.0, 1.0, 1.0,  
+                                            1.0, 1.0, 1.0, 1.0,
+
+                                            1.0, 1.0, 1.0, 1.0,  
+                                            1.0, 1.0, 1.0, 1.0,  
+                                            1.0, 1.0, 2.0, 2.0,  
+                                            1.0, 1.0, 2.0, 2.0,
+
+                                            1.0, 1.0, 2.0, 2.0,  
+                                            1.0, 1.0, 2.0, 2.0,  
+                                            2.0, 2.0, 2.0, 2.0,  
+                                            2.0, 2.0, 2.0, 2.0,
+
+                                            2.0, 2.0, 2.0, 2.0, 
+                                            2.0, 2.0, 2.0, 2.0, 
+                                            2.0, 2.0, 2.0, 2.0,  
+                                            2.0, 2.0, 2.0, 2.0};
+        shouldEqualSequence(res.begin(), res.end(), reference);
+
+        // the contour is on the plateau z == 2 and must be the same as with the heap
+        IntVolume desired(vol1), border(vol1);
+        seededRegionGrowing3D(srcMultiArrayRange(distvol1), srcMultiArray(vol1),
+                              destMultiArray(desired), cost, KeepContours);
+        seededRegionGrowing3D(srcMultiArrayRange(distvol1), srcMultiArray(vol1),
+                              destMultiArray(border), cost, KeepContours, 
+                              NeighborCode3DSix(), NumericTraits<double>::max(), 16);
+        shouldEqualSequence(border.begin(), border.end(), desired.begin());
+
+        // stop at threshold: only voxels with cost <= 2 are assigned
+        seededRegionGrowing3D(srcMultiArrayRange(distvol1), srcMultiArray(vol1),
+                              destMultiArray(border), cost, StopAtThreshold, 
+                              NeighborCode3DSix(), 2.0, 16);
+        for(int z=0; z<5; ++z)
+            for(int y=0; y<5; ++y)
+                for(int x=0; x<5; ++x)
+                    shouldEqual(border(x,y,z) != 0, distvol1(x,y,z) <= 2.0);
+
+        // the threshold is compared with the cost, not with its bucket
+        DoubleVolume halfvol(distvol1);
+        halfvol += 0.5;
+        seededRegionGrowing3D(srcMultiArrayRange(halfvol), srcMultiArray(vol1),
+                              destMultiArray(border), cost, StopAtThreshold, 
+                              NeighborCode3DSix(), 2.0, 16);
+        for(int z=0; z<5; ++z)
+            for(int y=0; y<5; ++y)
+                for(int x=0; x<5; ++x)
+                    shouldEqual(border(x,y,z) != 0, halfvol(x,y,z) <= 2.0);
+
+        // bucket 2 receives the costs 2.8 (distvol1 == 4, inserted first) and 2.1 
+        // (distvol1 == 3): the candidates above the threshold must be skipped without 
+        // stopping, as long as the bucket may still contain cheaper candidates
+        DoubleVolume scaledvol(distvol1);
+        scaledvol *= 0.7;
+        seededRegionGrowing3D(srcMultiArrayRange(scaledvol), srcMultiArray(vol1),
+                              destMultiArray(desired), cost, StopAtThreshold, 
+                              NeighborCode3DSix(), 2.5);
+        seededRegionGrowing3D(srcMultiArrayRange(scaledvol), srcMultiArray(vol1),
+                              destMultiArray(border), cost, StopAtThreshold, 
+                              NeighborCode3DSix(), 2.5, 16);
+        shouldEqualSequence(border.begin(), border.end(), desired.begin());
+        for(int z=0; z<5; ++z)
+            for(int y=0; y<5; ++y)
+                for(int x=0; x<5; ++x)
+                    shouldEqual(border(x,y,z) != 0, scaledvol(x,y,z) <= 2.5);
+
+        // costs outside the bucket range are detected
+        try
+        {
+            seededRegionGrowing3D(srcMultiArrayRange(distvol1), srcMultiArray(vol1),
+                                  destMultiArray(border), cost, CompleteGrow, 
+                                  NeighborCode3DSix(), NumericTraits<double>::max(), 8);
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nseededRegionGrowing(): cost must be in the range");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
     void simpleTest()
     {
         IntVolume res(vol3);
@@ -306,6 +405,7 @@ struct SeededRegionGrowing3DTestSuite
         add( testCase( &SeededRegionGrowing3DTest::voronoiTest));
         add( testCase( &SeededRegionGrowing3DTest::voronoiTestWithBorder));
         add( testCase( &SeededRegionGrowing3DTest::simpleTest));
+        add( testCase( &SeededRegionGrowing3DTest::voronoiBucketQueueTest));
     }
 };
 
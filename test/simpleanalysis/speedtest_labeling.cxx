@@ -0,0 +1,127 @@
+/************************************************************************/
+/*                                                                      */
+/*                 Copyright 2014 by Ullrich Koethe                     */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+
+// Compares the run-based labeling of 8-bit images in labelImageWithBackground()
+// with the pixel-based algorithm used for all other pixel types.
+
+#include <iostream>
+#include <functional>
+#include "unittest.hxx"
+#include "vigra/stdimage.hxx"
+#include "vigra/labelimage.hxx"
+#include "vigra/random.hxx"
+#include "vigra/timing.hxx"
+
+using namespace vigra;
+
+struct LabelingSpeedTest
+{
+    BImage binary, blobs;
+    int repetitions;
+
+    LabelingSpeedTest()
+    : binary(2000, 2000),
+      blobs(2000, 2000),
+      repetitions(5)
+    {
+        // white noise: many small regions
+        MersenneTwister random;
+        for(BImage::ScanOrderIterator i = binary.begin(); i != binary.end(); ++i)
+            *i = random.uniformInt(2);
+
+        // discs: few large regions
+        for(int y=0; y<blobs.height(); ++y)
+            for(int x=0; x<blobs.width(); ++x)
+                blobs(x, y) = ((x % 100 - 50)*(x % 100 - 50) + (y % 100 - 50)*(y % 100 - 50)) < 1600
+                                   ? 1
+                                   : 0;
+    }
+
+    template <class Equal>
+    double run(BImage const & in, IImage & labels, bool eight_neighbors, Equal equal, unsigned int & count)
+    {
+        USETICTOC;
+        TIC;
+        for(int k=0; k<repetitions; ++k)
+            count = labelImageWithBackground(srcImageRange(in), destImage(labels), 
+                                             eight_neighbors, 0, equal);
+        return TOCN / repetitions;
+    }
+
+    void compare(const char * name, BImage const & in, bool eight_neighbors)
+    {
+        IImage pixelwise(in.size()), runs(in.size());
+        unsigned int pixelwiseCount = 0, runsCount = 0;
+        // any functor but std::equal_to<UInt8> selects the pixel-based algorithm
+        double t_pixelwise = run(in, pixelwise, eight_neighbors, std::equal_to<int>(), pixelwiseCount),
+               t_runs      = run(in, runs, eight_neighbors, std::equal_to<UInt8>(), runsCount);
+
+        shouldEqual(runsCount, pixelwiseCount);
+        shouldEqualSequence(runs.begin(), runs.end(), pixelwise.begin());
+        std::cout << "    " << name << (eight_neighbors ? ", 8-neighborhood" : ", 4-neighborhood") 
+                  << " (" << runsCount << " regions):\n"
+                  << "        pixel-based: " << t_pixelwise << " msec\n"
+                  << "        run-based:   " << t_runs << " msec\n"
+                  << "        speed-up:    " << t_pixelwise / t_runs << std::endl;
+    }
+
+    void testSpeed()
+    {
+        compare("random binary", binary, false);
+        compare("random binary", binary, true);
+        compare("discs", blobs, false);
+        compare("discs", blobs, true);
+    }
+};
+
+struct LabelingSpeedTestSuite
+: public vigra::test_suite
+{
+    LabelingSpeedTestSuite()
+    : vigra::test_suite("LabelingSpeedTestSuite")
+    {
+        add( testCase( &LabelingSpeedTest::testSpeed ) );
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    LabelingSpeedTestSuite test;
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+    std::cout << test.report() << std::endl;
+
+    return (failed != 0);
+}
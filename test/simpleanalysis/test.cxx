@@ -51,6 +51,7 @@
 #include "vigra/affinegeometry.hxx"
 #include "vigra/affine_registration.hxx"
 #include "vigra/impex.hxx"
+#include "vigra/random.hxx"
 
 #ifdef HasFFTW3
 # include "vigra/slanted_edge_mtf.hxx"
@@ -328,6 +329,59 @@ struct LabelingTest
         }
     }
 
+    void labelingParallelTest()
+    {
+        IImage in(61, 47), desired(in.size()), res(in.size());
+        MersenneTwister random;
+        for(IImage::ScanOrderIterator i = in.begin(); i != in.end(); ++i)
+            *i = random.uniformInt(3);
+            
+        int threads[] = { 2, 3, 5, 8, 64 };
+        for(int t=0; t<5; ++t)
+        {
+            ParallelOptions opt = ParallelOptions().numThreads(threads[t]);
+            for(int eight=0; eight<2; ++eight)
+            {
+                unsigned int count = labelImage(srcImageRange(in), destImage(desired), eight == 1);
+                shouldEqual(labelImage(srcImageRange(in), destImage(res), eight == 1, opt), count);
+                shouldEqualSequence(res.begin(), res.end(), desired.begin());
+                
+                count = labelImageWithBackground(srcImageRange(in), destImage(desired), eight == 1, 0);
+                shouldEqual(labelImageWithBackground(srcImageRange(in), destImage(res), eight == 1, 0, opt), count);
+                shouldEqualSequence(res.begin(), res.end(), desired.begin());
+            }
+        }
+    }
+
+    void labelingRunsTest()
+    {
+        // BImage uses the run-based algorithm, std::equal_to<int> the pixel-based one
+        BImage in(61, 47);
+        IImage desired(in.size()), res(in.size());
+        MersenneTwister random;
+        for(int k=0; k<2; ++k)
+        {
+            for(BImage::ScanOrderIterator i = in.begin(); i != in.end(); ++i)
+                *i = (k == 0)
+                        ? random.uniformInt(3)         // multi-valued
+                        : random.uniformInt(5) < 3;    // binary mask
+            for(int eight=0; eight<2; ++eight)
+            {
+                desired.init(-1);
+                res.init(-1);
+                unsigned int count = labelImageWithBackground(srcImageRange(in), destImage(desired), 
+                                                              eight == 1, 0, std::equal_to<int>());
+                shouldEqual(labelImageWithBackground(srcImageRange(in), destImage(res), eight == 1, 0), count);
+                shouldEqualSequence(res.begin(), res.end(), desired.begin());
+                
+                count = labelImageWithBackground(srcImageRange(in), destImage(desired), 
+                                                 eight == 1, 1, std::equal_to<int>());
+                shouldEqual(labelImageWithBackground(srcImageRange(in), destImage(res), eight == 1, 1), count);
+                shouldEqualSequence(res.begin(), res.end(), desired.begin());
+            }
+        }
+    }
+
     void labelingFourWithBackgroundTest2()
     {
         Image res(img4);
@@ -788,6 +842,74 @@ struct DistanceTransformTest
         }
     }
 
+    void euclideanDistanceTransformTest()
+    {
+        int w = 150, h = 70;
+        vigra::BImage mask(w, h);
+        vigra::RandomMT19937 random(42);
+        for(vigra::BImage::iterator i = mask.begin(); i != mask.end(); ++i)
+            *i = random.uniformInt(500) == 0;
+        
+        vigra::TinyVector<double, 2> pitch(0.5, 2.0);
+        Image ref(w, h), res(w, h);
+        for(int y=0; y<h; ++y)
+        {
+            for(int x=0; x<w; ++x)
+            {
+                double best = vigra::NumericTraits<double>::max();
+                for(int yy=0; yy<h; ++yy)
+                    for(int xx=0; xx<w; ++xx)
+                        if(mask(xx, yy) != 0)
+                            best = std::min(best, vigra::sq(pitch[0]*(x-xx)) + vigra::sq(pitch[1]*(y-yy)));
+                ref(x, y) = std::sqrt(best);
+            }
+        }
+        
+        for(int n=1; n<=4; n+=3)
+        {
+            res = -1.0;
+            euclideanDistanceTransform(srcImageRange(mask), destImage(res), 0, pitch, n);
+            shouldEqualSequenceTolerance(res.begin(), res.end(), ref.begin(), 1e-12);
+        }
+        
+        // column distances in a separate image (the destination is accessed via 
+        // a vector component) and in place (UInt32 destination)
+        vigra::FVector2Image vres(w, h);
+        euclideanDistanceTransform(srcImageRange(mask), 
+            destImage(vres, vigra::VectorComponentValueAccessor<vigra::FVector2Image::value_type>(1)), 0, pitch);
+        for(int y=0; y<h; ++y)
+            for(int x=0; x<w; ++x)
+                shouldEqualTolerance(vres(x, y)[1], ref(x, y), 1e-6);
+        vigra::UInt32Image ires(w, h);
+        euclideanDistanceTransform(srcImageRange(mask), destImage(ires), 0, pitch);
+        for(int y=0; y<h; ++y)
+            for(int x=0; x<w; ++x)
+                shouldEqual(ires(x, y), (vigra::UInt32)(ref(x, y) + 0.5));
+        
+        // unit pitch is the same as distanceTransform() with the L2 norm
+        Image l2(w, h);
+        euclideanDistanceTransform(srcImageRange(mask), destImage(res), 0);
+        distanceTransform(srcImageRange(mask), destImage(l2), 0, 2);
+        shouldEqualSequence(res.begin(), res.end(), l2.begin());
+        for(int y=0; y<h; ++y)
+        {
+            for(int x=0; x<w; ++x)
+            {
+                double best = vigra::NumericTraits<double>::max();
+                for(int yy=0; yy<h; ++yy)
+                    for(int xx=0; xx<w; ++xx)
+                        if(mask(xx, yy) != 0)
+                            best = std::min(best, double(vigra::sq(x-xx) + vigra::sq(y-yy)));
+                shouldEqualTolerance(res(x, y), std::sqrt(best), 1e-12);
+            }
+        }
+        
+        // no objects: all pixels get the image diagonal
+        mask = 0;
+        euclideanDistanceTransform(srcImageRange(mask), destImage(res), 0, pitch);
+        shouldEqualTolerance(res(0, 0), std::sqrt(vigra::sq(0.5*w) + vigra::sq(2.0*h)), 1e-12);
+        shouldEqualTolerance(res(w-1, h-1), res(0, 0), 1e-12);
+    }
 
     Image img;
 };
@@ -1466,6 +1588,15 @@ struct WatershedsTest
         shouldEqual(5, count);
         shouldEqualSequence(res.begin(), res.end(), desiredTRG);
 
+        // the turbo algorithm uses the bucket queue variant of seededRegionGrowing() for contours
+        res.init(0);
+        count = watershedsRegionGrowing(srcImageRange(img), destImage(res),
+                                        WatershedOptions().keepContours().turboAlgorithm()
+                                          .seedOptions(SeedOptions().extendedMinima()));
+
+        shouldEqual(5, count);
+        shouldEqualSequence(res.begin(), res.end(), desiredRGC);
+
 #if 0
         std::cerr << count << "\n";
         for(int y=0;y<9;++y)
@@ -1691,6 +1822,48 @@ struct RegionGrowingTest
         shouldEqualSequence(res.begin(), res.end(), reference);
     }
 
+    void bucketQueueTest()
+    {
+        // squared distances to the seeds are integer costs
+        Image sqdist(img.size()), res(img.size());
+        for(int y=0; y<7; ++y)
+            for(int x=0; x<7; ++x)
+                sqdist(x,y) = std::min(sq(2.0 - x) + sq(2.0 - y), sq(5.0 - x) + sq(5.0 - y));
+
+        vigra::ArrayOfRegionStatistics<DirectCostFunctor> cost(2);
+        shouldEqual(seededRegionGrowing(srcImageRange(sqdist), srcImage(seeds), destImage(res), 
+                                        cost, CompleteGrow, FourNeighborCode(), 
+                                        NumericTraits<double>::max(), 64), 2);
+
+        // the pixels on the diagonal x + y == 7 have the same distance to both 
+        // seeds, i.e. they are ties. With FIFO order, they go to region 1, whose 
+        // candidates are inserted first (its seed comes first in scan order)
+        Image::value_type completeReference[] = {
+            1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 2,
+            1, 1, 1, 1, 1, 2, 2,
+            1, 1, 1, 1, 2, 2, 2,
+            1, 1, 1, 2, 2, 2, 2,
+            1, 1, 2, 2, 2, 2, 2
+        };
+        shouldEqualSequence(res.begin(), res.end(), completeReference);
+
+        Image::value_type reference[] = {
+            1, 1, 1, 1, 1, 1, 1,
+            1, 1, 1, 1, 1, 1, 0,
+            1, 1, 1, 1, 1, 0, 2,
+            1, 1, 1, 1, 0, 2, 2,
+            1, 1, 1, 0, 2, 2, 2,
+            1, 1, 0, 2, 2, 2, 2,
+            1, 0, 2, 2, 2, 2, 2
+        };
+        seededRegionGrowing(srcImageRange(sqdist), srcImage(seeds), destImage(res), 
+                            cost, KeepContours, FourNeighborCode(), 
+                            NumericTraits<double>::max(), 64);
+        shouldEqualSequence(res.begin(), res.end(), reference);
+    }
+
     Image img, seeds;
 };
 
@@ -2178,6 +2351,8 @@ struct SimpleAnalysisTestSuite
         add( testCase( &LabelingTest::labelingFourWithBackgroundTest1));
         add( testCase( &LabelingTest::labelingFourWithBackgroundTest2));
         add( testCase( &LabelingTest::labelingEightWithBackgroundTest));
+        add( testCase( &LabelingTest::labelingParallelTest));
+        add( testCase( &LabelingTest::labelingRunsTest));
         add( testCase( &EdgeDetectionTest::edgeDetectionTest));
         add( testCase( &EdgeDetectionTest::edgeToCrackEdgeTest));
         add( testCase( &EdgeDetectionTest::removeShortEdgesTest));
@@ -2190,6 +2365,7 @@ struct SimpleAnalysisTestSuite
         add( testCase( &DistanceTransformTest::distanceTransformL1Test));
         add( testCase( &DistanceTransformTest::distanceTransformL2Test));
         add( testCase( &DistanceTransformTest::distanceTransformLInfTest));
+        add( testCase( &DistanceTransformTest::euclideanDistanceTransformTest));
 
         add( testCase( &LocalMinMaxTest::localMinimumTest));
         add( testCase( &LocalMinMaxTest::localMinimum4Test));
@@ -2214,6 +2390,7 @@ struct SimpleAnalysisTestSuite
         add( testCase( &WatershedsTest::watersheds4Test));
         add( testCase( &RegionGrowingTest::voronoiTest));
         add( testCase( &RegionGrowingTest::voronoiWithBorderTest));
+        add( testCase( &RegionGrowingTest::bucketQueueTest));
         add( testCase( &InterestOperatorTest::cornerResponseFunctionTest));
         add( testCase( &InterestOperatorTest::foerstnerCornerTest));
         add( testCase( &InterestOperatorTest::rohrCornerTest));
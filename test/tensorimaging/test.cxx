@@ -224,6 +224,28 @@ struct EdgeJunctionTensorTest
         shouldEqualSequenceTolerance(res.begin(), res.end(), ref.begin(), 1e-12);
     }
 
+    void boundaryTensorArenaTest()
+    {
+        V3Image ref(img2.size()), res(img2.size());
+        boundaryTensor(srcImageRange(img2), destImage(ref), 2.0);
+        
+        ScratchArena arena;
+        for(int k=0; k<2; ++k)
+        {
+            arena.resetStatistics();
+            boundaryTensor(srcImageRange(img2), destImage(res), 2.0, arena);
+            shouldEqualSequence(res.begin(), res.end(), ref.begin());
+            shouldEqual(arena.bytesInUse(), 0u);
+            if(k > 0)
+                shouldEqual(arena.systemAllocations(), 0u);
+        }
+        
+        boundaryTensor1(srcImageRange(img2), destImage(ref), 2.0);
+        boundaryTensor1(srcImageRange(img2), destImage(res), 2.0, arena);
+        shouldEqualSequence(res.begin(), res.end(), ref.begin());
+        shouldEqual(arena.systemAllocations(), 0u);
+    }
+
     void boundaryTensorTest3()
     {
         // does not produce the correct result
@@ -304,6 +326,7 @@ struct TensorTestSuite
         add( testCase( &EdgeJunctionTensorTest::rieszTransform02Test));
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest0));
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest1));
+        add( testCase( &EdgeJunctionTensorTest::boundaryTensorArenaTest));
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest2));
         add( testCase( &EdgeJunctionTensorTest::hourglassTest));
         add( testCase( &EdgeJunctionTensorTest::energyTensorTest));
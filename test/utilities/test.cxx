@@ -41,9 +41,19 @@
 #include "unittest.hxx"
 #include "vigra/accessor.hxx"
 #include "vigra/array_vector.hxx"
+#include "vigra/histogram.hxx"
 #include "vigra/copyimage.hxx"
 #include "vigra/sized_int.hxx"
 #include "vigra/bucket_queue.hxx"
+#include "vigra/threadpool.hxx"
+#include "vigra/random.hxx"
+#include "vigra/multi_array.hxx"
+#include "vigra/multi_iterator_coupled.hxx"
+#include "vigra/scratch_arena.hxx"
+#ifdef VIGRA_HAS_STD_THREAD
+#include <atomic>
+#include <chrono>
+#endif
 
 using namespace vigra;
 
@@ -224,6 +234,45 @@ struct ArrayVectorTest
         ArrayVector<std::ptrdiff_t> a(2, std::ptrdiff_t(1));
         ArrayVector<std::ptrdiff_t> b(a.begin(), a.end());
     }
+
+    void testMove()
+    {
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+        static value_type data[] = { 0, 1, 2, 3, 4 };
+        
+        Vector a(data, data + 5);
+        value_type * p = a.data();
+        Vector b(std::move(a));
+        shouldEqual(b.data(), p);
+        shouldEqual(a.size(), 0u);
+        shouldEqualSequence(b.begin(), b.end(), data);
+        
+        // moved-from vectors are still usable
+        a.push_back(7);
+        shouldEqual(a.size(), 1u);
+        shouldEqual(a[0], 7);
+
+        // different size => the memory is taken over
+        a = std::move(b);
+        shouldEqual(a.data(), p);
+        shouldEqual(b.size(), 0u);
+
+        // same size => the memory is taken over as well
+        Vector c(5, 0);
+        c = std::move(a);
+        shouldEqual(c.data(), p);
+        shouldEqual(a.size(), 0u);
+        shouldEqualSequence(c.begin(), c.end(), data);
+        
+        std::swap(a, c);
+        shouldEqual(a.data(), p);
+        shouldEqual(c.size(), 0u);
+        using std::swap;
+        swap(a, c);
+        shouldEqual(c.data(), p);
+        shouldEqual(a.size(), 0u);
+#endif
+    }
 };
 
 struct BucketQueueTest
@@ -460,6 +509,261 @@ struct MetaprogrammingTest
     }
 };
 
+struct ThreadPoolTest
+{
+    typedef CoupledIteratorType<2, int, UInt8>::type CoupledIterator;
+
+    struct Square
+    {
+        MultiArrayView<1, int> & a;
+
+        void operator()(int, std::ptrdiff_t i) const
+        {
+            a(i) = (int)(i*i);
+        }
+    };
+
+    struct Negate
+    {
+        void operator()(int, int & v) const
+        {
+            v = -v;
+        }
+    };
+
+    struct ClearMasked
+    {
+        void operator()(int, CoupledIterator::reference h) const
+        {
+            if(get<2>(h) != 0)
+                get<1>(h) = 0;
+        }
+    };
+
+    struct Throwing
+    {
+        void operator()(int, std::ptrdiff_t i) const
+        {
+            vigra_precondition(i != 77, "Throwing: index 77.");
+        }
+    };
+
+    struct RandomRows
+    {
+        MultiArrayView<2, double> & a;
+
+        void operator()(int, std::ptrdiff_t row) const
+        {
+            RandomMT19937 random = randomStream<RandomMT19937>(42, (UInt32)row);
+            for(int x=0; x<a.shape(0); ++x)
+                a(x, row) = random.uniform();
+        }
+    };
+
+#ifdef VIGRA_HAS_STD_THREAD
+    struct SleepingTask
+    {
+        int k;
+        std::atomic<int> * done;
+        std::atomic<int> * badId;
+
+        void operator()(int threadId) const
+        {
+            if(threadId < 0 || threadId >= 4)
+                ++*badId;
+            // very different running times to exercise work stealing
+            std::this_thread::sleep_for(std::chrono::microseconds(k % 7 == 0 ? 2000 : 10));
+            ++*done;
+        }
+    };
+#endif
+
+    struct RecordThread
+    {
+        MultiArrayView<1, int> & ids;
+
+        void operator()(int threadId, std::ptrdiff_t i) const
+        {
+            ids(i) = threadId;
+        }
+    };
+
+    struct NestedLoop
+    {
+        MultiArrayView<2, int> & ids;
+
+        void operator()(int, std::ptrdiff_t row) const
+        {
+            MultiArrayView<1, int> line = ids.bind<1>(row);
+            RecordThread f = { line };
+            parallel_foreach(4, line.size(), f);
+        }
+    };
+
+    void testThreadPool()
+    {
+#ifdef VIGRA_HAS_STD_THREAD
+        std::atomic<int> done(0), badId(0);
+        {
+            ThreadPool pool(4);
+            shouldEqual(pool.numThreads(), 4u);
+            std::vector<std::future<void> > results;
+            for(int k=0; k<200; ++k)
+            {
+                SleepingTask task = { k, &done, &badId };
+                results.push_back(pool.enqueue(task));
+            }
+            pool.waitFinished();
+            shouldEqual(done.load(), 200);
+            for(int k=0; k<200; ++k)
+                results[k].get();
+
+            for(int k=0; k<50; ++k)
+            {
+                SleepingTask task = { k, &done, &badId };
+                pool.enqueue(task);
+            }
+        }   // the destructor finishes all pending tasks
+        shouldEqual(done.load(), 250);
+        shouldEqual(badId.load(), 0);
+#endif
+    }
+
+    void testParallelForeach()
+    {
+        MultiArray<1, int> ref(Shape1(10000)), res(Shape1(10000));
+        Square f1 = { ref }, f4 = { res };
+        parallel_foreach(1, ref.size(), f1);
+        parallel_foreach(4, res.size(), f4);
+        for(int k=0; k<10000; ++k)
+            shouldEqual(ref(k), k*k);
+        should(ref == res);
+
+        // zero threads: use the default
+        res.init(0);
+        parallel_foreach(0, res.size(), f4);
+        should(ref == res);
+
+#ifdef VIGRA_HAS_STD_THREAD
+        {
+            ThreadPool pool(3);
+            res.init(0);
+            parallel_foreach(pool, res.size(), f4);
+            should(ref == res);
+        }
+#endif
+
+        try
+        {
+            parallel_foreach(4, 1000, Throwing());
+            failTest("no exception thrown");
+        }
+        catch(vigra::PreconditionViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nThrowing: index 77.");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void testParallelForeachIterators()
+    {
+        MultiArray<2, int> a(Shape2(100, 80));
+        linearSequence(a.begin(), a.end());
+        MultiArray<2, int> ref(a);
+
+        // strided scan-order iterator over a transposed subarray
+        MultiArrayView<2, int, StridedArrayTag> view = a.subarray(Shape2(10, 5), Shape2(90, 70)).transpose();
+        parallel_foreach(4, view.begin(), view.end(), Negate());
+        for(int y=0; y<80; ++y)
+            for(int x=0; x<100; ++x)
+                shouldEqual(a(x,y), (x >= 10 && x < 90 && y >= 5 && y < 70) ? -ref(x,y) : ref(x,y));
+
+        // coupled scan-order iterator
+        MultiArray<2, UInt8> mask(a.shape());
+        for(int y=0; y<80; ++y)
+            for(int x=0; x<100; ++x)
+                mask(x,y) = (x + y) % 3 == 0;
+        CoupledIterator iter = createCoupledIterator(a, mask),
+                        end  = iter.getEndIterator();
+        parallel_foreach(3, iter, end, ClearMasked());
+        for(int y=0; y<80; ++y)
+            for(int x=0; x<100; ++x)
+                if(mask(x,y))
+                    shouldEqual(a(x,y), 0);
+                else
+                    shouldEqual(a(x,y), (x >= 10 && x < 90 && y >= 5 && y < 70) ? -ref(x,y) : ref(x,y));
+
+#ifdef VIGRA_HAS_STD_THREAD
+        ThreadPool pool(2);
+        parallel_foreach(pool, view.begin(), view.end(), Negate());
+        for(int y=5; y<70; ++y)
+            for(int x=10; x<90; ++x)
+                if(!mask(x,y))
+                    shouldEqual(a(x,y), ref(x,y));
+#endif
+    }
+
+    void testSharedThreadPool()
+    {
+#ifdef VIGRA_HAS_STD_THREAD
+        // the pools are created once per thread count
+        ThreadPool & pool = sharedThreadPool(3);
+        shouldEqual(pool.numThreads(), 3u);
+        should(&sharedThreadPool(3) == &pool);
+        should(&sharedThreadPool(2) != &pool);
+        shouldEqual(sharedThreadPool().numThreads(), (std::size_t)defaultConcurrency());
+        should(!pool.isWorkerThread());
+#endif
+
+        MultiArray<1, int> ids(Shape1(1000));
+        RecordThread f = { ids };
+        parallel_foreach(3, ids.size(), f);
+        for(int k=0; k<ids.size(); ++k)
+            should(ids(k) >= 0 && ids(k) < 3);
+
+        // inner loops called from a shared pool run sequentially
+        MultiArray<2, int> nested(Shape2(100, 20), -1);
+        NestedLoop g = { nested };
+        parallel_foreach(3, nested.shape(1), g);
+        for(int k=0; k<nested.size(); ++k)
+            shouldEqual(nested[k], 0);
+    }
+
+    void testDefaultConcurrency()
+    {
+        int old = setDefaultConcurrency(3);
+        shouldEqual(old, hardwareConcurrency());
+        shouldEqual(defaultConcurrency(), 3);
+#ifdef VIGRA_HAS_STD_THREAD
+        {
+            ThreadPool pool;
+            shouldEqual(pool.numThreads(), 3u);
+        }
+#endif
+        shouldEqual(setDefaultConcurrency(0), 3);
+        shouldEqual(defaultConcurrency(), hardwareConcurrency());
+    }
+
+    void testRandomStreams()
+    {
+        MultiArray<2, double> r1(Shape2(50, 200)), r4(r1.shape());
+        RandomRows f1 = { r1 }, f4 = { r4 };
+        parallel_foreach(1, r1.shape(1), f1);
+        parallel_foreach(4, r4.shape(1), f4);
+        should(r1 == r4);
+
+        RandomMT19937 random = randomStream<RandomMT19937>(42, 7);
+        for(int x=0; x<50; ++x)
+            shouldEqual(r1(x, 7), random.uniform());
+
+        // different streams and seeds give different sequences
+        should(r1.bind<1>(7) != r1.bind<1>(8));
+        RandomMT19937 other = randomStream<RandomMT19937>(43, 7);
+        should(other.uniform() != r1(0, 7));
+    }
+};
+
 void stringTest()
 {
     std::string s;
@@ -474,6 +778,125 @@ void stringTest()
     shouldEqual(normalizeString("AluFr iNsta< Z89>"), "alufrinsta<z89>");
 }
 
+void histogramCopyTest()
+{
+    Histogram<double, int> h(0.0, 1.0, 4);
+    h.add(0.1);
+    
+    // copies refer to their own bins
+    Histogram<double, int> c(h);
+    c.add(0.1);
+    shouldEqual(h[0], 1);
+    shouldEqual(c[0], 2);
+    c = h;
+    c.add(0.9);
+    shouldEqual(c[0], 1);
+    shouldEqual(c[3], 1);
+    shouldEqual(h[3], 0);
+    
+#ifdef VIGRA_HAS_RVALUE_REFERENCES
+    Histogram<double, int> m(std::move(c));
+    shouldEqual(m[0], 1);
+    shouldEqual(m[3], 1);
+    should(!c.hasData());
+#endif
+}
+
+struct ThrowingCopy
+{
+    static int copies;
+
+    ThrowingCopy()
+    {}
+
+    ThrowingCopy(ThrowingCopy const &)
+    {
+        vigra_precondition(++copies < 10, "ThrowingCopy: too many copies.");
+    }
+};
+
+int ThrowingCopy::copies = 0;
+
+void scratchArenaTest()
+{
+    ScratchArena arena;
+    shouldEqual(arena.capacity(), 0u);
+    
+    ScratchArena::Mark m0 = arena.mark();
+    char * p1 = static_cast<char *>(arena.allocate(100));
+    shouldEqual(reinterpret_cast<std::size_t>(p1) % ScratchArena::alignment, 0u);
+    shouldEqual(arena.bytesInUse(), 128u);
+    shouldEqual(arena.capacity(), 128u);
+    
+    // a request that doesn't fit opens a new block
+    ScratchArena::Mark m1 = arena.mark();
+    char * p2 = static_cast<char *>(arena.allocate(1000));
+    shouldEqual(reinterpret_cast<std::size_t>(p2) % ScratchArena::alignment, 0u);
+    shouldEqual(arena.bytesInUse(), 128u+1024u);
+    shouldEqual(arena.systemAllocations(), 2u);
+    
+    // memory is reused after rewind()
+    arena.rewind(m1);
+    shouldEqual(arena.bytesInUse(), 128u);
+    should(static_cast<char *>(arena.allocate(1000)) == p2);
+    
+    // the blocks are merged when the arena becomes empty
+    arena.rewind(m0);
+    shouldEqual(arena.bytesInUse(), 0u);
+    shouldEqual(arena.highWaterMark(), 128u+1024u);
+    shouldEqual(arena.capacity(), 128u+1024u);
+    shouldEqual(arena.systemAllocations(), 3u);
+    
+    arena.resetStatistics();
+    arena.allocate(100);
+    arena.allocate(1000);
+    arena.rewind(m0);
+    shouldEqual(arena.systemAllocations(), 0u);
+    
+    {
+        ScratchArray<2, int> a(Shape2(10, 20), &arena, 3);
+        shouldEqual(a.shape(), Shape2(10, 20));
+        shouldEqual(a(9, 19), 3);
+        should(a.isUnstrided());
+        shouldEqual(arena.bytesInUse(), 832u);
+        
+        ScratchImage<double> i(Size2D(5, 5), &arena);
+        shouldEqual(i(4, 4), 0.0);
+        shouldEqual(arena.bytesInUse(), 832u+256u);
+        
+        // without an arena, the array owns its memory
+        ScratchArray<2, int> b(Shape2(10, 20));
+        shouldEqual(b(9, 19), 0);
+        shouldEqual(arena.bytesInUse(), 832u+256u);
+    }
+    shouldEqual(arena.bytesInUse(), 0u);
+    
+    // the memory is returned when the initialization throws
+    try
+    {
+        ThrowingCopy::copies = 0;
+        ScratchArray<1, ThrowingCopy> a(Shape1(100), &arena);
+        failTest("no exception thrown");
+    }
+    catch(vigra::PreconditionViolation &)
+    {}
+    shouldEqual(arena.bytesInUse(), 0u);
+    try
+    {
+        ThrowingCopy::copies = 0;
+        ScratchImage<ThrowingCopy> i(Size2D(10, 10), &arena);
+        failTest("no exception thrown");
+    }
+    catch(vigra::PreconditionViolation &)
+    {}
+    shouldEqual(arena.bytesInUse(), 0u);
+    
+    arena.release();
+    shouldEqual(arena.capacity(), 0u);
+    arena.reserve(5000);
+    shouldEqual(arena.capacity(), 5056u);
+}
+
 struct UtilitiesTestSuite
 : public vigra::test_suite
 {
@@ -483,6 +906,7 @@ struct UtilitiesTestSuite
         add( testCase( &ArrayVectorTest::testAccessor));
         add( testCase( &ArrayVectorTest::testBackInsertion));
         add( testCase( &ArrayVectorTest::testAmbiguousConstructor));
+        add( testCase( &ArrayVectorTest::testMove));
         add( testCase( &BucketQueueTest::testDescending));
         add( testCase( &BucketQueueTest::testAscending));
         add( testCase( &BucketQueueTest::testDescendingMapped));
@@ -491,7 +915,15 @@ struct UtilitiesTestSuite
         add( testCase( &MetaprogrammingTest::testInt));
         add( testCase( &MetaprogrammingTest::testLogic));
         add( testCase( &MetaprogrammingTest::testTypeTools));
+        add( testCase( &ThreadPoolTest::testThreadPool));
+        add( testCase( &ThreadPoolTest::testParallelForeach));
+        add( testCase( &ThreadPoolTest::testParallelForeachIterators));
+        add( testCase( &ThreadPoolTest::testSharedThreadPool));
+        add( testCase( &ThreadPoolTest::testDefaultConcurrency));
+        add( testCase( &ThreadPoolTest::testRandomStreams));
         add( testCase( &stringTest));
+        add( testCase( &histogramCopyTest));
+        add( testCase( &scratchArenaTest));
     }
 };
 
@@ -35,13 +35,23 @@
 
 #include <iostream>
 #include <functional>
+#include <cstdlib>
 #include <cmath>
 #include "unittest.hxx"
 
 #include "vigra/labelvolume.hxx"
+#include "vigra/random.hxx"
 
 using namespace vigra;
 
+struct DifferByAtMostOne
+{
+    bool operator()(int a, int b) const
+    {
+        return std::abs(a - b) <= 1;
+    }
+};
+
 struct VolumeLabelingTest
 {
     typedef vigra::MultiArray<3,int> IntVolume;
@@ -383,6 +393,66 @@ struct VolumeLabelingTest
 
     }
 
+    void labelingParallelTest()
+    {
+        IntVolume in(IntVolume::difference_type(17, 13, 23)), 
+                  desired(in.shape()), res(in.shape());
+        MersenneTwister random;
+        for(MultiArrayIndex k=0; k<in.size(); ++k)
+            in[k] = random.uniformInt(3);
+            
+        int threads[] = { 2, 3, 5, 8, 64 };
+        for(int t=0; t<5; ++t)
+        {
+            ParallelOptions opt = ParallelOptions().numThreads(threads[t]);
+            
+            unsigned int count = labelVolumeSix(srcMultiArrayRange(in), destMultiArray(desired));
+            shouldEqual(labelVolumeSix(srcMultiArrayRange(in), destMultiArray(res), opt), count);
+            should(res == desired);
+            
+            count = labelVolume(srcMultiArrayRange(in), destMultiArray(desired), NeighborCode3DTwentySix());
+            shouldEqual(labelVolume(srcMultiArrayRange(in), destMultiArray(res), NeighborCode3DTwentySix(), opt), count);
+            should(res == desired);
+            
+            count = labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(desired), NeighborCode3DSix(), 0);
+            shouldEqual(labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(res), NeighborCode3DSix(), 0, opt), count);
+            should(res == desired);
+            
+            count = labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(desired), NeighborCode3DTwentySix(), 0);
+            shouldEqual(labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(res), NeighborCode3DTwentySix(), 0, opt), count);
+            should(res == desired);
+        }
+        
+        // custom equality that also holds between background and foreground (values 0 
+        // and 1 are background, 2 is equal to both 1 and 3): background voxels must never 
+        // be merged into a region, not even across slabs
+        for(MultiArrayIndex k=0; k<in.size(); ++k)
+            in[k] = random.uniformInt(4);
+        for(int t=0; t<5; ++t)
+        {
+            ParallelOptions opt = ParallelOptions().numThreads(threads[t]);
+            
+            unsigned int count = labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(desired), 
+                                                           NeighborCode3DSix(), 0, DifferByAtMostOne());
+            shouldEqual(labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(res), 
+                                                  NeighborCode3DSix(), 0, DifferByAtMostOne(), opt), count);
+            should(res == desired);
+            for(MultiArrayIndex k=0; k<in.size(); ++k)
+                shouldEqual(res[k] == 0, in[k] <= 1);
+            
+            count = labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(desired), 
+                                              NeighborCode3DTwentySix(), 0, DifferByAtMostOne());
+            shouldEqual(labelVolumeWithBackground(srcMultiArrayRange(in), destMultiArray(res), 
+                                                  NeighborCode3DTwentySix(), 0, DifferByAtMostOne(), opt), count);
+            should(res == desired);
+        }
+        
+        // a single region spanning all slabs
+        IntVolume ones(in.shape(), 1);
+        shouldEqual(labelVolumeSix(srcMultiArrayRange(ones), destMultiArray(res), ParallelOptions().numThreads(4)), 1u);
+        should(res == ones);
+    }
+
     IntVolume vol1, vol2, vol3;
     DoubleVolume vol4, vol5, vol6;
 };
@@ -405,6 +475,7 @@ struct VolumeLabelingTestSuite
         add( testCase( &VolumeLabelingTest::labelingTwentySixTest3));
         add( testCase( &VolumeLabelingTest::labelingTwentySixWithBackgroundTest1));
         add( testCase( &VolumeLabelingTest::labelingAllTest));
+        add( testCase( &VolumeLabelingTest::labelingParallelTest));
     }
 };
 
@@ -40,6 +40,8 @@
 
 #include "vigra/watersheds3d.hxx"
 #include "vigra/multi_array.hxx"
+#include "vigra/multi_array_chunked.hxx"
+#include "vigra/blockwise_watersheds.hxx"
 #include "list"
 
 #include <stdlib.h>
@@ -457,6 +459,49 @@ struct Watersheds3dTest
     }
 
 
+    template <class Neighborhood>
+    void testBlockwiseImpl(Neighborhood nbh)
+    {
+        typedef IntVolume::difference_type Shape;
+        Shape shape(37, 29, 23);
+
+        // quantized smooth function plus noise to get many minima and plateaus
+        IntVolume vol(shape);
+        srand(42);
+        for(int z=0; z<shape[2]; ++z)
+            for(int y=0; y<shape[1]; ++y)
+                for(int x=0; x<shape[0]; ++x)
+                    vol(x,y,z) = (int)(3.0*std::sin(0.4*x) + 3.0*std::cos(0.3*y) + 2.0*std::sin(0.5*z)) + 
+                                 rand() % 3;
+
+        IntVolume reference(shape);
+        unsigned int count = watersheds3D(vol.traverser_begin(), shape, StandardConstValueAccessor<int>(),
+                                          reference.traverser_begin(), StandardValueAccessor<int>(), nbh);
+        should(count > 1);
+
+        Shape blockShapes[] = { Shape(8), Shape(5, 7, 3), Shape(1, 29, 23), Shape(64) };
+        for(int k=0; k<4; ++k)
+        {
+            IntVolume labels(shape);
+            BlockwiseOptions<3> opt;
+            opt.blockShape(blockShapes[k]).numThreads(3);
+            shouldEqual(watersheds3D(vol, labels, nbh, opt), count);
+            shouldEqualSequence(labels.begin(), labels.end(), reference.begin());
+        }
+
+        ChunkedArrayLazy<3, int> chunkedVol(shape, Shape(8)), chunkedLabels(shape, Shape(8));
+        chunkedVol.commitSubarray(Shape(), vol);
+        shouldEqual(watersheds3D(chunkedVol, chunkedLabels, nbh, BlockwiseOptions<3>()), count);
+        IntVolume labels(shape);
+        chunkedLabels.checkoutSubarray(Shape(), labels);
+        shouldEqualSequence(labels.begin(), labels.end(), reference.begin());
+    }
+
+    void testBlockwise()
+    {
+        testBlockwiseImpl(NeighborCode3DSix());
+        testBlockwiseImpl(NeighborCode3DTwentySix());
+    }
 };
 
 
@@ -472,6 +517,7 @@ struct SimpleAnalysisTestSuite
         add( testCase( &Watersheds3dTest::testWatersheds3dSix2));
         add( testCase( &Watersheds3dTest::testWatersheds3dGradient1));
         add( testCase( &Watersheds3dTest::testWatersheds3dGradient2));
+        add( testCase( &Watersheds3dTest::testBlockwise));
     }
 };
 